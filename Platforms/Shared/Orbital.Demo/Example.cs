@@ -2,6 +2,9 @@
 using System.Diagnostics;
 using System.IO;
 using System.Runtime.InteropServices;
+#if !CS2X
+using System.Threading.Tasks;
+#endif
 using Orbital.Host;
 using Orbital.Numerics;
 using Orbital.Video;
@@ -332,5 +335,126 @@ namespace Orbital.Demo
 				application.RunEvents();
 			}
 		}
+
+		#if !CS2X
+		/// <summary>
+		/// Measures draw-recording throughput as recording is split across more threads (results written to debug output)
+		/// </summary>
+		public void BenchmarkRecording(int drawCount, int maxThreadCount, int frameCount)
+		{
+			var commandLists = new CommandListBase[maxThreadCount];
+			for (int i = 0; i != maxThreadCount; ++i) commandLists[i] = device.CreateCommandList();
+			try
+			{
+				var windowSize = window.GetSize(WindowSizeType.WorkingArea);
+				var viewPort = new ViewPort(new Rect2(0, 0, windowSize.width, windowSize.height));
+				for (int threadCount = 1; threadCount <= maxThreadCount; threadCount *= 2)
+				{
+					int drawsPerThread = drawCount / threadCount;
+					var stopwatch = new Stopwatch();
+					for (int f = 0; f != frameCount; ++f)
+					{
+						device.BeginFrame();
+
+						// record in parallel
+						stopwatch.Start();
+						Parallel.For(0, threadCount, i =>
+						{
+							var commandList = commandLists[i];
+							commandList.Start();
+							commandList.BeginRenderPass(renderPass);
+							commandList.SetViewPort(viewPort);
+							commandList.SetRenderState(renderState);
+							for (int d = 0; d != drawsPerThread; ++d) commandList.Draw();
+							commandList.EndRenderPass();
+							commandList.Finish();
+						});
+						stopwatch.Stop();
+
+						// submit in order
+						for (int i = 0; i != threadCount; ++i) commandLists[i].Execute();
+						device.EndFrame();
+						application.RunEvents();
+					}
+
+					double ms = stopwatch.Elapsed.TotalMilliseconds / frameCount;
+					double drawsPerMS = (drawsPerThread * threadCount) / ms;
+					Debug.WriteLine(string.Format("Recording: {0} thread(s), {1:0.000}ms per frame, {2:0} draws per ms", threadCount, ms, drawsPerMS));
+				}
+			}
+			finally
+			{
+				foreach (var commandList in commandLists) commandList.Dispose();
+			}
+		}
+
+		/// <summary>
+		/// Records two passes into the swap-chain per frame with the render state bound outside them, so split barriers are begun, taken back by the second pass and ended at the draw and Finish (run with the debug layer, errors go to debug output)
+		/// </summary>
+		public void ValidateSplitBarriers(int frameCount)
+		{
+			application.RunEvents();
+			for (int f = 0; f != frameCount && !window.IsClosed(); ++f)
+			{
+				device.BeginFrame();
+				commandList.Start();
+				var windowSize = window.GetSize(WindowSizeType.WorkingArea);
+				for (int pass = 0; pass != 2; ++pass)
+				{
+					commandList.SetRenderState(renderState);// outside the pass: resource transitions begin split
+					commandList.BeginRenderPass(renderPass);// takes the image back from the split present transition of the first pass
+					commandList.SetViewPort(new ViewPort(new Rect2(0, 0, windowSize.width, windowSize.height)));
+					commandList.SetRenderState(renderState);
+					commandList.Draw();
+					commandList.EndRenderPass();
+				}
+				commandList.Finish();
+				commandList.Execute();
+				device.EndFrame();
+				application.RunEvents();
+			}
+			Debug.WriteLine(string.Format("Split barriers: recorded {0} frames", frameCount));
+		}
+
+		/// <summary>
+		/// Measures CPU frame time of a headless D3D12 device with 1, 2 and 3 frames in flight (results written to debug output)
+		/// </summary>
+		public void BenchmarkFramesInFlight(int frameCount)
+		{
+			// every frame uploads a texture on the copy queue the direct queue waits on, then disposes it while the frame is in flight
+			const int textureSize = 1024;
+			var textureData = new byte[textureSize * textureSize * 4];
+			for (int framesInFlight = 1; framesInFlight <= 3; ++framesInFlight)
+			{
+				var deviceDesc = new Video.D3D12.DeviceDesc()
+				{
+					adapterIndex = -1,
+					frameCount = framesInFlight
+				};
+				using (var headlessDevice = new Video.D3D12.Device((Video.D3D12.Instance)instance, DeviceType.Background))
+				{
+					if (!headlessDevice.Init(deviceDesc)) throw new Exception("Failed to init headless device");
+					using (var headlessCommandList = headlessDevice.CreateCommandList())
+					{
+						var stopwatch = Stopwatch.StartNew();
+						for (int f = 0; f != frameCount; ++f)
+						{
+							headlessDevice.BeginFrame();
+							var frameTexture = headlessDevice.CreateTexture2D(TextureFormat.B8G8R8A8, textureSize, textureSize, textureData, TextureMode.GPUOptimized);
+							headlessCommandList.Start();
+							headlessCommandList.Finish();
+							headlessCommandList.Execute();
+							frameTexture.Dispose();
+							headlessDevice.EndFrame();
+						}
+						stopwatch.Stop();
+
+						double ms = stopwatch.Elapsed.TotalMilliseconds / frameCount;
+						Debug.WriteLine(string.Format("Frames in flight: {0}, {1:0.000}ms per frame", framesInFlight, ms));
+					}
+				}
+			}
+		}
+		#endif
 	}
 }
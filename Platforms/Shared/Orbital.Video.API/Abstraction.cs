@@ -58,6 +58,7 @@ namespace Orbital.Video.API
 			deviceDescD3D12.adapterIndex = -1;
 			deviceDescD3D12.ensureSwapChainMatchesWindowSize = true;
 			deviceDescD3D12.swapChainBufferCount = 2;
+			deviceDescD3D12.frameCount = 2;
 			#endif
 
 			// set Vulkan defualts
@@ -0,0 +1,108 @@
+#include "BarrierBatch.h"
+
+void BarrierBatch_EndSplit(BarrierBatch* handle, D3D12_RESOURCE_BARRIER barrier)
+{
+	// begin half still queued: nothing ran in between so issue it as a whole transition
+	for (D3D12_RESOURCE_BARRIER& queued : *handle->barriers)
+	{
+		if (queued.Flags != D3D12_RESOURCE_BARRIER_FLAGS::D3D12_RESOURCE_BARRIER_FLAG_BEGIN_ONLY || queued.Transition.pResource != barrier.Transition.pResource || queued.Transition.Subresource != barrier.Transition.Subresource) continue;
+		queued.Flags = D3D12_RESOURCE_BARRIER_FLAGS::D3D12_RESOURCE_BARRIER_FLAG_NONE;
+		return;
+	}
+	barrier.Flags = D3D12_RESOURCE_BARRIER_FLAGS::D3D12_RESOURCE_BARRIER_FLAG_END_ONLY;
+	handle->barriers->push_back(barrier);
+}
+
+void BarrierBatch_EndTransition(BarrierBatch* handle, ID3D12Resource* resource, UINT subresource)
+{
+	// ends splits overlapping the subresource (all of them if either side covers every subresource)
+	for (size_t i = 0; i != handle->splitBarriers->size();)
+	{
+		D3D12_RESOURCE_BARRIER barrier = (*handle->splitBarriers)[i];
+		UINT splitSubresource = barrier.Transition.Subresource;
+		bool overlaps = subresource == D3D12_RESOURCE_BARRIER_ALL_SUBRESOURCES || splitSubresource == D3D12_RESOURCE_BARRIER_ALL_SUBRESOURCES || splitSubresource == subresource;
+		if (barrier.Transition.pResource != resource || !overlaps)
+		{
+			++i;
+			continue;
+		}
+		BarrierBatch_EndSplit(handle, barrier);
+		handle->splitBarriers->erase(handle->splitBarriers->begin() + i);
+	}
+}
+
+void BarrierBatch_Init(BarrierBatch* handle)
+{
+	handle->barriers = new std::vector<D3D12_RESOURCE_BARRIER>();
+	handle->splitBarriers = new std::vector<D3D12_RESOURCE_BARRIER>();
+}
+
+void BarrierBatch_Dispose(BarrierBatch* handle)
+{
+	if (handle->barriers != NULL)
+	{
+		delete handle->barriers;
+		handle->barriers = NULL;
+	}
+
+	if (handle->splitBarriers != NULL)
+	{
+		delete handle->splitBarriers;
+		handle->splitBarriers = NULL;
+	}
+}
+
+void BarrierBatch_Transition(BarrierBatch* handle, ID3D12Resource* resource, UINT subresource, D3D12_RESOURCE_STATES stateBefore, D3D12_RESOURCE_STATES stateAfter)
+{
+	// a split transition in flight must end before the resource changes state again
+	BarrierBatch_EndTransition(handle, resource, subresource);
+
+	// fold into transition already queued for this resource (A->B + B->C = A->C)
+	for (size_t i = 0; i != handle->barriers->size(); ++i)
+	{
+		D3D12_RESOURCE_BARRIER* barrier = &(*handle->barriers)[i];
+		if (barrier->Transition.pResource != resource || barrier->Transition.Subresource != subresource || barrier->Flags != D3D12_RESOURCE_BARRIER_FLAGS::D3D12_RESOURCE_BARRIER_FLAG_NONE) continue;
+		if (barrier->Transition.StateBefore == stateAfter) handle->barriers->erase(handle->barriers->begin() + i);
+		else barrier->Transition.StateAfter = stateAfter;
+		return;
+	}
+
+	if (stateBefore == stateAfter) return;
+	D3D12_RESOURCE_BARRIER barrier = {};
+	barrier.Type = D3D12_RESOURCE_BARRIER_TYPE::D3D12_RESOURCE_BARRIER_TYPE_TRANSITION;
+	barrier.Flags = D3D12_RESOURCE_BARRIER_FLAGS::D3D12_RESOURCE_BARRIER_FLAG_NONE;
+	barrier.Transition.pResource = resource;
+	barrier.Transition.StateBefore = stateBefore;
+	barrier.Transition.StateAfter = stateAfter;
+	barrier.Transition.Subresource = subresource;
+	handle->barriers->push_back(barrier);
+}
+
+void BarrierBatch_BeginTransition(BarrierBatch* handle, ID3D12Resource* resource, UINT subresource, D3D12_RESOURCE_STATES stateBefore, D3D12_RESOURCE_STATES stateAfter)
+{
+	// GPU may start the transition at the next flush and overlap it with work recorded before the end
+	BarrierBatch_EndTransition(handle, resource, subresource);
+	if (stateBefore == stateAfter) return;
+	D3D12_RESOURCE_BARRIER barrier = {};
+	barrier.Type = D3D12_RESOURCE_BARRIER_TYPE::D3D12_RESOURCE_BARRIER_TYPE_TRANSITION;
+	barrier.Flags = D3D12_RESOURCE_BARRIER_FLAGS::D3D12_RESOURCE_BARRIER_FLAG_BEGIN_ONLY;
+	barrier.Transition.pResource = resource;
+	barrier.Transition.StateBefore = stateBefore;
+	barrier.Transition.StateAfter = stateAfter;
+	barrier.Transition.Subresource = subresource;
+	handle->barriers->push_back(barrier);
+	handle->splitBarriers->push_back(barrier);
+}
+
+void BarrierBatch_EndTransitions(BarrierBatch* handle)
+{
+	for (const D3D12_RESOURCE_BARRIER& barrier : *handle->splitBarriers) BarrierBatch_EndSplit(handle, barrier);
+	handle->splitBarriers->clear();
+}
+
+void BarrierBatch_Flush(BarrierBatch* handle, ID3D12GraphicsCommandList* commandList)
+{
+	if (handle->barriers->size() == 0) return;
+	commandList->ResourceBarrier((UINT)handle->barriers->size(), handle->barriers->data());
+	handle->barriers->clear();
+}
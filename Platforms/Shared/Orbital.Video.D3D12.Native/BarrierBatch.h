@@ -0,0 +1,16 @@
+#pragma once
+#include "Common.h"
+#include <vector>
+
+struct BarrierBatch
+{
+	std::vector<D3D12_RESOURCE_BARRIER>* barriers;// queued until the next flush
+	std::vector<D3D12_RESOURCE_BARRIER>* splitBarriers;// begun but not yet ended
+};
+
+void BarrierBatch_Init(BarrierBatch* handle);
+void BarrierBatch_Dispose(BarrierBatch* handle);
+void BarrierBatch_Transition(BarrierBatch* handle, ID3D12Resource* resource, UINT subresource, D3D12_RESOURCE_STATES stateBefore, D3D12_RESOURCE_STATES stateAfter);
+void BarrierBatch_BeginTransition(BarrierBatch* handle, ID3D12Resource* resource, UINT subresource, D3D12_RESOURCE_STATES stateBefore, D3D12_RESOURCE_STATES stateAfter);
+void BarrierBatch_EndTransitions(BarrierBatch* handle);
+void BarrierBatch_Flush(BarrierBatch* handle, ID3D12GraphicsCommandList* commandList);
@@ -0,0 +1,114 @@
+#include "BindingSet.h"
+
+bool BindingSet_InitTables(BindingSet* handle, ShaderEffect* shaderEffect, UINT constantBufferCount, intptr_t* constantBuffers, UINT textureCount, intptr_t* textures)
+{
+	handle->shaderEffect = shaderEffect;
+	if (constantBufferCount != shaderEffect->constantBufferCount || textureCount != shaderEffect->textureCount) return false;
+
+	// both tables share one range of the device heap
+	DescriptorHeap* descriptorHeap = &handle->device->resourceDescriptorHeap;
+	if (constantBufferCount + textureCount != 0)
+	{
+		if (!DescriptorHeap_AllocateRange(descriptorHeap, constantBufferCount + textureCount, &handle->tableDescriptors)) return false;
+	}
+
+	// add constant buffer table
+	if (constantBufferCount != 0)
+	{
+		handle->constantBufferCount = constantBufferCount;
+		UINT size = sizeof(ConstantBuffer*) * handle->constantBufferCount;
+		handle->constantBuffers = (ConstantBuffer**)malloc(size);
+		memcpy(handle->constantBuffers, constantBuffers, size);
+		for (UINT i = 0; i != handle->constantBufferCount; ++i) HeapAllocator_Pin(&handle->device->heapAllocator, &handle->constantBuffers[i]->allocation);// descriptors copied below
+
+		handle->constantBufferGPUDescHandle = DescriptorHeap_GetGPUHandle(descriptorHeap, handle->tableDescriptors.index);
+		D3D12_CPU_DESCRIPTOR_HANDLE cpuComputerBufferHeap = DescriptorHeap_GetCPUHandle(descriptorHeap, handle->tableDescriptors.index);
+		UINT heapSize = descriptorHeap->descriptorSize;
+
+		// merge descriptors adjacent in a pool page into one source range
+		D3D12_CPU_DESCRIPTOR_HANDLE* srcRangeStarts = (D3D12_CPU_DESCRIPTOR_HANDLE*)alloca(sizeof(D3D12_CPU_DESCRIPTOR_HANDLE) * constantBufferCount);
+		UINT* srcRangeSizes = (UINT*)alloca(sizeof(UINT) * constantBufferCount);
+		UINT srcRangeCount = 0;
+		for (UINT i = 0; i != constantBufferCount; ++i)
+		{
+			D3D12_CPU_DESCRIPTOR_HANDLE descriptor = handle->constantBuffers[i]->descriptor;
+			if (srcRangeCount != 0 && srcRangeStarts[srcRangeCount - 1].ptr + ((SIZE_T)srcRangeSizes[srcRangeCount - 1] * heapSize) == descriptor.ptr)
+			{
+				++srcRangeSizes[srcRangeCount - 1];
+			}
+			else
+			{
+				srcRangeStarts[srcRangeCount] = descriptor;
+				srcRangeSizes[srcRangeCount] = 1;
+				++srcRangeCount;
+			}
+		}
+		UINT dstRangeSize = constantBufferCount;
+		handle->device->device->CopyDescriptors(1, &cpuComputerBufferHeap, &dstRangeSize, srcRangeCount, srcRangeStarts, srcRangeSizes, D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV);
+	}
+
+	// add texture table
+	if (textureCount != 0)
+	{
+		handle->textureCount = textureCount;
+		UINT size = sizeof(Texture*) * handle->textureCount;
+		handle->textures = (Texture**)malloc(size);
+		memcpy(handle->textures, textures, size);
+		for (UINT i = 0; i != handle->textureCount; ++i) HeapAllocator_Pin(&handle->device->heapAllocator, &handle->textures[i]->allocation);// descriptors copied below
+
+		handle->textureGPUDescHandle = DescriptorHeap_GetGPUHandle(descriptorHeap, handle->tableDescriptors.index + constantBufferCount);
+		D3D12_CPU_DESCRIPTOR_HANDLE cpuTextureHeap = DescriptorHeap_GetCPUHandle(descriptorHeap, handle->tableDescriptors.index + constantBufferCount);
+		D3D12_CPU_DESCRIPTOR_HANDLE* srcRangeStarts = (D3D12_CPU_DESCRIPTOR_HANDLE*)alloca(sizeof(D3D12_CPU_DESCRIPTOR_HANDLE) * textureCount);
+		UINT* srcRangeSizes = (UINT*)alloca(sizeof(UINT) * textureCount);
+		for (UINT i = 0; i != textureCount; ++i)
+		{
+			srcRangeStarts[i] = handle->textures[i]->textureHeap->GetCPUDescriptorHandleForHeapStart();
+			srcRangeSizes[i] = 1;
+		}
+		UINT dstRangeSize = textureCount;
+		handle->device->device->CopyDescriptors(1, &cpuTextureHeap, &dstRangeSize, textureCount, srcRangeStarts, srcRangeSizes, D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV);
+	}
+
+	return true;
+}
+
+void BindingSet_DisposeTables(BindingSet* handle)
+{
+	if (handle->constantBuffers != NULL)
+	{
+		for (UINT i = 0; i != handle->constantBufferCount; ++i) HeapAllocator_Unpin(&handle->device->heapAllocator, &handle->constantBuffers[i]->allocation);
+		free(handle->constantBuffers);
+		handle->constantBuffers = NULL;
+	}
+
+	if (handle->textures != NULL)
+	{
+		for (UINT i = 0; i != handle->textureCount; ++i) HeapAllocator_Unpin(&handle->device->heapAllocator, &handle->textures[i]->allocation);
+		free(handle->textures);
+		handle->textures = NULL;
+	}
+
+	Device_DeferFreeDescriptors(handle->device, &handle->tableDescriptors);
+}
+
+extern "C"
+{
+	ORBITAL_EXPORT BindingSet* Orbital_Video_D3D12_BindingSet_Create(Device* device)
+	{
+		BindingSet* handle = (BindingSet*)calloc(1, sizeof(BindingSet));
+		handle->device = device;
+		return handle;
+	}
+
+	ORBITAL_EXPORT int Orbital_Video_D3D12_BindingSet_Init(BindingSet* handle, BindingSetDesc* desc)
+	{
+		// no pipeline state is created, only descriptors are copied into the device heap
+		return BindingSet_InitTables(handle, (ShaderEffect*)desc->shaderEffect, desc->constantBufferCount, desc->constantBuffers, desc->textureCount, desc->textures);
+	}
+
+	ORBITAL_EXPORT void Orbital_Video_D3D12_BindingSet_Dispose(BindingSet* handle)
+	{
+		BindingSet_DisposeTables(handle);
+		free(handle);
+	}
+}
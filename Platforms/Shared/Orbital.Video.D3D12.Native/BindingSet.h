@@ -0,0 +1,25 @@
+#pragma once
+#include "Device.h"
+#include "ShaderEffect.h"
+#include "ConstantBuffer.h"
+#include "Texture.h"
+
+// resources for a ShaderEffect's descriptor tables, bound independently of the pipeline state
+struct BindingSet
+{
+	Device* device;
+	ShaderEffect* shaderEffect;
+
+	UINT constantBufferCount;
+	ConstantBuffer** constantBuffers;
+	D3D12_GPU_DESCRIPTOR_HANDLE constantBufferGPUDescHandle;
+
+	UINT textureCount;
+	Texture** textures;
+	D3D12_GPU_DESCRIPTOR_HANDLE textureGPUDescHandle;
+
+	DescriptorAllocation tableDescriptors;// constant buffer then texture table in the device heap
+};
+
+bool BindingSet_InitTables(BindingSet* handle, ShaderEffect* shaderEffect, UINT constantBufferCount, intptr_t* constantBuffers, UINT textureCount, intptr_t* textures);
+void BindingSet_DisposeTables(BindingSet* handle);
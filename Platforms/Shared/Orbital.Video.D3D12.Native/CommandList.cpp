@@ -2,138 +2,289 @@
 #include "SwapChain.h"
 #include "RenderPass.h"
 #include "RenderState.h"
+#include "BindingSet.h"
 #include "VertexBuffer.h"
 #include "ShaderEffect.h"
 #include "ConstantBuffer.h"
 
+void CommandList_ChangeBindingSetResources(CommandList* handle, BindingSet* bindingSet, bool split)
+{
+	for (UINT i = 0; i != bindingSet->constantBufferCount; ++i)
+	{
+		ConstantBuffer* constantBuffer = bindingSet->constantBuffers[i];
+		Orbital_Video_D3D12_ConstantBuffer_ChangeState(constantBuffer, D3D12_RESOURCE_STATE_VERTEX_AND_CONSTANT_BUFFER, &handle->stateTracker, split);
+	}
+
+	for (UINT i = 0; i != bindingSet->textureCount; ++i)
+	{
+		Texture* texture = bindingSet->textures[i];
+		D3D12_RESOURCE_STATES state = {};
+		ShaderEffectResourceUsage usage = bindingSet->shaderEffect->textures[i].usage;
+		if ((usage & ShaderEffectResourceUsage_PS) != 0) state |= D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE;
+		if ((usage & ~ShaderEffectResourceUsage_PS) != 0) state |= D3D12_RESOURCE_STATE_NON_PIXEL_SHADER_RESOURCE;
+		Orbital_Video_D3D12_Texture_ChangeState(texture, state, &handle->stateTracker, split);
+	}
+}
+
+void CommandList_ChangeRenderStateResources(CommandList* handle, RenderState* renderState, bool split)
+{
+	CommandList_ChangeBindingSetResources(handle, &renderState->bindingSet, split);
+	VertexBuffer* vertexBuffer = renderState->vertexBuffer;
+	if (vertexBuffer->mode != TextureMode_Read) Orbital_Video_D3D12_VertexBuffer_ChangeState(vertexBuffer, D3D12_RESOURCE_STATE_VERTEX_AND_CONSTANT_BUFFER, &handle->stateTracker, split);
+}
+
+void CommandList_SetDescriptorHeaps(CommandList* handle)
+{
+	// device heaps are the only shader visible ones, so this is the only heap switch a list (or bundle) records
+	ID3D12DescriptorHeap* heaps[2] = { handle->device->resourceDescriptorHeap.heap, handle->device->samplerDescriptorHeap.heap };
+	handle->commandList->SetDescriptorHeaps(2, heaps);
+}
+
+void CommandList_SetDescriptorTable(CommandList* handle, UINT index, D3D12_GPU_DESCRIPTOR_HANDLE table)
+{
+	if (handle->bindState.descriptorTables[index].ptr == table.ptr)
+	{
+		++handle->elidedCalls.descriptorTable;
+		return;
+	}
+	handle->commandList->SetGraphicsRootDescriptorTable(index, table);
+	handle->bindState.descriptorTables[index] = table;
+}
+
+void CommandList_SetShaderEffect(CommandList* handle, ShaderEffect* shaderEffect)
+{
+	if (handle->type == CommandListType_Compute) return;// compute lists have no graphics pipeline
+	CommandListBindState* bindState = &handle->bindState;
+	ID3D12RootSignature* rootSignature = shaderEffect->signatures[0];// TODO: handle multi-gpu
+	if (bindState->rootSignature == rootSignature)
+	{
+		++handle->elidedCalls.rootSignature;
+	}
+	else
+	{
+		handle->commandList->SetGraphicsRootSignature(rootSignature);
+		bindState->rootSignature = rootSignature;
+		memset(bindState->descriptorTables, 0, sizeof(bindState->descriptorTables));// root arguments are reset with the signature
+
+		// bindless tables only change with the signature
+		for (UINT i = 0; i != shaderEffect->bindlessTableCount; ++i) handle->commandList->SetGraphicsRootDescriptorTable(shaderEffect->bindlessParameterIndex + i, handle->device->resourceDescriptorHeap.gpuStart);
+	}
+	bindState->shaderEffect = shaderEffect;
+}
+
+void CommandList_SetBindingSetTables(CommandList* handle, BindingSet* bindingSet)
+{
+	// tables live in the device heap bound at Start
+	UINT descIndex = 0;
+	if (bindingSet->constantBufferCount != 0)
+	{
+		CommandList_SetDescriptorTable(handle, descIndex, bindingSet->constantBufferGPUDescHandle);
+		++descIndex;
+	}
+
+	if (bindingSet->textureCount != 0)
+	{
+		CommandList_SetDescriptorTable(handle, descIndex, bindingSet->textureGPUDescHandle);
+	}
+}
+
+void CommandList_UnpinBundleVertexBuffers(CommandList* handle)
+{
+	for (VertexBuffer* vertexBuffer : *handle->bundleVertexBuffers) HeapAllocator_Unpin(&handle->device->heapAllocator, &vertexBuffer->allocation);
+	handle->bundleVertexBuffers->clear();
+}
+
+void CommandList_SetVertexBuffer(CommandList* handle, VertexBuffer* vertexBuffer)
+{
+	if (handle->bindState.vertexBufferView == &vertexBuffer->vertexBufferView)
+	{
+		++handle->elidedCalls.vertexBuffer;
+		return;
+	}
+	handle->commandList->IASetVertexBuffers(0, 1, &vertexBuffer->vertexBufferView);
+	handle->bindState.vertexBufferView = &vertexBuffer->vertexBufferView;
+	if (handle->type == CommandListType_Bundle)
+	{
+		HeapAllocator_Pin(&handle->device->heapAllocator, &vertexBuffer->allocation);
+		handle->bundleVertexBuffers->push_back(vertexBuffer);
+	}
+}
+
 extern "C"
 {
 	ORBITAL_EXPORT CommandList* Orbital_Video_D3D12_CommandList_Create(Device* device)
 	{
 		CommandList* handle = (CommandList*)calloc(1, sizeof(CommandList));
 		handle->device = device;
+		BarrierBatch_Init(&handle->barrierBatch);
+		ResourceStateTracker_Init(&handle->stateTracker, &handle->barrierBatch);
 		return handle;
 	}
 
-	ORBITAL_EXPORT int Orbital_Video_D3D12_CommandList_Init(CommandList* handle)
+	ORBITAL_EXPORT int Orbital_Video_D3D12_CommandList_Init(CommandList* handle, CommandListType type)
 	{
 		// create command list
-		if (FAILED(handle->device->device->CreateCommandList(0, D3D12_COMMAND_LIST_TYPE_DIRECT, handle->device->commandAllocator, nullptr, IID_PPV_ARGS(&handle->commandList)))) return 0;
-		if (FAILED(handle->commandList->Close())) return 0;// make sure this is closed as it defaults to open for writing
-
-		// create fence
-		if (FAILED(handle->device->device->CreateFence(0, D3D12_FENCE_FLAG_NONE, IID_PPV_ARGS(&handle->fence)))) return 0;
-		handle->fenceEvent = CreateEvent(nullptr, FALSE, FALSE, nullptr);
-		if (handle->fenceEvent == NULL) return 0;
-
-		// make sure fence values start at 1 so they don't match 'GetCompletedValue' when its first called
-		handle->fenceValue = 1;
+		handle->type = type;
+		if (type == CommandListType_Bundle)
+		{
+			handle->bundleRenderStates = new std::vector<RenderState*>();
+			handle->bundleBindingSets = new std::vector<BindingSet*>();
+			handle->bundleVertexBuffers = new std::vector<VertexBuffer*>();
+			if (FAILED(handle->device->device->CreateCommandAllocator(D3D12_COMMAND_LIST_TYPE_BUNDLE, IID_PPV_ARGS(&handle->bundleAllocator)))) return 0;
+			if (FAILED(handle->device->device->CreateCommandList(0, D3D12_COMMAND_LIST_TYPE_BUNDLE, handle->bundleAllocator, nullptr, IID_PPV_ARGS(&handle->commandList)))) return 0;
+			return SUCCEEDED(handle->commandList->Close());
+		}
 
-		return 1;
+		DeviceRecordingContext* context = Device_AcquireRecordingContext(handle->device, type);
+		if (context == NULL) return 0;
+		D3D12_COMMAND_LIST_TYPE nativeType = type == CommandListType_Compute ? D3D12_COMMAND_LIST_TYPE_COMPUTE : D3D12_COMMAND_LIST_TYPE_DIRECT;
+		HRESULT result = handle->device->device->CreateCommandList(0, nativeType, context->commandAllocators[handle->device->frameIndex], nullptr, IID_PPV_ARGS(&handle->commandList));
+		if (SUCCEEDED(result)) result = handle->commandList->Close();// make sure this is closed as it defaults to open for writing
+		Device_ReleaseRecordingContext(handle->device, context);
+		return SUCCEEDED(result);
 	}
 
 	ORBITAL_EXPORT void Orbital_Video_D3D12_CommandList_Dispose(CommandList* handle)
 	{
+		if (handle->recordingContext != NULL)
+		{
+			Device_ReleaseRecordingContext(handle->device, handle->recordingContext);
+			handle->recordingContext = NULL;
+		}
+
 		if (handle->commandList != NULL)
 		{
-			handle->commandList->Release();
+			Device_DeferRelease(handle->device, handle->commandList);
 			handle->commandList = NULL;
 		}
 
-		if (handle->fenceEvent != NULL)
+		if (handle->bundleAllocator != NULL)
 		{
-			CloseHandle(handle->fenceEvent);
-			handle->fenceEvent = NULL;
+			Device_DeferRelease(handle->device, handle->bundleAllocator);
+			handle->bundleAllocator = NULL;
 		}
 
-		if (handle->fence != NULL)
+		if (handle->bundleRenderStates != NULL)
 		{
-			handle->fence->Release();
-			handle->fence = NULL;
+			delete handle->bundleRenderStates;
+			handle->bundleRenderStates = NULL;
 		}
 
+		if (handle->bundleBindingSets != NULL)
+		{
+			delete handle->bundleBindingSets;
+			handle->bundleBindingSets = NULL;
+		}
+
+		if (handle->bundleVertexBuffers != NULL)
+		{
+			CommandList_UnpinBundleVertexBuffers(handle);
+			delete handle->bundleVertexBuffers;
+			handle->bundleVertexBuffers = NULL;
+		}
+
+		ResourceStateTracker_Dispose(&handle->stateTracker);
+		BarrierBatch_Dispose(&handle->barrierBatch);
+
 		free(handle);
 	}
 
 	ORBITAL_EXPORT void Orbital_Video_D3D12_CommandList_Start(CommandList* handle, Device* device)
 	{
-		handle->commandList->Reset(device->commandAllocator, NULL);
+		memset(&handle->bindState, 0, sizeof(CommandListBindState));
+		memset(&handle->elidedCalls, 0, sizeof(CommandListElidedCalls));
+		ResourceStateTracker_Reset(&handle->stateTracker);
+		handle->insideRenderPass = false;
+		handle->transientPage = NULL;// page belongs to the frame it was acquired in
+		if (handle->type == CommandListType_Bundle)
+		{
+			// previous recording may still be replayed by in-flight lists, so swap allocators instead of resetting
+			ID3D12CommandAllocator* allocator;
+			if (SUCCEEDED(device->device->CreateCommandAllocator(D3D12_COMMAND_LIST_TYPE_BUNDLE, IID_PPV_ARGS(&allocator))))
+			{
+				Device_DeferRelease(device, handle->bundleAllocator);
+				handle->bundleAllocator = allocator;
+			}
+			handle->bundleRenderStates->clear();
+			handle->bundleBindingSets->clear();
+			CommandList_UnpinBundleVertexBuffers(handle);
+			handle->commandList->Reset(handle->bundleAllocator, NULL);
+			CommandList_SetDescriptorHeaps(handle);// must match the replaying list
+			return;
+		}
+
+		// grab allocator set no other thread is recording with (safe to call from worker threads)
+		handle->recordingContext = Device_AcquireRecordingContext(device, handle->type);
+		handle->commandList->Reset(handle->recordingContext->commandAllocators[device->frameIndex], NULL);
+		CommandList_SetDescriptorHeaps(handle);
 	}
 
 	ORBITAL_EXPORT void Orbital_Video_D3D12_CommandList_Finish(CommandList* handle)
 	{
+		// split transitions can't span command lists
+		BarrierBatch_EndTransitions(&handle->barrierBatch);
+		BarrierBatch_Flush(&handle->barrierBatch, handle->commandList);
 		handle->commandList->Close();
+		if (handle->recordingContext == NULL) return;// bundles own their allocator
+
+		// allocator keeps its memory until the frame completes but can now back another list
+		Device_ReleaseRecordingContext(handle->device, handle->recordingContext);
+		handle->recordingContext = NULL;
 	}
 	
 	ORBITAL_EXPORT void Orbital_Video_D3D12_CommandList_BeginRenderPass(CommandList* handle, RenderPass* renderPass)
 	{
+		if (handle->type == CommandListType_Compute) return;// compute lists have no graphics pipeline
+		handle->bindState.renderState = NULL;// render targets may also be bound as textures
+		handle->bindState.bindingSet = NULL;
+		handle->insideRenderPass = true;
+
+		// tracker supplies the before-state (first use in the list is resolved against the global state at submit)
 		if (renderPass->swapChain != NULL)
 		{
-			D3D12_RESOURCE_BARRIER barrier = {};
-			barrier.Type = D3D12_RESOURCE_BARRIER_TYPE::D3D12_RESOURCE_BARRIER_TYPE_TRANSITION;
-			barrier.Flags = D3D12_RESOURCE_BARRIER_FLAGS::D3D12_RESOURCE_BARRIER_FLAG_NONE;
-			barrier.Transition.pResource = renderPass->renderTargetViews[renderPass->swapChain->currentRenderTargetIndex];
-			barrier.Transition.StateBefore = D3D12_RESOURCE_STATES::D3D12_RESOURCE_STATE_PRESENT;
-			barrier.Transition.StateAfter = D3D12_RESOURCE_STATES::D3D12_RESOURCE_STATE_RENDER_TARGET;
-			barrier.Transition.Subresource = D3D12_RESOURCE_BARRIER_ALL_SUBRESOURCES;
-			handle->commandList->ResourceBarrier(1, &barrier);
+			ResourceStateTracker_Transition(&handle->stateTracker, renderPass->renderTargetStates[renderPass->swapChain->currentRenderTargetIndex], D3D12_RESOURCE_BARRIER_ALL_SUBRESOURCES, D3D12_RESOURCE_STATE_RENDER_TARGET, false);
+			BarrierBatch_Flush(&handle->barrierBatch, handle->commandList);
 			handle->commandList->BeginRenderPass(1, &renderPass->renderTargetDescs[renderPass->swapChain->currentRenderTargetIndex], renderPass->depthStencilDesc, D3D12_RENDER_PASS_FLAGS::D3D12_RENDER_PASS_FLAG_NONE);
 		}
 		else
 		{
-			D3D12_RESOURCE_BARRIER barriers[D3D12_SIMULTANEOUS_RENDER_TARGET_COUNT] = {};
 			for (UINT i = 0; i != renderPass->renderTargetCount; ++i)
 			{
-				barriers[i].Type = D3D12_RESOURCE_BARRIER_TYPE::D3D12_RESOURCE_BARRIER_TYPE_TRANSITION;
-				barriers[i].Flags = D3D12_RESOURCE_BARRIER_FLAGS::D3D12_RESOURCE_BARRIER_FLAG_NONE;
-				barriers[i].Transition.pResource = renderPass->renderTargetViews[i];
-				barriers[i].Transition.StateBefore = D3D12_RESOURCE_STATES::D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE;
-				barriers[i].Transition.StateAfter = D3D12_RESOURCE_STATES::D3D12_RESOURCE_STATE_RENDER_TARGET;
-				barriers[i].Transition.Subresource = D3D12_RESOURCE_BARRIER_ALL_SUBRESOURCES;
+				ResourceStateTracker_Transition(&handle->stateTracker, renderPass->renderTargetStates[i], D3D12_RESOURCE_BARRIER_ALL_SUBRESOURCES, D3D12_RESOURCE_STATE_RENDER_TARGET, false);
 			}
-			handle->commandList->ResourceBarrier(renderPass->renderTargetCount, barriers);
+			BarrierBatch_Flush(&handle->barrierBatch, handle->commandList);
 			handle->commandList->BeginRenderPass(renderPass->renderTargetCount, renderPass->renderTargetDescs, renderPass->depthStencilDesc, D3D12_RENDER_PASS_FLAGS::D3D12_RENDER_PASS_FLAG_NONE);
 		}
 	}
 
 	ORBITAL_EXPORT void Orbital_Video_D3D12_CommandList_EndRenderPass(CommandList* handle, RenderPass* renderPass)
 	{
+		if (handle->type == CommandListType_Compute) return;
+		handle->bindState.renderState = NULL;
+		handle->bindState.bindingSet = NULL;
 		handle->commandList->EndRenderPass();
+		handle->insideRenderPass = false;
 		if (renderPass->swapChain != NULL)
 		{
-			D3D12_RESOURCE_BARRIER barrier = {};
-			barrier.Type = D3D12_RESOURCE_BARRIER_TYPE::D3D12_RESOURCE_BARRIER_TYPE_TRANSITION;
-			barrier.Flags = D3D12_RESOURCE_BARRIER_FLAGS::D3D12_RESOURCE_BARRIER_FLAG_NONE;
-			barrier.Transition.pResource = renderPass->renderTargetViews[renderPass->swapChain->currentRenderTargetIndex];
-			barrier.Transition.StateBefore = D3D12_RESOURCE_STATES::D3D12_RESOURCE_STATE_RENDER_TARGET;
-			barrier.Transition.StateAfter = D3D12_RESOURCE_STATES::D3D12_RESOURCE_STATE_PRESENT;
-			barrier.Transition.Subresource = D3D12_RESOURCE_BARRIER_ALL_SUBRESOURCES;
-			handle->commandList->ResourceBarrier(1, &barrier);
-		}
-		else
-		{
-			D3D12_RESOURCE_BARRIER barriers[D3D12_SIMULTANEOUS_RENDER_TARGET_COUNT] = {};
-			for (UINT i = 0; i != renderPass->renderTargetCount; ++i)
-			{
-				barriers[i].Type = D3D12_RESOURCE_BARRIER_TYPE::D3D12_RESOURCE_BARRIER_TYPE_TRANSITION;
-				barriers[i].Flags = D3D12_RESOURCE_BARRIER_FLAGS::D3D12_RESOURCE_BARRIER_FLAG_NONE;
-				barriers[i].Transition.pResource = renderPass->renderTargetViews[i];
-				barriers[i].Transition.StateBefore = D3D12_RESOURCE_STATES::D3D12_RESOURCE_STATE_RENDER_TARGET;
-				barriers[i].Transition.StateAfter = D3D12_RESOURCE_STATES::D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE;
-				barriers[i].Transition.Subresource = D3D12_RESOURCE_BARRIER_ALL_SUBRESOURCES;
-			}
-			handle->commandList->ResourceBarrier(renderPass->renderTargetCount, barriers);
+			// begin now so the transition overlaps the rest of the list, ends at Finish (or when a later pass takes the image back)
+			ResourceStateTracker_Transition(&handle->stateTracker, renderPass->renderTargetStates[renderPass->swapChain->currentRenderTargetIndex], D3D12_RESOURCE_BARRIER_ALL_SUBRESOURCES, D3D12_RESOURCE_STATE_PRESENT, true);
+			BarrierBatch_Flush(&handle->barrierBatch, handle->commandList);
 		}
+
+		// other targets stay in RENDER_TARGET until their next use transitions them
 	}
 
 	ORBITAL_EXPORT void Orbital_Video_D3D12_CommandList_ClearSwapChainRenderTarget(CommandList* handle, SwapChain* swapChain, float r, float g, float b, float a)
 	{
+		if (handle->type == CommandListType_Compute) return;
 		float rgba[4] = {r, g, b, a};
+		BarrierBatch_Flush(&handle->barrierBatch, handle->commandList);
 		handle->commandList->ClearRenderTargetView(swapChain->renderTargetDescHandles[swapChain->currentRenderTargetIndex], rgba, 0, NULL);
 	}
 
 	ORBITAL_EXPORT void Orbital_Video_D3D12_CommandList_SetViewPort(CommandList* handle, UINT x, UINT y, UINT width, UINT height, float minDepth, float maxDepth)
 	{
+		if (handle->type == CommandListType_Compute) return;
 		D3D12_VIEWPORT viewPort;
 		viewPort.TopLeftX = x;
 		viewPort.TopLeftY = y;
@@ -141,6 +292,7 @@ extern "C"
 		viewPort.Height = height;
 		viewPort.MinDepth = minDepth;
 		viewPort.MaxDepth = maxDepth;
+		if (handle->type == CommandListType_Bundle) return;// bundles inherit view ports from the replaying list
 		handle->commandList->RSSetViewports(1, &viewPort);
 
 		D3D12_RECT rect;
@@ -153,71 +305,160 @@ extern "C"
 
 	ORBITAL_EXPORT void Orbital_Video_D3D12_CommandList_SetRenderState(CommandList* handle, RenderState* renderState)
 	{
-		// set resource states
-		for (UINT i = 0; i != renderState->constantBufferCount; ++i)
+		if (handle->type == CommandListType_Compute) return;
+		// substitute the fallback while the pipeline compiles (bundles keep whichever was bound when recorded)
+		CommandListBindState* bindState = &handle->bindState;
+		if (renderState->status != RenderStateStatus_Ready)
 		{
-			ConstantBuffer* constantBuffer = renderState->constantBuffers[i];
-			Orbital_Video_D3D12_ConstantBuffer_ChangeState(constantBuffer, D3D12_RESOURCE_STATE_VERTEX_AND_CONSTANT_BUFFER, handle->commandList);
+			renderState = renderState->fallback;
+			bindState->skipDraws = renderState == NULL || renderState->status != RenderStateStatus_Ready;
+			if (bindState->skipDraws) return;
 		}
-
-		for (UINT i = 0; i != renderState->textureCount; ++i)
+		else
 		{
-			Texture* texture = renderState->textures[i];
-			D3D12_RESOURCE_STATES state = {};
-			if (renderState->shaderEffect->textures[i].usage == ShaderEffectResourceUsage_PS)
-			{
-				state = D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE;
-			}
-			else
-			{
-				state = D3D12_RESOURCE_STATE_NON_PIXEL_SHADER_RESOURCE;
-				if ((renderState->shaderEffect->textures[i].usage | ShaderEffectResourceUsage_PS) != 0) state |= D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE;
-			}
-			Orbital_Video_D3D12_Texture_ChangeState(texture, state, handle->commandList);
+			bindState->skipDraws = false;
 		}
 
-		VertexBuffer* vertexBuffer = renderState->vertexBuffer;
-		if (vertexBuffer->mode != TextureMode_Read) Orbital_Video_D3D12_VertexBuffer_ChangeState(vertexBuffer, D3D12_RESOURCE_STATE_VERTEX_AND_CONSTANT_BUFFER, handle->commandList);
+		// set resource states (bundles can't use barriers, the replaying list transitions them)
+		if (bindState->renderState == renderState)
+		{
+			++handle->elidedCalls.resourceStates;
+		}
+		else
+		{
+			if (handle->type == CommandListType_Bundle) handle->bundleRenderStates->push_back(renderState);
+			else CommandList_ChangeRenderStateResources(handle, renderState, !handle->insideRenderPass);
+			bindState->renderState = renderState;
+		}
 
-		// bind shader resources
-		handle->commandList->SetGraphicsRootSignature(renderState->shaderEffect->signatures[0]);// TODO: handle multi-gpu
+		// bind shader resources (pipeline only states leave the tables to SetBindingSet)
+		CommandList_SetShaderEffect(handle, renderState->shaderEffect);
+		CommandList_SetBindingSetTables(handle, &renderState->bindingSet);
 
-		UINT descIndex = 0;
-		if (renderState->constantBufferHeap != NULL)
+		// enable render state
+		if (bindState->pipelineState == renderState->state)
 		{
-			handle->commandList->SetDescriptorHeaps(1, &renderState->constantBufferHeap);
-			handle->commandList->SetGraphicsRootDescriptorTable(descIndex, renderState->constantBufferGPUDescHandle);
-			++descIndex;
+			++handle->elidedCalls.pipelineState;
+		}
+		else
+		{
+			handle->commandList->SetPipelineState(renderState->state);
+			bindState->pipelineState = renderState->state;
 		}
 
-		if (renderState->textureHeap != NULL)
+		// enable vertex / index buffers
+		if (bindState->topology == renderState->topology)
 		{
-			handle->commandList->SetDescriptorHeaps(1, &renderState->textureHeap);
-			handle->commandList->SetGraphicsRootDescriptorTable(descIndex, renderState->textureGPUDescHandle);
+			++handle->elidedCalls.topology;
 		}
+		else
+		{
+			handle->commandList->IASetPrimitiveTopology(renderState->topology);
+			bindState->topology = renderState->topology;
+		}
+		CommandList_SetVertexBuffer(handle, renderState->vertexBuffer);
+	}
 
-		// enable render state
-		handle->commandList->SetPipelineState(renderState->state);
+	ORBITAL_EXPORT void Orbital_Video_D3D12_CommandList_SetBindingSet(CommandList* handle, BindingSet* bindingSet)
+	{
+		if (handle->type == CommandListType_Compute) return;
+		// set resource states (bundles can't use barriers, the replaying list transitions them)
+		CommandListBindState* bindState = &handle->bindState;
+		if (bindState->bindingSet == bindingSet)
+		{
+			++handle->elidedCalls.resourceStates;
+		}
+		else
+		{
+			if (handle->type == CommandListType_Bundle) handle->bundleBindingSets->push_back(bindingSet);
+			else CommandList_ChangeBindingSetResources(handle, bindingSet, !handle->insideRenderPass);
+			bindState->bindingSet = bindingSet;
+		}
 
-		// enable vertex / index buffers
-		handle->commandList->IASetPrimitiveTopology(renderState->topology);
-		handle->commandList->IASetVertexBuffers(0, 1, &vertexBuffer->vertexBufferView);
+		// only the tables change, the pipeline state stays bound
+		CommandList_SetShaderEffect(handle, bindingSet->shaderEffect);
+		CommandList_SetBindingSetTables(handle, bindingSet);
 	}
 
 	ORBITAL_EXPORT void Orbital_Video_D3D12_CommandList_SetVertexBuffer(CommandList* handle, VertexBuffer* vertexBuffer)
 	{
-		handle->commandList->IASetVertexBuffers(0, 1, &vertexBuffer->vertexBufferView);
+		if (handle->type == CommandListType_Compute) return;
+		CommandList_SetVertexBuffer(handle, vertexBuffer);
 	}
 
 	ORBITAL_EXPORT void Orbital_Video_D3D12_CommandList_DrawInstanced(CommandList* handle, UINT vertexIndex, UINT vertexCount, UINT instanceCount)
 	{
+		if (handle->type == CommandListType_Compute) return;
+		if (handle->bindState.skipDraws) return;
+		BarrierBatch_EndTransitions(&handle->barrierBatch);// bound resources begun outside the pass must be ready
+		BarrierBatch_Flush(&handle->barrierBatch, handle->commandList);
 		handle->commandList->DrawInstanced(vertexCount, instanceCount, vertexIndex, 0);
 	}
 
-	ORBITAL_EXPORT void Orbital_Video_D3D12_CommandList_Execute(CommandList* handle)
+	ORBITAL_EXPORT void Orbital_Video_D3D12_CommandList_ExecuteBundle(CommandList* handle, CommandList* bundle)
+	{
+		if (handle->type == CommandListType_Compute) return;
+		for (RenderState* renderState : *bundle->bundleRenderStates) CommandList_ChangeRenderStateResources(handle, renderState, false);
+		for (BindingSet* bindingSet : *bundle->bundleBindingSets) CommandList_ChangeBindingSetResources(handle, bindingSet, false);
+		BarrierBatch_EndTransitions(&handle->barrierBatch);
+		BarrierBatch_Flush(&handle->barrierBatch, handle->commandList);
+		handle->commandList->ExecuteBundle(bundle->commandList);
+
+		// state set by the bundle carries over to this list (heaps match so they stay bound)
+		memset(&handle->bindState, 0, sizeof(CommandListBindState));
+	}
+
+	ORBITAL_EXPORT int Orbital_Video_D3D12_CommandList_AllocateTransient(CommandList* handle, UINT64 size, void** data, UINT64* gpuAddress)
+	{
+		// bundles are replayed after the frame that owns the memory has completed
+		if (handle->type == CommandListType_Bundle) return 0;
+
+		const UINT64 alignment = TRANSIENT_ALLOCATOR_ALIGNMENT - 1;
+		const UINT64 alignedSize = (size + alignment) & ~alignment;
+		if (handle->transientPage == NULL || handle->transientOffset + alignedSize > handle->transientPage->size)
+		{
+			handle->transientPage = TransientAllocator_AcquirePage(&handle->device->transientAllocator, alignedSize, handle->device->frames[handle->device->frameIndex].transientPages);
+			handle->transientOffset = 0;
+			if (handle->transientPage == NULL) return 0;
+		}
+
+		*data = handle->transientPage->data + handle->transientOffset;
+		*gpuAddress = handle->transientPage->gpuAddress + handle->transientOffset;
+		handle->transientOffset += alignedSize;
+		return 1;
+	}
+
+	ORBITAL_EXPORT void Orbital_Video_D3D12_CommandList_SetRootConstantBuffer(CommandList* handle, UINT index, UINT64 gpuAddress)
+	{
+		ShaderEffect* shaderEffect = handle->bindState.shaderEffect;
+		if (shaderEffect == NULL || index >= shaderEffect->rootConstantBufferCount) return;
+		handle->commandList->SetGraphicsRootConstantBufferView(shaderEffect->rootConstantBufferParameterIndex + index, gpuAddress);
+	}
+
+	ORBITAL_EXPORT void Orbital_Video_D3D12_CommandList_SetRootShaderResource(CommandList* handle, UINT index, UINT64 gpuAddress)
+	{
+		ShaderEffect* shaderEffect = handle->bindState.shaderEffect;
+		if (shaderEffect == NULL || index >= shaderEffect->rootShaderResourceCount) return;
+		handle->commandList->SetGraphicsRootShaderResourceView(shaderEffect->rootShaderResourceParameterIndex + index, gpuAddress);
+	}
+
+	ORBITAL_EXPORT void Orbital_Video_D3D12_CommandList_SetRootConstants(CommandList* handle, UINT index, void* data, UINT count, UINT offset)
+	{
+		// values are copied into the list, no descriptor or buffer is involved
+		ShaderEffect* shaderEffect = handle->bindState.shaderEffect;
+		if (shaderEffect == NULL || index >= shaderEffect->rootConstantCount) return;
+		if (offset + count > (UINT)shaderEffect->rootConstants[index].count) return;
+		handle->commandList->SetGraphicsRoot32BitConstants(shaderEffect->rootConstantParameterIndex + index, count, data, offset);
+	}
+
+	ORBITAL_EXPORT void Orbital_Video_D3D12_CommandList_GetElidedCalls(CommandList* handle, CommandListElidedCalls* elidedCalls)
+	{
+		*elidedCalls = handle->elidedCalls;
+	}
+
+	ORBITAL_EXPORT UINT64 Orbital_Video_D3D12_CommandList_Execute(CommandList* handle)
 	{
-		ID3D12CommandList* commandLists[1] = { handle->commandList };
-		handle->device->commandQueue->ExecuteCommandLists(1, commandLists);
-		WaitForFence(handle->device, handle->fence, handle->fenceEvent, handle->fenceValue);// make sure gpu has finished before we continue
+		// non-blocking: frame fences protect allocators, use the returned ticket to wait on results
+		return Orbital_Video_D3D12_Device_ExecuteCommandLists(handle->device, &handle, 1);
 	}
 }
\ No newline at end of file
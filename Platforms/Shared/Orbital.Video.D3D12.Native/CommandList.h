@@ -1,12 +1,49 @@
 #pragma once
 #include "Device.h"
+#include "RenderState.h"
+
+// shadow of what is bound on the native list so only deltas reach the driver
+struct CommandListBindState
+{
+	RenderState* renderState;// resources already transitioned for
+	BindingSet* bindingSet;
+	ShaderEffect* shaderEffect;// layout root arguments are set against
+	ID3D12RootSignature* rootSignature;
+	D3D12_GPU_DESCRIPTOR_HANDLE descriptorTables[2];// constant buffers, textures (reset with root signature)
+	ID3D12PipelineState* pipelineState;
+	D3D_PRIMITIVE_TOPOLOGY topology;
+	const D3D12_VERTEX_BUFFER_VIEW* vertexBufferView;
+	bool skipDraws;// render state is still compiling and has no fallback
+};
+
+// native calls skipped since Start because the state was already bound
+struct CommandListElidedCalls
+{
+	UINT64 resourceStates, rootSignature, descriptorTable, pipelineState, topology, vertexBuffer;
+};
 
 struct CommandList
 {
 	Device* device;
+	CommandListType type;
 	ID3D12GraphicsCommandList5* commandList;
+	DeviceRecordingContext* recordingContext;// held between Start and Finish
+	UINT64 fenceValue;// device fence ticket of the last submission
+	CommandListBindState bindState;
+	BarrierBatch barrierBatch;// transitions queued until the next draw, clear or render pass
+	bool insideRenderPass;// transitions recorded outside a pass are split and end at the next draw
+	ResourceStateTracker stateTracker;// resource states local to this list, resolved at submit
+	CommandListElidedCalls elidedCalls;
+
+	// bump allocated upload memory valid until the frame it was allocated in completes
+	TransientPage* transientPage;
+	UINT64 transientOffset;
+
+	// bundles own their allocator as they are replayed across frames
+	ID3D12CommandAllocator* bundleAllocator;
+	std::vector<RenderState*>* bundleRenderStates;// resources the replaying list must transition
+	std::vector<BindingSet*>* bundleBindingSets;
+	std::vector<VertexBuffer*>* bundleVertexBuffers;// pinned as the recorded view can't be retargeted
+};
 
-	ID3D12Fence* fence;
-	HANDLE fenceEvent;
-	UINT64 fenceValue;
-};
\ No newline at end of file
+extern "C" ORBITAL_EXPORT UINT64 Orbital_Video_D3D12_Device_ExecuteCommandLists(Device* handle, CommandList** commandLists, UINT commandListCount);
\ No newline at end of file
@@ -1,5 +1,39 @@
 #include "ConstantBuffer.h"
 
+void ConstantBuffer_CreateView(ConstantBuffer* handle)
+{
+	D3D12_CONSTANT_BUFFER_VIEW_DESC cbvDesc = {};
+	cbvDesc.BufferLocation = handle->resource->GetGPUVirtualAddress();
+	cbvDesc.SizeInBytes = (UINT)handle->resource->GetDesc().Width;
+	handle->device->device->CreateConstantBufferView(&cbvDesc, handle->descriptor);
+}
+
+void ConstantBuffer_WriteBindlessDescriptor(ConstantBuffer* handle)
+{
+	// copy the CPU view into the shader visible slot
+	D3D12_CPU_DESCRIPTOR_HANDLE slot = DescriptorHeap_GetCPUHandle(&handle->device->resourceDescriptorHeap, handle->bindlessDescriptor.index);
+	handle->device->device->CopyDescriptorsSimple(1, slot, handle->descriptor, D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV);
+}
+
+void ConstantBuffer_Relocate(void* owner, ID3D12Resource* resource, HeapAllocation* allocation)
+{
+	// old copy may still be read by frames in flight
+	ConstantBuffer* handle = (ConstantBuffer*)owner;
+	HeapAllocation oldAllocation = handle->allocation;
+	Device_DeferRelease(handle->device, handle->resource);
+	Device_DeferFree(handle->device, &oldAllocation);
+
+	handle->resource = resource;
+	handle->allocation = *allocation;
+	ConstantBuffer_CreateView(handle);// CPU only heap, render states copy it when created
+
+	// frames in flight may still read the old slot, so the view goes into a new one (rewritten in place only if the heap is full)
+	DescriptorAllocation oldDescriptor = handle->bindlessDescriptor;
+	if (DescriptorHeap_AllocateSlot(&handle->device->resourceDescriptorHeap, &handle->bindlessDescriptor)) Device_DeferFreeDescriptors(handle->device, &oldDescriptor);
+	ConstantBuffer_WriteBindlessDescriptor(handle);
+	ResourceState_Retarget(&handle->resourceState, resource);
+}
+
 extern "C"
 {
 	ORBITAL_EXPORT ConstantBuffer* Orbital_Video_D3D12_ConstantBuffer_Create(Device* device, ConstantBufferMode mode)
@@ -14,17 +48,29 @@ extern "C"
 	{
 		const UINT32 alignment = D3D12_CONSTANT_BUFFER_DATA_PLACEMENT_ALIGNMENT - 1;
 		const int alignedSize = (size + alignment) & ~alignment;// size is required to be aligned
-		
+
+		// small buffers share a page resource and descriptor heap with others
+		if (ConstantBufferPool_Allocate(&handle->device->constantBufferPool, handle->mode, alignedSize, &handle->poolAllocation))
+		{
+			ConstantBufferPage* page = handle->poolAllocation.page;
+			handle->resource = page->resource;
+			handle->descriptor = ConstantBufferPool_GetDescriptor(&handle->device->constantBufferPool, &handle->poolAllocation);
+			if (!DescriptorHeap_AllocateSlot(&handle->device->resourceDescriptorHeap, &handle->bindlessDescriptor)) return 0;
+			ConstantBuffer_WriteBindlessDescriptor(handle);
+			if (initialData != NULL)
+			{
+				if (page->data != NULL) memcpy(page->data + handle->poolAllocation.offset, initialData, size);
+				else if (UploadEngine_UploadBuffer(&handle->device->uploadEngine, page->resource, handle->poolAllocation.offset, initialData, size) == 0) return 0;
+			}
+			return 1;
+		}
+
 		// create resource
-		D3D12_HEAP_PROPERTIES heapProperties = {};
-		if (handle->mode == ConstantBufferMode_GPUOptimized) heapProperties.Type = D3D12_HEAP_TYPE_DEFAULT;
-		else if (handle->mode == ConstantBufferMode_Write) heapProperties.Type = D3D12_HEAP_TYPE_UPLOAD;
-		else if (handle->mode == ConstantBufferMode_Read) heapProperties.Type = D3D12_HEAP_TYPE_READBACK;
+		D3D12_HEAP_TYPE heapType;
+		if (handle->mode == ConstantBufferMode_GPUOptimized) heapType = D3D12_HEAP_TYPE_DEFAULT;
+		else if (handle->mode == ConstantBufferMode_Write) heapType = D3D12_HEAP_TYPE_UPLOAD;
+		else if (handle->mode == ConstantBufferMode_Read) heapType = D3D12_HEAP_TYPE_READBACK;
 		else return 0;
-        heapProperties.CPUPageProperty = D3D12_CPU_PAGE_PROPERTY_UNKNOWN;
-        heapProperties.MemoryPoolPreference = D3D12_MEMORY_POOL_UNKNOWN;
-        heapProperties.CreationNodeMask = 1;// TODO: multi-gpu setup
-        heapProperties.VisibleNodeMask = 1;
 
 		D3D12_RESOURCE_DESC resourceDesc = {};
 		resourceDesc.Dimension = D3D12_RESOURCE_DIMENSION_BUFFER;
@@ -39,11 +85,11 @@ extern "C"
         resourceDesc.Layout = D3D12_TEXTURE_LAYOUT_ROW_MAJOR;
         resourceDesc.Flags = D3D12_RESOURCE_FLAG_NONE;
 
-		handle->resourceState = D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE;
-		if (initialData != NULL && handle->mode == ConstantBufferMode_GPUOptimized) handle->resourceState = D3D12_RESOURCE_STATE_COPY_DEST;// init for gpu copy
-		else if (handle->mode == ConstantBufferMode_Read) handle->resourceState = D3D12_RESOURCE_STATE_COPY_DEST;// init for CPU read
-		else if (handle->mode == ConstantBufferMode_Write) handle->resourceState = D3D12_RESOURCE_STATE_GENERIC_READ;// init for frequent cpu writes
-		if (FAILED(handle->device->device->CreateCommittedResource(&heapProperties, D3D12_HEAP_FLAG_NONE, &resourceDesc, handle->resourceState, NULL, IID_PPV_ARGS(&handle->resource)))) return 0;
+		D3D12_RESOURCE_STATES initialState = D3D12_RESOURCE_STATE_COMMON;// buffers are promoted on first use and decay back after each submission
+		if (handle->mode == ConstantBufferMode_Read) initialState = D3D12_RESOURCE_STATE_COPY_DEST;// init for CPU read
+		else if (handle->mode == ConstantBufferMode_Write) initialState = D3D12_RESOURCE_STATE_GENERIC_READ;// init for frequent cpu writes
+		if (!HeapAllocator_CreateResource(&handle->device->heapAllocator, heapType, &resourceDesc, initialState, &handle->resource, &handle->allocation)) return 0;
+		ResourceState_Init(&handle->resourceState, handle->resource, initialState);
 
 		// create resource heap
 		D3D12_DESCRIPTOR_HEAP_DESC heapDesc = {};
@@ -51,58 +97,30 @@ extern "C"
         heapDesc.Type = D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV;
         heapDesc.Flags = D3D12_DESCRIPTOR_HEAP_FLAG_NONE;// set to none so it can be copied in RenderState
         if (FAILED(handle->device->device->CreateDescriptorHeap(&heapDesc, IID_PPV_ARGS(&handle->resourceHeap)))) return 0;
-		handle->resourceHeapHandle = handle->resourceHeap->GetGPUDescriptorHandleForHeapStart();
+		handle->descriptor = handle->resourceHeap->GetCPUDescriptorHandleForHeapStart();
 
 		// create resource view
-		D3D12_CONSTANT_BUFFER_VIEW_DESC cbvDesc = {};
-        cbvDesc.BufferLocation = handle->resource->GetGPUVirtualAddress();
-        cbvDesc.SizeInBytes = alignedSize;
-        handle->device->device->CreateConstantBufferView(&cbvDesc, handle->resourceHeap->GetCPUDescriptorHandleForHeapStart());
+		ConstantBuffer_CreateView(handle);
+		if (!DescriptorHeap_AllocateSlot(&handle->device->resourceDescriptorHeap, &handle->bindlessDescriptor)) return 0;
+		ConstantBuffer_WriteBindlessDescriptor(handle);
+		if (heapType == D3D12_HEAP_TYPE_DEFAULT) HeapAllocator_SetRelocatable(&handle->device->heapAllocator, &handle->allocation, handle, ConstantBuffer_Relocate, handle->resource, &handle->resourceState);
 
 		// upload initial data
 		if (initialData != NULL)
 		{
-			// allocate gpu upload buffer if needed
-			bool useUploadBuffer = false;
-			ID3D12Resource* uploadResource = handle->resource;
-			if (heapProperties.Type != D3D12_HEAP_TYPE_UPLOAD)
+			if (heapType == D3D12_HEAP_TYPE_UPLOAD)
 			{
-				useUploadBuffer = true;
-				uploadResource = NULL;
-				heapProperties.Type = D3D12_HEAP_TYPE_UPLOAD;
-				if (FAILED(handle->device->device->CreateCommittedResource(&heapProperties, D3D12_HEAP_FLAG_NONE, &resourceDesc, D3D12_RESOURCE_STATE_GENERIC_READ, NULL, IID_PPV_ARGS(&uploadResource)))) return 0;
+				// copy CPU memory to GPU
+				UINT8* gpuDataPtr;
+				D3D12_RANGE readRange = {};
+				if (FAILED(handle->resource->Map(0, &readRange, reinterpret_cast<void**>(&gpuDataPtr)))) return 0;
+				memcpy(gpuDataPtr, initialData, size);
+				handle->resource->Unmap(0, nullptr);
 			}
-
-			// copy CPU memory to GPU
-			UINT8* gpuDataPtr;
-			D3D12_RANGE readRange = {};
-			if (FAILED(uploadResource->Map(0, &readRange, reinterpret_cast<void**>(&gpuDataPtr))))
+			else
 			{
-				if (useUploadBuffer) uploadResource->Release();
-				return 0;
-			}
-			memcpy(gpuDataPtr, initialData, size);
-			uploadResource->Unmap(0, nullptr);
-
-			// copy upload buffer to default buffer
-			if (useUploadBuffer)
-			{
-				handle->device->internalMutex->lock();
-				// reset command list and copy resource
-				handle->device->internalCommandList->Reset(handle->device->commandAllocator, NULL);
-				handle->device->internalCommandList->CopyResource(handle->resource, uploadResource);
-
-				// close command list
-				handle->device->internalCommandList->Close();
-
-				// execute operations
-				ID3D12CommandList* commandLists[1] = { handle->device->internalCommandList };
-				handle->device->commandQueue->ExecuteCommandLists(1, commandLists);
-				WaitForFence(handle->device, handle->device->internalFence, handle->device->internalFenceEvent, handle->device->internalFenceValue);
-
-				// release temp resource
-				uploadResource->Release();
-				handle->device->internalMutex->unlock();
+				// copy on copy queue (doesn't wait for GPU, direct queue waits on it before next submit)
+				if (UploadEngine_UploadBuffer(&handle->device->uploadEngine, handle->resource, 0, initialData, size) == 0) return 0;
 			}
 		}
 
@@ -111,6 +129,14 @@ extern "C"
 
 	ORBITAL_EXPORT void Orbital_Video_D3D12_ConstantBuffer_Dispose(ConstantBuffer* handle)
 	{
+		Device_DeferFreeDescriptors(handle->device, &handle->bindlessDescriptor);
+		if (handle->poolAllocation.page != NULL)
+		{
+			Device_DeferFreeConstantBuffer(handle->device, &handle->poolAllocation);
+			free(handle);
+			return;
+		}
+
 		if (handle->resourceHeap != NULL)
 		{
 			handle->resourceHeap->Release();
@@ -119,15 +145,26 @@ extern "C"
 
 		if (handle->resource != NULL)
 		{
-			handle->resource->Release();
+			Device_DeferRelease(handle->device, handle->resource);
+			Device_DeferFree(handle->device, &handle->allocation);
 			handle->resource = NULL;
 		}
 
+		ResourceState_Dispose(&handle->resourceState);
 		free(handle);
 	}
 
 	ORBITAL_EXPORT int Orbital_Video_D3D12_ConstantBuffer_Update(ConstantBuffer* handle, void* data, UINT dataSize, UINT dstOffset)
 	{
+		if (handle->poolAllocation.page != NULL)
+		{
+			// neighbouring slots belong to other buffers
+			ConstantBufferPage* page = handle->poolAllocation.page;
+			if (page->data == NULL || dstOffset + dataSize > handle->poolAllocation.size) return 0;
+			memcpy(page->data + handle->poolAllocation.offset + dstOffset, data, dataSize);
+			return 1;
+		}
+
 		UINT8* gpuDataPtr;
 		D3D12_RANGE readRange = {};
 		if (FAILED(handle->resource->Map(0, &readRange, reinterpret_cast<void**>(&gpuDataPtr)))) return 0;
@@ -135,19 +172,17 @@ extern "C"
 		handle->resource->Unmap(0, nullptr);
 		return 1;
 	}
+
+	ORBITAL_EXPORT UINT Orbital_Video_D3D12_ConstantBuffer_GetBindlessIndex(ConstantBuffer* handle)
+	{
+		if (handle->bindlessDescriptor.heap == NULL) return DESCRIPTOR_HEAP_INVALID_INDEX;
+		return handle->bindlessDescriptor.index;
+	}
 }
 
-void Orbital_Video_D3D12_ConstantBuffer_ChangeState(ConstantBuffer* handle, D3D12_RESOURCE_STATES state, ID3D12GraphicsCommandList5* commandList)
+void Orbital_Video_D3D12_ConstantBuffer_ChangeState(ConstantBuffer* handle, D3D12_RESOURCE_STATES state, ResourceStateTracker* stateTracker, bool split)
 {
-	if (handle->resourceState == state) return;
 	if (handle->mode == ConstantBufferMode_Read || handle->mode == ConstantBufferMode_Write) return;
-	D3D12_RESOURCE_BARRIER barrier = {};
-	barrier.Type = D3D12_RESOURCE_BARRIER_TYPE::D3D12_RESOURCE_BARRIER_TYPE_TRANSITION;
-	barrier.Flags = D3D12_RESOURCE_BARRIER_FLAGS::D3D12_RESOURCE_BARRIER_FLAG_NONE;
-	barrier.Transition.pResource = handle->resource;
-	barrier.Transition.StateBefore = handle->resourceState;
-	barrier.Transition.StateAfter = state;
-	barrier.Transition.Subresource = D3D12_RESOURCE_BARRIER_ALL_SUBRESOURCES;
-	commandList->ResourceBarrier(1, &barrier);
-	handle->resourceState = state;
+	ResourceState* resourceState = handle->poolAllocation.page != NULL ? &handle->poolAllocation.page->resourceState : &handle->resourceState;
+	ResourceStateTracker_Transition(stateTracker, resourceState, 0, state, split);
 }
\ No newline at end of file
@@ -1,14 +1,18 @@
 #pragma once
 #include "Device.h"
+#include "ResourceState.h"
 
 struct ConstantBuffer
 {
 	Device* device;
 	ConstantBufferMode mode;
-	ID3D12Resource* resource;
-	ID3D12DescriptorHeap* resourceHeap;
-	D3D12_GPU_DESCRIPTOR_HANDLE resourceHeapHandle;
-	D3D12_RESOURCE_STATES resourceState;
+	ID3D12Resource* resource;// shared page resource if pooled
+	HeapAllocation allocation;
+	ID3D12DescriptorHeap* resourceHeap;// NULL if pooled
+	D3D12_CPU_DESCRIPTOR_HANDLE descriptor;// CBV render states copy from
+	DescriptorAllocation bindlessDescriptor;// slot in the device heap (ConstantBuffer<T>[] in space 2), moves if the buffer is relocated
+	ResourceState resourceState;
+	ConstantBufferPoolAllocation poolAllocation;// page is NULL unless pooled
 };
 
-void Orbital_Video_D3D12_ConstantBuffer_ChangeState(ConstantBuffer* handle, D3D12_RESOURCE_STATES state, ID3D12GraphicsCommandList5* commandList);
\ No newline at end of file
+void Orbital_Video_D3D12_ConstantBuffer_ChangeState(ConstantBuffer* handle, D3D12_RESOURCE_STATES state, ResourceStateTracker* stateTracker, bool split);
\ No newline at end of file
@@ -0,0 +1,189 @@
+#include "ConstantBufferPool.h"
+#include "Device.h"
+
+ConstantBufferPage* ConstantBufferPool_CreatePage(ConstantBufferPool* handle, UINT pageType)
+{
+	ConstantBufferPage* page = (ConstantBufferPage*)calloc(1, sizeof(ConstantBufferPage));
+	ID3D12Device* device = handle->device->device;
+
+	// create shared resource
+	D3D12_RESOURCE_DESC resourceDesc = {};
+	resourceDesc.Dimension = D3D12_RESOURCE_DIMENSION_BUFFER;
+	resourceDesc.Width = CONSTANT_BUFFER_POOL_PAGE_SIZE;
+	resourceDesc.Height = 1;
+	resourceDesc.DepthOrArraySize = 1;
+	resourceDesc.MipLevels = 1;
+	resourceDesc.Format = DXGI_FORMAT_UNKNOWN;
+	resourceDesc.SampleDesc.Count = 1;
+	resourceDesc.Layout = D3D12_TEXTURE_LAYOUT_ROW_MAJOR;
+	resourceDesc.Flags = D3D12_RESOURCE_FLAG_NONE;
+
+	D3D12_HEAP_TYPE heapType = pageType == ConstantBufferMode_Write ? D3D12_HEAP_TYPE_UPLOAD : D3D12_HEAP_TYPE_DEFAULT;
+	D3D12_RESOURCE_STATES initialState = pageType == ConstantBufferMode_Write ? D3D12_RESOURCE_STATE_GENERIC_READ : D3D12_RESOURCE_STATE_COMMON;
+	if (!HeapAllocator_CreateResource(&handle->device->heapAllocator, heapType, &resourceDesc, initialState, &page->resource, &page->allocation))
+	{
+		free(page);
+		return NULL;
+	}
+	ResourceState_Init(&page->resourceState, page->resource, initialState);
+
+	// map upload pages for the lifetime of the pool
+	if (heapType == D3D12_HEAP_TYPE_UPLOAD)
+	{
+		D3D12_RANGE readRange = {};
+		if (FAILED(page->resource->Map(0, &readRange, reinterpret_cast<void**>(&page->data)))) page->data = NULL;
+	}
+
+	// create descriptor page
+	D3D12_DESCRIPTOR_HEAP_DESC heapDesc = {};
+	heapDesc.NumDescriptors = CONSTANT_BUFFER_POOL_SLOT_COUNT;
+	heapDesc.Type = D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV;
+	heapDesc.Flags = D3D12_DESCRIPTOR_HEAP_FLAG_NONE;// set to none so it can be copied in RenderState
+	if (FAILED(device->CreateDescriptorHeap(&heapDesc, IID_PPV_ARGS(&page->descriptorHeap))))
+	{
+		ResourceState_Dispose(&page->resourceState);
+		page->resource->Release();
+		HeapAllocator_Free(&handle->device->heapAllocator, &page->allocation);
+		free(page);
+		return NULL;
+	}
+	page->descriptorStart = page->descriptorHeap->GetCPUDescriptorHandleForHeapStart();
+
+	return page;
+}
+
+void ConstantBufferPool_DisposePage(ConstantBufferPool* handle, ConstantBufferPage* page)
+{
+	page->descriptorHeap->Release();
+	if (page->data != NULL) page->resource->Unmap(0, nullptr);
+	ResourceState_Dispose(&page->resourceState);
+	page->resource->Release();
+	HeapAllocator_Free(&handle->device->heapAllocator, &page->allocation);
+	free(page);
+}
+
+bool ConstantBufferPage_AllocateSlots(ConstantBufferPage* page, UINT slotCount, UINT* firstSlot)
+{
+	if (CONSTANT_BUFFER_POOL_SLOT_COUNT - page->usedSlotCount < slotCount) return false;
+
+	// first fit run of free slots
+	UINT runStart = 0, runLength = 0;
+	for (UINT i = 0; i != CONSTANT_BUFFER_POOL_SLOT_COUNT;)
+	{
+		UINT64 word = page->usedSlots[i >> 6];
+		if ((i & 63) == 0 && word == UINT64_MAX)
+		{
+			i += 64;
+			runStart = i;
+			runLength = 0;
+			continue;
+		}
+
+		if (word & (1ull << (i & 63)))
+		{
+			runStart = i + 1;
+			runLength = 0;
+		}
+		else if (++runLength == slotCount)
+		{
+			for (UINT s = runStart; s != runStart + slotCount; ++s) page->usedSlots[s >> 6] |= 1ull << (s & 63);
+			page->usedSlotCount += slotCount;
+			*firstSlot = runStart;
+			return true;
+		}
+		++i;
+	}
+	return false;
+}
+
+void ConstantBufferPool_Init(ConstantBufferPool* handle, Device* device)
+{
+	handle->device = device;
+	handle->descriptorSize = device->device->GetDescriptorHandleIncrementSize(D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV);
+	for (UINT i = 0; i != CONSTANT_BUFFER_POOL_PAGE_TYPE_COUNT; ++i) handle->pages[i] = new std::vector<ConstantBufferPage*>();
+	handle->mutex = new std::mutex();
+}
+
+void ConstantBufferPool_Dispose(ConstantBufferPool* handle)
+{
+	// GPU is idle and all deferred frees have been processed by the device
+	for (UINT i = 0; i != CONSTANT_BUFFER_POOL_PAGE_TYPE_COUNT; ++i)
+	{
+		if (handle->pages[i] != NULL)
+		{
+			for (ConstantBufferPage* page : *handle->pages[i]) ConstantBufferPool_DisposePage(handle, page);
+			delete handle->pages[i];
+			handle->pages[i] = NULL;
+		}
+	}
+
+	if (handle->mutex != NULL)
+	{
+		delete handle->mutex;
+		handle->mutex = NULL;
+	}
+}
+
+bool ConstantBufferPool_Allocate(ConstantBufferPool* handle, ConstantBufferMode mode, UINT size, ConstantBufferPoolAllocation* allocation)
+{
+	if (mode != ConstantBufferMode_GPUOptimized && mode != ConstantBufferMode_Write) return false;
+	if (size == 0 || size > CONSTANT_BUFFER_POOL_MAX_SIZE) return false;
+	const UINT slotCount = (size + (CONSTANT_BUFFER_POOL_SLOT_SIZE - 1)) / CONSTANT_BUFFER_POOL_SLOT_SIZE;
+
+	// find page with a large enough run or add one
+	ConstantBufferPage* page = NULL;
+	UINT firstSlot = 0;
+	{
+		std::lock_guard<std::mutex> lock(*handle->mutex);
+		std::vector<ConstantBufferPage*>* pages = handle->pages[mode];
+		for (ConstantBufferPage* existingPage : *pages)
+		{
+			if (ConstantBufferPage_AllocateSlots(existingPage, slotCount, &firstSlot))
+			{
+				page = existingPage;
+				break;
+			}
+		}
+
+		if (page == NULL)
+		{
+			page = ConstantBufferPool_CreatePage(handle, mode);
+			if (page == NULL) return false;
+			if (mode == ConstantBufferMode_Write && page->data == NULL)
+			{
+				ConstantBufferPool_DisposePage(handle, page);
+				return false;
+			}
+			pages->push_back(page);
+			ConstantBufferPage_AllocateSlots(page, slotCount, &firstSlot);
+		}
+	}
+
+	allocation->page = page;
+	allocation->offset = firstSlot * CONSTANT_BUFFER_POOL_SLOT_SIZE;
+	allocation->size = slotCount * CONSTANT_BUFFER_POOL_SLOT_SIZE;
+
+	// write view into the slot of the descriptor page (slots are only written by their owner)
+	D3D12_CONSTANT_BUFFER_VIEW_DESC cbvDesc = {};
+	cbvDesc.BufferLocation = page->resource->GetGPUVirtualAddress() + allocation->offset;
+	cbvDesc.SizeInBytes = allocation->size;
+	handle->device->device->CreateConstantBufferView(&cbvDesc, ConstantBufferPool_GetDescriptor(handle, allocation));
+	return true;
+}
+
+void ConstantBufferPool_Free(ConstantBufferPool* handle, ConstantBufferPoolAllocation* allocation)
+{
+	std::lock_guard<std::mutex> lock(*handle->mutex);
+	ConstantBufferPage* page = allocation->page;
+	const UINT firstSlot = allocation->offset / CONSTANT_BUFFER_POOL_SLOT_SIZE;
+	const UINT slotCount = allocation->size / CONSTANT_BUFFER_POOL_SLOT_SIZE;
+	for (UINT s = firstSlot; s != firstSlot + slotCount; ++s) page->usedSlots[s >> 6] &= ~(1ull << (s & 63));
+	page->usedSlotCount -= slotCount;
+}
+
+D3D12_CPU_DESCRIPTOR_HANDLE ConstantBufferPool_GetDescriptor(ConstantBufferPool* handle, ConstantBufferPoolAllocation* allocation)
+{
+	D3D12_CPU_DESCRIPTOR_HANDLE descriptor = allocation->page->descriptorStart;
+	descriptor.ptr += (SIZE_T)(allocation->offset / CONSTANT_BUFFER_POOL_SLOT_SIZE) * handle->descriptorSize;
+	return descriptor;
+}
@@ -0,0 +1,48 @@
+#pragma once
+#include "Common.h"
+#include "HeapAllocator.h"
+#include "ResourceState.h"
+#include <mutex>
+#include <vector>
+
+#define CONSTANT_BUFFER_POOL_SLOT_SIZE D3D12_CONSTANT_BUFFER_DATA_PLACEMENT_ALIGNMENT// 256
+#define CONSTANT_BUFFER_POOL_SLOT_COUNT 1024
+#define CONSTANT_BUFFER_POOL_PAGE_SIZE (CONSTANT_BUFFER_POOL_SLOT_SIZE * CONSTANT_BUFFER_POOL_SLOT_COUNT)// 256KB
+#define CONSTANT_BUFFER_POOL_MAX_SIZE (16 * CONSTANT_BUFFER_POOL_SLOT_SIZE)// larger buffers get their own resource
+#define CONSTANT_BUFFER_POOL_PAGE_TYPE_COUNT 2// GPU optimized, write
+
+struct Device;
+
+// shared buffer split into 256 byte slots, each logical constant buffer owns a run of them
+struct ConstantBufferPage
+{
+	ID3D12Resource* resource;
+	HeapAllocation allocation;
+	ResourceState resourceState;
+	UINT8* data;// persistently mapped (NULL unless upload heap)
+	ID3D12DescriptorHeap* descriptorHeap;// CPU only, one CBV slot per buffer slot so render states can copy runs of them
+	D3D12_CPU_DESCRIPTOR_HANDLE descriptorStart;
+	UINT64 usedSlots[CONSTANT_BUFFER_POOL_SLOT_COUNT / 64];
+	UINT usedSlotCount;
+};
+
+// range of a page owned by a constant buffer (offset is the handle within the page)
+struct ConstantBufferPoolAllocation
+{
+	ConstantBufferPage* page;
+	UINT offset, size;
+};
+
+struct ConstantBufferPool
+{
+	Device* device;
+	UINT descriptorSize;
+	std::vector<ConstantBufferPage*>* pages[CONSTANT_BUFFER_POOL_PAGE_TYPE_COUNT];
+	std::mutex* mutex;
+};
+
+void ConstantBufferPool_Init(ConstantBufferPool* handle, Device* device);
+void ConstantBufferPool_Dispose(ConstantBufferPool* handle);
+bool ConstantBufferPool_Allocate(ConstantBufferPool* handle, ConstantBufferMode mode, UINT size, ConstantBufferPoolAllocation* allocation);
+void ConstantBufferPool_Free(ConstantBufferPool* handle, ConstantBufferPoolAllocation* allocation);
+D3D12_CPU_DESCRIPTOR_HANDLE ConstantBufferPool_GetDescriptor(ConstantBufferPool* handle, ConstantBufferPoolAllocation* allocation);
@@ -0,0 +1,172 @@
+#include "DescriptorHeap.h"
+
+bool DescriptorHeap_Init(DescriptorHeap* handle, ID3D12Device* device, D3D12_DESCRIPTOR_HEAP_TYPE type, UINT capacity, UINT slotCount)
+{
+	handle->device = device;
+	handle->type = type;
+	handle->capacity = capacity;
+	handle->slotCount = slotCount;
+	handle->generations = (UINT*)calloc(slotCount, sizeof(UINT));
+	handle->freeSlots = new std::vector<UINT>();
+	handle->freeRanges = new std::vector<DescriptorHeapRange>();
+	handle->mutex = new std::mutex();
+	if (capacity != slotCount)
+	{
+		DescriptorHeapRange range;
+		range.start = slotCount;
+		range.count = capacity - slotCount;
+		handle->freeRanges->push_back(range);
+	}
+
+	// one heap for the device lifetime so command lists never switch heaps
+	D3D12_DESCRIPTOR_HEAP_DESC heapDesc = {};
+	heapDesc.NumDescriptors = capacity;
+	heapDesc.Type = type;
+	heapDesc.Flags = D3D12_DESCRIPTOR_HEAP_FLAG_SHADER_VISIBLE;
+	if (FAILED(device->CreateDescriptorHeap(&heapDesc, IID_PPV_ARGS(&handle->heap)))) return false;
+	handle->descriptorSize = device->GetDescriptorHandleIncrementSize(type);
+	handle->cpuStart = handle->heap->GetCPUDescriptorHandleForHeapStart();
+	handle->gpuStart = handle->heap->GetGPUDescriptorHandleForHeapStart();
+	return true;
+}
+
+void DescriptorHeap_Dispose(DescriptorHeap* handle)
+{
+	if (handle->heap != NULL)
+	{
+		handle->heap->Release();
+		handle->heap = NULL;
+	}
+
+	if (handle->generations != NULL)
+	{
+		free(handle->generations);
+		handle->generations = NULL;
+	}
+
+	if (handle->freeSlots != NULL)
+	{
+		delete handle->freeSlots;
+		handle->freeSlots = NULL;
+	}
+
+	if (handle->freeRanges != NULL)
+	{
+		delete handle->freeRanges;
+		handle->freeRanges = NULL;
+	}
+
+	if (handle->mutex != NULL)
+	{
+		delete handle->mutex;
+		handle->mutex = NULL;
+	}
+}
+
+bool DescriptorHeap_AllocateSlot(DescriptorHeap* handle, DescriptorAllocation* allocation)
+{
+	std::lock_guard<std::mutex> lock(*handle->mutex);
+
+	// reuse freed slots before growing into untouched ones
+	UINT index;
+	if (!handle->freeSlots->empty())
+	{
+		index = handle->freeSlots->back();
+		handle->freeSlots->pop_back();
+	}
+	else if (handle->slotHighWater != handle->slotCount)
+	{
+		index = handle->slotHighWater++;
+	}
+	else
+	{
+		return false;
+	}
+
+	++handle->usedSlotCount;
+	allocation->heap = handle;
+	allocation->index = index;
+	allocation->count = 1;
+	allocation->generation = handle->generations[index];
+	return true;
+}
+
+bool DescriptorHeap_AllocateRange(DescriptorHeap* handle, UINT count, DescriptorAllocation* allocation)
+{
+	if (count == 0) return false;
+	std::lock_guard<std::mutex> lock(*handle->mutex);
+	std::vector<DescriptorHeapRange>* freeRanges = handle->freeRanges;
+	for (size_t i = 0; i != freeRanges->size(); ++i)
+	{
+		DescriptorHeapRange& range = (*freeRanges)[i];
+		if (range.count < count) continue;
+
+		allocation->heap = handle;
+		allocation->index = range.start;
+		allocation->count = count;
+		allocation->generation = 0;// ranges are owned by a single render state
+		range.start += count;
+		range.count -= count;
+		if (range.count == 0) freeRanges->erase(freeRanges->begin() + i);
+		return true;
+	}
+	return false;
+}
+
+void DescriptorHeap_Free(DescriptorHeap* handle, DescriptorAllocation* allocation)
+{
+	if (allocation->heap != handle) return;
+	std::lock_guard<std::mutex> lock(*handle->mutex);
+	if (allocation->index < handle->slotCount)
+	{
+		// stale handle (slot already freed and maybe reused)
+		if (handle->generations[allocation->index] != allocation->generation) return;
+		++handle->generations[allocation->index];
+		handle->freeSlots->push_back(allocation->index);
+		--handle->usedSlotCount;
+		return;
+	}
+
+	// insert sorted and merge with neighbours
+	std::vector<DescriptorHeapRange>* freeRanges = handle->freeRanges;
+	size_t i = 0;
+	while (i != freeRanges->size() && (*freeRanges)[i].start < allocation->index) ++i;
+	DescriptorHeapRange range;
+	range.start = allocation->index;
+	range.count = allocation->count;
+	if (i != freeRanges->size() && range.start + range.count == (*freeRanges)[i].start)
+	{
+		range.count += (*freeRanges)[i].count;
+		freeRanges->erase(freeRanges->begin() + i);
+	}
+	if (i != 0 && (*freeRanges)[i - 1].start + (*freeRanges)[i - 1].count == range.start)
+	{
+		(*freeRanges)[i - 1].count += range.count;
+	}
+	else
+	{
+		freeRanges->insert(freeRanges->begin() + i, range);
+	}
+}
+
+bool DescriptorHeap_IsValid(DescriptorHeap* handle, DescriptorAllocation* allocation)
+{
+	if (allocation->heap != handle) return false;
+	if (allocation->index >= handle->slotCount) return true;
+	std::lock_guard<std::mutex> lock(*handle->mutex);
+	return handle->generations[allocation->index] == allocation->generation;
+}
+
+D3D12_CPU_DESCRIPTOR_HANDLE DescriptorHeap_GetCPUHandle(DescriptorHeap* handle, UINT index)
+{
+	D3D12_CPU_DESCRIPTOR_HANDLE descriptor = handle->cpuStart;
+	descriptor.ptr += (SIZE_T)index * handle->descriptorSize;
+	return descriptor;
+}
+
+D3D12_GPU_DESCRIPTOR_HANDLE DescriptorHeap_GetGPUHandle(DescriptorHeap* handle, UINT index)
+{
+	D3D12_GPU_DESCRIPTOR_HANDLE descriptor = handle->gpuStart;
+	descriptor.ptr += (UINT64)index * handle->descriptorSize;
+	return descriptor;
+}
@@ -0,0 +1,59 @@
+#pragma once
+#include "Common.h"
+#include <mutex>
+#include <vector>
+
+#define DESCRIPTOR_HEAP_RESOURCE_COUNT (64 * 1024)// CBV/SRV/UAV descriptors shared by the whole device
+#define DESCRIPTOR_HEAP_RESOURCE_SLOT_COUNT (32 * 1024)// front of the heap, the rest holds render state tables
+#define DESCRIPTOR_HEAP_SAMPLER_COUNT D3D12_MAX_SHADER_VISIBLE_SAMPLER_HEAP_SIZE// 2048
+#define DESCRIPTOR_HEAP_INVALID_INDEX UINT_MAX
+
+// shader space of the unbounded tables bindless indices address (t0/b0 of each)
+#define DESCRIPTOR_HEAP_BINDLESS_SRV_SPACE 1
+#define DESCRIPTOR_HEAP_BINDLESS_CBV_SPACE 2
+
+struct DescriptorHeap;
+
+// single slot (stable bindless index) or contiguous table range of a heap
+struct DescriptorAllocation
+{
+	DescriptorHeap* heap;// NULL if not allocated
+	UINT index, count;
+	UINT generation;// bumped each time a slot is freed so stale frees are ignored
+};
+
+struct DescriptorHeapRange
+{
+	UINT start, count;
+};
+
+// shader visible heap bound once per command list
+struct DescriptorHeap
+{
+	ID3D12Device* device;
+	ID3D12DescriptorHeap* heap;
+	D3D12_DESCRIPTOR_HEAP_TYPE type;
+	UINT descriptorSize;
+	D3D12_CPU_DESCRIPTOR_HANDLE cpuStart;
+	D3D12_GPU_DESCRIPTOR_HANDLE gpuStart;
+
+	// slots [0, slotCount) are handed out one at a time from a free list
+	UINT slotCount, usedSlotCount, slotHighWater;
+	UINT* generations;
+	std::vector<UINT>* freeSlots;
+
+	// tables [slotCount, capacity) are first fit ranges, kept sorted and merged
+	UINT capacity;
+	std::vector<DescriptorHeapRange>* freeRanges;
+
+	std::mutex* mutex;
+};
+
+bool DescriptorHeap_Init(DescriptorHeap* handle, ID3D12Device* device, D3D12_DESCRIPTOR_HEAP_TYPE type, UINT capacity, UINT slotCount);
+void DescriptorHeap_Dispose(DescriptorHeap* handle);
+bool DescriptorHeap_AllocateSlot(DescriptorHeap* handle, DescriptorAllocation* allocation);
+bool DescriptorHeap_AllocateRange(DescriptorHeap* handle, UINT count, DescriptorAllocation* allocation);
+void DescriptorHeap_Free(DescriptorHeap* handle, DescriptorAllocation* allocation);
+bool DescriptorHeap_IsValid(DescriptorHeap* handle, DescriptorAllocation* allocation);
+D3D12_CPU_DESCRIPTOR_HANDLE DescriptorHeap_GetCPUHandle(DescriptorHeap* handle, UINT index);
+D3D12_GPU_DESCRIPTOR_HANDLE DescriptorHeap_GetGPUHandle(DescriptorHeap* handle, UINT index);
@@ -1,6 +1,31 @@
 #include "Device.h"
 #include "CommandList.h"
 
+ID3D12GraphicsCommandList* Device_ResolveCommandList(Device* handle, CommandListType type, UINT index, DeviceRecordingContext** context)
+{
+	if (*context == NULL)
+	{
+		*context = Device_AcquireRecordingContext(handle, type);
+		if (*context == NULL) return NULL;
+	}
+	ID3D12CommandAllocator* allocator = (*context)->commandAllocators[handle->frameIndex];
+
+	// lists can be reset as soon as they are submitted, the allocator keeps their commands alive
+	std::vector<ID3D12GraphicsCommandList*>* resolveCommandLists = handle->resolveCommandLists[type];
+	ID3D12GraphicsCommandList* commandList;
+	if (index < resolveCommandLists->size())
+	{
+		commandList = (*resolveCommandLists)[index];
+		if (FAILED(commandList->Reset(allocator, NULL))) return NULL;
+		return commandList;
+	}
+
+	D3D12_COMMAND_LIST_TYPE nativeType = type == CommandListType_Compute ? D3D12_COMMAND_LIST_TYPE_COMPUTE : D3D12_COMMAND_LIST_TYPE_DIRECT;
+	if (FAILED(handle->device->CreateCommandList(0, nativeType, allocator, nullptr, IID_PPV_ARGS(&commandList)))) return NULL;
+	resolveCommandLists->push_back(commandList);
+	return commandList;
+}
+
 extern "C"
 {
 	ORBITAL_EXPORT Device* Orbital_Video_D3D12_Device_Create(Instance* instance)
@@ -8,11 +33,26 @@ extern "C"
 		Device* handle = (Device*)calloc(1, sizeof(Device));
 		handle->instance = instance;
 		handle->internalMutex = new std::mutex();
+		handle->recordingContextMutex = new std::mutex();
+		handle->recordingContexts = new std::vector<DeviceRecordingContext*>();
+		handle->freeRecordingContexts[CommandListType_Rasterize] = new std::vector<DeviceRecordingContext*>();
+		handle->freeRecordingContexts[CommandListType_Compute] = new std::vector<DeviceRecordingContext*>();
+		handle->resolveCommandLists[CommandListType_Rasterize] = new std::vector<ID3D12GraphicsCommandList*>();
+		handle->resolveCommandLists[CommandListType_Compute] = new std::vector<ID3D12GraphicsCommandList*>();
+		BarrierBatch_Init(&handle->resolveBarrierBatch);
+		handle->decayingResources = new std::vector<ResourceState*>();
+		handle->releases = new std::vector<DeviceRelease>();
 		return handle;
 	}
 
-	ORBITAL_EXPORT int Orbital_Video_D3D12_Device_Init(Device* handle, int adapterIndex, int softwareRasterizer)
+	ORBITAL_EXPORT int Orbital_Video_D3D12_Device_Init(Device* handle, int adapterIndex, int softwareRasterizer, int frameCount, int pipelineWorkerCount)
 	{
+		// validate frames in flight
+		if (frameCount <= 0) frameCount = DEVICE_DEFAULT_FRAME_COUNT;
+		if (frameCount > DEVICE_MAX_FRAME_COUNT) return 0;
+		handle->frameCount = frameCount;
+		if (pipelineWorkerCount < 0) return 0;
+
 		// get adapter
 		if (softwareRasterizer)
 		{
@@ -61,54 +101,177 @@ extern "C"
 		}
 		handle->maxRootSignatureVersion = rootSignature.HighestVersion;
 
+		// get resource binding tier (unbounded bindless tables need tier 2 for SRVs and tier 3 for CBVs)
+		D3D12_FEATURE_DATA_D3D12_OPTIONS options = {};
+		if (FAILED(handle->device->CheckFeatureSupport(D3D12_FEATURE::D3D12_FEATURE_D3D12_OPTIONS, &options, sizeof(D3D12_FEATURE_DATA_D3D12_OPTIONS)))) return 0;
+		handle->resourceBindingTier = options.ResourceBindingTier;
+
 		// create command queue
 		D3D12_COMMAND_QUEUE_DESC queueDesc = {};
 		queueDesc.Flags = D3D12_COMMAND_QUEUE_FLAG_NONE;
 		queueDesc.Type = D3D12_COMMAND_LIST_TYPE_DIRECT;
 		if (FAILED(handle->device->CreateCommandQueue(&queueDesc, IID_PPV_ARGS(&handle->commandQueue)))) return 0;
 
-		// create command allocator
-		if (FAILED(handle->device->CreateCommandAllocator(D3D12_COMMAND_LIST_TYPE_DIRECT, IID_PPV_ARGS(&handle->commandAllocator)))) return 0;
+		// create async compute queue
+		queueDesc.Type = D3D12_COMMAND_LIST_TYPE_COMPUTE;
+		if (FAILED(handle->device->CreateCommandQueue(&queueDesc, IID_PPV_ARGS(&handle->computeQueue)))) return 0;
 
-		// create fence
+		// create frame transient page lists
+		for (UINT i = 0; i != handle->frameCount; ++i)
+		{
+			handle->frames[i].transientPages = new std::vector<TransientPage*>();
+		}
+
+		// create fences
 		if (FAILED(handle->device->CreateFence(0, D3D12_FENCE_FLAG_NONE, IID_PPV_ARGS(&handle->fence)))) return 0;
 		handle->fenceEvent = CreateEvent(nullptr, FALSE, FALSE, nullptr);
 		if (handle->fenceEvent == NULL) return 0;
 
-		// create helpers for synchronous buffer operations
-		if (FAILED(handle->device->CreateCommandList(0, D3D12_COMMAND_LIST_TYPE_DIRECT, handle->commandAllocator, nullptr, IID_PPV_ARGS(&handle->internalCommandList)))) return 0;
-		if (FAILED(handle->internalCommandList->Close())) return 0;// make sure this is closed as it defaults to open for writing
+		if (FAILED(handle->device->CreateFence(0, D3D12_FENCE_FLAG_NONE, IID_PPV_ARGS(&handle->computeFence)))) return 0;
+		handle->computeFenceEvent = CreateEvent(nullptr, FALSE, FALSE, nullptr);
+		if (handle->computeFenceEvent == NULL) return 0;
+
+		// create placed resource heap allocator
+		HeapAllocator_Init(&handle->heapAllocator, handle->device);
+
+		// create pooled constant buffer pages
+		ConstantBufferPool_Init(&handle->constantBufferPool, handle);
+
+		// create transient upload pages
+		TransientAllocator_Init(&handle->transientAllocator, handle);
+
+		// create device wide shader visible descriptor heaps
+		if (!DescriptorHeap_Init(&handle->resourceDescriptorHeap, handle->device, D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV, DESCRIPTOR_HEAP_RESOURCE_COUNT, DESCRIPTOR_HEAP_RESOURCE_SLOT_COUNT)) return 0;
+		if (!DescriptorHeap_Init(&handle->samplerDescriptorHeap, handle->device, D3D12_DESCRIPTOR_HEAP_TYPE_SAMPLER, DESCRIPTOR_HEAP_SAMPLER_COUNT, DESCRIPTOR_HEAP_SAMPLER_COUNT)) return 0;
+
+		// create root signature and pipeline state caches
+		RootSignatureCache_Init(&handle->rootSignatureCache, handle);
+		PipelineCache_Init(&handle->pipelineCache, handle->device);
+		PipelineCompiler_Init(&handle->pipelineCompiler, handle, pipelineWorkerCount);
 
-		if (FAILED(handle->device->CreateFence(0, D3D12_FENCE_FLAG_NONE, IID_PPV_ARGS(&handle->internalFence)))) return 0;
-		handle->internalFenceEvent = CreateEvent(nullptr, FALSE, FALSE, nullptr);
-		if (handle->internalFenceEvent == NULL) return 0;
+		// create upload engine
+		if (!UploadEngine_Init(&handle->uploadEngine, handle)) return 0;
+
+		// create background heap defragmenter
+		if (!HeapDefragmenter_Init(&handle->heapDefragmenter, handle)) return 0;
 
 		// make sure fence values start at 1 so they don't match 'GetCompletedValue' when its first called
 		handle->fenceValue = 1;
-		handle->internalFenceValue = 1;
+		handle->computeFenceValue = 1;
 
 		return 1;
 	}
 
 	ORBITAL_EXPORT void Orbital_Video_D3D12_Device_Dispose(Device* handle)
 	{
+		// make sure the GPU is no longer using any frame resources
+		if (handle->commandQueue != NULL && handle->fence != NULL && handle->fenceEvent != NULL)
+		{
+			WaitForFence(handle, handle->fence, handle->fenceEvent, handle->fenceValue);
+		}
+
+		if (handle->computeQueue != NULL && handle->computeFence != NULL && handle->computeFenceEvent != NULL)
+		{
+			WaitForFenceValue(handle->computeFence, handle->computeFenceEvent, Device_SignalQueue(handle->computeQueue, handle->computeFence, handle->computeFenceValue));
+		}
+
+		// release everything disposed so far (both queues are idle)
+		if (handle->releases != NULL)
+		{
+			if (handle->fence != NULL && handle->computeFence != NULL) Device_ProcessReleases(handle);
+			delete handle->releases;
+			handle->releases = NULL;
+		}
+
+		// dispose frames
+		for (UINT i = 0; i != DEVICE_MAX_FRAME_COUNT; ++i)
+		{
+			DeviceFrame* frame = &handle->frames[i];
+			if (frame->transientPages != NULL)
+			{
+				if (handle->transientAllocator.mutex != NULL) TransientAllocator_ReleasePages(&handle->transientAllocator, frame->transientPages);
+				delete frame->transientPages;
+				frame->transientPages = NULL;
+			}
+		}
+
+		// dispose resolve lists
+		for (UINT i = 0; i != 2; ++i)
+		{
+			if (handle->resolveCommandLists[i] != NULL)
+			{
+				for (ID3D12GraphicsCommandList* commandList : *handle->resolveCommandLists[i]) commandList->Release();
+				delete handle->resolveCommandLists[i];
+				handle->resolveCommandLists[i] = NULL;
+			}
+		}
+
+		BarrierBatch_Dispose(&handle->resolveBarrierBatch);
+		if (handle->decayingResources != NULL)
+		{
+			delete handle->decayingResources;
+			handle->decayingResources = NULL;
+		}
+
+		// dispose recording contexts
+		if (handle->recordingContexts != NULL)
+		{
+			for (DeviceRecordingContext* context : *handle->recordingContexts)
+			{
+				for (UINT i = 0; i != DEVICE_MAX_FRAME_COUNT; ++i)
+				{
+					if (context->commandAllocators[i] != NULL) context->commandAllocators[i]->Release();
+				}
+				free(context);
+			}
+			delete handle->recordingContexts;
+			handle->recordingContexts = NULL;
+		}
+
+		for (UINT i = 0; i != 2; ++i)
+		{
+			if (handle->freeRecordingContexts[i] != NULL)
+			{
+				delete handle->freeRecordingContexts[i];
+				handle->freeRecordingContexts[i] = NULL;
+			}
+		}
+
+		if (handle->recordingContextMutex != NULL)
+		{
+			delete handle->recordingContextMutex;
+			handle->recordingContextMutex = NULL;
+		}
+
 		// dispose helpers
-		if (handle->internalFenceEvent != NULL)
+		HeapDefragmenter_Dispose(&handle->heapDefragmenter);
+		UploadEngine_Dispose(&handle->uploadEngine);
+		if (handle->constantBufferPool.mutex != NULL) ConstantBufferPool_Dispose(&handle->constantBufferPool);
+		if (handle->transientAllocator.mutex != NULL) TransientAllocator_Dispose(&handle->transientAllocator);
+		if (handle->resourceDescriptorHeap.mutex != NULL) DescriptorHeap_Dispose(&handle->resourceDescriptorHeap);
+		if (handle->samplerDescriptorHeap.mutex != NULL) DescriptorHeap_Dispose(&handle->samplerDescriptorHeap);
+		if (handle->pipelineCompiler.mutex != NULL) PipelineCompiler_Dispose(&handle->pipelineCompiler);
+		if (handle->pipelineCache.mutex != NULL) PipelineCache_Dispose(&handle->pipelineCache);
+		if (handle->rootSignatureCache.mutex != NULL) RootSignatureCache_Dispose(&handle->rootSignatureCache);
+		if (handle->heapAllocator.mutex != NULL) HeapAllocator_Dispose(&handle->heapAllocator);
+
+		// dispose compute
+		if (handle->computeFenceEvent != NULL)
 		{
-			CloseHandle(handle->internalFenceEvent);
-			handle->internalFenceEvent = NULL;
+			CloseHandle(handle->computeFenceEvent);
+			handle->computeFenceEvent = NULL;
 		}
 
-		if (handle->internalFence != NULL)
+		if (handle->computeFence != NULL)
 		{
-			handle->internalFence->Release();
-			handle->internalFence = NULL;
+			handle->computeFence->Release();
+			handle->computeFence = NULL;
 		}
 
-		if (handle->internalCommandList != NULL)
+		if (handle->computeQueue != NULL)
 		{
-			handle->internalCommandList->Release();
-			handle->internalCommandList = NULL;
+			handle->computeQueue->Release();
+			handle->computeQueue = NULL;
 		}
 
 		// dispose normal
@@ -124,12 +287,6 @@ extern "C"
 			handle->fence = NULL;
 		}
 
-		if (handle->commandAllocator != NULL)
-		{
-			handle->commandAllocator->Release();
-			handle->commandAllocator = NULL;
-		}
-
 		if (handle->commandQueue != NULL)
 		{
 			handle->commandQueue->Release();
@@ -159,13 +316,273 @@ extern "C"
 
 	ORBITAL_EXPORT void Orbital_Video_D3D12_Device_BeginFrame(Device* handle)
 	{
-		handle->commandAllocator->Reset();
+		// only blocks if the ring wrapped onto a frame the GPU hasn't finished yet
+		DeviceFrame* frame = &handle->frames[handle->frameIndex];
+		WaitForFenceValue(handle->fence, handle->fenceEvent, frame->fenceValue);
+		WaitForFenceValue(handle->computeFence, handle->computeFenceEvent, frame->computeFenceValue);
+
+		// release disposed objects the GPU has finished with and transient pages of the completed frame
+		Device_ProcessReleases(handle);
+		TransientAllocator_ReleasePages(&handle->transientAllocator, frame->transientPages);
+
+		// move a bounded amount of resources out of sparse heaps
+		HeapDefragmenter_Update(&handle->heapDefragmenter);
+
+		// recycle allocators of the completed frame
+		handle->recordingContextMutex->lock();
+		for (DeviceRecordingContext* context : *handle->recordingContexts) context->commandAllocators[handle->frameIndex]->Reset();
+		handle->recordingContextMutex->unlock();
 	}
 
 	ORBITAL_EXPORT void Orbital_Video_D3D12_Device_EndFrame(Device* handle)
 	{
-		WaitForFence(handle, handle->fence, handle->fenceEvent, handle->fenceValue);
+		// mark end of frame on the GPU timeline without waiting for it
+		UploadEngine_QueueWait(&handle->uploadEngine, handle->commandQueue, handle->uploadFenceValue);
+		DeviceFrame* frame = &handle->frames[handle->frameIndex];
+		frame->fenceValue = Device_SignalFence(handle);
+		frame->computeFenceValue = Device_SignalQueue(handle->computeQueue, handle->computeFence, handle->computeFenceValue);
+
+		// move to next frame in ring
+		handle->frameIndex = (handle->frameIndex + 1) % handle->frameCount;
 	}
+
+	ORBITAL_EXPORT UINT64 Orbital_Video_D3D12_Device_ExecuteCommandLists(Device* handle, CommandList** commandLists, UINT commandListCount)
+	{
+		// all lists in a batch must target the same queue (bundles are only replayed by other lists)
+		if (commandListCount == 0) return 0;
+		CommandListType type = commandLists[0]->type;
+		if (type == CommandListType_Bundle) return 0;
+		for (UINT i = 1; i != commandListCount; ++i)
+		{
+			if (commandLists[i]->type != type) return 0;
+		}
+
+		// make sure resource uploads finish before lists using them execute (GPU-side wait)
+		ID3D12CommandQueue* queue;
+		if (type == CommandListType_Compute)
+		{
+			queue = handle->computeQueue;
+			UploadEngine_QueueWait(&handle->uploadEngine, queue, handle->computeUploadFenceValue);
+		}
+		else
+		{
+			queue = handle->commandQueue;
+			UploadEngine_QueueWait(&handle->uploadEngine, queue, handle->uploadFenceValue);
+		}
+
+		// resolve the states each list expects against the global ones (lists only know the states they set themselves)
+		ID3D12CommandList** nativeCommandLists = (ID3D12CommandList**)alloca(sizeof(ID3D12CommandList*) * commandListCount * 2);
+		UINT nativeCommandListCount = 0, resolveCommandListCount = 0;
+		DeviceRecordingContext* context = NULL;
+		for (UINT i = 0; i != commandListCount; ++i)
+		{
+			ResourceStateTracker_Resolve(&commandLists[i]->stateTracker, &handle->resolveBarrierBatch, handle->decayingResources);
+			if (handle->resolveBarrierBatch.barriers->size() != 0)
+			{
+				ID3D12GraphicsCommandList* resolveCommandList = Device_ResolveCommandList(handle, type, resolveCommandListCount, &context);
+				if (resolveCommandList == NULL) return 0;
+				BarrierBatch_Flush(&handle->resolveBarrierBatch, resolveCommandList);
+				resolveCommandList->Close();
+				nativeCommandLists[nativeCommandListCount++] = resolveCommandList;
+				++resolveCommandListCount;
+			}
+			nativeCommandLists[nativeCommandListCount++] = commandLists[i]->commandList;
+		}
+		if (context != NULL) Device_ReleaseRecordingContext(handle, context);
+
+		// submit all lists in one call
+		queue->ExecuteCommandLists(nativeCommandListCount, nativeCommandLists);
+		ResourceState_Decay(handle->decayingResources);// promoted states decay once the lists complete
+
+		// return ticket that completes when the GPU has finished the lists
+		UINT64 ticket;
+		if (type == CommandListType_Compute) ticket = Device_SignalQueue(queue, handle->computeFence, handle->computeFenceValue);
+		else ticket = Device_SignalFence(handle);
+		for (UINT i = 0; i != commandListCount; ++i) commandLists[i]->fenceValue = ticket;
+		return ticket;
+	}
+
+	ORBITAL_EXPORT int Orbital_Video_D3D12_Device_IsFenceTicketComplete(Device* handle, CommandListType type, UINT64 ticket)
+	{
+		ID3D12Fence* fence = type == CommandListType_Compute ? handle->computeFence : handle->fence;
+		return fence->GetCompletedValue() >= ticket;
+	}
+
+	ORBITAL_EXPORT void Orbital_Video_D3D12_Device_WaitForFenceTicket(Device* handle, CommandListType type, UINT64 ticket)
+	{
+		ID3D12Fence* fence = type == CommandListType_Compute ? handle->computeFence : handle->fence;
+		if (fence->GetCompletedValue() >= ticket) return;
+		fence->SetEventOnCompletion(ticket, NULL);// NULL event blocks until complete and is safe to call from any thread
+	}
+
+	ORBITAL_EXPORT void Orbital_Video_D3D12_Device_QueueWaitForFenceTicket(Device* handle, CommandListType type, CommandListType ticketType, UINT64 ticket)
+	{
+		// GPU-side wait so work submitted to one queue after this call starts once the other queue reaches the ticket
+		ID3D12CommandQueue* queue = type == CommandListType_Compute ? handle->computeQueue : handle->commandQueue;
+		ID3D12Fence* fence = ticketType == CommandListType_Compute ? handle->computeFence : handle->fence;
+		queue->Wait(fence, ticket);
+	}
+
+	ORBITAL_EXPORT void Orbital_Video_D3D12_Device_SetDefragmentBudget(Device* handle, UINT64 bytesPerFrame)
+	{
+		handle->heapDefragmenter.budget = bytesPerFrame;
+	}
+
+	ORBITAL_EXPORT void Orbital_Video_D3D12_Device_GetHeapAllocatorStats(Device* handle, HeapAllocatorStats* stats)
+	{
+		HeapAllocator_GetStats(&handle->heapAllocator, stats);
+	}
+
+	ORBITAL_EXPORT int Orbital_Video_D3D12_Device_LoadPipelineCache(Device* handle, void* data, UINT64 size)
+	{
+		return PipelineCache_Load(&handle->pipelineCache, data, size);
+	}
+
+	ORBITAL_EXPORT int Orbital_Video_D3D12_Device_SerializePipelineCache(Device* handle, void* data, UINT64* size)
+	{
+		return PipelineCache_Serialize(&handle->pipelineCache, data, size);
+	}
+
+	ORBITAL_EXPORT void Orbital_Video_D3D12_Device_GetPipelineCacheStats(Device* handle, PipelineCacheStats* stats)
+	{
+		PipelineCache_GetStats(&handle->pipelineCache, stats);
+	}
+
+	ORBITAL_EXPORT void Orbital_Video_D3D12_Device_GetRootSignatureCacheStats(Device* handle, RootSignatureCacheStats* stats)
+	{
+		RootSignatureCache_GetStats(&handle->rootSignatureCache, stats);
+	}
+}
+
+UINT64 Device_SignalFence(Device* handle)
+{
+	return Device_SignalQueue(handle->commandQueue, handle->fence, handle->fenceValue);
+}
+
+UINT64 Device_SignalQueue(ID3D12CommandQueue* queue, ID3D12Fence* fence, UINT64& fenceValue)
+{
+	++fenceValue;
+	if (fenceValue == UINT64_MAX) fenceValue = 0;// UINT64_MAX is reserved
+	queue->Signal(fence, fenceValue);
+	return fenceValue;
+}
+
+void WaitForFenceValue(ID3D12Fence* fence, HANDLE fenceEvent, UINT64 fenceValue)
+{
+	if (fence->GetCompletedValue() >= fenceValue) return;
+	if (FAILED(fence->SetEventOnCompletion(fenceValue, fenceEvent))) return;
+	WaitForSingleObject(fenceEvent, INFINITE);
+}
+
+void Device_PushRelease(Device* handle, DeviceRelease* release)
+{
+	// anything submitted before the dispose completes once the queues reach the next values they signal
+	// (frame slots can't be used for this, between EndFrame and BeginFrame the current one belongs to an older frame)
+	handle->internalMutex->lock();
+	release->fenceValue = handle->fenceValue + 1;
+	release->computeFenceValue = handle->computeFenceValue + 1;
+	handle->releases->push_back(*release);
+	handle->internalMutex->unlock();
+}
+
+void Device_DeferRelease(Device* handle, IUnknown* object)
+{
+	// objects may still be referenced by submitted command lists
+	DeviceRelease release = {};
+	release.object = object;
+	Device_PushRelease(handle, &release);
+}
+
+void Device_DeferFree(Device* handle, HeapAllocation* allocation)
+{
+	// heap range may only be reused once the resource placed in it has been released
+	HeapAllocator_Detach(&handle->heapAllocator, allocation);
+	DeviceRelease release = {};
+	release.freeAllocation = true;
+	release.allocation = *allocation;
+	Device_PushRelease(handle, &release);
+}
+
+void Device_DeferFreeConstantBuffer(Device* handle, ConstantBufferPoolAllocation* allocation)
+{
+	// slots may still be read by submitted command lists
+	DeviceRelease release = {};
+	release.constantBufferAllocation = *allocation;
+	Device_PushRelease(handle, &release);
+}
+
+void Device_DeferFreeDescriptors(Device* handle, DescriptorAllocation* allocation)
+{
+	// descriptors may still be read by submitted command lists
+	if (allocation->heap == NULL) return;
+	DeviceRelease release = {};
+	release.descriptorAllocation = *allocation;
+	Device_PushRelease(handle, &release);
+	allocation->heap = NULL;
+}
+
+void Device_ProcessReleases(Device* handle)
+{
+	// take completed entries in order until one may still be in use
+	std::vector<DeviceRelease> completedReleases;
+	handle->internalMutex->lock();
+	std::vector<DeviceRelease>* releases = handle->releases;
+	UINT64 completedFenceValue = handle->fence->GetCompletedValue();
+	UINT64 completedComputeFenceValue = handle->computeFence->GetCompletedValue();
+	size_t count = 0;
+	for (; count != releases->size(); ++count)
+	{
+		DeviceRelease& release = (*releases)[count];
+		if (release.fenceValue > completedFenceValue || release.computeFenceValue > completedComputeFenceValue) break;
+	}
+	completedReleases.assign(releases->begin(), releases->begin() + count);
+	releases->erase(releases->begin(), releases->begin() + count);
+	handle->internalMutex->unlock();
+
+	// release outside the lock as the heap allocator defers frees into it while locked (resources go before the heap ranges they were placed in)
+	for (DeviceRelease& release : completedReleases)
+	{
+		if (release.object != NULL) release.object->Release();
+		if (release.freeAllocation) HeapAllocator_Free(&handle->heapAllocator, &release.allocation);
+		if (release.constantBufferAllocation.page != NULL) ConstantBufferPool_Free(&handle->constantBufferPool, &release.constantBufferAllocation);
+		if (release.descriptorAllocation.heap != NULL) DescriptorHeap_Free(release.descriptorAllocation.heap, &release.descriptorAllocation);
+	}
+}
+
+DeviceRecordingContext* Device_AcquireRecordingContext(Device* handle, CommandListType type)
+{
+	std::lock_guard<std::mutex> lock(*handle->recordingContextMutex);
+
+	// reuse context no other list is recording with
+	std::vector<DeviceRecordingContext*>* freeContexts = handle->freeRecordingContexts[type];
+	if (!freeContexts->empty())
+	{
+		DeviceRecordingContext* context = freeContexts->back();
+		freeContexts->pop_back();
+		return context;
+	}
+
+	// create new context (only happens when more lists record at once than ever before)
+	DeviceRecordingContext* context = (DeviceRecordingContext*)calloc(1, sizeof(DeviceRecordingContext));
+	context->type = type;
+	D3D12_COMMAND_LIST_TYPE nativeType = type == CommandListType_Compute ? D3D12_COMMAND_LIST_TYPE_COMPUTE : D3D12_COMMAND_LIST_TYPE_DIRECT;
+	for (UINT i = 0; i != handle->frameCount; ++i)
+	{
+		if (FAILED(handle->device->CreateCommandAllocator(nativeType, IID_PPV_ARGS(&context->commandAllocators[i]))))
+		{
+			for (UINT j = 0; j != i; ++j) context->commandAllocators[j]->Release();
+			free(context);
+			return NULL;
+		}
+	}
+	handle->recordingContexts->push_back(context);
+	return context;
+}
+
+void Device_ReleaseRecordingContext(Device* handle, DeviceRecordingContext* context)
+{
+	std::lock_guard<std::mutex> lock(*handle->recordingContextMutex);
+	handle->freeRecordingContexts[context->type]->push_back(context);
 }
 
 void WaitForFence(Device* handle, ID3D12Fence* fence, HANDLE fenceEvent, UINT64& fenceValue)
@@ -178,9 +595,5 @@ void WaitForFence(Device* handle, ID3D12Fence* fence, HANDLE fenceEvent, UINT64&
 	if (FAILED(handle->commandQueue->Signal(fence, fenceValue))) return;
 
 	// wait for frame to finish
-	if (fence->GetCompletedValue() != fenceValue)
-	{
-		if (FAILED(fence->SetEventOnCompletion(fenceValue, fenceEvent))) return;
-		WaitForSingleObject(fenceEvent, INFINITE);
-	}
+	WaitForFenceValue(fence, fenceEvent, fenceValue);
 }
\ No newline at end of file
@@ -1,28 +1,117 @@
 #pragma once
 #include "Instance.h"
+#include "UploadEngine.h"
+#include "HeapAllocator.h"
+#include "HeapDefragmenter.h"
+#include "ConstantBufferPool.h"
+#include "TransientAllocator.h"
+#include "DescriptorHeap.h"
+#include "PipelineCache.h"
+#include "PipelineCompiler.h"
+#include "RootSignatureCache.h"
+#include "ResourceState.h"
 #include <mutex>
+#include <vector>
+
+#define DEVICE_MAX_FRAME_COUNT 3
+#define DEVICE_DEFAULT_FRAME_COUNT 2
+
+struct DeviceFrame
+{
+	UINT64 fenceValue, computeFenceValue;// values signaled when the GPU finished this frame
+	std::vector<TransientPage*>* transientPages;// per-frame upload memory handed out to command lists
+};
+
+// object or range of a disposed resource, released once both queues signaled the values that followed the dispose
+struct DeviceRelease
+{
+	UINT64 fenceValue, computeFenceValue;
+	IUnknown* object;// NULL if none
+	bool freeAllocation;
+	HeapAllocation allocation;// freed after objects queued before it were released
+	ConstantBufferPoolAllocation constantBufferAllocation;// page is NULL if none
+	DescriptorAllocation descriptorAllocation;// heap is NULL if none
+};
+
+struct DeviceRecordingContext
+{
+	CommandListType type;
+	ID3D12CommandAllocator* commandAllocators[DEVICE_MAX_FRAME_COUNT];// one per frame in flight
+};
 
 struct Device
 {
 	D3D_FEATURE_LEVEL nativeFeatureLevel;
 	D3D_ROOT_SIGNATURE_VERSION maxRootSignatureVersion;
+	D3D12_RESOURCE_BINDING_TIER resourceBindingTier;
 
 	Instance* instance;
 	IDXGIAdapter* adapter;
 	ID3D12Device* device;
 	UINT nodeCount;
 	ID3D12CommandQueue* commandQueue;
-	ID3D12CommandAllocator* commandAllocator;
 	ID3D12Fence* fence;
 	HANDLE fenceEvent;
 	UINT64 fenceValue;
+	UINT64 uploadFenceValue;// last upload batch the queue waits on
+
+	// async compute queue
+	ID3D12CommandQueue* computeQueue;
+	ID3D12Fence* computeFence;
+	HANDLE computeFenceEvent;
+	UINT64 computeFenceValue;
+	UINT64 computeUploadFenceValue;
+
+	// frames in flight
+	UINT frameCount, frameIndex;
+	DeviceFrame frames[DEVICE_MAX_FRAME_COUNT];
+	std::vector<DeviceRelease>* releases;// in dispose order, guarded by internalMutex
+
+	// allocator sets held by command lists while they record (one per recording thread)
+	std::vector<DeviceRecordingContext*>* recordingContexts;
+	std::vector<DeviceRecordingContext*>* freeRecordingContexts[2];// indexed by CommandListType
+	std::mutex* recordingContextMutex;
+
+	// placed resource heaps
+	HeapAllocator heapAllocator;
+	HeapDefragmenter heapDefragmenter;
+
+	// small constant buffers sharing resources and descriptor pages
+	ConstantBufferPool constantBufferPool;
+
+	// per-frame upload memory for dynamic constants
+	TransientAllocator transientAllocator;
+
+	// shader visible heaps every command list binds once (bindless slots + render state tables)
+	DescriptorHeap resourceDescriptorHeap;
+	DescriptorHeap samplerDescriptorHeap;
+
+	// root signatures shared by effects with identical serialized layouts
+	RootSignatureCache rootSignatureCache;
+
+	// pipeline states shared by content hash, persisted through a pipeline library
+	PipelineCache pipelineCache;
+	PipelineCompiler pipelineCompiler;// workers for render states created async
+
+	// asynchronous resource uploads on copy queue
+	UploadEngine uploadEngine;
+
+	// barrier lists inserted at submit to bring resources into the states command lists expect
+	std::vector<ID3D12GraphicsCommandList*>* resolveCommandLists[2];// indexed by CommandListType, reused every submit
+	BarrierBatch resolveBarrierBatch;
+	std::vector<ResourceState*>* decayingResources;
 
-	// used for special synchronous buffer operations
-	ID3D12GraphicsCommandList5* internalCommandList;
-	ID3D12Fence* internalFence;
-	HANDLE internalFenceEvent;
-	UINT64 internalFenceValue;
 	std::mutex* internalMutex;
 };
 
-void WaitForFence(Device* handle, ID3D12Fence* fence, HANDLE fenceEvent, UINT64& fenceValue);
\ No newline at end of file
+void WaitForFence(Device* handle, ID3D12Fence* fence, HANDLE fenceEvent, UINT64& fenceValue);
+void WaitForFenceValue(ID3D12Fence* fence, HANDLE fenceEvent, UINT64 fenceValue);
+UINT64 Device_SignalFence(Device* handle);
+UINT64 Device_SignalQueue(ID3D12CommandQueue* queue, ID3D12Fence* fence, UINT64& fenceValue);
+void Device_DeferRelease(Device* handle, IUnknown* object);
+void Device_DeferFree(Device* handle, HeapAllocation* allocation);
+void Device_DeferFreeConstantBuffer(Device* handle, ConstantBufferPoolAllocation* allocation);
+void Device_DeferFreeDescriptors(Device* handle, DescriptorAllocation* allocation);
+void Device_ProcessReleases(Device* handle);
+DeviceRecordingContext* Device_AcquireRecordingContext(Device* handle, CommandListType type);
+void Device_ReleaseRecordingContext(Device* handle, DeviceRecordingContext* context);
\ No newline at end of file
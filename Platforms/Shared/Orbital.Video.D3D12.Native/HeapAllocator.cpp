@@ -0,0 +1,467 @@
+#include "HeapAllocator.h"
+#include "ResourceState.h"
+
+#define HEAP_ALLOCATOR_UNIT_FREE 0x80
+#define HEAP_ALLOCATOR_UNIT_ALLOCATED 0x40
+#define HEAP_ALLOCATOR_UNIT_ORDER_MASK 0x0F
+
+bool HeapAllocator_GetHeapTypeIndex(D3D12_HEAP_TYPE heapType, UINT* index)
+{
+	switch (heapType)
+	{
+		case D3D12_HEAP_TYPE_DEFAULT: *index = 0; break;
+		case D3D12_HEAP_TYPE_UPLOAD: *index = 1; break;
+		case D3D12_HEAP_TYPE_READBACK: *index = 2; break;
+		default: return false;
+	}
+	return true;
+}
+
+void HeapAllocatorBlock_PushFree(HeapAllocatorBlock* block, UINT16 unit, UINT16 order)
+{
+	block->unitStates[unit] = HEAP_ALLOCATOR_UNIT_FREE | order;
+	block->freePrev[unit] = HEAP_ALLOCATOR_INVALID_UNIT;
+	block->freeNext[unit] = block->freeHeads[order];
+	if (block->freeHeads[order] != HEAP_ALLOCATOR_INVALID_UNIT) block->freePrev[block->freeHeads[order]] = unit;
+	block->freeHeads[order] = unit;
+}
+
+void HeapAllocatorBlock_RemoveFree(HeapAllocatorBlock* block, UINT16 unit, UINT16 order)
+{
+	UINT16 prev = block->freePrev[unit], next = block->freeNext[unit];
+	if (prev != HEAP_ALLOCATOR_INVALID_UNIT) block->freeNext[prev] = next;
+	else block->freeHeads[order] = next;
+	if (next != HEAP_ALLOCATOR_INVALID_UNIT) block->freePrev[next] = prev;
+	block->unitStates[unit] = 0;
+}
+
+bool HeapAllocatorBlock_Allocate(HeapAllocatorBlock* block, UINT16 order, UINT16* unit)
+{
+	// find smallest free buddy that fits then split it down
+	UINT16 freeOrder = order;
+	while (freeOrder != HEAP_ALLOCATOR_ORDER_COUNT && block->freeHeads[freeOrder] == HEAP_ALLOCATOR_INVALID_UNIT) ++freeOrder;
+	if (freeOrder == HEAP_ALLOCATOR_ORDER_COUNT) return false;
+
+	UINT16 freeUnit = block->freeHeads[freeOrder];
+	HeapAllocatorBlock_RemoveFree(block, freeUnit, freeOrder);
+	while (freeOrder != order)
+	{
+		--freeOrder;
+		HeapAllocatorBlock_PushFree(block, freeUnit + (1 << freeOrder), freeOrder);// upper half stays free
+	}
+
+	block->unitStates[freeUnit] = HEAP_ALLOCATOR_UNIT_ALLOCATED | order;
+	block->usedSize += (UINT64)HEAP_ALLOCATOR_UNIT_SIZE << order;
+	*unit = freeUnit;
+	return true;
+}
+
+void HeapAllocatorBlock_Free(HeapAllocatorBlock* block, UINT16 unit, UINT16 order)
+{
+	block->usedSize -= (UINT64)HEAP_ALLOCATOR_UNIT_SIZE << order;
+	block->unitStates[unit] = 0;
+
+	// merge with buddy while it's free and the same size
+	while (order != HEAP_ALLOCATOR_ORDER_COUNT - 1)
+	{
+		UINT16 buddy = unit ^ (1 << order);
+		if (block->unitStates[buddy] != (HEAP_ALLOCATOR_UNIT_FREE | order)) break;
+		HeapAllocatorBlock_RemoveFree(block, buddy, order);
+		if (buddy < unit) unit = buddy;
+		++order;
+	}
+	HeapAllocatorBlock_PushFree(block, unit, order);
+}
+
+HeapAllocatorBlock* HeapAllocator_CreateBlock(HeapAllocator* handle, D3D12_HEAP_TYPE heapType, HeapAllocatorCategory category)
+{
+	D3D12_HEAP_DESC heapDesc = {};
+	heapDesc.SizeInBytes = HEAP_ALLOCATOR_BLOCK_SIZE;
+	heapDesc.Properties.Type = heapType;
+	heapDesc.Properties.CPUPageProperty = D3D12_CPU_PAGE_PROPERTY_UNKNOWN;
+	heapDesc.Properties.MemoryPoolPreference = D3D12_MEMORY_POOL_UNKNOWN;
+	heapDesc.Properties.CreationNodeMask = 1;// TODO: multi-gpu setup
+	heapDesc.Properties.VisibleNodeMask = 1;
+	if (category == HeapAllocatorCategory_Buffer)
+	{
+		heapDesc.Alignment = D3D12_DEFAULT_RESOURCE_PLACEMENT_ALIGNMENT;
+		heapDesc.Flags = D3D12_HEAP_FLAG_ALLOW_ONLY_BUFFERS;
+	}
+	else if (category == HeapAllocatorCategory_Texture)
+	{
+		heapDesc.Alignment = D3D12_DEFAULT_RESOURCE_PLACEMENT_ALIGNMENT;
+		heapDesc.Flags = D3D12_HEAP_FLAG_ALLOW_ONLY_NON_RT_DS_TEXTURES;
+	}
+	else
+	{
+		heapDesc.Alignment = D3D12_DEFAULT_MSAA_RESOURCE_PLACEMENT_ALIGNMENT;
+		heapDesc.Flags = D3D12_HEAP_FLAG_ALLOW_ONLY_RT_DS_TEXTURES;
+	}
+
+	ID3D12Heap* heap = NULL;
+	if (FAILED(handle->device->CreateHeap(&heapDesc, IID_PPV_ARGS(&heap)))) return NULL;
+
+	HeapAllocatorBlock* block = (HeapAllocatorBlock*)calloc(1, sizeof(HeapAllocatorBlock));
+	block->heap = heap;
+	for (UINT i = 0; i != HEAP_ALLOCATOR_ORDER_COUNT; ++i) block->freeHeads[i] = HEAP_ALLOCATOR_INVALID_UNIT;
+	HeapAllocatorBlock_PushFree(block, 0, HEAP_ALLOCATOR_ORDER_COUNT - 1);
+
+	handle->stats.blockCount++;
+	handle->stats.reservedSize += HEAP_ALLOCATOR_BLOCK_SIZE;
+	return block;
+}
+
+void HeapAllocator_Init(HeapAllocator* handle, ID3D12Device* device)
+{
+	handle->device = device;
+	for (UINT t = 0; t != HEAP_ALLOCATOR_HEAP_TYPE_COUNT; ++t)
+	{
+		for (UINT c = 0; c != HeapAllocatorCategory_Count; ++c) handle->pools[t][c] = new std::vector<HeapAllocatorBlock*>();
+	}
+	memset(&handle->stats, 0, sizeof(HeapAllocatorStats));
+	handle->moves = new std::vector<HeapAllocatorMove>();
+	handle->mutex = new std::recursive_mutex();
+}
+
+void HeapAllocator_Dispose(HeapAllocator* handle)
+{
+	if (handle->moves != NULL)
+	{
+		for (HeapAllocatorMove& move : *handle->moves) move.resource->Release();// heaps are released below
+		delete handle->moves;
+		handle->moves = NULL;
+	}
+
+	for (UINT t = 0; t != HEAP_ALLOCATOR_HEAP_TYPE_COUNT; ++t)
+	{
+		for (UINT c = 0; c != HeapAllocatorCategory_Count; ++c)
+		{
+			if (handle->pools[t][c] == NULL) continue;
+			for (HeapAllocatorBlock* block : *handle->pools[t][c])
+			{
+				block->heap->Release();
+				free(block);
+			}
+			delete handle->pools[t][c];
+			handle->pools[t][c] = NULL;
+		}
+	}
+
+	if (handle->mutex != NULL)
+	{
+		delete handle->mutex;
+		handle->mutex = NULL;
+	}
+}
+
+bool HeapAllocator_CreateResource(HeapAllocator* handle, D3D12_HEAP_TYPE heapType, const D3D12_RESOURCE_DESC* resourceDesc, D3D12_RESOURCE_STATES initialState, ID3D12Resource** resource, HeapAllocation* allocation)
+{
+	memset(allocation, 0, sizeof(HeapAllocation));
+	D3D12_RESOURCE_ALLOCATION_INFO info = handle->device->GetResourceAllocationInfo(0, 1, resourceDesc);
+	allocation->size = info.SizeInBytes;
+
+	// pick pool (CPU visible heaps only hold buffers)
+	UINT heapTypeIndex;
+	HeapAllocatorCategory category;
+	if (resourceDesc->Dimension == D3D12_RESOURCE_DIMENSION_BUFFER) category = HeapAllocatorCategory_Buffer;
+	else if ((resourceDesc->Flags & (D3D12_RESOURCE_FLAG_ALLOW_RENDER_TARGET | D3D12_RESOURCE_FLAG_ALLOW_DEPTH_STENCIL)) != 0) category = HeapAllocatorCategory_RenderTarget;
+	else category = HeapAllocatorCategory_Texture;
+	bool placed = HeapAllocator_GetHeapTypeIndex(heapType, &heapTypeIndex);
+	if (heapType != D3D12_HEAP_TYPE_DEFAULT && category != HeapAllocatorCategory_Buffer) placed = false;
+	if (info.SizeInBytes == UINT64_MAX || info.SizeInBytes > HEAP_ALLOCATOR_BLOCK_SIZE || info.Alignment > HEAP_ALLOCATOR_BLOCK_SIZE) placed = false;
+
+	// resources that don't fit a block get their own allocation
+	if (!placed)
+	{
+		D3D12_HEAP_PROPERTIES heapProperties = {};
+		heapProperties.Type = heapType;
+		heapProperties.CPUPageProperty = D3D12_CPU_PAGE_PROPERTY_UNKNOWN;
+		heapProperties.MemoryPoolPreference = D3D12_MEMORY_POOL_UNKNOWN;
+		heapProperties.CreationNodeMask = 1;// TODO: multi-gpu setup
+		heapProperties.VisibleNodeMask = 1;
+		if (FAILED(handle->device->CreateCommittedResource(&heapProperties, D3D12_HEAP_FLAG_NONE, resourceDesc, initialState, NULL, IID_PPV_ARGS(resource)))) return false;
+
+		std::lock_guard<std::recursive_mutex> lock(*handle->mutex);
+		handle->stats.committedCount++;
+		handle->stats.committedSize += info.SizeInBytes;
+		return true;
+	}
+
+	// buddies are aligned to their own size so rounding up to the alignment covers it
+	UINT64 size = info.SizeInBytes > info.Alignment ? info.SizeInBytes : info.Alignment;
+	UINT16 order = 0;
+	while (((UINT64)HEAP_ALLOCATOR_UNIT_SIZE << order) < size) ++order;
+
+	std::lock_guard<std::recursive_mutex> lock(*handle->mutex);
+	std::vector<HeapAllocatorBlock*>* pool = handle->pools[heapTypeIndex][category];
+	HeapAllocatorBlock* block = NULL;
+	UINT16 unit = 0;
+	for (HeapAllocatorBlock* poolBlock : *pool)
+	{
+		if (HeapAllocatorBlock_Allocate(poolBlock, order, &unit))
+		{
+			block = poolBlock;
+			break;
+		}
+	}
+
+	if (block == NULL)
+	{
+		block = HeapAllocator_CreateBlock(handle, heapType, category);
+		if (block == NULL) return false;
+		pool->push_back(block);
+		HeapAllocatorBlock_Allocate(block, order, &unit);
+	}
+
+	UINT64 offset = (UINT64)unit * HEAP_ALLOCATOR_UNIT_SIZE;
+	if (FAILED(handle->device->CreatePlacedResource(block->heap, offset, resourceDesc, initialState, NULL, IID_PPV_ARGS(resource))))
+	{
+		HeapAllocatorBlock_Free(block, unit, order);
+		return false;
+	}
+
+	allocation->block = block;
+	allocation->unit = unit;
+	allocation->order = order;
+	allocation->heapTypeIndex = heapTypeIndex;
+	allocation->category = category;
+	handle->stats.allocationCount++;
+	handle->stats.allocatedSize += (UINT64)HEAP_ALLOCATOR_UNIT_SIZE << order;
+	handle->stats.requestedSize += info.SizeInBytes;
+	return true;
+}
+
+void HeapAllocator_Free(HeapAllocator* handle, HeapAllocation* allocation)
+{
+	std::lock_guard<std::recursive_mutex> lock(*handle->mutex);
+	HeapAllocatorBlock* block = allocation->block;
+	if (block == NULL)
+	{
+		handle->stats.committedCount--;
+		handle->stats.committedSize -= allocation->size;
+		return;
+	}
+
+	block->allocations[allocation->unit] = NULL;
+	HeapAllocatorBlock_Free(block, allocation->unit, allocation->order);
+	handle->stats.allocationCount--;
+	handle->stats.allocatedSize -= (UINT64)HEAP_ALLOCATOR_UNIT_SIZE << allocation->order;
+	handle->stats.requestedSize -= allocation->size;
+	allocation->block = NULL;
+
+	// release empty blocks but keep one per pool around to avoid heap churn
+	if (block->usedSize != 0) return;
+	std::vector<HeapAllocatorBlock*>* pool = handle->pools[allocation->heapTypeIndex][allocation->category];
+	if (pool->size() <= 1) return;
+	for (size_t i = 0; i != pool->size(); ++i)
+	{
+		if ((*pool)[i] != block) continue;
+		pool->erase(pool->begin() + i);
+		break;
+	}
+	block->heap->Release();
+	free(block);
+	handle->stats.blockCount--;
+	handle->stats.reservedSize -= HEAP_ALLOCATOR_BLOCK_SIZE;
+}
+
+void HeapAllocator_GetStats(HeapAllocator* handle, HeapAllocatorStats* stats)
+{
+	std::lock_guard<std::recursive_mutex> lock(*handle->mutex);
+	*stats = handle->stats;
+
+	// walk free lists for fragmentation info
+	stats->freeRangeCount = 0;
+	stats->largestFreeRange = 0;
+	for (UINT t = 0; t != HEAP_ALLOCATOR_HEAP_TYPE_COUNT; ++t)
+	{
+		for (UINT c = 0; c != HeapAllocatorCategory_Count; ++c)
+		{
+			for (HeapAllocatorBlock* block : *handle->pools[t][c])
+			{
+				for (UINT order = 0; order != HEAP_ALLOCATOR_ORDER_COUNT; ++order)
+				{
+					for (UINT16 unit = block->freeHeads[order]; unit != HEAP_ALLOCATOR_INVALID_UNIT; unit = block->freeNext[unit])
+					{
+						stats->freeRangeCount++;
+						UINT64 size = (UINT64)HEAP_ALLOCATOR_UNIT_SIZE << order;
+						if (size > stats->largestFreeRange) stats->largestFreeRange = size;
+					}
+				}
+			}
+		}
+	}
+}
+
+void HeapAllocator_SetRelocatable(HeapAllocator* handle, HeapAllocation* allocation, void* owner, HeapAllocatorRelocateCallback relocate, ID3D12Resource* resource, ResourceState* resourceState)
+{
+	std::lock_guard<std::recursive_mutex> lock(*handle->mutex);
+	if (allocation->block == NULL) return;// committed resources stay where they are
+	allocation->owner = owner;
+	allocation->relocate = relocate;
+	allocation->resource = resource;
+	allocation->resourceState = resourceState;
+	allocation->block->allocations[allocation->unit] = allocation;
+}
+
+void HeapAllocator_Pin(HeapAllocator* handle, HeapAllocation* allocation)
+{
+	std::lock_guard<std::recursive_mutex> lock(*handle->mutex);
+	++allocation->pinCount;
+
+	// the caller is about to copy views of the current resource, so a copy in flight must not be swapped in
+	if (allocation->moving)
+	{
+		for (HeapAllocatorMove& move : *handle->moves)
+		{
+			if (move.allocation == allocation) move.allocation = NULL;
+		}
+		allocation->moving = false;
+	}
+}
+
+void HeapAllocator_Unpin(HeapAllocator* handle, HeapAllocation* allocation)
+{
+	std::lock_guard<std::recursive_mutex> lock(*handle->mutex);
+	--allocation->pinCount;
+}
+
+void HeapAllocator_Detach(HeapAllocator* handle, HeapAllocation* allocation)
+{
+	// owner is going away (or swapping allocations) so the defragmenter must no longer reach it
+	std::lock_guard<std::recursive_mutex> lock(*handle->mutex);
+	if (allocation->block != NULL) allocation->block->allocations[allocation->unit] = NULL;
+	for (HeapAllocatorMove& move : *handle->moves)
+	{
+		if (move.allocation == allocation) move.allocation = NULL;
+	}
+}
+
+bool HeapAllocator_CanMove(HeapAllocation* allocation)
+{
+	if (allocation == NULL || allocation->pinCount != 0 || allocation->moving) return false;
+
+	// copy queue can only access resources no other queue holds in a non-common state
+	ResourceState* resourceState = allocation->resourceState;
+	for (UINT i = 0; i != resourceState->subresourceCount; ++i)
+	{
+		if (resourceState->states[i] != D3D12_RESOURCE_STATE_COMMON) return false;
+	}
+	return true;
+}
+
+void HeapAllocator_BeginMoves(HeapAllocator* handle, UINT64 maxSize, std::vector<HeapAllocatorMove>* moves)
+{
+	std::lock_guard<std::recursive_mutex> lock(*handle->mutex);
+	UINT64 movedSize = 0;
+
+	// render targets are written by the direct queue so only buffers and textures in default heaps move
+	for (UINT c = 0; c != HeapAllocatorCategory_RenderTarget; ++c)
+	{
+		std::vector<HeapAllocatorBlock*>* pool = handle->pools[0][c];
+		if (pool->size() < 2) continue;
+
+		// empty the sparsest block into fuller ones so it can be released
+		HeapAllocatorBlock* source = NULL;
+		for (HeapAllocatorBlock* block : *pool)
+		{
+			if (block->usedSize == 0 || block->usedSize > HEAP_ALLOCATOR_SPARSE_SIZE) continue;
+			if (source == NULL || block->usedSize < source->usedSize) source = block;
+		}
+		if (source == NULL) continue;
+
+		for (UINT unit = 0; unit != HEAP_ALLOCATOR_UNIT_COUNT; ++unit)
+		{
+			HeapAllocation* allocation = source->allocations[unit];
+			if (!HeapAllocator_CanMove(allocation)) continue;
+			UINT64 size = (UINT64)HEAP_ALLOCATOR_UNIT_SIZE << allocation->order;
+			if (movedSize + size > maxSize) continue;
+
+			// find room in a block at least as full
+			HeapAllocatorMove move = {};
+			UINT16 targetUnit = 0;
+			for (HeapAllocatorBlock* block : *pool)
+			{
+				if (block == source || block->usedSize < source->usedSize) continue;
+				if (HeapAllocatorBlock_Allocate(block, allocation->order, &targetUnit))
+				{
+					move.target.block = block;
+					break;
+				}
+			}
+			if (move.target.block == NULL) continue;
+
+			D3D12_RESOURCE_DESC resourceDesc = allocation->resource->GetDesc();
+			if (FAILED(handle->device->CreatePlacedResource(move.target.block->heap, (UINT64)targetUnit * HEAP_ALLOCATOR_UNIT_SIZE, &resourceDesc, D3D12_RESOURCE_STATE_COMMON, NULL, IID_PPV_ARGS(&move.resource))))
+			{
+				HeapAllocatorBlock_Free(move.target.block, targetUnit, allocation->order);
+				continue;
+			}
+
+			move.allocation = allocation;
+			move.target.unit = targetUnit;
+			move.target.order = allocation->order;
+			move.target.size = allocation->size;
+			move.target.heapTypeIndex = allocation->heapTypeIndex;
+			move.target.category = allocation->category;
+			handle->stats.allocationCount++;
+			handle->stats.allocatedSize += size;
+			handle->stats.requestedSize += allocation->size;
+			allocation->moving = true;
+			moves->push_back(move);
+			movedSize += size;
+		}
+	}
+}
+
+void HeapAllocator_AddMoves(HeapAllocator* handle, std::vector<HeapAllocatorMove>* moves, UINT64 fenceValue)
+{
+	std::lock_guard<std::recursive_mutex> lock(*handle->mutex);
+	for (HeapAllocatorMove& move : *moves)
+	{
+		move.fenceValue = fenceValue;
+		handle->moves->push_back(move);
+	}
+}
+
+void HeapAllocator_EndMoves(HeapAllocator* handle, UINT64 completedFenceValue, std::vector<HeapAllocatorMove>* completedMoves)
+{
+	// owners pin or detach under the same lock, so holding it across the swap keeps a cancelled move from being applied
+	std::lock_guard<std::recursive_mutex> lock(*handle->mutex);
+
+	// collect finished copies
+	for (size_t i = 0; i != handle->moves->size();)
+	{
+		HeapAllocatorMove& move = (*handle->moves)[i];
+		if (move.fenceValue > completedFenceValue)
+		{
+			++i;
+			continue;
+		}
+		completedMoves->push_back(move);
+		handle->moves->erase(handle->moves->begin() + i);
+	}
+
+	// swap owners over (they defer-free their old allocation)
+	for (HeapAllocatorMove& move : *completedMoves)
+	{
+		HeapAllocation* allocation = move.allocation;
+		if (allocation == NULL)
+		{
+			// owner released the source while copying, nothing references the copy
+			move.resource->Release();
+			HeapAllocator_Free(handle, &move.target);
+			continue;
+		}
+
+		move.target.owner = allocation->owner;
+		move.target.relocate = allocation->relocate;
+		move.target.resource = move.resource;
+		move.target.resourceState = allocation->resourceState;
+		allocation->relocate(allocation->owner, move.resource, &move.target);// owner now holds target in 'allocation'
+		allocation->block->allocations[allocation->unit] = allocation;
+		handle->stats.movedCount++;
+		handle->stats.movedSize += (UINT64)HEAP_ALLOCATOR_UNIT_SIZE << allocation->order;
+	}
+	completedMoves->clear();
+}
@@ -0,0 +1,95 @@
+#pragma once
+#include "Common.h"
+#include <mutex>
+#include <vector>
+
+#define HEAP_ALLOCATOR_BLOCK_SIZE (64 * 1024 * 1024)
+#define HEAP_ALLOCATOR_UNIT_SIZE D3D12_DEFAULT_RESOURCE_PLACEMENT_ALIGNMENT// smallest buddy (64KB)
+#define HEAP_ALLOCATOR_UNIT_COUNT (HEAP_ALLOCATOR_BLOCK_SIZE / HEAP_ALLOCATOR_UNIT_SIZE)
+#define HEAP_ALLOCATOR_ORDER_COUNT 11// unit << 10 == block
+#define HEAP_ALLOCATOR_HEAP_TYPE_COUNT 3// default, upload, readback
+#define HEAP_ALLOCATOR_INVALID_UNIT 0xFFFF
+#define HEAP_ALLOCATOR_SPARSE_SIZE (HEAP_ALLOCATOR_BLOCK_SIZE / 2)// blocks using less are emptied into others by the defragmenter
+
+struct ResourceState;
+struct HeapAllocation;
+
+// swaps the owner over to a relocated copy of its resource (called with the allocator locked, so no Pin or Dispose can interleave)
+typedef void (*HeapAllocatorRelocateCallback)(void* owner, ID3D12Resource* resource, HeapAllocation* allocation);
+
+// resource tier 1 hardware can't mix these in one heap
+enum HeapAllocatorCategory
+{
+	HeapAllocatorCategory_Buffer,
+	HeapAllocatorCategory_Texture,
+	HeapAllocatorCategory_RenderTarget,
+	HeapAllocatorCategory_Count
+};
+
+// large ID3D12Heap split into power of two buddies
+struct HeapAllocatorBlock
+{
+	ID3D12Heap* heap;
+	UINT8 unitStates[HEAP_ALLOCATOR_UNIT_COUNT];// order + flags, only valid on the first unit of a buddy
+	UINT16 freeHeads[HEAP_ALLOCATOR_ORDER_COUNT];// intrusive free list per order
+	UINT16 freeNext[HEAP_ALLOCATOR_UNIT_COUNT], freePrev[HEAP_ALLOCATOR_UNIT_COUNT];
+	HeapAllocation* allocations[HEAP_ALLOCATOR_UNIT_COUNT];// relocatable allocation placed at the unit (NULL otherwise)
+	UINT64 usedSize;
+};
+
+struct HeapAllocation
+{
+	HeapAllocatorBlock* block;// NULL if the resource didn't fit and is committed
+	UINT16 unit, order;
+	UINT64 size;// size the resource asked for
+	UINT heapTypeIndex;
+	HeapAllocatorCategory category;
+
+	// set by owners the defragmenter may move
+	void* owner;
+	HeapAllocatorRelocateCallback relocate;
+	ID3D12Resource* resource;
+	ResourceState* resourceState;
+	UINT pinCount;// views of the resource were copied somewhere we can't retarget
+	bool moving;
+};
+
+struct HeapAllocatorMove
+{
+	HeapAllocation* allocation;// NULL if the owner released it while the copy was in flight
+	ID3D12Resource* resource;
+	HeapAllocation target;
+	UINT64 fenceValue;// copy is done once the defragmenter fence reaches this
+};
+
+// mirrored in C# (D3D12 Device.HeapAllocatorStats)
+struct HeapAllocatorStats
+{
+	UINT64 blockCount, reservedSize;// heap memory owned by the allocator
+	UINT64 allocationCount, allocatedSize, requestedSize;// allocated includes buddy rounding
+	UINT64 freeRangeCount, largestFreeRange;// fragmentation of the free space
+	UINT64 committedCount, committedSize;// resources too large for a block
+	UINT64 movedCount, movedSize;// relocated by the defragmenter
+};
+
+struct HeapAllocator
+{
+	ID3D12Device* device;
+	std::vector<HeapAllocatorBlock*>* pools[HEAP_ALLOCATOR_HEAP_TYPE_COUNT][HeapAllocatorCategory_Count];
+	HeapAllocatorStats stats;
+	std::vector<HeapAllocatorMove>* moves;// copies in flight
+	std::recursive_mutex* mutex;// relocate callbacks run under it and re-enter through Detach
+};
+
+void HeapAllocator_Init(HeapAllocator* handle, ID3D12Device* device);
+void HeapAllocator_Dispose(HeapAllocator* handle);
+bool HeapAllocator_CreateResource(HeapAllocator* handle, D3D12_HEAP_TYPE heapType, const D3D12_RESOURCE_DESC* resourceDesc, D3D12_RESOURCE_STATES initialState, ID3D12Resource** resource, HeapAllocation* allocation);
+void HeapAllocator_Free(HeapAllocator* handle, HeapAllocation* allocation);
+void HeapAllocator_GetStats(HeapAllocator* handle, HeapAllocatorStats* stats);
+void HeapAllocator_SetRelocatable(HeapAllocator* handle, HeapAllocation* allocation, void* owner, HeapAllocatorRelocateCallback relocate, ID3D12Resource* resource, ResourceState* resourceState);
+void HeapAllocator_Pin(HeapAllocator* handle, HeapAllocation* allocation);
+void HeapAllocator_Unpin(HeapAllocator* handle, HeapAllocation* allocation);
+void HeapAllocator_Detach(HeapAllocator* handle, HeapAllocation* allocation);
+void HeapAllocator_BeginMoves(HeapAllocator* handle, UINT64 maxSize, std::vector<HeapAllocatorMove>* moves);
+void HeapAllocator_AddMoves(HeapAllocator* handle, std::vector<HeapAllocatorMove>* moves, UINT64 fenceValue);
+void HeapAllocator_EndMoves(HeapAllocator* handle, UINT64 completedFenceValue, std::vector<HeapAllocatorMove>* completedMoves);
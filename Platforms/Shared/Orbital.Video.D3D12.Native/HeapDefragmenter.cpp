@@ -0,0 +1,114 @@
+#include "HeapDefragmenter.h"
+#include "Device.h"
+
+int HeapDefragmenter_Init(HeapDefragmenter* handle, Device* device)
+{
+	handle->device = device;
+	handle->budget = HEAP_DEFRAGMENTER_DEFAULT_BUDGET;
+	handle->moves = new std::vector<HeapAllocatorMove>();
+
+	// create copy queue
+	D3D12_COMMAND_QUEUE_DESC queueDesc = {};
+	queueDesc.Flags = D3D12_COMMAND_QUEUE_FLAG_NONE;
+	queueDesc.Type = D3D12_COMMAND_LIST_TYPE_COPY;
+	queueDesc.Priority = D3D12_COMMAND_QUEUE_PRIORITY_NORMAL;
+	if (FAILED(device->device->CreateCommandQueue(&queueDesc, IID_PPV_ARGS(&handle->copyQueue)))) return 0;
+
+	// create fence
+	if (FAILED(device->device->CreateFence(0, D3D12_FENCE_FLAG_NONE, IID_PPV_ARGS(&handle->fence)))) return 0;
+	handle->fenceEvent = CreateEvent(nullptr, FALSE, FALSE, nullptr);
+	if (handle->fenceEvent == NULL) return 0;
+
+	// create command allocators and list
+	for (UINT i = 0; i != HEAP_DEFRAGMENTER_ALLOCATOR_COUNT; ++i)
+	{
+		if (FAILED(device->device->CreateCommandAllocator(D3D12_COMMAND_LIST_TYPE_COPY, IID_PPV_ARGS(&handle->commandAllocators[i])))) return 0;
+	}
+	if (FAILED(device->device->CreateCommandList(0, D3D12_COMMAND_LIST_TYPE_COPY, handle->commandAllocators[0], nullptr, IID_PPV_ARGS(&handle->commandList)))) return 0;
+	if (FAILED(handle->commandList->Close())) return 0;// make sure this is closed as it defaults to open for writing
+
+	return 1;
+}
+
+void HeapDefragmenter_Dispose(HeapDefragmenter* handle)
+{
+	// wait for copies in flight (moves themselves are released with the heap allocator)
+	if (handle->copyQueue != NULL && handle->fence != NULL && handle->fenceEvent != NULL)
+	{
+		WaitForFenceValue(handle->fence, handle->fenceEvent, handle->fenceValue);
+	}
+
+	if (handle->moves != NULL)
+	{
+		delete handle->moves;
+		handle->moves = NULL;
+	}
+
+	if (handle->commandList != NULL)
+	{
+		handle->commandList->Release();
+		handle->commandList = NULL;
+	}
+
+	for (UINT i = 0; i != HEAP_DEFRAGMENTER_ALLOCATOR_COUNT; ++i)
+	{
+		if (handle->commandAllocators[i] != NULL)
+		{
+			handle->commandAllocators[i]->Release();
+			handle->commandAllocators[i] = NULL;
+		}
+	}
+
+	if (handle->fenceEvent != NULL)
+	{
+		CloseHandle(handle->fenceEvent);
+		handle->fenceEvent = NULL;
+	}
+
+	if (handle->fence != NULL)
+	{
+		handle->fence->Release();
+		handle->fence = NULL;
+	}
+
+	if (handle->copyQueue != NULL)
+	{
+		handle->copyQueue->Release();
+		handle->copyQueue = NULL;
+	}
+}
+
+void HeapDefragmenter_Update(HeapDefragmenter* handle)
+{
+	HeapAllocator* heapAllocator = &handle->device->heapAllocator;
+
+	// retarget owners whose copies finished
+	HeapAllocator_EndMoves(heapAllocator, handle->fence->GetCompletedValue(), handle->moves);
+	if (handle->budget == 0) return;
+
+	// skip a frame rather than block if the allocator we'd record into is still in use
+	ID3D12CommandAllocator* commandAllocator = handle->commandAllocators[handle->commandAllocatorIndex];
+	if (handle->fence->GetCompletedValue() < handle->commandAllocatorFenceValues[handle->commandAllocatorIndex]) return;
+
+	HeapAllocator_BeginMoves(heapAllocator, handle->budget, handle->moves);
+	if (handle->moves->empty()) return;
+
+	// record copies
+	commandAllocator->Reset();
+	handle->commandList->Reset(commandAllocator, NULL);
+	for (HeapAllocatorMove& move : *handle->moves) handle->commandList->CopyResource(move.resource, move.allocation->resource);
+	handle->commandList->Close();
+
+	// order after pending uploads into the sources (GPU-side wait on the upload queue only)
+	UploadEngine* uploadEngine = &handle->device->uploadEngine;
+	handle->copyQueue->Wait(uploadEngine->fence, UploadEngine_Flush(uploadEngine));
+	ID3D12CommandList* commandLists[1] = { handle->commandList };
+	handle->copyQueue->ExecuteCommandLists(1, commandLists);
+	++handle->fenceValue;
+	handle->copyQueue->Signal(handle->fence, handle->fenceValue);
+	handle->commandAllocatorFenceValues[handle->commandAllocatorIndex] = handle->fenceValue;
+	handle->commandAllocatorIndex = (handle->commandAllocatorIndex + 1) % HEAP_DEFRAGMENTER_ALLOCATOR_COUNT;
+
+	HeapAllocator_AddMoves(heapAllocator, handle->moves, handle->fenceValue);
+	handle->moves->clear();
+}
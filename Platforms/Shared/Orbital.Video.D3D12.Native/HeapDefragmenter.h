@@ -0,0 +1,29 @@
+#pragma once
+#include "Common.h"
+#include "HeapAllocator.h"
+#include <vector>
+
+#define HEAP_DEFRAGMENTER_DEFAULT_BUDGET (8 * 1024 * 1024)
+#define HEAP_DEFRAGMENTER_ALLOCATOR_COUNT 2
+
+struct Device;
+
+// moves placed resources out of sparse heap blocks on its own copy queue (direct queue never waits on it)
+struct HeapDefragmenter
+{
+	Device* device;
+	UINT64 budget;// max bytes copied per frame (0 disables)
+	ID3D12CommandQueue* copyQueue;
+	ID3D12Fence* fence;
+	HANDLE fenceEvent;
+	UINT64 fenceValue;
+	ID3D12CommandAllocator* commandAllocators[HEAP_DEFRAGMENTER_ALLOCATOR_COUNT];
+	UINT64 commandAllocatorFenceValues[HEAP_DEFRAGMENTER_ALLOCATOR_COUNT];
+	UINT commandAllocatorIndex;
+	ID3D12GraphicsCommandList* commandList;
+	std::vector<HeapAllocatorMove>* moves;// scratch list reused every update
+};
+
+int HeapDefragmenter_Init(HeapDefragmenter* handle, Device* device);
+void HeapDefragmenter_Dispose(HeapDefragmenter* handle);
+void HeapDefragmenter_Update(HeapDefragmenter* handle);
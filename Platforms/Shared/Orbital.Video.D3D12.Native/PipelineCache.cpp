@@ -0,0 +1,292 @@
+#include "PipelineCache.h"
+#include <stdio.h>
+
+UINT64 PipelineCache_Hash(UINT64 hash, const void* data, size_t size)
+{
+	// FNV-1a, stable across runs so it can name pipelines in the serialized library
+	const BYTE* bytes = (const BYTE*)data;
+	for (size_t i = 0; i != size; ++i)
+	{
+		hash ^= bytes[i];
+		hash *= 1099511628211ull;
+	}
+	return hash;
+}
+
+void PipelineCache_AppendKey(std::vector<BYTE>* key, const void* data, size_t size)
+{
+	key->insert(key->end(), (const BYTE*)data, (const BYTE*)data + size);
+}
+
+UINT64 PipelineCache_HashKey(UINT64 hash, std::vector<BYTE>* key, const void* data, size_t size)
+{
+	PipelineCache_AppendKey(key, data, size);
+	return PipelineCache_Hash(hash, data, size);
+}
+
+#define PIPELINE_CACHE_HASH_FIELD(field) hash = PipelineCache_HashKey(hash, key, &(field), sizeof(field))
+
+UINT64 PipelineCache_HashGraphicsDesc(const D3D12_GRAPHICS_PIPELINE_STATE_DESC* desc, UINT64 effectHash, const void* signatureBlob, SIZE_T signatureBlobSize, std::vector<BYTE>* key)
+{
+	// shader bytecode and root signature content (pointers change every run)
+	key->clear();
+	UINT64 hash = PipelineCache_HashKey(PIPELINE_CACHE_HASH_SEED, key, &effectHash, sizeof(UINT64));
+
+	// input layout
+	PIPELINE_CACHE_HASH_FIELD(desc->InputLayout.NumElements);
+	for (UINT i = 0; i != desc->InputLayout.NumElements; ++i)
+	{
+		const D3D12_INPUT_ELEMENT_DESC* element = &desc->InputLayout.pInputElementDescs[i];
+		hash = PipelineCache_HashKey(hash, key, element->SemanticName, strlen(element->SemanticName));
+		PIPELINE_CACHE_HASH_FIELD(element->SemanticIndex);
+		PIPELINE_CACHE_HASH_FIELD(element->Format);
+		PIPELINE_CACHE_HASH_FIELD(element->InputSlot);
+		PIPELINE_CACHE_HASH_FIELD(element->AlignedByteOffset);
+		PIPELINE_CACHE_HASH_FIELD(element->InputSlotClass);
+		PIPELINE_CACHE_HASH_FIELD(element->InstanceDataStepRate);
+	}
+	PIPELINE_CACHE_HASH_FIELD(desc->IBStripCutValue);
+	PIPELINE_CACHE_HASH_FIELD(desc->PrimitiveTopologyType);
+
+	// render targets
+	PIPELINE_CACHE_HASH_FIELD(desc->NumRenderTargets);
+	hash = PipelineCache_HashKey(hash, key, desc->RTVFormats, sizeof(DXGI_FORMAT) * desc->NumRenderTargets);
+	PIPELINE_CACHE_HASH_FIELD(desc->DSVFormat);
+	PIPELINE_CACHE_HASH_FIELD(desc->SampleDesc.Count);
+	PIPELINE_CACHE_HASH_FIELD(desc->SampleDesc.Quality);
+	PIPELINE_CACHE_HASH_FIELD(desc->SampleMask);
+
+	// fixed function state (field by field where the structs contain padding)
+	hash = PipelineCache_HashKey(hash, key, &desc->RasterizerState, sizeof(D3D12_RASTERIZER_DESC));
+	const D3D12_DEPTH_STENCIL_DESC* depthStencil = &desc->DepthStencilState;
+	PIPELINE_CACHE_HASH_FIELD(depthStencil->DepthEnable);
+	PIPELINE_CACHE_HASH_FIELD(depthStencil->DepthWriteMask);
+	PIPELINE_CACHE_HASH_FIELD(depthStencil->DepthFunc);
+	PIPELINE_CACHE_HASH_FIELD(depthStencil->StencilEnable);
+	PIPELINE_CACHE_HASH_FIELD(depthStencil->StencilReadMask);
+	PIPELINE_CACHE_HASH_FIELD(depthStencil->StencilWriteMask);
+	hash = PipelineCache_HashKey(hash, key, &depthStencil->FrontFace, sizeof(D3D12_DEPTH_STENCILOP_DESC));
+	hash = PipelineCache_HashKey(hash, key, &depthStencil->BackFace, sizeof(D3D12_DEPTH_STENCILOP_DESC));
+	PIPELINE_CACHE_HASH_FIELD(desc->BlendState.AlphaToCoverageEnable);
+	PIPELINE_CACHE_HASH_FIELD(desc->BlendState.IndependentBlendEnable);
+	for (UINT i = 0; i != desc->NumRenderTargets; ++i)
+	{
+		const D3D12_RENDER_TARGET_BLEND_DESC* blend = &desc->BlendState.RenderTarget[i];
+		hash = PipelineCache_HashKey(hash, key, blend, offsetof(D3D12_RENDER_TARGET_BLEND_DESC, RenderTargetWriteMask));
+		PIPELINE_CACHE_HASH_FIELD(blend->RenderTargetWriteMask);
+	}
+
+	PIPELINE_CACHE_HASH_FIELD(desc->NodeMask);
+	PIPELINE_CACHE_HASH_FIELD(desc->Flags);
+
+	// the effect hash stands in for these in the hash, the key compares them in full
+	PipelineCache_AppendKey(key, &signatureBlobSize, sizeof(SIZE_T));
+	PipelineCache_AppendKey(key, signatureBlob, signatureBlobSize);
+	const D3D12_SHADER_BYTECODE* stages[5] = { &desc->VS, &desc->PS, &desc->HS, &desc->DS, &desc->GS };
+	for (UINT i = 0; i != 5; ++i)
+	{
+		PipelineCache_AppendKey(key, &stages[i]->BytecodeLength, sizeof(SIZE_T));
+		PipelineCache_AppendKey(key, stages[i]->pShaderBytecode, stages[i]->BytecodeLength);
+	}
+	return hash;
+}
+
+#undef PIPELINE_CACHE_HASH_FIELD
+
+bool PipelineCache_CreateLibrary(PipelineCache* handle, const void* data, UINT64 size)
+{
+	if (handle->device1 == NULL) return false;
+	if (size != 0)
+	{
+		handle->libraryData = (BYTE*)malloc(size);
+		memcpy(handle->libraryData, data, size);
+	}
+
+	if (FAILED(handle->device1->CreatePipelineLibrary(handle->libraryData, size, IID_PPV_ARGS(&handle->library))))
+	{
+		handle->library = NULL;
+		if (handle->libraryData != NULL)
+		{
+			free(handle->libraryData);
+			handle->libraryData = NULL;
+		}
+		else
+		{
+			// driver doesn't support libraries, stop trying and only cache in memory
+			handle->device1->Release();
+			handle->device1 = NULL;
+		}
+		return false;
+	}
+	return true;
+}
+
+void PipelineCache_Init(PipelineCache* handle, ID3D12Device* device)
+{
+	handle->device = device;
+	if (FAILED(device->QueryInterface(IID_PPV_ARGS(&handle->device1)))) handle->device1 = NULL;
+	handle->pipelines = new std::unordered_multimap<UINT64, PipelineCacheEntry*>();
+	memset(&handle->stats, 0, sizeof(PipelineCacheStats));
+	handle->mutex = new std::mutex();
+}
+
+void PipelineCache_Dispose(PipelineCache* handle)
+{
+	if (handle->pipelines != NULL)
+	{
+		for (auto& pipeline : *handle->pipelines)
+		{
+			pipeline.second->pipeline->Release();
+			free(pipeline.second->key);
+			free(pipeline.second);
+		}
+		delete handle->pipelines;
+		handle->pipelines = NULL;
+	}
+
+	if (handle->library != NULL)
+	{
+		handle->library->Release();
+		handle->library = NULL;
+	}
+
+	if (handle->libraryData != NULL)
+	{
+		free(handle->libraryData);
+		handle->libraryData = NULL;
+	}
+
+	if (handle->device1 != NULL)
+	{
+		handle->device1->Release();
+		handle->device1 = NULL;
+	}
+
+	if (handle->mutex != NULL)
+	{
+		delete handle->mutex;
+		handle->mutex = NULL;
+	}
+}
+
+bool PipelineCache_Load(PipelineCache* handle, const void* data, UINT64 size)
+{
+	if (size == 0) return false;
+	std::lock_guard<std::mutex> lock(*handle->mutex);
+	if (handle->library != NULL) return false;// must be loaded before the first pipeline is requested
+
+	// blobs from another driver or adapter are rejected, an empty library is created on first use instead
+	return PipelineCache_CreateLibrary(handle, data, size);
+}
+
+bool PipelineCache_Serialize(PipelineCache* handle, void* data, UINT64* size)
+{
+	std::lock_guard<std::mutex> lock(*handle->mutex);
+	if (handle->library == NULL)
+	{
+		*size = 0;
+		return false;
+	}
+
+	// query size when no buffer is passed
+	SIZE_T serializedSize = handle->library->GetSerializedSize();
+	if (data == NULL)
+	{
+		*size = serializedSize;
+		return true;
+	}
+
+	if (*size < serializedSize) return false;
+	if (FAILED(handle->library->Serialize(data, serializedSize))) return false;
+	*size = serializedSize;
+	return true;
+}
+
+PipelineCacheEntry* PipelineCache_FindEntry(PipelineCache* handle, UINT64 hash, const BYTE* key, SIZE_T keySize)
+{
+	auto range = handle->pipelines->equal_range(hash);
+	for (auto existing = range.first; existing != range.second; ++existing)
+	{
+		PipelineCacheEntry* entry = existing->second;
+		if (entry->keySize == keySize && memcmp(entry->key, key, keySize) == 0) return entry;
+	}
+	return NULL;
+}
+
+bool PipelineCache_FindGraphicsPipeline(PipelineCache* handle, const D3D12_GRAPHICS_PIPELINE_STATE_DESC* desc, UINT64 hash, const BYTE* key, SIZE_T keySize, ID3D12PipelineState** state)
+{
+	// in memory only, never loads or compiles
+	std::lock_guard<std::mutex> lock(*handle->mutex);
+	PipelineCacheEntry* entry = PipelineCache_FindEntry(handle, hash, key, keySize);
+	if (entry == NULL) return false;
+	++handle->stats.memoryHits;
+	entry->pipeline->AddRef();
+	*state = entry->pipeline;
+	return true;
+}
+
+bool PipelineCache_GetGraphicsPipeline(PipelineCache* handle, const D3D12_GRAPHICS_PIPELINE_STATE_DESC* desc, UINT64 hash, const BYTE* key, SIZE_T keySize, ID3D12PipelineState** state)
+{
+	wchar_t name[17];
+	swprintf_s(name, 17, L"%016llx", hash);
+
+	LARGE_INTEGER frequency, start, end;
+	QueryPerformanceFrequency(&frequency);
+	QueryPerformanceCounter(&start);
+	ID3D12PipelineState* pipeline = NULL;
+	bool loaded = false;
+	{
+		std::lock_guard<std::mutex> lock(*handle->mutex);
+		PipelineCacheEntry* entry = PipelineCache_FindEntry(handle, hash, key, keySize);
+		if (entry != NULL)
+		{
+			++handle->stats.memoryHits;
+			entry->pipeline->AddRef();
+			*state = entry->pipeline;
+			return true;
+		}
+
+		// a colliding hash shares the library name, loading then fails as the desc doesn't match and the pipeline is compiled
+		// loading the same name from several threads isn't safe so loads stay under the lock
+		if (handle->library == NULL) PipelineCache_CreateLibrary(handle, NULL, 0);
+		if (handle->library != NULL) loaded = SUCCEEDED(handle->library->LoadGraphicsPipeline(name, desc, IID_PPV_ARGS(&pipeline)));
+	}
+
+	// compile outside the lock so render states can be created on several threads
+	if (!loaded && FAILED(handle->device->CreateGraphicsPipelineState(desc, IID_PPV_ARGS(&pipeline)))) return false;
+	QueryPerformanceCounter(&end);
+
+	std::lock_guard<std::mutex> lock(*handle->mutex);
+	handle->stats.compileMicroseconds += (UINT64)((end.QuadPart - start.QuadPart) * 1000000 / frequency.QuadPart);
+	if (loaded) ++handle->stats.libraryHits;
+	else ++handle->stats.misses;
+
+	// another thread finished the same pipeline first
+	PipelineCacheEntry* existing = PipelineCache_FindEntry(handle, hash, key, keySize);
+	if (existing != NULL)
+	{
+		pipeline->Release();
+		existing->pipeline->AddRef();
+		*state = existing->pipeline;
+		return true;
+	}
+
+	// fails if the name is taken by a stale pipeline, it is then compiled every run until the library is deleted
+	if (!loaded && handle->library != NULL) handle->library->StorePipeline(name, pipeline);
+	PipelineCacheEntry* entry = (PipelineCacheEntry*)calloc(1, sizeof(PipelineCacheEntry));
+	entry->key = (BYTE*)malloc(keySize);
+	memcpy(entry->key, key, keySize);
+	entry->keySize = keySize;
+	entry->pipeline = pipeline;
+	handle->pipelines->insert(std::make_pair(hash, entry));
+	++handle->stats.pipelineCount;
+	pipeline->AddRef();// reference for the caller
+	*state = pipeline;
+	return true;
+}
+
+void PipelineCache_GetStats(PipelineCache* handle, PipelineCacheStats* stats)
+{
+	std::lock_guard<std::mutex> lock(*handle->mutex);
+	*stats = handle->stats;
+}
@@ -0,0 +1,47 @@
+#pragma once
+#include "Common.h"
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+#define PIPELINE_CACHE_HASH_SEED 14695981039346656037ull
+
+// mirrored in C# (D3D12 Device.PipelineCacheStats)
+struct PipelineCacheStats
+{
+	UINT64 memoryHits;// identical state already created this run
+	UINT64 libraryHits, misses;// loaded from the serialized library or compiled
+	UINT64 compileMicroseconds;// time spent loading and compiling pipelines
+	UINT64 pipelineCount;
+};
+
+// hashes can collide, entries are told apart by the bytes the hash was computed from
+struct PipelineCacheEntry
+{
+	BYTE* key;// serialized desc, root signature blob and shader bytecode compared on hash match
+	SIZE_T keySize;
+	ID3D12PipelineState* pipeline;
+};
+
+// pipelines are shared by every render state with the same content hash and kept for the device lifetime
+struct PipelineCache
+{
+	ID3D12Device* device;
+	ID3D12Device1* device1;// NULL if pipeline libraries aren't supported
+	ID3D12PipelineLibrary* library;// created on first use if nothing was loaded
+	BYTE* libraryData;// must outlive the library
+	bool libraryModified;
+	std::unordered_multimap<UINT64, PipelineCacheEntry*>* pipelines;// keyed on content (root signature by its serialized blob, never the object pointer)
+	PipelineCacheStats stats;
+	std::mutex* mutex;
+};
+
+UINT64 PipelineCache_Hash(UINT64 hash, const void* data, size_t size);
+UINT64 PipelineCache_HashGraphicsDesc(const D3D12_GRAPHICS_PIPELINE_STATE_DESC* desc, UINT64 effectHash, const void* signatureBlob, SIZE_T signatureBlobSize, std::vector<BYTE>* key);
+void PipelineCache_Init(PipelineCache* handle, ID3D12Device* device);
+void PipelineCache_Dispose(PipelineCache* handle);
+bool PipelineCache_Load(PipelineCache* handle, const void* data, UINT64 size);
+bool PipelineCache_Serialize(PipelineCache* handle, void* data, UINT64* size);
+bool PipelineCache_FindGraphicsPipeline(PipelineCache* handle, const D3D12_GRAPHICS_PIPELINE_STATE_DESC* desc, UINT64 hash, const BYTE* key, SIZE_T keySize, ID3D12PipelineState** state);
+bool PipelineCache_GetGraphicsPipeline(PipelineCache* handle, const D3D12_GRAPHICS_PIPELINE_STATE_DESC* desc, UINT64 hash, const BYTE* key, SIZE_T keySize, ID3D12PipelineState** state);
+void PipelineCache_GetStats(PipelineCache* handle, PipelineCacheStats* stats);
@@ -0,0 +1,184 @@
+#include "PipelineCompiler.h"
+#include "Device.h"
+#include "RenderState.h"
+#include <algorithm>
+
+bool PipelineCompiler_JobOrder(const PipelineCompileJob* a, const PipelineCompileJob* b)
+{
+	// std heaps keep the largest element first, 'a' sorts below 'b' if it should compile later
+	if (a->priority != b->priority) return a->priority < b->priority;
+	return a->sequence > b->sequence;
+}
+
+void PipelineCompiler_FreeJob(PipelineCompileJob* job)
+{
+	free(job->inputElements);
+	free(job->key);
+	free(job);
+}
+
+void PipelineCompiler_Worker(PipelineCompiler* handle)
+{
+	std::unique_lock<std::mutex> lock(*handle->mutex);
+	while (true)
+	{
+		handle->jobQueued->wait(lock, [handle] { return handle->stopping || !handle->jobs->empty(); });
+		if (handle->stopping) return;
+		std::pop_heap(handle->jobs->begin(), handle->jobs->end(), PipelineCompiler_JobOrder);
+		PipelineCompileJob* job = handle->jobs->back();
+		handle->jobs->pop_back();
+
+		// compile without holding the lock, the render state waits in Cancel if disposed meanwhile
+		lock.unlock();
+		ID3D12PipelineState* state = NULL;
+		bool success = PipelineCache_GetGraphicsPipeline(&handle->device->pipelineCache, &job->desc, job->hash, job->key, job->keySize, &state);
+		lock.lock();
+
+		// state is written before status so draw threads never see a ready status without it
+		RenderState* renderState = job->renderState;
+		renderState->state = state;
+		InterlockedExchange(&renderState->status, success ? RenderStateStatus_Ready : RenderStateStatus_Failed);
+		renderState->compileJob = NULL;
+		PipelineCompiler_FreeJob(job);
+		handle->jobFinished->notify_all();
+	}
+}
+
+void PipelineCompiler_Init(PipelineCompiler* handle, Device* device, UINT workerCount)
+{
+	handle->device = device;
+	if (workerCount == 0)
+	{
+		// leave a core for the threads recording frames
+		UINT coreCount = std::thread::hardware_concurrency();
+		workerCount = coreCount > 1 ? coreCount - 1 : 1;
+		if (workerCount > PIPELINE_COMPILER_DEFAULT_WORKER_COUNT) workerCount = PIPELINE_COMPILER_DEFAULT_WORKER_COUNT;
+	}
+	if (workerCount > PIPELINE_COMPILER_MAX_WORKER_COUNT) workerCount = PIPELINE_COMPILER_MAX_WORKER_COUNT;
+	handle->workerCount = workerCount;
+	handle->workers = new std::vector<std::thread*>();
+	handle->jobs = new std::vector<PipelineCompileJob*>();
+	handle->mutex = new std::mutex();
+	handle->jobQueued = new std::condition_variable();
+	handle->jobFinished = new std::condition_variable();
+}
+
+void PipelineCompiler_Dispose(PipelineCompiler* handle)
+{
+	// render states cancel their jobs when disposed, anything left belongs to leaked states
+	if (handle->workers != NULL)
+	{
+		{
+			std::lock_guard<std::mutex> lock(*handle->mutex);
+			handle->stopping = true;
+		}
+		handle->jobQueued->notify_all();
+		for (std::thread* worker : *handle->workers)
+		{
+			worker->join();
+			delete worker;
+		}
+		delete handle->workers;
+		handle->workers = NULL;
+	}
+
+	if (handle->jobs != NULL)
+	{
+		for (PipelineCompileJob* job : *handle->jobs)
+		{
+			InterlockedExchange(&job->renderState->status, RenderStateStatus_Failed);
+			job->renderState->compileJob = NULL;
+			PipelineCompiler_FreeJob(job);
+		}
+		delete handle->jobs;
+		handle->jobs = NULL;
+	}
+
+	if (handle->jobQueued != NULL)
+	{
+		delete handle->jobQueued;
+		handle->jobQueued = NULL;
+	}
+
+	if (handle->jobFinished != NULL)
+	{
+		delete handle->jobFinished;
+		handle->jobFinished = NULL;
+	}
+
+	if (handle->mutex != NULL)
+	{
+		delete handle->mutex;
+		handle->mutex = NULL;
+	}
+}
+
+void PipelineCompiler_Submit(PipelineCompiler* handle, RenderState* renderState, const D3D12_GRAPHICS_PIPELINE_STATE_DESC* desc, UINT64 hash, const BYTE* key, SIZE_T keySize, int priority)
+{
+	// copy input layout and key as the caller's desc lives on its stack
+	PipelineCompileJob* job = (PipelineCompileJob*)calloc(1, sizeof(PipelineCompileJob));
+	job->renderState = renderState;
+	job->desc = *desc;
+	job->hash = hash;
+	job->key = (BYTE*)malloc(keySize);
+	memcpy(job->key, key, keySize);
+	job->keySize = keySize;
+	job->priority = priority;
+	if (desc->InputLayout.NumElements != 0)
+	{
+		size_t inputElementsSize = sizeof(D3D12_INPUT_ELEMENT_DESC) * desc->InputLayout.NumElements;
+		job->inputElements = (D3D12_INPUT_ELEMENT_DESC*)malloc(inputElementsSize);
+		memcpy(job->inputElements, desc->InputLayout.pInputElementDescs, inputElementsSize);
+		job->desc.InputLayout.pInputElementDescs = job->inputElements;
+	}
+
+	{
+		std::lock_guard<std::mutex> lock(*handle->mutex);
+
+		// start workers on first use so devices that never compile async don't own threads
+		if (handle->workers->empty())
+		{
+			for (UINT i = 0; i != handle->workerCount; ++i) handle->workers->push_back(new std::thread(PipelineCompiler_Worker, handle));
+		}
+
+		job->sequence = handle->sequence++;
+		renderState->status = RenderStateStatus_Compiling;
+		renderState->compileJob = job;
+		handle->jobs->push_back(job);
+		std::push_heap(handle->jobs->begin(), handle->jobs->end(), PipelineCompiler_JobOrder);
+	}
+	handle->jobQueued->notify_one();
+}
+
+void PipelineCompiler_SetPriority(PipelineCompiler* handle, RenderState* renderState, int priority)
+{
+	std::lock_guard<std::mutex> lock(*handle->mutex);
+	PipelineCompileJob* job = renderState->compileJob;
+	if (job == NULL || job->priority == priority) return;
+
+	// only queued jobs can move, a running job is left as is
+	if (std::find(handle->jobs->begin(), handle->jobs->end(), job) == handle->jobs->end()) return;
+	job->priority = priority;
+	std::make_heap(handle->jobs->begin(), handle->jobs->end(), PipelineCompiler_JobOrder);
+}
+
+void PipelineCompiler_Cancel(PipelineCompiler* handle, RenderState* renderState)
+{
+	std::unique_lock<std::mutex> lock(*handle->mutex);
+	PipelineCompileJob* job = renderState->compileJob;
+	if (job == NULL) return;
+
+	// drop queued job
+	auto queuedJob = std::find(handle->jobs->begin(), handle->jobs->end(), job);
+	if (queuedJob != handle->jobs->end())
+	{
+		handle->jobs->erase(queuedJob);
+		std::make_heap(handle->jobs->begin(), handle->jobs->end(), PipelineCompiler_JobOrder);
+		renderState->compileJob = NULL;
+		PipelineCompiler_FreeJob(job);
+		return;
+	}
+
+	// already compiling, wait so the worker doesn't write to a disposed render state
+	handle->jobFinished->wait(lock, [renderState] { return renderState->compileJob == NULL; });
+}
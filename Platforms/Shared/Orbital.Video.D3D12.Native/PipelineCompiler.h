@@ -0,0 +1,45 @@
+#pragma once
+#include "Common.h"
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <vector>
+
+#define PIPELINE_COMPILER_MAX_WORKER_COUNT 8
+#define PIPELINE_COMPILER_DEFAULT_WORKER_COUNT 2// upper bound of the count picked from the core count
+
+struct Device;
+struct RenderState;
+
+// pipeline desc copied out of RenderState_Init, resources it points to are owned by the render state
+struct PipelineCompileJob
+{
+	RenderState* renderState;
+	D3D12_GRAPHICS_PIPELINE_STATE_DESC desc;
+	D3D12_INPUT_ELEMENT_DESC* inputElements;// desc.InputLayout points here
+	UINT64 hash;
+	BYTE* key;// content the hash was computed from (see PipelineCache_HashGraphicsDesc)
+	SIZE_T keySize;
+	int priority;
+	UINT64 sequence;// jobs of equal priority compile in submit order
+};
+
+// workers started on the first async render state, compile through the device pipeline cache
+struct PipelineCompiler
+{
+	Device* device;
+	UINT workerCount;
+	std::vector<std::thread*>* workers;
+	std::vector<PipelineCompileJob*>* jobs;// heap, highest priority first
+	UINT64 sequence;
+	bool stopping;
+	std::mutex* mutex;
+	std::condition_variable* jobQueued;
+	std::condition_variable* jobFinished;
+};
+
+void PipelineCompiler_Init(PipelineCompiler* handle, Device* device, UINT workerCount);
+void PipelineCompiler_Dispose(PipelineCompiler* handle);
+void PipelineCompiler_Submit(PipelineCompiler* handle, RenderState* renderState, const D3D12_GRAPHICS_PIPELINE_STATE_DESC* desc, UINT64 hash, const BYTE* key, SIZE_T keySize, int priority);
+void PipelineCompiler_SetPriority(PipelineCompiler* handle, RenderState* renderState, int priority);
+void PipelineCompiler_Cancel(PipelineCompiler* handle, RenderState* renderState);
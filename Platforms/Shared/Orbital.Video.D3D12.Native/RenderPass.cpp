@@ -11,17 +11,19 @@ extern "C"
 		return handle;
 	}
 
-	ORBITAL_EXPORT int Orbital_Video_D3D12_RenderPass_Init_Native(RenderPass* handle, RenderPassDesc* desc, DXGI_FORMAT* renderTargetFormats, ID3D12Resource** renderTargetViews, D3D12_CPU_DESCRIPTOR_HANDLE* renderTargetHandles, UINT renderTargetCount)//, DXGI_FORMAT depthStencilFormat)
+	ORBITAL_EXPORT int Orbital_Video_D3D12_RenderPass_Init_Native(RenderPass* handle, RenderPassDesc* desc, DXGI_FORMAT* renderTargetFormats, ID3D12Resource** renderTargetViews, ResourceState** renderTargetStates, D3D12_CPU_DESCRIPTOR_HANDLE* renderTargetHandles, UINT renderTargetCount)//, DXGI_FORMAT depthStencilFormat)
 	{
 		// render-pass: render target
 		handle->renderTargetCount = renderTargetCount;
 		handle->renderTargetFormats = (DXGI_FORMAT*)calloc(renderTargetCount, sizeof(DXGI_FORMAT));
 		handle->renderTargetViews = (ID3D12Resource**)calloc(renderTargetCount, sizeof(ID3D12Resource));
+		handle->renderTargetStates = (ResourceState**)calloc(renderTargetCount, sizeof(ResourceState*));
 		handle->renderTargetDescs = (D3D12_RENDER_PASS_RENDER_TARGET_DESC*)calloc(renderTargetCount, sizeof(D3D12_RENDER_PASS_RENDER_TARGET_DESC));
 		for (UINT i = 0; i != renderTargetCount; ++i)
 		{
 			handle->renderTargetFormats[i] = renderTargetFormats[i];
 			handle->renderTargetViews[i] = renderTargetViews[i];
+			handle->renderTargetStates[i] = renderTargetStates[i];
 
 			D3D12_RENDER_PASS_BEGINNING_ACCESS renderPassBeginningAccessClear;
 			renderPassBeginningAccessClear.Type = D3D12_RENDER_PASS_BEGINNING_ACCESS_TYPE::D3D12_RENDER_PASS_BEGINNING_ACCESS_TYPE_CLEAR;
@@ -51,8 +53,13 @@ extern "C"
 		if (handle->swapChain != NULL)
 		{
 			DXGI_FORMAT* renderTargetFormatFormats = (DXGI_FORMAT*)alloca(sizeof(DXGI_FORMAT) * handle->swapChain->bufferCount);
-			for (UINT i = 0; i != handle->swapChain->bufferCount; ++i) renderTargetFormatFormats[i] = handle->swapChain->renderTargetFormat;
-			return Orbital_Video_D3D12_RenderPass_Init_Native(handle, desc, renderTargetFormatFormats, handle->swapChain->renderTargetViews, handle->swapChain->renderTargetDescHandles, handle->swapChain->bufferCount);//, handle->depthStencilFormat);
+			ResourceState** renderTargetStates = (ResourceState**)alloca(sizeof(ResourceState*) * handle->swapChain->bufferCount);
+			for (UINT i = 0; i != handle->swapChain->bufferCount; ++i)
+			{
+				renderTargetFormatFormats[i] = handle->swapChain->renderTargetFormat;
+				renderTargetStates[i] = &handle->swapChain->renderTargetStates[i];
+			}
+			return Orbital_Video_D3D12_RenderPass_Init_Native(handle, desc, renderTargetFormatFormats, handle->swapChain->renderTargetViews, renderTargetStates, handle->swapChain->renderTargetDescHandles, handle->swapChain->bufferCount);//, handle->depthStencilFormat);
 		}
 		else
 		{
@@ -74,6 +81,12 @@ extern "C"
 			handle->renderTargetViews = NULL;
 		}
 
+		if (handle->renderTargetStates != NULL)
+		{
+			free(handle->renderTargetStates);
+			handle->renderTargetStates = NULL;
+		}
+
 		if (handle->renderTargetDescs != NULL)
 		{
 			free(handle->renderTargetDescs);
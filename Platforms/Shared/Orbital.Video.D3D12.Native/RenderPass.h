@@ -11,6 +11,7 @@ struct RenderPass
 	DXGI_FORMAT* renderTargetFormats;
 	DXGI_FORMAT depthStencilFormat;
 	ID3D12Resource** renderTargetViews;
+	ResourceState** renderTargetStates;// transitioned through the recording list's tracker
 	D3D12_RENDER_PASS_RENDER_TARGET_DESC* renderTargetDescs;
 	D3D12_RENDER_PASS_DEPTH_STENCIL_DESC* depthStencilDesc;
 };
\ No newline at end of file
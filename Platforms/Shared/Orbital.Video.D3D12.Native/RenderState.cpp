@@ -1,8 +1,7 @@
 #include "RenderState.h"
 #include "RenderPass.h"
 #include "ShaderEffect.h"
-#include "ConstantBuffer.h"
-#include "Texture.h"
+#include "BindingSet.h"
 #include "VertexBuffer.h"
 #include "Utils.h"
 
@@ -29,54 +28,12 @@ extern "C"
 		if (shaderEffect->gs != NULL) pipelineDesc.GS = shaderEffect->gs->bytecode;
 		pipelineDesc.pRootSignature = shaderEffect->signatures[gpuIndex];
 
-		// add constant buffer heaps
-		if (desc->constantBufferCount != 0)
+		// resources are optional, pipeline only states are paired with binding sets at draw time
+		handle->bindingSet.device = handle->device;
+		handle->bindingSet.shaderEffect = shaderEffect;
+		if (desc->constantBufferCount + desc->textureCount != 0)
 		{
-			handle->constantBufferCount = desc->constantBufferCount;
-			UINT size = sizeof(ConstantBuffer*) * handle->constantBufferCount;
-			handle->constantBuffers = (ConstantBuffer**)malloc(size);
-			memcpy(handle->constantBuffers, desc->constantBuffers, size);
-
-			D3D12_DESCRIPTOR_HEAP_DESC heapDesc = {};
-			heapDesc.NumDescriptors = desc->constantBufferCount;
-			heapDesc.Type = D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV;
-			heapDesc.Flags = D3D12_DESCRIPTOR_HEAP_FLAG_SHADER_VISIBLE;
-			if (FAILED(handle->device->device->CreateDescriptorHeap(&heapDesc, IID_PPV_ARGS(&handle->constantBufferHeap)))) return 0;
-			handle->constantBufferGPUDescHandle = handle->constantBufferHeap->GetGPUDescriptorHandleForHeapStart();
-			D3D12_CPU_DESCRIPTOR_HANDLE cpuComputerBufferHeap = handle->constantBufferHeap->GetCPUDescriptorHandleForHeapStart();
-			UINT heapSize = handle->device->device->GetDescriptorHandleIncrementSize(D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV);
-			for (int i = 0; i != desc->constantBufferCount; ++i)
-			{
-				ConstantBuffer* constantBuffer = (ConstantBuffer*)desc->constantBuffers[i];
-				D3D12_CPU_DESCRIPTOR_HANDLE heap = constantBuffer->resourceHeap->GetCPUDescriptorHandleForHeapStart();
-				handle->device->device->CopyDescriptorsSimple(1, cpuComputerBufferHeap, heap, D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV);
-				cpuComputerBufferHeap.ptr += heapSize;
-			}
-		}
-
-		// add texture heaps
-		if (desc->textureCount != 0)
-		{
-			handle->textureCount = desc->textureCount;
-			UINT size = sizeof(Texture*) * handle->textureCount;
-			handle->textures = (Texture**)malloc(size);
-			memcpy(handle->textures, desc->textures, size);
-
-			D3D12_DESCRIPTOR_HEAP_DESC heapDesc = {};
-			heapDesc.NumDescriptors = desc->textureCount;
-			heapDesc.Type = D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV;
-			heapDesc.Flags = D3D12_DESCRIPTOR_HEAP_FLAG_SHADER_VISIBLE;
-			if (FAILED(handle->device->device->CreateDescriptorHeap(&heapDesc, IID_PPV_ARGS(&handle->textureHeap)))) return 0;
-			handle->textureGPUDescHandle = handle->textureHeap->GetGPUDescriptorHandleForHeapStart();
-			D3D12_CPU_DESCRIPTOR_HANDLE cpuTextureHeap = handle->textureHeap->GetCPUDescriptorHandleForHeapStart();
-			UINT heapSize = handle->device->device->GetDescriptorHandleIncrementSize(D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV);
-			for (int i = 0; i != desc->textureCount; ++i)
-			{
-				Texture* texture = (Texture*)desc->textures[i];
-				D3D12_CPU_DESCRIPTOR_HANDLE heap = texture->textureHeap->GetCPUDescriptorHandleForHeapStart();
-				handle->device->device->CopyDescriptorsSimple(1, cpuTextureHeap, heap, D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV);
-				cpuTextureHeap.ptr += heapSize;
-			}
+			if (!BindingSet_InitTables(&handle->bindingSet, shaderEffect, desc->constantBufferCount, desc->constantBuffers, desc->textureCount, desc->textures)) return 0;
 		}
 
 		// topology
@@ -164,40 +121,42 @@ extern "C"
         pipelineDesc.SampleDesc.Count = desc->msaaLevel != 0 ? desc->msaaLevel : 1;
 		pipelineDesc.SampleDesc.Quality = 0;// default MSAA quality
 
-		// create pipeline state
-        if (FAILED(handle->device->device->CreateGraphicsPipelineState(&pipelineDesc, IID_PPV_ARGS(&handle->state)))) return 0;
+		// share pipeline state with identical render states (compiled or loaded from the pipeline library once)
+		const void* signatureBlob;
+		SIZE_T signatureBlobSize;
+		if (!RootSignatureCache_GetBlob(&handle->device->rootSignatureCache, pipelineDesc.pRootSignature, &signatureBlob, &signatureBlobSize)) return 0;
+		std::vector<BYTE> pipelineKey;
+		UINT64 pipelineHash = PipelineCache_HashGraphicsDesc(&pipelineDesc, shaderEffect->effectHash, signatureBlob, signatureBlobSize, &pipelineKey);
+		handle->fallback = (RenderState*)desc->fallback;
+		if (desc->compileAsync && !PipelineCache_FindGraphicsPipeline(&handle->device->pipelineCache, &pipelineDesc, pipelineHash, pipelineKey.data(), pipelineKey.size(), &handle->state))
+		{
+			// return while compiling, command lists bind the fallback until the status is ready
+			PipelineCompiler_Submit(&handle->device->pipelineCompiler, handle, &pipelineDesc, pipelineHash, pipelineKey.data(), pipelineKey.size(), desc->compilePriority);
+			return 1;
+		}
+		if (handle->state == NULL && !PipelineCache_GetGraphicsPipeline(&handle->device->pipelineCache, &pipelineDesc, pipelineHash, pipelineKey.data(), pipelineKey.size(), &handle->state)) return 0;
+		handle->status = RenderStateStatus_Ready;
 		return 1;
 	}
 
-	ORBITAL_EXPORT void Orbital_Video_D3D12_RenderState_Dispose(RenderState* handle)
+	ORBITAL_EXPORT int Orbital_Video_D3D12_RenderState_GetStatus(RenderState* handle)
 	{
-		if (handle->constantBuffers != NULL)
-		{
-			free(handle->constantBuffers);
-			handle->constantBuffers = NULL;
-		}
-
-		if (handle->textures != NULL)
-		{
-			free(handle->textures);
-			handle->textures = NULL;
-		}
+		return handle->status;
+	}
 
-		if (handle->constantBufferHeap != NULL)
-		{
-			handle->constantBufferHeap->Release();
-			handle->constantBufferHeap = NULL;
-		}
+	ORBITAL_EXPORT void Orbital_Video_D3D12_RenderState_SetCompilePriority(RenderState* handle, int priority)
+	{
+		PipelineCompiler_SetPriority(&handle->device->pipelineCompiler, handle, priority);
+	}
 
-		if (handle->textureHeap != NULL)
-		{
-			handle->textureHeap->Release();
-			handle->textureHeap = NULL;
-		}
+	ORBITAL_EXPORT void Orbital_Video_D3D12_RenderState_Dispose(RenderState* handle)
+	{
+		PipelineCompiler_Cancel(&handle->device->pipelineCompiler, handle);
+		BindingSet_DisposeTables(&handle->bindingSet);
 
 		if (handle->state != NULL)
 		{
-			handle->state->Release();
+			Device_DeferRelease(handle->device, handle->state);
 			handle->state = NULL;
 		}
 
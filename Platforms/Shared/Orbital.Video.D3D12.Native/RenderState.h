@@ -1,26 +1,21 @@
 #pragma once
 #include "Device.h"
 #include "ShaderEffect.h"
-#include "ConstantBuffer.h"
-#include "Texture.h"
+#include "BindingSet.h"
 #include "VertexBuffer.h"
 
 struct RenderState
 {
 	Device* device;
-	ID3D12PipelineState* state;
+	ID3D12PipelineState* state;// NULL until compiled if created async
 	ShaderEffect* shaderEffect;
 
-	UINT constantBufferCount;
-	ConstantBuffer** constantBuffers;
-	ID3D12DescriptorHeap* constantBufferHeap;
-	D3D12_GPU_DESCRIPTOR_HANDLE constantBufferGPUDescHandle;
-
-	UINT textureCount;
-	Texture** textures;
-	ID3D12DescriptorHeap* textureHeap;
-	D3D12_GPU_DESCRIPTOR_HANDLE textureGPUDescHandle;
+	// async compilation
+	volatile LONG status;// RenderStateStatus, read without locks when binding
+	RenderState* fallback;// bound instead until ready (draws are skipped if NULL)
+	PipelineCompileJob* compileJob;// guarded by the compiler mutex
 
+	BindingSet bindingSet;// empty if the desc leaves resources to separately bound binding sets
 
 	D3D_PRIMITIVE_TOPOLOGY topology;
 	VertexBuffer* vertexBuffer;
@@ -0,0 +1,207 @@
+#include "ResourceState.h"
+
+#define RESOURCE_STATE_READ_MASK (D3D12_RESOURCE_STATE_GENERIC_READ | D3D12_RESOURCE_STATE_DEPTH_READ)
+#define RESOURCE_STATE_TEXTURE_PROMOTION_MASK (D3D12_RESOURCE_STATE_NON_PIXEL_SHADER_RESOURCE | D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE | D3D12_RESOURCE_STATE_COPY_SOURCE | D3D12_RESOURCE_STATE_COPY_DEST)
+
+bool ResourceState_IsRead(D3D12_RESOURCE_STATES state)
+{
+	return state != D3D12_RESOURCE_STATE_COMMON && (state & ~RESOURCE_STATE_READ_MASK) == 0;
+}
+
+bool ResourceState_CanPromote(ResourceState* handle, D3D12_RESOURCE_STATES state)
+{
+	if (handle->isBuffer) return true;
+	return (state & ~RESOURCE_STATE_TEXTURE_PROMOTION_MASK) == 0;
+}
+
+// queue one barrier per subresource, or a single one if they all transition the same way
+void ResourceState_QueueBarriers(ResourceState* handle, UINT firstSubresource, D3D12_RESOURCE_STATES* statesBefore, D3D12_RESOURCE_STATES* statesAfter, UINT count, BarrierBatch* barrierBatch, bool split)
+{
+	UINT barrierCount = 0;
+	bool uniform = true;
+	for (UINT i = 0; i != count; ++i)
+	{
+		if (statesBefore[i] == statesAfter[i])
+		{
+			uniform = false;
+			continue;
+		}
+		if (statesBefore[i] != statesBefore[0] || statesAfter[i] != statesAfter[0]) uniform = false;
+		++barrierCount;
+	}
+	if (barrierCount == 0) return;
+
+	if (uniform && count == handle->subresourceCount)
+	{
+		if (split) BarrierBatch_BeginTransition(barrierBatch, handle->resource, D3D12_RESOURCE_BARRIER_ALL_SUBRESOURCES, statesBefore[0], statesAfter[0]);
+		else BarrierBatch_Transition(barrierBatch, handle->resource, D3D12_RESOURCE_BARRIER_ALL_SUBRESOURCES, statesBefore[0], statesAfter[0]);
+		return;
+	}
+
+	for (UINT i = 0; i != count; ++i)
+	{
+		if (statesBefore[i] == statesAfter[i]) continue;
+		if (split) BarrierBatch_BeginTransition(barrierBatch, handle->resource, firstSubresource + i, statesBefore[i], statesAfter[i]);
+		else BarrierBatch_Transition(barrierBatch, handle->resource, firstSubresource + i, statesBefore[i], statesAfter[i]);
+	}
+}
+
+void ResourceState_Init(ResourceState* handle, ID3D12Resource* resource, D3D12_RESOURCE_STATES state)
+{
+	D3D12_RESOURCE_DESC desc = resource->GetDesc();
+	handle->resource = resource;
+	handle->isBuffer = desc.Dimension == D3D12_RESOURCE_DIMENSION_BUFFER;
+	handle->subresourceCount = desc.MipLevels;
+	if (desc.Dimension != D3D12_RESOURCE_DIMENSION_TEXTURE3D) handle->subresourceCount *= desc.DepthOrArraySize;
+	if (handle->subresourceCount == 0) handle->subresourceCount = 1;
+	handle->states = (D3D12_RESOURCE_STATES*)calloc(handle->subresourceCount, sizeof(D3D12_RESOURCE_STATES));
+	handle->decays = (bool*)calloc(handle->subresourceCount, sizeof(bool));
+	for (UINT i = 0; i != handle->subresourceCount; ++i) handle->states[i] = state;
+}
+
+void ResourceState_Dispose(ResourceState* handle)
+{
+	if (handle->states != NULL)
+	{
+		free(handle->states);
+		handle->states = NULL;
+	}
+
+	if (handle->decays != NULL)
+	{
+		free(handle->decays);
+		handle->decays = NULL;
+	}
+}
+
+void ResourceState_Retarget(ResourceState* handle, ID3D12Resource* resource)
+{
+	// relocated copy has the same layout and comes off the copy queue in COMMON, lists already tracking this state keep their pointer
+	handle->resource = resource;
+	for (UINT i = 0; i != handle->subresourceCount; ++i)
+	{
+		handle->states[i] = D3D12_RESOURCE_STATE_COMMON;
+		handle->decays[i] = false;
+	}
+}
+
+void ResourceState_Decay(std::vector<ResourceState*>* resources)
+{
+	for (ResourceState* resourceState : *resources)
+	{
+		for (UINT i = 0; i != resourceState->subresourceCount; ++i)
+		{
+			if (!resourceState->decays[i]) continue;
+			resourceState->states[i] = D3D12_RESOURCE_STATE_COMMON;
+			resourceState->decays[i] = false;
+		}
+	}
+	resources->clear();
+}
+
+void ResourceStateTracker_Init(ResourceStateTracker* handle, BarrierBatch* barrierBatch)
+{
+	handle->barrierBatch = barrierBatch;
+	handle->resources = new std::unordered_map<ResourceState*, std::vector<ResourceStateTrackerSubresource>>();
+}
+
+void ResourceStateTracker_Dispose(ResourceStateTracker* handle)
+{
+	if (handle->resources != NULL)
+	{
+		delete handle->resources;
+		handle->resources = NULL;
+	}
+}
+
+void ResourceStateTracker_Reset(ResourceStateTracker* handle)
+{
+	handle->resources->clear();
+}
+
+void ResourceStateTracker_Transition(ResourceStateTracker* handle, ResourceState* resourceState, UINT subresource, D3D12_RESOURCE_STATES state, bool split)
+{
+	std::vector<ResourceStateTrackerSubresource>& subresources = (*handle->resources)[resourceState];
+	if (subresources.size() == 0)
+	{
+		ResourceStateTrackerSubresource unknown = {RESOURCE_STATE_UNKNOWN, RESOURCE_STATE_UNKNOWN, false};
+		subresources.resize(resourceState->subresourceCount, unknown);
+	}
+
+	UINT first = subresource, count = 1;
+	if (subresource == D3D12_RESOURCE_BARRIER_ALL_SUBRESOURCES)
+	{
+		first = 0;
+		count = resourceState->subresourceCount;
+	}
+
+	D3D12_RESOURCE_STATES* statesBefore = (D3D12_RESOURCE_STATES*)alloca(sizeof(D3D12_RESOURCE_STATES) * count);
+	D3D12_RESOURCE_STATES* statesAfter = (D3D12_RESOURCE_STATES*)alloca(sizeof(D3D12_RESOURCE_STATES) * count);
+	for (UINT i = 0; i != count; ++i)
+	{
+		ResourceStateTrackerSubresource* sub = &subresources[first + i];
+		statesBefore[i] = statesAfter[i] = sub->state;
+
+		// first use: no barrier here, global state is resolved when the list is submitted
+		if (sub->state == RESOURCE_STATE_UNKNOWN)
+		{
+			sub->firstState = sub->state = state;
+			continue;
+		}
+
+		if (sub->state == state) continue;
+		if (ResourceState_IsRead(sub->state) && ResourceState_IsRead(state))
+		{
+			// merge read states instead of bouncing between them
+			if ((sub->state & state) == state) continue;
+			if (!sub->transitioned)
+			{
+				sub->firstState |= state;
+				sub->state |= state;
+				continue;
+			}
+			statesAfter[i] = sub->state | state;
+		}
+		else
+		{
+			statesAfter[i] = state;
+		}
+		sub->state = statesAfter[i];
+		sub->transitioned = true;
+	}
+
+	ResourceState_QueueBarriers(resourceState, first, statesBefore, statesAfter, count, handle->barrierBatch, split);
+}
+
+void ResourceStateTracker_Resolve(ResourceStateTracker* handle, BarrierBatch* resolveBarrierBatch, std::vector<ResourceState*>* decayingResources)
+{
+	std::vector<D3D12_RESOURCE_STATES> statesBefore, statesAfter;
+	for (auto& it : *handle->resources)
+	{
+		ResourceState* resourceState = it.first;
+		std::vector<ResourceStateTrackerSubresource>& subresources = it.second;
+		statesBefore.resize(resourceState->subresourceCount);
+		statesAfter.resize(resourceState->subresourceCount);
+		bool decays = false;
+		for (UINT i = 0; i != resourceState->subresourceCount; ++i)
+		{
+			ResourceStateTrackerSubresource* sub = &subresources[i];
+			statesBefore[i] = statesAfter[i] = resourceState->states[i];
+			if (sub->firstState == RESOURCE_STATE_UNKNOWN) continue;
+
+			// implicit promotion out of COMMON needs no barrier
+			bool promoted = false;
+			if (resourceState->states[i] == D3D12_RESOURCE_STATE_COMMON && ResourceState_CanPromote(resourceState, sub->firstState)) promoted = true;
+			else statesAfter[i] = sub->firstState;
+
+			// buffers and textures promoted to read-only states decay back to COMMON after the submission
+			resourceState->states[i] = sub->state;
+			if (resourceState->isBuffer) resourceState->decays[i] = true;
+			else resourceState->decays[i] = promoted && !sub->transitioned && ResourceState_IsRead(sub->state);
+			decays |= resourceState->decays[i];
+		}
+
+		ResourceState_QueueBarriers(resourceState, 0, statesBefore.data(), statesAfter.data(), resourceState->subresourceCount, resolveBarrierBatch, false);
+		if (decays) decayingResources->push_back(resourceState);
+	}
+}
@@ -0,0 +1,42 @@
+#pragma once
+#include "Common.h"
+#include "BarrierBatch.h"
+#include <vector>
+#include <unordered_map>
+
+#define RESOURCE_STATE_UNKNOWN ((D3D12_RESOURCE_STATES)-1)
+
+// state of a resource as the queues see it between submissions
+struct ResourceState
+{
+	ID3D12Resource* resource;
+	bool isBuffer;// buffers promote from COMMON to any state and always decay back
+	UINT subresourceCount;
+	D3D12_RESOURCE_STATES* states;// per subresource (mip + slice * mipLevels)
+	bool* decays;// returns to COMMON once the current submission completes
+};
+
+struct ResourceStateTrackerSubresource
+{
+	D3D12_RESOURCE_STATES firstState;// state the list expects on entry (resolved at submit)
+	D3D12_RESOURCE_STATES state;// state at the current point of the list
+	bool transitioned;// explicit barrier recorded since first use
+};
+
+// command list local view of the resources it touches
+struct ResourceStateTracker
+{
+	BarrierBatch* barrierBatch;
+	std::unordered_map<ResourceState*, std::vector<ResourceStateTrackerSubresource>>* resources;
+};
+
+void ResourceState_Init(ResourceState* handle, ID3D12Resource* resource, D3D12_RESOURCE_STATES state);
+void ResourceState_Dispose(ResourceState* handle);
+void ResourceState_Retarget(ResourceState* handle, ID3D12Resource* resource);
+void ResourceState_Decay(std::vector<ResourceState*>* resources);
+
+void ResourceStateTracker_Init(ResourceStateTracker* handle, BarrierBatch* barrierBatch);
+void ResourceStateTracker_Dispose(ResourceStateTracker* handle);
+void ResourceStateTracker_Reset(ResourceStateTracker* handle);
+void ResourceStateTracker_Transition(ResourceStateTracker* handle, ResourceState* resourceState, UINT subresource, D3D12_RESOURCE_STATES state, bool split);// split: begins now, ends at the next use or BarrierBatch_EndTransitions
+void ResourceStateTracker_Resolve(ResourceStateTracker* handle, BarrierBatch* resolveBarrierBatch, std::vector<ResourceState*>* decayingResources);
@@ -0,0 +1,107 @@
+#include "RootSignatureCache.h"
+#include "Device.h"
+
+void RootSignatureCache_Init(RootSignatureCache* handle, Device* device)
+{
+	handle->device = device;
+	handle->entries = new std::vector<RootSignatureCacheEntry*>();
+	memset(&handle->stats, 0, sizeof(RootSignatureCacheStats));
+	handle->mutex = new std::mutex();
+}
+
+void RootSignatureCache_Dispose(RootSignatureCache* handle)
+{
+	// effects release their signatures before the device is disposed, anything left was leaked
+	if (handle->entries != NULL)
+	{
+		for (RootSignatureCacheEntry* entry : *handle->entries)
+		{
+			entry->signature->Release();
+			free(entry->blob);
+			free(entry);
+		}
+		delete handle->entries;
+		handle->entries = NULL;
+	}
+
+	if (handle->mutex != NULL)
+	{
+		delete handle->mutex;
+		handle->mutex = NULL;
+	}
+}
+
+bool RootSignatureCache_Acquire(RootSignatureCache* handle, UINT nodeIndex, const void* blob, SIZE_T blobSize, ID3D12RootSignature** signature)
+{
+	UINT64 hash = PipelineCache_Hash(PIPELINE_CACHE_HASH_SEED, blob, blobSize);
+	std::lock_guard<std::mutex> lock(*handle->mutex);
+	++handle->stats.requestCount;
+	for (RootSignatureCacheEntry* entry : *handle->entries)
+	{
+		if (entry->hash != hash || entry->nodeIndex != nodeIndex || entry->blobSize != blobSize) continue;
+		if (memcmp(entry->blob, blob, blobSize) != 0) continue;
+		++entry->refCount;
+		++handle->stats.referenceCount;
+		*signature = entry->signature;
+		return true;
+	}
+
+	// create signature for new layout
+	ID3D12RootSignature* newSignature;
+	if (FAILED(handle->device->device->CreateRootSignature(nodeIndex, blob, blobSize, IID_PPV_ARGS(&newSignature)))) return false;
+	RootSignatureCacheEntry* entry = (RootSignatureCacheEntry*)calloc(1, sizeof(RootSignatureCacheEntry));
+	entry->hash = hash;
+	entry->nodeIndex = nodeIndex;
+	entry->blob = (BYTE*)malloc(blobSize);
+	memcpy(entry->blob, blob, blobSize);
+	entry->blobSize = blobSize;
+	entry->signature = newSignature;
+	entry->refCount = 1;
+	handle->entries->push_back(entry);
+	++handle->stats.createCount;
+	++handle->stats.uniqueCount;
+	++handle->stats.referenceCount;
+	*signature = newSignature;
+	return true;
+}
+
+void RootSignatureCache_Release(RootSignatureCache* handle, ID3D12RootSignature* signature)
+{
+	std::lock_guard<std::mutex> lock(*handle->mutex);
+	std::vector<RootSignatureCacheEntry*>* entries = handle->entries;
+	for (size_t i = 0; i != entries->size(); ++i)
+	{
+		RootSignatureCacheEntry* entry = (*entries)[i];
+		if (entry->signature != signature) continue;
+		--handle->stats.referenceCount;
+		if (--entry->refCount != 0) return;
+
+		// last effect using it, in-flight command lists may still reference it
+		Device_DeferRelease(handle->device, entry->signature);
+		free(entry->blob);
+		free(entry);
+		entries->erase(entries->begin() + i);
+		--handle->stats.uniqueCount;
+		return;
+	}
+}
+
+bool RootSignatureCache_GetBlob(RootSignatureCache* handle, ID3D12RootSignature* signature, const void** blob, SIZE_T* blobSize)
+{
+	// blob stays valid while the caller holds a reference to the signature
+	std::lock_guard<std::mutex> lock(*handle->mutex);
+	for (RootSignatureCacheEntry* entry : *handle->entries)
+	{
+		if (entry->signature != signature) continue;
+		*blob = entry->blob;
+		*blobSize = entry->blobSize;
+		return true;
+	}
+	return false;
+}
+
+void RootSignatureCache_GetStats(RootSignatureCache* handle, RootSignatureCacheStats* stats)
+{
+	std::lock_guard<std::mutex> lock(*handle->mutex);
+	*stats = handle->stats;
+}
@@ -0,0 +1,39 @@
+#pragma once
+#include "Common.h"
+#include <mutex>
+#include <vector>
+
+struct Device;
+
+// mirrored in C# (D3D12 Device.RootSignatureCacheStats)
+struct RootSignatureCacheStats
+{
+	UINT64 requestCount, createCount;// every effect asks once per node, only distinct blobs create
+	UINT64 uniqueCount, referenceCount;// live signatures and the effects sharing them
+};
+
+struct RootSignatureCacheEntry
+{
+	UINT64 hash;
+	UINT nodeIndex;
+	BYTE* blob;// serialized desc compared on hash match
+	SIZE_T blobSize;
+	ID3D12RootSignature* signature;
+	UINT refCount;
+};
+
+// effects with identical binding layouts share one signature so switching between them doesn't rebind it
+struct RootSignatureCache
+{
+	Device* device;
+	std::vector<RootSignatureCacheEntry*>* entries;
+	RootSignatureCacheStats stats;
+	std::mutex* mutex;
+};
+
+void RootSignatureCache_Init(RootSignatureCache* handle, Device* device);
+void RootSignatureCache_Dispose(RootSignatureCache* handle);
+bool RootSignatureCache_Acquire(RootSignatureCache* handle, UINT nodeIndex, const void* blob, SIZE_T blobSize, ID3D12RootSignature** signature);
+void RootSignatureCache_Release(RootSignatureCache* handle, ID3D12RootSignature* signature);
+bool RootSignatureCache_GetBlob(RootSignatureCache* handle, ID3D12RootSignature* signature, const void** blob, SIZE_T* blobSize);
+void RootSignatureCache_GetStats(RootSignatureCache* handle, RootSignatureCacheStats* stats);
@@ -15,12 +15,13 @@ extern "C"
 		handle->bytecode.BytecodeLength = bytecodeLength;
 		handle->bytecode.pShaderBytecode = malloc(bytecodeLength);
 		memcpy((void*)handle->bytecode.pShaderBytecode, bytecode, bytecodeLength);
+		handle->bytecodeHash = PipelineCache_Hash(PIPELINE_CACHE_HASH_SEED, bytecode, bytecodeLength);
 		return 1;
 	}
 
 	ORBITAL_EXPORT void Orbital_Video_D3D12_Shader_Dispose(Shader* handle)
 	{
-		if (handle->bytecode.pShaderBytecode != NULL)
+		if (handle->bytecode.pShaderBytecode != NULL && !handle->mappedBytecode)
 		{
 			free((void*)handle->bytecode.pShaderBytecode);
 			handle->bytecode.pShaderBytecode = NULL;
@@ -5,4 +5,8 @@ struct Shader
 {
 	Device* device;
 	D3D12_SHADER_BYTECODE bytecode;
-};
\ No newline at end of file
+	UINT64 bytecodeHash;// content part of pipeline cache keys
+	bool mappedBytecode;// points into a shader pack mapping instead of an owned copy
+};
+
+extern "C" ORBITAL_EXPORT void Orbital_Video_D3D12_Shader_Dispose(Shader* handle);
\ No newline at end of file
@@ -1,4 +1,5 @@
 #include "ShaderEffect.h"
+#include "ShaderPack.h"
 
 extern "C"
 {
@@ -68,7 +69,7 @@ extern "C"
 		return handle;
 	}
 
-	ORBITAL_EXPORT int Orbital_Video_D3D12_ShaderEffect_Init(ShaderEffect* handle, Shader* vs, Shader* ps, Shader* hs, Shader* ds, Shader* gs, ShaderEffectDesc* desc)
+	int ShaderEffect_Init(ShaderEffect* handle, Shader* vs, Shader* ps, Shader* hs, Shader* ds, Shader* gs, ShaderEffectDesc* desc, const ShaderPackEffect* packEffect)
 	{
 		// reference shaders
 		handle->vs = vs;
@@ -109,6 +110,22 @@ extern "C"
 		signatureDesc.Desc_1_1.NumParameters = 0;
 		if (desc->constantBufferCount != 0) ++signatureDesc.Desc_1_1.NumParameters;
 		if (desc->textureCount != 0) ++signatureDesc.Desc_1_1.NumParameters;
+		signatureDesc.Desc_1_1.NumParameters += desc->rootConstantBufferCount + desc->rootShaderResourceCount + desc->rootConstantCount;
+
+		// bindless SRVs need resource binding tier 2, bindless CBVs tier 3
+		if (handle->device->resourceBindingTier >= D3D12_RESOURCE_BINDING_TIER_3) handle->bindlessTableCount = 2;
+		else if (handle->device->resourceBindingTier >= D3D12_RESOURCE_BINDING_TIER_2) handle->bindlessTableCount = 1;
+		signatureDesc.Desc_1_1.NumParameters += handle->bindlessTableCount;
+
+		// root signatures are limited to 64 DWORDs (tables cost 1, root descriptors 2, constants 1 per value)
+		UINT rootSignatureCost = signatureDesc.Desc_1_1.NumParameters - desc->rootConstantBufferCount - desc->rootShaderResourceCount - desc->rootConstantCount;
+		rootSignatureCost += (desc->rootConstantBufferCount + desc->rootShaderResourceCount) * 2;
+		for (int i = 0; i != desc->rootConstantCount; ++i)
+		{
+			if (desc->rootConstants[i].count <= 0) return 0;
+			rootSignatureCost += desc->rootConstants[i].count;
+		}
+		if (rootSignatureCost > D3D12_MAX_ROOT_COST) return 0;
 		signatureDesc.Desc_1_1.pParameters = (D3D12_ROOT_PARAMETER1*)alloca(sizeof(D3D12_ROOT_PARAMETER1) * signatureDesc.Desc_1_1.NumParameters);// PARAMETER1 is the same size as PARAMETER
 
 		int parameterIndex = 0;
@@ -208,19 +225,135 @@ extern "C"
 			++parameterIndex;
 		}
 
-		// serialize desc
+		// root CBVs are bound straight from a GPU address (no descriptor heap)
+		handle->rootConstantBufferParameterIndex = parameterIndex;
+		if (desc->rootConstantBufferCount != 0)
+		{
+			handle->rootConstantBufferCount = desc->rootConstantBufferCount;
+			size_t size = sizeof(ShaderEffectConstantBuffer) * desc->rootConstantBufferCount;
+			handle->rootConstantBuffers = (ShaderEffectConstantBuffer*)malloc(size);
+			memcpy(handle->rootConstantBuffers, desc->rootConstantBuffers, size);
+
+			for (int i = 0; i != desc->rootConstantBufferCount; ++i)
+			{
+				D3D12_ROOT_PARAMETER1 parameter = {};
+				parameter.ParameterType = D3D12_ROOT_PARAMETER_TYPE::D3D12_ROOT_PARAMETER_TYPE_CBV;
+				if (!ResourceUsageToNative(desc->rootConstantBuffers[i].usage, &parameter.ShaderVisibility)) return 0;
+				parameter.Descriptor.ShaderRegister = desc->rootConstantBuffers[i].registerIndex;
+				parameter.Descriptor.RegisterSpace = 0;
+				memcpy((void*)&signatureDesc.Desc_1_1.pParameters[parameterIndex], &parameter, sizeof(D3D12_ROOT_PARAMETER1));
+				++parameterIndex;
+			}
+		}
+
+		// root SRVs can only reference buffers
+		handle->rootShaderResourceParameterIndex = parameterIndex;
+		handle->rootShaderResourceCount = desc->rootShaderResourceCount;
+		for (int i = 0; i != desc->rootShaderResourceCount; ++i)
+		{
+			D3D12_ROOT_PARAMETER1 parameter = {};
+			parameter.ParameterType = D3D12_ROOT_PARAMETER_TYPE::D3D12_ROOT_PARAMETER_TYPE_SRV;
+			if (!ResourceUsageToNative(desc->rootShaderResources[i].usage, &parameter.ShaderVisibility)) return 0;
+			parameter.Descriptor.ShaderRegister = desc->rootShaderResources[i].registerIndex;
+			parameter.Descriptor.RegisterSpace = 0;
+			memcpy((void*)&signatureDesc.Desc_1_1.pParameters[parameterIndex], &parameter, sizeof(D3D12_ROOT_PARAMETER1));
+			++parameterIndex;
+		}
+
+		// 32-bit constants are stored in the root arguments themselves
+		handle->rootConstantParameterIndex = parameterIndex;
+		if (desc->rootConstantCount != 0)
+		{
+			handle->rootConstantCount = desc->rootConstantCount;
+			size_t size = sizeof(ShaderEffectRootConstant) * desc->rootConstantCount;
+			handle->rootConstants = (ShaderEffectRootConstant*)malloc(size);
+			memcpy(handle->rootConstants, desc->rootConstants, size);
+
+			for (int i = 0; i != desc->rootConstantCount; ++i)
+			{
+				D3D12_ROOT_PARAMETER1 parameter = {};
+				parameter.ParameterType = D3D12_ROOT_PARAMETER_TYPE::D3D12_ROOT_PARAMETER_TYPE_32BIT_CONSTANTS;
+				if (!ResourceUsageToNative(desc->rootConstants[i].usage, &parameter.ShaderVisibility)) return 0;
+				parameter.Constants.ShaderRegister = desc->rootConstants[i].registerIndex;
+				parameter.Constants.RegisterSpace = 0;
+				parameter.Constants.Num32BitValues = desc->rootConstants[i].count;
+				memcpy((void*)&signatureDesc.Desc_1_1.pParameters[parameterIndex], &parameter, sizeof(D3D12_ROOT_PARAMETER1));
+				++parameterIndex;
+			}
+		}
+
+		// bindless tables start at the front of the device heap and are indexed with texture / constant buffer bindless indices
+		handle->bindlessParameterIndex = parameterIndex;
+		for (UINT i = 0; i != handle->bindlessTableCount; ++i)
+		{
+			D3D12_DESCRIPTOR_RANGE_TYPE rangeType = i == 0 ? D3D12_DESCRIPTOR_RANGE_TYPE_SRV : D3D12_DESCRIPTOR_RANGE_TYPE_CBV;
+			UINT registerSpace = i == 0 ? DESCRIPTOR_HEAP_BINDLESS_SRV_SPACE : DESCRIPTOR_HEAP_BINDLESS_CBV_SPACE;
+			D3D12_ROOT_PARAMETER1 parameter = {};
+			parameter.ParameterType = D3D12_ROOT_PARAMETER_TYPE::D3D12_ROOT_PARAMETER_TYPE_DESCRIPTOR_TABLE;
+			parameter.ShaderVisibility = D3D12_SHADER_VISIBILITY_ALL;
+			parameter.DescriptorTable.NumDescriptorRanges = 1;
+			if (signatureDesc.Version == D3D_ROOT_SIGNATURE_VERSION::D3D_ROOT_SIGNATURE_VERSION_1_0)
+			{
+				D3D12_DESCRIPTOR_RANGE* range = (D3D12_DESCRIPTOR_RANGE*)alloca(sizeof(D3D12_DESCRIPTOR_RANGE));
+				range->RangeType = rangeType;
+				range->NumDescriptors = UINT_MAX;// unbounded
+				range->BaseShaderRegister = 0;
+				range->RegisterSpace = registerSpace;
+				range->OffsetInDescriptorsFromTableStart = 0;
+				parameter.DescriptorTable.pDescriptorRanges = (D3D12_DESCRIPTOR_RANGE1*)range;
+			}
+			else
+			{
+				D3D12_DESCRIPTOR_RANGE1* range = (D3D12_DESCRIPTOR_RANGE1*)alloca(sizeof(D3D12_DESCRIPTOR_RANGE1));
+				range->RangeType = rangeType;
+				range->NumDescriptors = UINT_MAX;// unbounded
+				range->BaseShaderRegister = 0;
+				range->RegisterSpace = registerSpace;
+				range->Flags = D3D12_DESCRIPTOR_RANGE_FLAG_DESCRIPTORS_VOLATILE | D3D12_DESCRIPTOR_RANGE_FLAG_DATA_VOLATILE;// slots are reused and rewritten while bound
+				range->OffsetInDescriptorsFromTableStart = 0;
+				parameter.DescriptorTable.pDescriptorRanges = range;
+			}
+			memcpy((void*)&signatureDesc.Desc_1_1.pParameters[parameterIndex], &parameter, sizeof(D3D12_ROOT_PARAMETER1));
+			++parameterIndex;
+		}
+
+		// serialize desc (shader packs carry it precomputed if built for the same version and bindless tables)
 		ID3DBlob* serializedDesc = NULL;
 		ID3DBlob* error = NULL;
-		if (FAILED(D3D12SerializeVersionedRootSignature(&signatureDesc, &serializedDesc, &error))) goto FAIL_EXIT;
+		const void* signatureData = NULL;
+		SIZE_T signatureSize = 0;
+		if (packEffect != NULL && packEffect->rootSignatureVersion == (UINT)signatureDesc.Version && packEffect->rootSignatureBindlessTableCount == handle->bindlessTableCount)
+		{
+			if (ShaderPack_GetRange(handle->pack, &packEffect->rootSignature, &signatureData)) signatureSize = (SIZE_T)packEffect->rootSignature.size;
+		}
+		if (signatureData == NULL)
+		{
+			if (FAILED(D3D12SerializeVersionedRootSignature(&signatureDesc, &serializedDesc, &error))) goto FAIL_EXIT;
+			signatureData = serializedDesc->GetBufferPointer();
+			signatureSize = serializedDesc->GetBufferSize();
+		}
 
 		// create signature per physical GPU node
 		handle->signatureCount = 1;//handle->device->nodeCount// TODO: handle multi-gpu
 		handle->signatures = (ID3D12RootSignature**)calloc(handle->signatureCount, sizeof(ID3D12RootSignature*));
 		for (UINT i = 0; i != handle->signatureCount; ++i)
 		{
-			 if (FAILED(handle->device->device->CreateRootSignature(i, serializedDesc->GetBufferPointer(), serializedDesc->GetBufferSize(), IID_PPV_ARGS(&handle->signatures[i])))) goto FAIL_EXIT;
+			// shared with effects of the same binding layout
+			if (!RootSignatureCache_Acquire(&handle->device->rootSignatureCache, i, signatureData, signatureSize, &handle->signatures[i])) goto FAIL_EXIT;
 		}
 
+		// hash content render states share pipelines by (starts from the blob hash the root signature cache keys on)
+		handle->effectHash = PipelineCache_Hash(PIPELINE_CACHE_HASH_SEED, signatureData, signatureSize);
+		{
+			Shader* stages[5] = { handle->vs, handle->ps, handle->hs, handle->ds, handle->gs };
+			for (UINT i = 0; i != 5; ++i)
+			{
+				UINT64 stageHash = stages[i] != NULL ? stages[i]->bytecodeHash : 0;
+				handle->effectHash = PipelineCache_Hash(handle->effectHash, &stageHash, sizeof(UINT64));
+			}
+		}
+		if (serializedDesc != NULL) serializedDesc->Release();
+
 		// return success
 		return 1;
 
@@ -235,6 +368,85 @@ extern "C"
 		return 0;
 	}
 
+	ORBITAL_EXPORT int Orbital_Video_D3D12_ShaderEffect_Init(ShaderEffect* handle, Shader* vs, Shader* ps, Shader* hs, Shader* ds, Shader* gs, ShaderEffectDesc* desc)
+	{
+		return ShaderEffect_Init(handle, vs, ps, hs, ds, gs, desc, NULL);
+	}
+
+	ORBITAL_EXPORT int Orbital_Video_D3D12_ShaderEffect_InitFromPack(ShaderEffect* handle, ShaderPack* pack, int effectIndex, ShaderEffectSamplerAnisotropy anisotropyOverride)
+	{
+		if (pack->effects == NULL || effectIndex < 0 || (UINT)effectIndex >= pack->header->effectCount) return 0;
+		const ShaderPackEffect* effect = &pack->effects[effectIndex];
+		handle->pack = pack;
+		ShaderPack_AddRef(pack);
+
+		// shaders use bytecode in place, pages are read when the driver compiles pipelines
+		Shader* stages[SHADER_PACK_STAGE_COUNT] = {};
+		bool stagesValid = true;
+		for (UINT i = 0; i != SHADER_PACK_STAGE_COUNT; ++i)
+		{
+			const ShaderPackRange* range = &effect->bytecode[ShaderPackBytecode_DXIL][i];
+			if (range->size == 0) continue;
+			const void* bytecode;
+			if (!ShaderPack_GetRange(pack, range, &bytecode))
+			{
+				stagesValid = false;
+				break;
+			}
+			Shader* shader = (Shader*)calloc(1, sizeof(Shader));
+			shader->device = handle->device;
+			shader->bytecode.pShaderBytecode = bytecode;
+			shader->bytecode.BytecodeLength = (SIZE_T)range->size;
+			shader->bytecodeHash = PipelineCache_Hash(PIPELINE_CACHE_HASH_SEED, bytecode, (size_t)range->size);
+			shader->mappedBytecode = true;
+			stages[i] = shader;
+		}
+		handle->vs = stages[ShaderType_VS];
+		handle->ps = stages[ShaderType_PS];
+		handle->hs = stages[ShaderType_HS];
+		handle->ds = stages[ShaderType_DS];
+		handle->gs = stages[ShaderType_GS];
+		if (!stagesValid) return 0;
+
+		// desc arrays are read in place too (Init copies what it keeps)
+		ShaderEffectDesc desc = {};
+		desc.constantBufferCount = effect->constantBufferCount;
+		desc.textureCount = effect->textureCount;
+		desc.samplersCount = effect->samplersCount;
+		desc.rootConstantBufferCount = effect->rootConstantBufferCount;
+		desc.rootShaderResourceCount = effect->rootShaderResourceCount;
+		desc.rootConstantCount = effect->rootConstantCount;
+		if (!ShaderPack_GetArray(pack, effect->constantBuffersOffset, effect->constantBufferCount, sizeof(ShaderEffectConstantBuffer), (const void**)&desc.constantBuffers)) return 0;
+		if (!ShaderPack_GetArray(pack, effect->texturesOffset, effect->textureCount, sizeof(ShaderEffectTexture), (const void**)&desc.textures)) return 0;
+		if (!ShaderPack_GetArray(pack, effect->samplersOffset, effect->samplersCount, sizeof(ShaderEffectSampler), (const void**)&desc.samplers)) return 0;
+		if (!ShaderPack_GetArray(pack, effect->rootConstantBuffersOffset, effect->rootConstantBufferCount, sizeof(ShaderEffectConstantBuffer), (const void**)&desc.rootConstantBuffers)) return 0;
+		if (!ShaderPack_GetArray(pack, effect->rootShaderResourcesOffset, effect->rootShaderResourceCount, sizeof(ShaderEffectRootShaderResource), (const void**)&desc.rootShaderResources)) return 0;
+		if (!ShaderPack_GetArray(pack, effect->rootConstantsOffset, effect->rootConstantCount, sizeof(ShaderEffectRootConstant), (const void**)&desc.rootConstants)) return 0;
+
+		// samplers are static in the root signature, so an override can't use the precomputed one
+		if (anisotropyOverride != ShaderEffectSamplerAnisotropy_Default && desc.samplersCount != 0)
+		{
+			ShaderEffectSampler* samplers = (ShaderEffectSampler*)alloca(sizeof(ShaderEffectSampler) * desc.samplersCount);
+			memcpy(samplers, desc.samplers, sizeof(ShaderEffectSampler) * desc.samplersCount);
+			for (int i = 0; i != desc.samplersCount; ++i) samplers[i].anisotropy = anisotropyOverride;
+			desc.samplers = samplers;
+			return ShaderEffect_Init(handle, handle->vs, handle->ps, handle->hs, handle->ds, handle->gs, &desc, NULL);
+		}
+		return ShaderEffect_Init(handle, handle->vs, handle->ps, handle->hs, handle->ds, handle->gs, &desc, effect);
+	}
+
+	ORBITAL_EXPORT UINT64 Orbital_Video_D3D12_ShaderEffect_GetSerializedRootSignature(ShaderEffect* handle, void* data, UINT64 size, UINT* version, UINT* bindlessTableCount)
+	{
+		// signature bytes for shader pack builders, returns required size
+		const void* blob;
+		SIZE_T blobSize;
+		if (handle->signatures == NULL || !RootSignatureCache_GetBlob(&handle->device->rootSignatureCache, handle->signatures[0], &blob, &blobSize)) return 0;
+		if (data != NULL && size >= blobSize) memcpy(data, blob, blobSize);
+		*version = (UINT)handle->device->maxRootSignatureVersion;
+		*bindlessTableCount = handle->bindlessTableCount;
+		return blobSize;
+	}
+
 	ORBITAL_EXPORT void Orbital_Video_D3D12_ShaderEffect_Dispose(ShaderEffect* handle)
 	{
 		if (handle->constantBuffers != NULL)
@@ -249,13 +461,25 @@ extern "C"
 			handle->textures = NULL;
 		}
 
+		if (handle->rootConstantBuffers != NULL)
+		{
+			free(handle->rootConstantBuffers);
+			handle->rootConstantBuffers = NULL;
+		}
+
+		if (handle->rootConstants != NULL)
+		{
+			free(handle->rootConstants);
+			handle->rootConstants = NULL;
+		}
+
 		if (handle->signatures != NULL)
 		{
 			for (UINT i = 0; i != handle->signatureCount; ++i)
 			{
 				if (handle->signatures[i] != NULL)
 				{
-					handle->signatures[i]->Release();
+					RootSignatureCache_Release(&handle->device->rootSignatureCache, handle->signatures[i]);
 					handle->signatures[i] = NULL;
 				}
 			}
@@ -263,6 +487,18 @@ extern "C"
 			handle->signatures = NULL;
 		}
 
+		// shaders of pack effects are owned by the effect
+		if (handle->pack != NULL)
+		{
+			Shader* stages[SHADER_PACK_STAGE_COUNT] = { handle->vs, handle->ps, handle->hs, handle->ds, handle->gs };
+			for (UINT i = 0; i != SHADER_PACK_STAGE_COUNT; ++i)
+			{
+				if (stages[i] != NULL) Orbital_Video_D3D12_Shader_Dispose(stages[i]);
+			}
+			ShaderPack_Release(handle->pack);
+			handle->pack = NULL;
+		}
+
 		free(handle);
 	}
 }
\ No newline at end of file
@@ -1,17 +1,31 @@
 #pragma once
 #include "Shader.h"
 
+struct ShaderPack;
+
 struct ShaderEffect
 {
 	Device* device;
 	Shader *vs, *ps, *hs, *ds, *gs;
+	ShaderPack* pack;// referenced while the shaders point into its mapping, they are then owned by the effect
 
 	UINT signatureCount;
 	ID3D12RootSignature** signatures;// signature per GPU node
+	UINT64 effectHash;// serialized signature and shader bytecode, shared by pipeline cache keys
 
 	UINT constantBufferCount;
 	ShaderEffectConstantBuffer* constantBuffers;
 
 	UINT textureCount;
 	ShaderEffectTexture* textures;
+
+	// root arguments follow the descriptor tables (CBVs, SRVs then 32-bit constants)
+	UINT rootConstantBufferCount, rootConstantBufferParameterIndex;
+	ShaderEffectConstantBuffer* rootConstantBuffers;
+	UINT rootShaderResourceCount, rootShaderResourceParameterIndex;
+	UINT rootConstantCount, rootConstantParameterIndex;
+	ShaderEffectRootConstant* rootConstants;
+
+	// unbounded tables over the device heap (SRVs then CBVs, count depends on the resource binding tier)
+	UINT bindlessTableCount, bindlessParameterIndex;
 };
\ No newline at end of file
@@ -0,0 +1,132 @@
+#include "ShaderPack.h"
+
+UINT64 ShaderPack_HashName(const wchar_t* name, UINT nameLength)
+{
+	return PipelineCache_Hash(PIPELINE_CACHE_HASH_SEED, name, sizeof(wchar_t) * nameLength);
+}
+
+bool ShaderPack_GetRange(ShaderPack* handle, const ShaderPackRange* range, const void** data)
+{
+	// corrupt or truncated packs must not read outside the mapping
+	if (range->size == 0 || range->offset > handle->size || range->size > handle->size - range->offset) return false;
+	*data = handle->data + range->offset;
+	return true;
+}
+
+bool ShaderPack_GetArray(ShaderPack* handle, UINT64 offset, int count, size_t elementSize, const void** data)
+{
+	*data = NULL;
+	if (count < 0) return false;
+	if (count == 0) return true;
+	ShaderPackRange range;
+	range.offset = offset;
+	range.size = (UINT64)count * elementSize;
+	return ShaderPack_GetRange(handle, &range, data);
+}
+
+void ShaderPack_AddRef(ShaderPack* handle)
+{
+	InterlockedIncrement(&handle->refCount);
+}
+
+void ShaderPack_Release(ShaderPack* handle)
+{
+	if (InterlockedDecrement(&handle->refCount) != 0) return;
+	if (handle->data != NULL)
+	{
+		UnmapViewOfFile(handle->data);
+		handle->data = NULL;
+	}
+
+	if (handle->mapping != NULL)
+	{
+		CloseHandle(handle->mapping);
+		handle->mapping = NULL;
+	}
+
+	if (handle->file != INVALID_HANDLE_VALUE)
+	{
+		CloseHandle(handle->file);
+		handle->file = INVALID_HANDLE_VALUE;
+	}
+
+	free(handle);
+}
+
+extern "C"
+{
+	ORBITAL_EXPORT ShaderPack* Orbital_Video_D3D12_ShaderPack_Create(Device* device)
+	{
+		ShaderPack* handle = (ShaderPack*)calloc(1, sizeof(ShaderPack));
+		handle->device = device;
+		handle->file = INVALID_HANDLE_VALUE;
+		handle->refCount = 1;
+		return handle;
+	}
+
+	ORBITAL_EXPORT int Orbital_Video_D3D12_ShaderPack_Init(ShaderPack* handle, const wchar_t* filename)
+	{
+		// map whole file, pages are only read once an effect touches them
+		handle->file = CreateFileW(filename, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_RANDOM_ACCESS, NULL);
+		if (handle->file == INVALID_HANDLE_VALUE) return 0;
+		LARGE_INTEGER fileSize;
+		if (!GetFileSizeEx(handle->file, &fileSize) || fileSize.QuadPart < (LONGLONG)sizeof(ShaderPackHeader)) return 0;
+		handle->size = (UINT64)fileSize.QuadPart;
+		handle->mapping = CreateFileMappingW(handle->file, NULL, PAGE_READONLY, 0, 0, NULL);
+		if (handle->mapping == NULL) return 0;
+		handle->data = (const BYTE*)MapViewOfFile(handle->mapping, FILE_MAP_READ, 0, 0, 0);
+		if (handle->data == NULL) return 0;
+
+		// validate header and effect table
+		handle->header = (const ShaderPackHeader*)handle->data;
+		if (handle->header->magic != SHADER_PACK_MAGIC || handle->header->version != SHADER_PACK_VERSION) return 0;
+		const void* effects;
+		if (!ShaderPack_GetArray(handle, handle->header->effectsOffset, handle->header->effectCount, sizeof(ShaderPackEffect), &effects)) return 0;
+		handle->effects = (const ShaderPackEffect*)effects;
+		return 1;
+	}
+
+	ORBITAL_EXPORT int Orbital_Video_D3D12_ShaderPack_GetEffectCount(ShaderPack* handle)
+	{
+		return handle->effects != NULL ? handle->header->effectCount : 0;
+	}
+
+	ORBITAL_EXPORT int Orbital_Video_D3D12_ShaderPack_FindEffect(ShaderPack* handle, const wchar_t* name, int nameLength, UINT64 variantHash)
+	{
+		if (handle->effects == NULL) return -1;
+
+		// first entry with the hash, then compare names of entries sharing it (permutations of one effect are adjacent)
+		UINT64 hash = ShaderPack_HashName(name, nameLength);
+		UINT first = 0, last = handle->header->effectCount;
+		while (first != last)
+		{
+			UINT middle = first + ((last - first) / 2);
+			if (handle->effects[middle].nameHash < hash) first = middle + 1;
+			else last = middle;
+		}
+
+		for (UINT i = first; i != handle->header->effectCount && handle->effects[i].nameHash == hash; ++i)
+		{
+			const void* effectName;
+			if (handle->effects[i].variantHash != variantHash) continue;
+			if (handle->effects[i].name.size != sizeof(wchar_t) * nameLength) continue;
+			if (!ShaderPack_GetRange(handle, &handle->effects[i].name, &effectName)) continue;
+			if (memcmp(effectName, name, sizeof(wchar_t) * nameLength) == 0) return i;
+		}
+		return -1;
+	}
+
+	ORBITAL_EXPORT int Orbital_Video_D3D12_ShaderPack_GetEffectResourceCounts(ShaderPack* handle, int effectIndex, int* constantBufferCount, int* textureCount)
+	{
+		if (handle->effects == NULL || effectIndex < 0 || (UINT)effectIndex >= handle->header->effectCount) return 0;
+		*constantBufferCount = handle->effects[effectIndex].constantBufferCount;
+		*textureCount = handle->effects[effectIndex].textureCount;
+		return 1;
+	}
+
+	ORBITAL_EXPORT void Orbital_Video_D3D12_ShaderPack_Dispose(ShaderPack* handle)
+	{
+		// mapping stays alive until effects loaded from it are disposed
+		ShaderPack_Release(handle);
+	}
+}
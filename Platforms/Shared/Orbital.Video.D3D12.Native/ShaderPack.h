@@ -0,0 +1,20 @@
+#pragma once
+#include "Device.h"
+
+// read only mapping of a shader pack file, effects are loaded from it on demand
+struct ShaderPack
+{
+	Device* device;
+	HANDLE file, mapping;
+	const BYTE* data;
+	UINT64 size;
+	const ShaderPackHeader* header;
+	const ShaderPackEffect* effects;
+	volatile LONG refCount;// pack handle plus every effect whose shaders point into the mapping
+};
+
+UINT64 ShaderPack_HashName(const wchar_t* name, UINT nameLength);
+bool ShaderPack_GetRange(ShaderPack* handle, const ShaderPackRange* range, const void** data);
+bool ShaderPack_GetArray(ShaderPack* handle, UINT64 offset, int count, size_t elementSize, const void** data);
+void ShaderPack_AddRef(ShaderPack* handle);
+void ShaderPack_Release(ShaderPack* handle);
@@ -52,11 +52,13 @@ extern "C"
 		D3D12_CPU_DESCRIPTOR_HANDLE renderTargetDescHandle = handle->renderTargetViewHeap->GetCPUDescriptorHandleForHeapStart();
 		handle->renderTargetDescHandles = (D3D12_CPU_DESCRIPTOR_HANDLE*)calloc(bufferCount, sizeof(D3D12_CPU_DESCRIPTOR_HANDLE));
 		handle->renderTargetViews = (ID3D12Resource**)calloc(bufferCount, sizeof(ID3D12Resource*));
+		handle->renderTargetStates = (ResourceState*)calloc(bufferCount, sizeof(ResourceState));
 		for (UINT i = 0; i != bufferCount; ++i)
         {
             if (FAILED(handle->swapChain->GetBuffer(i, IID_PPV_ARGS(&handle->renderTargetViews[i])))) return 0;
             handle->device->device->CreateRenderTargetView(handle->renderTargetViews[i], nullptr, renderTargetDescHandle);
 			handle->renderTargetDescHandles[i] = renderTargetDescHandle;
+			ResourceState_Init(&handle->renderTargetStates[i], handle->renderTargetViews[i], D3D12_RESOURCE_STATE_PRESENT);
             renderTargetDescHandle.ptr += renderTargetViewHeapSize;
         }
 
@@ -71,6 +73,13 @@ extern "C"
 			handle->renderTargetDescHandles = NULL;
 		}
 
+		if (handle->renderTargetStates != NULL)
+		{
+			for (UINT i = 0; i != handle->bufferCount; ++i) ResourceState_Dispose(&handle->renderTargetStates[i]);
+			free(handle->renderTargetStates);
+			handle->renderTargetStates = NULL;
+		}
+
 		if (handle->renderTargetViews != NULL)
 		{
 			for (UINT i = 0; i != handle->bufferCount; ++i)
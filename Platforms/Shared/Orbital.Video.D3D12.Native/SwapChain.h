@@ -9,5 +9,6 @@ struct SwapChain
 	ID3D12DescriptorHeap* renderTargetViewHeap;
 	D3D12_CPU_DESCRIPTOR_HANDLE* renderTargetDescHandles;
 	ID3D12Resource** renderTargetViews;
+	ResourceState* renderTargetStates;// per buffer, PRESENT between frames
 	DXGI_FORMAT renderTargetFormat;
 };
\ No newline at end of file
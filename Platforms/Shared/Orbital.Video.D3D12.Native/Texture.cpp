@@ -1,5 +1,31 @@
 #include "Texture.h"
 
+void Texture_WriteBindlessDescriptor(Texture* handle)
+{
+	// copy the CPU view into the shader visible slot
+	D3D12_CPU_DESCRIPTOR_HANDLE slot = DescriptorHeap_GetCPUHandle(&handle->device->resourceDescriptorHeap, handle->bindlessDescriptor.index);
+	handle->device->device->CopyDescriptorsSimple(1, slot, handle->textureHeap->GetCPUDescriptorHandleForHeapStart(), D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV);
+}
+
+void Texture_Relocate(void* owner, ID3D12Resource* resource, HeapAllocation* allocation)
+{
+	// old copy may still be read by frames in flight
+	Texture* handle = (Texture*)owner;
+	HeapAllocation oldAllocation = handle->allocation;
+	Device_DeferRelease(handle->device, handle->texture);
+	Device_DeferFree(handle->device, &oldAllocation);
+
+	handle->texture = resource;
+	handle->allocation = *allocation;
+	handle->device->device->CreateShaderResourceView(resource, &handle->srvDesc, handle->textureHeap->GetCPUDescriptorHandleForHeapStart());// CPU only heap, render states copy it when created
+
+	// frames in flight may still read the old slot, so the view goes into a new one (rewritten in place only if the heap is full)
+	DescriptorAllocation oldDescriptor = handle->bindlessDescriptor;
+	if (DescriptorHeap_AllocateSlot(&handle->device->resourceDescriptorHeap, &handle->bindlessDescriptor)) Device_DeferFreeDescriptors(handle->device, &oldDescriptor);
+	Texture_WriteBindlessDescriptor(handle);
+	ResourceState_Retarget(&handle->resourceState, resource);
+}
+
 extern "C"
 {
 	bool TextureFormatToNative(TextureFormat format, DXGI_FORMAT* nativeFormat)
@@ -46,15 +72,11 @@ extern "C"
 		if (!TextureFormatToNative(format, &handle->format)) return 0;
 
 		// create resource
-		D3D12_HEAP_PROPERTIES heapProperties = {};
-		if (handle->mode == TextureMode_GPUOptimized) heapProperties.Type = D3D12_HEAP_TYPE_DEFAULT;
-		else if (handle->mode == TextureMode_Write) heapProperties.Type = D3D12_HEAP_TYPE_UPLOAD;
-		else if (handle->mode == TextureMode_Read) heapProperties.Type = D3D12_HEAP_TYPE_READBACK;
+		D3D12_HEAP_TYPE heapType;
+		if (handle->mode == TextureMode_GPUOptimized) heapType = D3D12_HEAP_TYPE_DEFAULT;
+		else if (handle->mode == TextureMode_Write) heapType = D3D12_HEAP_TYPE_UPLOAD;
+		else if (handle->mode == TextureMode_Read) heapType = D3D12_HEAP_TYPE_READBACK;
 		else return 0;
-        heapProperties.CPUPageProperty = D3D12_CPU_PAGE_PROPERTY_UNKNOWN;
-        heapProperties.MemoryPoolPreference = D3D12_MEMORY_POOL_UNKNOWN;
-        heapProperties.CreationNodeMask = 1;// TODO: multi-gpu setup
-        heapProperties.VisibleNodeMask = 1;
 
 		D3D12_RESOURCE_DESC resourceDesc = {};
 		if (type == TextureType::TextureType_1D) resourceDesc.Dimension = D3D12_RESOURCE_DIMENSION_TEXTURE1D;
@@ -73,11 +95,11 @@ extern "C"
         resourceDesc.Layout = D3D12_TEXTURE_LAYOUT_UNKNOWN;
         resourceDesc.Flags = D3D12_RESOURCE_FLAG_NONE;
 
-		handle->resourceState = D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE;
-		if (data != NULL && handle->mode == TextureMode_GPUOptimized) handle->resourceState = D3D12_RESOURCE_STATE_COPY_DEST;// init for gpu copy
-		else if (handle->mode == TextureMode_Read) handle->resourceState = D3D12_RESOURCE_STATE_COPY_DEST;// init for CPU read
-		else if (handle->mode == TextureMode_Write) handle->resourceState = D3D12_RESOURCE_STATE_GENERIC_READ;// init for frequent cpu writes
-		if (FAILED(handle->device->device->CreateCommittedResource(&heapProperties, D3D12_HEAP_FLAG_NONE, &resourceDesc, handle->resourceState, NULL, IID_PPV_ARGS(&handle->texture)))) return 0;
+		D3D12_RESOURCE_STATES initialState = D3D12_RESOURCE_STATE_COMMON;// first read is an implicit promotion (no barrier)
+		if (handle->mode == TextureMode_Read) initialState = D3D12_RESOURCE_STATE_COPY_DEST;// init for CPU read
+		else if (handle->mode == TextureMode_Write) initialState = D3D12_RESOURCE_STATE_GENERIC_READ;// init for frequent cpu writes
+		if (!HeapAllocator_CreateResource(&handle->device->heapAllocator, heapType, &resourceDesc, initialState, &handle->texture, &handle->allocation)) return 0;
+		ResourceState_Init(&handle->resourceState, handle->texture, initialState);
 
 		// create resource heap
 		D3D12_DESCRIPTOR_HEAP_DESC heapDesc = {};
@@ -88,7 +110,7 @@ extern "C"
 		handle->textureHeapHandle = handle->textureHeap->GetGPUDescriptorHandleForHeapStart();
 
 		// create resource view
-		D3D12_SHADER_RESOURCE_VIEW_DESC srvDesc = {};
+		D3D12_SHADER_RESOURCE_VIEW_DESC& srvDesc = handle->srvDesc;
 		srvDesc.Shader4ComponentMapping = D3D12_DEFAULT_SHADER_4_COMPONENT_MAPPING;
 		srvDesc.Format = handle->format;
 		if (type == TextureType::TextureType_1D) srvDesc.ViewDimension = D3D12_SRV_DIMENSION_TEXTURE1D;
@@ -98,101 +120,37 @@ extern "C"
 		else return 0;
 		srvDesc.Texture2D.MipLevels = mipLevels;
 		handle->device->device->CreateShaderResourceView(handle->texture, &srvDesc, handle->textureHeap->GetCPUDescriptorHandleForHeapStart());
+		if (!DescriptorHeap_AllocateSlot(&handle->device->resourceDescriptorHeap, &handle->bindlessDescriptor)) return 0;
+		Texture_WriteBindlessDescriptor(handle);
+		if (heapType == D3D12_HEAP_TYPE_DEFAULT) HeapAllocator_SetRelocatable(&handle->device->heapAllocator, &handle->allocation, handle, Texture_Relocate, handle->texture, &handle->resourceState);
 
 		// upload initial data
 		if (data != NULL)
 		{
-			// allocate gpu upload buffer if needed
-			bool useUploadBuffer = false;
-			ID3D12Resource* uploadResource = handle->texture;
-			if (heapProperties.Type != D3D12_HEAP_TYPE_UPLOAD)
-			{
-				useUploadBuffer = true;
-				uploadResource = NULL;
-				heapProperties.Type = D3D12_HEAP_TYPE_UPLOAD;
-
-				UINT64 uploadBufferSize;
-				handle->device->device->GetCopyableFootprints(&resourceDesc, 0, mipLevels, 0, nullptr, nullptr, nullptr, &uploadBufferSize);
-
-				ZeroMemory(&resourceDesc, sizeof(D3D12_RESOURCE_DESC));
-				resourceDesc.Dimension = D3D12_RESOURCE_DIMENSION_BUFFER;
-				resourceDesc.Alignment = 0;
-				resourceDesc.Width = uploadBufferSize;
-				resourceDesc.Height = 1;
-				resourceDesc.DepthOrArraySize = 1;
-				resourceDesc.MipLevels = 1;
-				resourceDesc.Format = DXGI_FORMAT_UNKNOWN;
-				resourceDesc.SampleDesc.Count = 1;
-				resourceDesc.SampleDesc.Quality = 0;
-				resourceDesc.Layout = D3D12_TEXTURE_LAYOUT_ROW_MAJOR;
-				resourceDesc.Flags = D3D12_RESOURCE_FLAG_NONE;
-
-				if (FAILED(handle->device->device->CreateCommittedResource(&heapProperties, D3D12_HEAP_FLAG_NONE, &resourceDesc, D3D12_RESOURCE_STATE_GENERIC_READ, NULL, IID_PPV_ARGS(&uploadResource)))) return 0;
-			}
-
-			// copy CPU memory to GPU
-			UINT8* gpuDataPtr;
-			D3D12_RANGE readRange = {};
-			for (UINT i = 0; i != mipLevels; ++i)
-			{
-				if (FAILED(uploadResource->Map(i, &readRange, reinterpret_cast<void**>(&gpuDataPtr))))
-				{
-					if (useUploadBuffer) uploadResource->Release();
-					return 0;
-				}
-			
-				UINT srcPitch = width[i] * TextureFormatSizePerPixel(handle->format);
-				const UINT32 alignment = D3D12_TEXTURE_DATA_PITCH_ALIGNMENT - 1;
-				UINT dstPitch = (srcPitch + alignment) & ~alignment;// row size is required to be aligned
-				for (UINT y = 0; y != height[i]; ++y)
-				{
-					memcpy(gpuDataPtr + (dstPitch * y), data[i] + (srcPitch * y), srcPitch);// copy texture row
-				}
-
-				uploadResource->Unmap(i, nullptr);
-			}
-
-			// copy upload buffer to default buffer
-			if (useUploadBuffer)
+			if (heapType == D3D12_HEAP_TYPE_UPLOAD)
 			{
-				handle->device->internalMutex->lock();
-				// reset command list and copy resource
-				handle->device->internalCommandList->Reset(handle->device->commandAllocator, NULL);
-
-				// copy all mip levels
+				// copy CPU memory to GPU
+				UINT8* gpuDataPtr;
+				D3D12_RANGE readRange = {};
 				for (UINT i = 0; i != mipLevels; ++i)
 				{
-					D3D12_TEXTURE_COPY_LOCATION dstLoc = {};
-					D3D12_TEXTURE_COPY_LOCATION srcLoc = {};
-					dstLoc.pResource = handle->texture;
-					srcLoc.pResource = uploadResource;
-					dstLoc.SubresourceIndex = i;
-					srcLoc.SubresourceIndex = i;
-					dstLoc.Type = D3D12_TEXTURE_COPY_TYPE_SUBRESOURCE_INDEX;
-					srcLoc.Type = D3D12_TEXTURE_COPY_TYPE_PLACED_FOOTPRINT;
-
-					srcLoc.PlacedFootprint.Footprint.Width = width[i];
-					srcLoc.PlacedFootprint.Footprint.Height = height[i];
-					srcLoc.PlacedFootprint.Footprint.Depth = depth[i];
-					srcLoc.PlacedFootprint.Footprint.Format = handle->format;
-					UINT32 size = width[i] * TextureFormatSizePerPixel(handle->format);
+					if (FAILED(handle->texture->Map(i, &readRange, reinterpret_cast<void**>(&gpuDataPtr)))) return 0;
+				
+					UINT srcPitch = width[i] * TextureFormatSizePerPixel(handle->format);
 					const UINT32 alignment = D3D12_TEXTURE_DATA_PITCH_ALIGNMENT - 1;
-					srcLoc.PlacedFootprint.Footprint.RowPitch = (size + alignment) & ~alignment;// row size is required to be aligned
+					UINT dstPitch = (srcPitch + alignment) & ~alignment;// row size is required to be aligned
+					for (UINT y = 0; y != height[i]; ++y)
+					{
+						memcpy(gpuDataPtr + (dstPitch * y), data[i] + (srcPitch * y), srcPitch);// copy texture row
+					}
 
-					handle->device->internalCommandList->CopyTextureRegion(&dstLoc, 0, 0, 0, &srcLoc, nullptr);
+					handle->texture->Unmap(i, nullptr);
 				}
-
-				// close command list
-				handle->device->internalCommandList->Close();
-
-				// execute operations
-				ID3D12CommandList* commandLists[1] = { handle->device->internalCommandList };
-				handle->device->commandQueue->ExecuteCommandLists(1, commandLists);
-				WaitForFence(handle->device, handle->device->internalFence, handle->device->internalFenceEvent, handle->device->internalFenceValue);
-
-				// release temp resource
-				uploadResource->Release();
-				handle->device->internalMutex->unlock();
+			}
+			else
+			{
+				// copy all mip levels on copy queue (doesn't wait for GPU, direct queue waits on it before next submit)
+				if (UploadEngine_UploadTexture(&handle->device->uploadEngine, handle->texture, mipLevels, data) == 0) return 0;
 			}
 		}
 
@@ -201,6 +159,7 @@ extern "C"
 
 	ORBITAL_EXPORT void Orbital_Video_D3D12_Texture_Dispose(Texture* handle)
 	{
+		Device_DeferFreeDescriptors(handle->device, &handle->bindlessDescriptor);
 		if (handle->textureHeap != NULL)
 		{
 			handle->textureHeap->Release();
@@ -209,25 +168,24 @@ extern "C"
 
 		if (handle->texture != NULL)
 		{
-			handle->texture->Release();
+			Device_DeferRelease(handle->device, handle->texture);
+			Device_DeferFree(handle->device, &handle->allocation);
 			handle->texture = NULL;
 		}
 
+		ResourceState_Dispose(&handle->resourceState);
 		free(handle);
 	}
+
+	ORBITAL_EXPORT UINT Orbital_Video_D3D12_Texture_GetBindlessIndex(Texture* handle)
+	{
+		if (handle->bindlessDescriptor.heap == NULL) return DESCRIPTOR_HEAP_INVALID_INDEX;
+		return handle->bindlessDescriptor.index;
+	}
 }
 
-void Orbital_Video_D3D12_Texture_ChangeState(Texture* handle, D3D12_RESOURCE_STATES state, ID3D12GraphicsCommandList5* commandList)
+void Orbital_Video_D3D12_Texture_ChangeState(Texture* handle, D3D12_RESOURCE_STATES state, ResourceStateTracker* stateTracker, bool split)
 {
-	if (handle->resourceState == state) return;
 	if (handle->mode == TextureMode_Read || handle->mode == TextureMode_Write) return;
-	D3D12_RESOURCE_BARRIER barrier = {};
-	barrier.Type = D3D12_RESOURCE_BARRIER_TYPE::D3D12_RESOURCE_BARRIER_TYPE_TRANSITION;
-	barrier.Flags = D3D12_RESOURCE_BARRIER_FLAGS::D3D12_RESOURCE_BARRIER_FLAG_NONE;
-	barrier.Transition.pResource = handle->texture;
-	barrier.Transition.StateBefore = handle->resourceState;
-	barrier.Transition.StateAfter = state;
-	barrier.Transition.Subresource = D3D12_RESOURCE_BARRIER_ALL_SUBRESOURCES;
-	commandList->ResourceBarrier(1, &barrier);
-	handle->resourceState = state;
+	ResourceStateTracker_Transition(stateTracker, &handle->resourceState, D3D12_RESOURCE_BARRIER_ALL_SUBRESOURCES, state, split);
 }
\ No newline at end of file
@@ -1,15 +1,19 @@
 #pragma once
 #include "Device.h"
+#include "ResourceState.h"
 
 struct Texture
 {
 	Device* device;
 	TextureMode mode;
 	ID3D12Resource* texture;
+	HeapAllocation allocation;
 	ID3D12DescriptorHeap* textureHeap;
 	D3D12_GPU_DESCRIPTOR_HANDLE textureHeapHandle;
+	D3D12_SHADER_RESOURCE_VIEW_DESC srvDesc;// kept to recreate the view when relocated
+	DescriptorAllocation bindlessDescriptor;// slot in the device heap (Texture2D[] in space 1), moves if the texture is relocated
 	DXGI_FORMAT format;
-	D3D12_RESOURCE_STATES resourceState;
+	ResourceState resourceState;
 };
 
-void Orbital_Video_D3D12_Texture_ChangeState(Texture* handle, D3D12_RESOURCE_STATES state, ID3D12GraphicsCommandList5* commandList);
\ No newline at end of file
+void Orbital_Video_D3D12_Texture_ChangeState(Texture* handle, D3D12_RESOURCE_STATES state, ResourceStateTracker* stateTracker, bool split);
\ No newline at end of file
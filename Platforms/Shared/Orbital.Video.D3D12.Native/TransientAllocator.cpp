@@ -0,0 +1,104 @@
+#include "TransientAllocator.h"
+#include "Device.h"
+
+TransientPage* TransientAllocator_CreatePage(TransientAllocator* handle, UINT64 size)
+{
+	TransientPage* page = (TransientPage*)calloc(1, sizeof(TransientPage));
+	page->size = size;
+
+	D3D12_RESOURCE_DESC resourceDesc = {};
+	resourceDesc.Dimension = D3D12_RESOURCE_DIMENSION_BUFFER;
+	resourceDesc.Width = size;
+	resourceDesc.Height = 1;
+	resourceDesc.DepthOrArraySize = 1;
+	resourceDesc.MipLevels = 1;
+	resourceDesc.Format = DXGI_FORMAT_UNKNOWN;
+	resourceDesc.SampleDesc.Count = 1;
+	resourceDesc.Layout = D3D12_TEXTURE_LAYOUT_ROW_MAJOR;
+	resourceDesc.Flags = D3D12_RESOURCE_FLAG_NONE;
+	if (!HeapAllocator_CreateResource(&handle->device->heapAllocator, D3D12_HEAP_TYPE_UPLOAD, &resourceDesc, D3D12_RESOURCE_STATE_GENERIC_READ, &page->resource, &page->allocation))
+	{
+		free(page);
+		return NULL;
+	}
+
+	// stays mapped for the lifetime of the page
+	D3D12_RANGE readRange = {};
+	if (FAILED(page->resource->Map(0, &readRange, reinterpret_cast<void**>(&page->data))))
+	{
+		page->resource->Release();
+		HeapAllocator_Free(&handle->device->heapAllocator, &page->allocation);
+		free(page);
+		return NULL;
+	}
+	page->gpuAddress = page->resource->GetGPUVirtualAddress();
+	return page;
+}
+
+void TransientAllocator_DisposePage(TransientAllocator* handle, TransientPage* page)
+{
+	page->resource->Unmap(0, nullptr);
+	page->resource->Release();
+	HeapAllocator_Free(&handle->device->heapAllocator, &page->allocation);
+	free(page);
+}
+
+void TransientAllocator_Init(TransientAllocator* handle, Device* device)
+{
+	handle->device = device;
+	handle->freePages = new std::vector<TransientPage*>();
+	handle->mutex = new std::mutex();
+}
+
+void TransientAllocator_Dispose(TransientAllocator* handle)
+{
+	// frames return their pages before the allocator is disposed
+	if (handle->freePages != NULL)
+	{
+		for (TransientPage* page : *handle->freePages) TransientAllocator_DisposePage(handle, page);
+		delete handle->freePages;
+		handle->freePages = NULL;
+	}
+
+	if (handle->mutex != NULL)
+	{
+		delete handle->mutex;
+		handle->mutex = NULL;
+	}
+}
+
+TransientPage* TransientAllocator_AcquirePage(TransientAllocator* handle, UINT64 minSize, std::vector<TransientPage*>* framePages)
+{
+	std::lock_guard<std::mutex> lock(*handle->mutex);
+
+	// oversized requests get a page of their own that isn't recycled
+	TransientPage* page;
+	if (minSize > TRANSIENT_ALLOCATOR_PAGE_SIZE)
+	{
+		page = TransientAllocator_CreatePage(handle, minSize);
+	}
+	else if (!handle->freePages->empty())
+	{
+		page = handle->freePages->back();
+		handle->freePages->pop_back();
+	}
+	else
+	{
+		page = TransientAllocator_CreatePage(handle, TRANSIENT_ALLOCATOR_PAGE_SIZE);
+	}
+
+	// frame owns the page until its fence completes
+	if (page != NULL) framePages->push_back(page);
+	return page;
+}
+
+void TransientAllocator_ReleasePages(TransientAllocator* handle, std::vector<TransientPage*>* framePages)
+{
+	std::lock_guard<std::mutex> lock(*handle->mutex);
+	for (TransientPage* page : *framePages)
+	{
+		if (page->size == TRANSIENT_ALLOCATOR_PAGE_SIZE) handle->freePages->push_back(page);
+		else TransientAllocator_DisposePage(handle, page);
+	}
+	framePages->clear();
+}
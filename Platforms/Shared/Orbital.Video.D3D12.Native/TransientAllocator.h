@@ -0,0 +1,32 @@
+#pragma once
+#include "Common.h"
+#include "HeapAllocator.h"
+#include <mutex>
+#include <vector>
+
+#define TRANSIENT_ALLOCATOR_PAGE_SIZE (1024 * 1024)
+#define TRANSIENT_ALLOCATOR_ALIGNMENT D3D12_CONSTANT_BUFFER_DATA_PLACEMENT_ALIGNMENT// allocations are bindable as root CBVs
+
+struct Device;
+
+// persistently mapped upload buffer command lists bump allocate from, owned by one frame at a time
+struct TransientPage
+{
+	ID3D12Resource* resource;
+	HeapAllocation allocation;
+	UINT8* data;
+	D3D12_GPU_VIRTUAL_ADDRESS gpuAddress;
+	UINT64 size;
+};
+
+struct TransientAllocator
+{
+	Device* device;
+	std::vector<TransientPage*>* freePages;// pages of completed frames
+	std::mutex* mutex;
+};
+
+void TransientAllocator_Init(TransientAllocator* handle, Device* device);
+void TransientAllocator_Dispose(TransientAllocator* handle);
+TransientPage* TransientAllocator_AcquirePage(TransientAllocator* handle, UINT64 minSize, std::vector<TransientPage*>* framePages);
+void TransientAllocator_ReleasePages(TransientAllocator* handle, std::vector<TransientPage*>* framePages);
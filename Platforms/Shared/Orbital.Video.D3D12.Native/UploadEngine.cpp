@@ -0,0 +1,337 @@
+#include "UploadEngine.h"
+#include "Device.h"
+
+UINT64 UploadEngine_Flush_Locked(UploadEngine* handle)
+{
+	if (!handle->commandListOpen) return handle->fenceValue;
+
+	// submit batch to copy queue
+	handle->commandList->Close();
+	ID3D12CommandList* commandLists[1] = { handle->commandList };
+	handle->copyQueue->ExecuteCommandLists(1, commandLists);
+	++handle->fenceValue;
+	handle->copyQueue->Signal(handle->fence, handle->fenceValue);
+
+	// allocator can be reused once this batch completes
+	handle->commandAllocatorFenceValues[handle->commandAllocatorIndex] = handle->fenceValue;
+	handle->commandAllocatorIndex = (handle->commandAllocatorIndex + 1) % UPLOAD_ENGINE_ALLOCATOR_COUNT;
+	handle->commandListOpen = false;
+	return handle->fenceValue;
+}
+
+void UploadEngine_OpenCommandList(UploadEngine* handle)
+{
+	if (handle->commandListOpen) return;
+	ID3D12CommandAllocator* commandAllocator = handle->commandAllocators[handle->commandAllocatorIndex];
+	WaitForFenceValue(handle->fence, handle->fenceEvent, handle->commandAllocatorFenceValues[handle->commandAllocatorIndex]);
+	commandAllocator->Reset();
+	handle->commandList->Reset(commandAllocator, NULL);
+	handle->commandListOpen = true;
+}
+
+void UploadEngine_ReclaimStaging(UploadEngine* handle)
+{
+	UINT64 completedValue = handle->fence->GetCompletedValue();
+	while (!handle->stagingRegions->empty() && handle->stagingRegions->front().fenceValue <= completedValue)
+	{
+		UploadStagingRegion& region = handle->stagingRegions->front();
+		if (region.dedicatedResource != NULL)
+		{
+			region.dedicatedResource->Release();
+			HeapAllocator_Free(&handle->device->heapAllocator, &region.dedicatedAllocation);
+		}
+		else handle->stagingTail = region.end;
+		handle->stagingRegions->pop_front();
+	}
+
+	// reset ring when empty to avoid needless wrapping
+	if (handle->stagingHead == handle->stagingTail)
+	{
+		handle->stagingHead = 0;
+		handle->stagingTail = 0;
+	}
+}
+
+bool UploadEngine_AllocateStaging(UploadEngine* handle, UINT64 size, UINT64 alignment, ID3D12Resource** resource, UINT64* offset, UINT8** data)
+{
+	// uploads larger than half the ring get their own buffer which is released once the batch completes
+	if (size > UPLOAD_ENGINE_STAGING_SIZE / 2)
+	{
+		D3D12_RESOURCE_DESC resourceDesc = {};
+		resourceDesc.Dimension = D3D12_RESOURCE_DIMENSION_BUFFER;
+		resourceDesc.Width = size;
+		resourceDesc.Height = 1;
+		resourceDesc.DepthOrArraySize = 1;
+		resourceDesc.MipLevels = 1;
+		resourceDesc.Format = DXGI_FORMAT_UNKNOWN;
+		resourceDesc.SampleDesc.Count = 1;
+		resourceDesc.Layout = D3D12_TEXTURE_LAYOUT_ROW_MAJOR;
+		resourceDesc.Flags = D3D12_RESOURCE_FLAG_NONE;
+
+		ID3D12Resource* dedicatedResource = NULL;
+		HeapAllocation dedicatedAllocation;
+		if (!HeapAllocator_CreateResource(&handle->device->heapAllocator, D3D12_HEAP_TYPE_UPLOAD, &resourceDesc, D3D12_RESOURCE_STATE_GENERIC_READ, &dedicatedResource, &dedicatedAllocation)) return false;
+		D3D12_RANGE readRange = {};
+		if (FAILED(dedicatedResource->Map(0, &readRange, reinterpret_cast<void**>(data))))
+		{
+			dedicatedResource->Release();
+			HeapAllocator_Free(&handle->device->heapAllocator, &dedicatedAllocation);
+			return false;
+		}
+
+		UploadStagingRegion region = {};
+		region.fenceValue = handle->fenceValue + 1;
+		region.dedicatedResource = dedicatedResource;
+		region.dedicatedAllocation = dedicatedAllocation;
+		handle->stagingRegions->push_back(region);
+
+		*resource = dedicatedResource;
+		*offset = 0;
+		return true;
+	}
+
+	for (;;)
+	{
+		UploadEngine_ReclaimStaging(handle);
+
+		// find space in ring
+		UINT64 alignedHead = (handle->stagingHead + (alignment - 1)) & ~(alignment - 1);
+		bool found = false;
+		if (handle->stagingHead >= handle->stagingTail)
+		{
+			if (alignedHead + size <= UPLOAD_ENGINE_STAGING_SIZE) found = true;
+			else if (size < handle->stagingTail)// wrap around
+			{
+				alignedHead = 0;
+				found = true;
+			}
+		}
+		else if (alignedHead + size < handle->stagingTail)
+		{
+			found = true;
+		}
+
+		if (found)
+		{
+			UploadStagingRegion region = {};
+			region.end = alignedHead + size;
+			region.fenceValue = handle->fenceValue + 1;
+			handle->stagingRegions->push_back(region);
+			handle->stagingHead = region.end;
+
+			*resource = handle->stagingResource;
+			*offset = alignedHead;
+			*data = handle->stagingData + alignedHead;
+			return true;
+		}
+
+		// ring is full: submit pending copies and wait for the oldest region
+		if (handle->stagingRegions->empty()) return false;
+		UploadEngine_Flush_Locked(handle);
+		WaitForFenceValue(handle->fence, handle->fenceEvent, handle->stagingRegions->front().fenceValue);
+	}
+}
+
+int UploadEngine_Init(UploadEngine* handle, Device* device)
+{
+	handle->device = device;
+	handle->mutex = new std::mutex();
+	handle->stagingRegions = new std::deque<UploadStagingRegion>();
+
+	// create copy queue
+	D3D12_COMMAND_QUEUE_DESC queueDesc = {};
+	queueDesc.Flags = D3D12_COMMAND_QUEUE_FLAG_NONE;
+	queueDesc.Type = D3D12_COMMAND_LIST_TYPE_COPY;
+	if (FAILED(device->device->CreateCommandQueue(&queueDesc, IID_PPV_ARGS(&handle->copyQueue)))) return 0;
+
+	// create fence
+	if (FAILED(device->device->CreateFence(0, D3D12_FENCE_FLAG_NONE, IID_PPV_ARGS(&handle->fence)))) return 0;
+	handle->fenceEvent = CreateEvent(nullptr, FALSE, FALSE, nullptr);
+	if (handle->fenceEvent == NULL) return 0;
+
+	// create command allocators and list
+	for (UINT i = 0; i != UPLOAD_ENGINE_ALLOCATOR_COUNT; ++i)
+	{
+		if (FAILED(device->device->CreateCommandAllocator(D3D12_COMMAND_LIST_TYPE_COPY, IID_PPV_ARGS(&handle->commandAllocators[i])))) return 0;
+	}
+	if (FAILED(device->device->CreateCommandList(0, D3D12_COMMAND_LIST_TYPE_COPY, handle->commandAllocators[0], nullptr, IID_PPV_ARGS(&handle->commandList)))) return 0;
+	if (FAILED(handle->commandList->Close())) return 0;// make sure this is closed as it defaults to open for writing
+
+	// create persistently mapped staging ring
+	D3D12_HEAP_PROPERTIES heapProperties = {};
+	heapProperties.Type = D3D12_HEAP_TYPE_UPLOAD;
+	heapProperties.CPUPageProperty = D3D12_CPU_PAGE_PROPERTY_UNKNOWN;
+	heapProperties.MemoryPoolPreference = D3D12_MEMORY_POOL_UNKNOWN;
+	heapProperties.CreationNodeMask = 1;// TODO: multi-gpu setup
+	heapProperties.VisibleNodeMask = 1;
+
+	D3D12_RESOURCE_DESC resourceDesc = {};
+	resourceDesc.Dimension = D3D12_RESOURCE_DIMENSION_BUFFER;
+	resourceDesc.Width = UPLOAD_ENGINE_STAGING_SIZE;
+	resourceDesc.Height = 1;
+	resourceDesc.DepthOrArraySize = 1;
+	resourceDesc.MipLevels = 1;
+	resourceDesc.Format = DXGI_FORMAT_UNKNOWN;
+	resourceDesc.SampleDesc.Count = 1;
+	resourceDesc.Layout = D3D12_TEXTURE_LAYOUT_ROW_MAJOR;
+	resourceDesc.Flags = D3D12_RESOURCE_FLAG_NONE;
+	if (FAILED(device->device->CreateCommittedResource(&heapProperties, D3D12_HEAP_FLAG_NONE, &resourceDesc, D3D12_RESOURCE_STATE_GENERIC_READ, NULL, IID_PPV_ARGS(&handle->stagingResource)))) return 0;
+
+	D3D12_RANGE readRange = {};
+	if (FAILED(handle->stagingResource->Map(0, &readRange, reinterpret_cast<void**>(&handle->stagingData)))) return 0;
+
+	return 1;
+}
+
+void UploadEngine_Dispose(UploadEngine* handle)
+{
+	// finish pending copies
+	if (handle->fence != NULL && handle->fenceEvent != NULL)
+	{
+		if (handle->copyQueue != NULL && handle->commandList != NULL) UploadEngine_Flush_Locked(handle);
+		WaitForFenceValue(handle->fence, handle->fenceEvent, handle->fenceValue);
+	}
+
+	if (handle->stagingRegions != NULL)
+	{
+		for (UploadStagingRegion& region : *handle->stagingRegions)
+		{
+			if (region.dedicatedResource != NULL)
+			{
+				region.dedicatedResource->Release();
+				HeapAllocator_Free(&handle->device->heapAllocator, &region.dedicatedAllocation);
+			}
+		}
+		delete handle->stagingRegions;
+		handle->stagingRegions = NULL;
+	}
+
+	if (handle->stagingResource != NULL)
+	{
+		handle->stagingResource->Release();
+		handle->stagingResource = NULL;
+		handle->stagingData = NULL;
+	}
+
+	if (handle->commandList != NULL)
+	{
+		handle->commandList->Release();
+		handle->commandList = NULL;
+	}
+
+	for (UINT i = 0; i != UPLOAD_ENGINE_ALLOCATOR_COUNT; ++i)
+	{
+		if (handle->commandAllocators[i] != NULL)
+		{
+			handle->commandAllocators[i]->Release();
+			handle->commandAllocators[i] = NULL;
+		}
+	}
+
+	if (handle->fenceEvent != NULL)
+	{
+		CloseHandle(handle->fenceEvent);
+		handle->fenceEvent = NULL;
+	}
+
+	if (handle->fence != NULL)
+	{
+		handle->fence->Release();
+		handle->fence = NULL;
+	}
+
+	if (handle->copyQueue != NULL)
+	{
+		handle->copyQueue->Release();
+		handle->copyQueue = NULL;
+	}
+
+	if (handle->mutex != NULL)
+	{
+		delete handle->mutex;
+		handle->mutex = NULL;
+	}
+}
+
+UINT64 UploadEngine_UploadBuffer(UploadEngine* handle, ID3D12Resource* resource, UINT64 dstOffset, void* data, UINT64 dataSize)
+{
+	std::lock_guard<std::mutex> lock(*handle->mutex);
+
+	// copy CPU memory to staging
+	ID3D12Resource* stagingResource;
+	UINT64 stagingOffset;
+	UINT8* stagingData;
+	if (!UploadEngine_AllocateStaging(handle, dataSize, 16, &stagingResource, &stagingOffset, &stagingData)) return 0;
+	memcpy(stagingData, data, dataSize);
+
+	// record copy into current batch
+	UploadEngine_OpenCommandList(handle);
+	handle->commandList->CopyBufferRegion(resource, dstOffset, stagingResource, stagingOffset, dataSize);
+	return handle->fenceValue + 1;
+}
+
+UINT64 UploadEngine_UploadTexture(UploadEngine* handle, ID3D12Resource* resource, UINT32 subresourceCount, BYTE** data)
+{
+	std::lock_guard<std::mutex> lock(*handle->mutex);
+
+	// get staging layout
+	D3D12_RESOURCE_DESC resourceDesc = resource->GetDesc();
+	D3D12_PLACED_SUBRESOURCE_FOOTPRINT* footprints = (D3D12_PLACED_SUBRESOURCE_FOOTPRINT*)alloca(sizeof(D3D12_PLACED_SUBRESOURCE_FOOTPRINT) * subresourceCount);
+	UINT* rowCounts = (UINT*)alloca(sizeof(UINT) * subresourceCount);
+	UINT64* rowSizes = (UINT64*)alloca(sizeof(UINT64) * subresourceCount);
+	UINT64 stagingSize;
+	handle->device->device->GetCopyableFootprints(&resourceDesc, 0, subresourceCount, 0, footprints, rowCounts, rowSizes, &stagingSize);
+
+	// copy CPU memory to staging (source rows are tightly packed)
+	ID3D12Resource* stagingResource;
+	UINT64 stagingOffset;
+	UINT8* stagingData;
+	if (!UploadEngine_AllocateStaging(handle, stagingSize, D3D12_TEXTURE_DATA_PLACEMENT_ALIGNMENT, &stagingResource, &stagingOffset, &stagingData)) return 0;
+	for (UINT32 i = 0; i != subresourceCount; ++i)
+	{
+		D3D12_PLACED_SUBRESOURCE_FOOTPRINT footprint = footprints[i];
+		UINT rowCount = rowCounts[i] * footprint.Footprint.Depth;
+		for (UINT y = 0; y != rowCount; ++y)
+		{
+			memcpy(stagingData + footprint.Offset + (footprint.Footprint.RowPitch * y), data[i] + (rowSizes[i] * y), rowSizes[i]);// copy texture row
+		}
+	}
+
+	// record copies into current batch
+	UploadEngine_OpenCommandList(handle);
+	for (UINT32 i = 0; i != subresourceCount; ++i)
+	{
+		D3D12_TEXTURE_COPY_LOCATION dstLoc = {};
+		dstLoc.pResource = resource;
+		dstLoc.Type = D3D12_TEXTURE_COPY_TYPE_SUBRESOURCE_INDEX;
+		dstLoc.SubresourceIndex = i;
+
+		D3D12_TEXTURE_COPY_LOCATION srcLoc = {};
+		srcLoc.pResource = stagingResource;
+		srcLoc.Type = D3D12_TEXTURE_COPY_TYPE_PLACED_FOOTPRINT;
+		srcLoc.PlacedFootprint = footprints[i];
+		srcLoc.PlacedFootprint.Offset += stagingOffset;
+
+		handle->commandList->CopyTextureRegion(&dstLoc, 0, 0, 0, &srcLoc, nullptr);
+	}
+	return handle->fenceValue + 1;
+}
+
+UINT64 UploadEngine_Flush(UploadEngine* handle)
+{
+	std::lock_guard<std::mutex> lock(*handle->mutex);
+	return UploadEngine_Flush_Locked(handle);
+}
+
+void UploadEngine_QueueWait(UploadEngine* handle, ID3D12CommandQueue* queue, UINT64& queueWaitFenceValue)
+{
+	std::lock_guard<std::mutex> lock(*handle->mutex);
+
+	// submit pending copies and make the queue wait on them GPU-side
+	UploadEngine_Flush_Locked(handle);
+	if (handle->fenceValue > queueWaitFenceValue)
+	{
+		queue->Wait(handle->fence, handle->fenceValue);
+		queueWaitFenceValue = handle->fenceValue;
+	}
+}
\ No newline at end of file
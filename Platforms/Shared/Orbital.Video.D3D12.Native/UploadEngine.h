@@ -0,0 +1,49 @@
+#pragma once
+#include "Common.h"
+#include "HeapAllocator.h"
+#include <mutex>
+#include <deque>
+
+#define UPLOAD_ENGINE_STAGING_SIZE (64 * 1024 * 1024)
+#define UPLOAD_ENGINE_ALLOCATOR_COUNT 4
+
+struct Device;
+
+struct UploadStagingRegion
+{
+	UINT64 end;// ring offset freed once the region completes
+	UINT64 fenceValue;
+	ID3D12Resource* dedicatedResource;// set for uploads too large for the ring
+	HeapAllocation dedicatedAllocation;
+};
+
+struct UploadEngine
+{
+	Device* device;
+	ID3D12CommandQueue* copyQueue;
+	ID3D12Fence* fence;
+	HANDLE fenceEvent;
+	UINT64 fenceValue;// last submitted batch
+
+	// persistently mapped staging ring
+	ID3D12Resource* stagingResource;
+	UINT8* stagingData;
+	UINT64 stagingHead, stagingTail;
+	std::deque<UploadStagingRegion>* stagingRegions;
+
+	// batch being recorded
+	ID3D12CommandAllocator* commandAllocators[UPLOAD_ENGINE_ALLOCATOR_COUNT];
+	UINT64 commandAllocatorFenceValues[UPLOAD_ENGINE_ALLOCATOR_COUNT];
+	UINT commandAllocatorIndex;
+	ID3D12GraphicsCommandList* commandList;
+	bool commandListOpen;
+
+	std::mutex* mutex;
+};
+
+int UploadEngine_Init(UploadEngine* handle, Device* device);
+void UploadEngine_Dispose(UploadEngine* handle);
+UINT64 UploadEngine_UploadBuffer(UploadEngine* handle, ID3D12Resource* resource, UINT64 dstOffset, void* data, UINT64 dataSize);
+UINT64 UploadEngine_UploadTexture(UploadEngine* handle, ID3D12Resource* resource, UINT32 subresourceCount, BYTE** data);
+UINT64 UploadEngine_Flush(UploadEngine* handle);
+void UploadEngine_QueueWait(UploadEngine* handle, ID3D12CommandQueue* queue, UINT64& queueWaitFenceValue);
\ No newline at end of file
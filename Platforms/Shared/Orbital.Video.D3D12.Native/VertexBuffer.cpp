@@ -1,5 +1,19 @@
 #include "VertexBuffer.h"
 
+void VertexBuffer_Relocate(void* owner, ID3D12Resource* resource, HeapAllocation* allocation)
+{
+	// old copy may still be read by frames in flight
+	VertexBuffer* handle = (VertexBuffer*)owner;
+	HeapAllocation oldAllocation = handle->allocation;
+	Device_DeferRelease(handle->device, handle->vertexBuffer);
+	Device_DeferFree(handle->device, &oldAllocation);
+
+	handle->vertexBuffer = resource;
+	handle->allocation = *allocation;
+	handle->vertexBufferView.BufferLocation = resource->GetGPUVirtualAddress();
+	ResourceState_Retarget(&handle->resourceState, resource);
+}
+
 extern "C"
 {
 	ORBITAL_EXPORT VertexBuffer* Orbital_Video_D3D12_VertexBuffer_Create(Device* device, VertexBufferMode mode)
@@ -15,13 +29,9 @@ extern "C"
 		uint64_t bufferSize = vertexSize * vertexCount;
 
 		// create buffer
-		D3D12_HEAP_PROPERTIES heapProperties = {};
-		if (handle->mode == VertexBufferMode_GPUOptimized) heapProperties.Type = D3D12_HEAP_TYPE_DEFAULT;
+		D3D12_HEAP_TYPE heapType;
+		if (handle->mode == VertexBufferMode_GPUOptimized) heapType = D3D12_HEAP_TYPE_DEFAULT;
 		else return 0;
-        heapProperties.CPUPageProperty = D3D12_CPU_PAGE_PROPERTY_UNKNOWN;
-        heapProperties.MemoryPoolPreference = D3D12_MEMORY_POOL_UNKNOWN;
-        heapProperties.CreationNodeMask = 1;// TODO: multi-gpu setup
-        heapProperties.VisibleNodeMask = 1;
 
 		D3D12_RESOURCE_DESC resourceDesc = {};
 		resourceDesc.Dimension = D3D12_RESOURCE_DIMENSION_BUFFER;
@@ -36,54 +46,26 @@ extern "C"
 		resourceDesc.Layout = D3D12_TEXTURE_LAYOUT_ROW_MAJOR;
 		resourceDesc.Flags = D3D12_RESOURCE_FLAG_NONE;
 
-		handle->resourceState = D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE;
-		if (vertices != NULL && handle->mode == VertexBufferMode_GPUOptimized) handle->resourceState = D3D12_RESOURCE_STATE_COPY_DEST;// init for gpu copy
-		if (FAILED(handle->device->device->CreateCommittedResource(&heapProperties, D3D12_HEAP_FLAG_NONE, &resourceDesc, handle->resourceState, nullptr, IID_PPV_ARGS(&handle->vertexBuffer)))) return 0;
+		D3D12_RESOURCE_STATES initialState = D3D12_RESOURCE_STATE_COMMON;// buffers are promoted on first use and decay back after each submission
+		if (!HeapAllocator_CreateResource(&handle->device->heapAllocator, heapType, &resourceDesc, initialState, &handle->vertexBuffer, &handle->allocation)) return 0;
+		ResourceState_Init(&handle->resourceState, handle->vertexBuffer, initialState);
 
 		// upload cpu buffer to gpu
 		if (vertices != NULL)
 		{
-			// allocate gpu upload buffer if needed
-			bool useUploadBuffer = false;
-			ID3D12Resource* uploadResource = handle->vertexBuffer;
-			if (heapProperties.Type != D3D12_HEAP_TYPE_UPLOAD)
+			if (heapType == D3D12_HEAP_TYPE_UPLOAD)
 			{
-				useUploadBuffer = true;
-				uploadResource = NULL;
-				heapProperties.Type = D3D12_HEAP_TYPE_UPLOAD;
-				if (FAILED(handle->device->device->CreateCommittedResource(&heapProperties, D3D12_HEAP_FLAG_NONE, &resourceDesc, D3D12_RESOURCE_STATE_GENERIC_READ, NULL, IID_PPV_ARGS(&uploadResource)))) return 0;
+				// copy CPU memory to GPU
+				UINT8* gpuDataPtr;
+				D3D12_RANGE readRange = {};
+				if (FAILED(handle->vertexBuffer->Map(0, &readRange, reinterpret_cast<void**>(&gpuDataPtr)))) return 0;
+				memcpy(gpuDataPtr, vertices, bufferSize);
+				handle->vertexBuffer->Unmap(0, nullptr);
 			}
-
-			// copy CPU memory to GPU
-			UINT8* gpuDataPtr;
-			D3D12_RANGE readRange = {};
-			if (FAILED(uploadResource->Map(0, &readRange, reinterpret_cast<void**>(&gpuDataPtr))))
-			{
-				if (useUploadBuffer) uploadResource->Release();
-				return 0;
-			}
-			memcpy(gpuDataPtr, vertices, bufferSize);
-			uploadResource->Unmap(0, nullptr);
-
-			// copy upload buffer to default buffer
-			if (useUploadBuffer)
+			else
 			{
-				handle->device->internalMutex->lock();
-				// reset command list and copy resource
-				handle->device->internalCommandList->Reset(handle->device->commandAllocator, NULL);
-				handle->device->internalCommandList->CopyResource(handle->vertexBuffer, uploadResource);
-
-				// close command list
-				handle->device->internalCommandList->Close();
-
-				// execute operations
-				ID3D12CommandList* commandLists[1] = { handle->device->internalCommandList };
-				handle->device->commandQueue->ExecuteCommandLists(1, commandLists);
-				WaitForFence(handle->device, handle->device->internalFence, handle->device->internalFenceEvent, handle->device->internalFenceValue);
-
-				// release temp resource
-				uploadResource->Release();
-				handle->device->internalMutex->unlock();
+				// copy on copy queue (doesn't wait for GPU, direct queue waits on it before next submit)
+				if (UploadEngine_UploadBuffer(&handle->device->uploadEngine, handle->vertexBuffer, 0, vertices, bufferSize) == 0) return 0;
 			}
 		}
 
@@ -91,6 +73,7 @@ extern "C"
 		handle->vertexBufferView.BufferLocation = handle->vertexBuffer->GetGPUVirtualAddress();
         handle->vertexBufferView.StrideInBytes = vertexSize;
         handle->vertexBufferView.SizeInBytes = bufferSize;
+		HeapAllocator_SetRelocatable(&handle->device->heapAllocator, &handle->allocation, handle, VertexBuffer_Relocate, handle->vertexBuffer, &handle->resourceState);
 
 		// vertex buffer layout
 		handle->elementCount = layout->elementCount;
@@ -145,24 +128,17 @@ extern "C"
 
 		if (handle->vertexBuffer != NULL)
 		{
-			handle->vertexBuffer->Release();
+			Device_DeferRelease(handle->device, handle->vertexBuffer);
+			Device_DeferFree(handle->device, &handle->allocation);
 			handle->vertexBuffer = NULL;
 		}
 
+		ResourceState_Dispose(&handle->resourceState);
 		free(handle);
 	}
 }
 
-void Orbital_Video_D3D12_VertexBuffer_ChangeState(VertexBuffer* handle, D3D12_RESOURCE_STATES state, ID3D12GraphicsCommandList5* commandList)
+void Orbital_Video_D3D12_VertexBuffer_ChangeState(VertexBuffer* handle, D3D12_RESOURCE_STATES state, ResourceStateTracker* stateTracker, bool split)
 {
-	if (handle->resourceState == state) return;
-	D3D12_RESOURCE_BARRIER barrier = {};
-	barrier.Type = D3D12_RESOURCE_BARRIER_TYPE::D3D12_RESOURCE_BARRIER_TYPE_TRANSITION;
-	barrier.Flags = D3D12_RESOURCE_BARRIER_FLAGS::D3D12_RESOURCE_BARRIER_FLAG_NONE;
-	barrier.Transition.pResource = handle->vertexBuffer;
-	barrier.Transition.StateBefore = handle->resourceState;
-	barrier.Transition.StateAfter = state;
-	barrier.Transition.Subresource = D3D12_RESOURCE_BARRIER_ALL_SUBRESOURCES;
-	commandList->ResourceBarrier(1, &barrier);
-	handle->resourceState = state;
+	ResourceStateTracker_Transition(stateTracker, &handle->resourceState, 0, state, split);
 }
\ No newline at end of file
@@ -1,15 +1,17 @@
 #pragma once
 #include "Device.h"
+#include "ResourceState.h"
 
 struct VertexBuffer
 {
 	Device* device;
 	VertexBufferMode mode;
 	ID3D12Resource* vertexBuffer;
+	HeapAllocation allocation;
     D3D12_VERTEX_BUFFER_VIEW vertexBufferView;
 	UINT elementCount;
 	D3D12_INPUT_ELEMENT_DESC* elements;
-	D3D12_RESOURCE_STATES resourceState;
+	ResourceState resourceState;
 };
 
-void Orbital_Video_D3D12_VertexBuffer_ChangeState(VertexBuffer* handle, D3D12_RESOURCE_STATES state, ID3D12GraphicsCommandList5* commandList);
\ No newline at end of file
+void Orbital_Video_D3D12_VertexBuffer_ChangeState(VertexBuffer* handle, D3D12_RESOURCE_STATES state, ResourceStateTracker* stateTracker, bool split);
\ No newline at end of file
@@ -3,11 +3,25 @@ using System.Runtime.InteropServices;
 
 namespace Orbital.Video.D3D12
 {
+	/// <summary>
+	/// Native calls skipped since 'Start' because the state was already bound
+	/// </summary>
+	[StructLayout(LayoutKind.Sequential)]
+	public struct CommandListElidedCalls
+	{
+		public ulong resourceStates, rootSignature, descriptorTable, pipelineState, topology, vertexBuffer;
+	}
+
 	public sealed class CommandList : CommandListBase
 	{
 		public readonly Device deviceD3D12;
 		internal IntPtr handle;
 
+		/// <summary>
+		/// Device fence ticket of the last submission
+		/// </summary>
+		public ulong fenceTicket { get; internal set; }
+
 		private VertexBuffer lastVertexBuffer;
 		private RenderPass lastRenderPass;
 
@@ -15,7 +29,7 @@ namespace Orbital.Video.D3D12
 		private static extern IntPtr Orbital_Video_D3D12_CommandList_Create(IntPtr device);
 
 		[DllImport(Instance.lib, CallingConvention = Instance.callingConvention)]
-		private static extern int Orbital_Video_D3D12_CommandList_Init(IntPtr handle);
+		private static extern int Orbital_Video_D3D12_CommandList_Init(IntPtr handle, CommandListType type);
 
 		[DllImport(Instance.lib, CallingConvention = Instance.callingConvention)]
 		private static extern void Orbital_Video_D3D12_CommandList_Dispose(IntPtr handle);
@@ -41,6 +55,9 @@ namespace Orbital.Video.D3D12
 		[DllImport(Instance.lib, CallingConvention = Instance.callingConvention)]
 		private static extern void Orbital_Video_D3D12_CommandList_SetRenderState(IntPtr handle, IntPtr renderState);
 
+		[DllImport(Instance.lib, CallingConvention = Instance.callingConvention)]
+		private static extern void Orbital_Video_D3D12_CommandList_SetBindingSet(IntPtr handle, IntPtr bindingSet);
+
 		[DllImport(Instance.lib, CallingConvention = Instance.callingConvention)]
 		private static extern void Orbital_Video_D3D12_CommandList_SetVertexBuffer(IntPtr handle, IntPtr vertexBuffer);
 
@@ -48,10 +65,28 @@ namespace Orbital.Video.D3D12
 		private static extern void Orbital_Video_D3D12_CommandList_DrawInstanced(IntPtr handle, uint vertexIndex, uint vertexCount, uint instanceCount);
 
 		[DllImport(Instance.lib, CallingConvention = Instance.callingConvention)]
-		private static extern void Orbital_Video_D3D12_CommandList_Execute(IntPtr handle);
+		private static extern void Orbital_Video_D3D12_CommandList_ExecuteBundle(IntPtr handle, IntPtr bundle);
+
+		[DllImport(Instance.lib, CallingConvention = Instance.callingConvention)]
+		private static extern ulong Orbital_Video_D3D12_CommandList_Execute(IntPtr handle);
+
+		[DllImport(Instance.lib, CallingConvention = Instance.callingConvention)]
+		private static unsafe extern int Orbital_Video_D3D12_CommandList_AllocateTransient(IntPtr handle, ulong size, void** data, ulong* gpuAddress);
+
+		[DllImport(Instance.lib, CallingConvention = Instance.callingConvention)]
+		private static extern void Orbital_Video_D3D12_CommandList_SetRootConstantBuffer(IntPtr handle, uint index, ulong gpuAddress);
 
-		internal CommandList(Device device)
-		: base(device)
+		[DllImport(Instance.lib, CallingConvention = Instance.callingConvention)]
+		private static extern void Orbital_Video_D3D12_CommandList_SetRootShaderResource(IntPtr handle, uint index, ulong gpuAddress);
+
+		[DllImport(Instance.lib, CallingConvention = Instance.callingConvention)]
+		private static unsafe extern void Orbital_Video_D3D12_CommandList_SetRootConstants(IntPtr handle, uint index, void* data, uint count, uint offset);
+
+		[DllImport(Instance.lib, CallingConvention = Instance.callingConvention)]
+		private static extern void Orbital_Video_D3D12_CommandList_GetElidedCalls(IntPtr handle, out CommandListElidedCalls elidedCalls);
+
+		internal CommandList(Device device, CommandListType type)
+		: base(device, type)
 		{
 			deviceD3D12 = device;
 			handle = Orbital_Video_D3D12_CommandList_Create(device.handle);
@@ -59,7 +94,7 @@ namespace Orbital.Video.D3D12
 
 		public bool Init()
 		{
-			return Orbital_Video_D3D12_CommandList_Init(handle) != 0;
+			return Orbital_Video_D3D12_CommandList_Init(handle, type) != 0;
 		}
 
 		public override void Dispose()
@@ -76,6 +111,11 @@ namespace Orbital.Video.D3D12
 			Orbital_Video_D3D12_CommandList_Start(handle, deviceD3D12.handle);
 		}
 
+		public override void Start(RenderPassBase renderPass)
+		{
+			Orbital_Video_D3D12_CommandList_Start(handle, deviceD3D12.handle);
+		}
+
 		public override void Finish()
 		{
 			Orbital_Video_D3D12_CommandList_Finish(handle);
@@ -122,20 +162,93 @@ namespace Orbital.Video.D3D12
 			Orbital_Video_D3D12_CommandList_SetRenderState(handle, renderStateD3D12.handle);
 		}
 
+		public override void SetBindingSet(BindingSetBase bindingSet)
+		{
+			var bindingSetD3D12 = (BindingSet)bindingSet;
+			Orbital_Video_D3D12_CommandList_SetBindingSet(handle, bindingSetD3D12.handle);
+		}
+
 		public override void SetVertexBuffer(VertexBufferBase vertexBuffer)
 		{
 			lastVertexBuffer = (VertexBuffer)vertexBuffer;
 			Orbital_Video_D3D12_CommandList_SetVertexBuffer(handle, lastVertexBuffer.handle);
 		}
 
+		public override unsafe void SetRootConstants(int index, void* data, int count, int offset)
+		{
+			Orbital_Video_D3D12_CommandList_SetRootConstants(handle, (uint)index, data, (uint)count, (uint)offset);
+		}
+
 		public override void Draw()
 		{
 			Orbital_Video_D3D12_CommandList_DrawInstanced(handle, 0, (uint)lastVertexBuffer.vertexCount, 1);
 		}
 
+		public override void ExecuteBundle(CommandListBase bundle)
+		{
+			var bundleD3D12 = (CommandList)bundle;
+			if (bundleD3D12.type != CommandListType.Bundle) throw new ArgumentException("CommandList must be of type Bundle");
+			Orbital_Video_D3D12_CommandList_ExecuteBundle(handle, bundleD3D12.handle);
+		}
+
 		public override void Execute()
 		{
-			Orbital_Video_D3D12_CommandList_Execute(handle);
+			if (type == CommandListType.Bundle) throw new NotSupportedException("Bundles can only be replayed with ExecuteBundle");
+			fenceTicket = Orbital_Video_D3D12_CommandList_Execute(handle);
+		}
+
+		/// <summary>
+		/// Allocates upload memory that stays valid until the current frame completes (256 byte aligned, not for bundles)
+		/// </summary>
+		/// <param name="data">CPU pointer to write the constants to</param>
+		/// <param name="gpuAddress">Address to pass to 'SetRootConstantBuffer'</param>
+		public unsafe bool AllocateTransient(int size, out void* data, out ulong gpuAddress)
+		{
+			void* dataPtr;
+			ulong address;
+			bool result = Orbital_Video_D3D12_CommandList_AllocateTransient(handle, (ulong)size, &dataPtr, &address) != 0;
+			data = dataPtr;
+			gpuAddress = address;
+			return result;
+		}
+
+		#if CS_7_3
+		/// <summary>
+		/// Copies data into transient upload memory and returns its GPU address
+		/// </summary>
+		public unsafe bool AllocateTransient<T>(T data, out ulong gpuAddress) where T : unmanaged
+		{
+			if (!AllocateTransient(sizeof(T), out void* dataPtr, out gpuAddress)) return false;
+			*(T*)dataPtr = data;
+			return true;
+		}
+		#endif
+
+		/// <summary>
+		/// Binds a GPU address to a root constant buffer of the current render state's effect
+		/// </summary>
+		/// <param name="index">Index into 'ShaderEffectDesc.rootConstantBuffers'</param>
+		public void SetRootConstantBuffer(int index, ulong gpuAddress)
+		{
+			Orbital_Video_D3D12_CommandList_SetRootConstantBuffer(handle, (uint)index, gpuAddress);
+		}
+
+		/// <summary>
+		/// Binds a GPU address to a root buffer SRV of the current render state's effect
+		/// </summary>
+		/// <param name="index">Index into 'ShaderEffectDesc.rootShaderResources'</param>
+		public void SetRootShaderResource(int index, ulong gpuAddress)
+		{
+			Orbital_Video_D3D12_CommandList_SetRootShaderResource(handle, (uint)index, gpuAddress);
+		}
+
+		/// <summary>
+		/// Redundant state changes filtered out while recording
+		/// </summary>
+		public CommandListElidedCalls GetElidedCalls()
+		{
+			Orbital_Video_D3D12_CommandList_GetElidedCalls(handle, out var elidedCalls);
+			return elidedCalls;
 		}
 	}
 }
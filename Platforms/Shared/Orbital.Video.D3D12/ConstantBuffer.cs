@@ -19,6 +19,9 @@ namespace Orbital.Video.D3D12
 		[DllImport(Instance.lib, CallingConvention = Instance.callingConvention)]
 		private static unsafe extern int Orbital_Video_D3D12_ConstantBuffer_Update(IntPtr handle, void* data, uint dataSize, uint dstOffset);
 
+		[DllImport(Instance.lib, CallingConvention = Instance.callingConvention)]
+		private static extern uint Orbital_Video_D3D12_ConstantBuffer_GetBindlessIndex(IntPtr handle);
+
 		public ConstantBuffer(Device device, ConstantBufferMode mode)
 		{
 			handle = Orbital_Video_D3D12_ConstantBuffer_Create(device.handle, mode);
@@ -85,5 +88,13 @@ namespace Orbital.Video.D3D12
 		{
 			return Orbital_Video_D3D12_ConstantBuffer_Update(handle, data, (uint)dataSize, (uint)dstOffset) != 0;
 		}
+
+		/// <summary>
+		/// Index into the device heap, valid for constant buffer arrays declared unbounded in register space 2 (resource binding tier 3). Changes if the buffer is relocated so query it when recording
+		/// </summary>
+		public int GetBindlessIndex()
+		{
+			return (int)Orbital_Video_D3D12_ConstantBuffer_GetBindlessIndex(handle);
+		}
 	}
 }
@@ -36,6 +36,64 @@ namespace Orbital.Video.D3D12
 		/// True to launch in fullscreen
 		/// </summary>
 		public bool fullscreen;
+
+		/// <summary>
+		/// Number of frames the CPU can record ahead of the GPU (1-3). 0 uses the default of 2
+		/// </summary>
+		public int frameCount;
+
+		/// <summary>
+		/// Threads compiling render states created with 'compileAsync'. 0 picks a count from the CPU cores
+		/// </summary>
+		public int pipelineWorkerCount;
+	}
+
+	/// <summary>
+	/// Usage of the heaps resources are placed in
+	/// </summary>
+	[StructLayout(LayoutKind.Sequential)]
+	public struct HeapAllocatorStats
+	{
+		public ulong blockCount, reservedSize;
+		public ulong allocationCount, allocatedSize, requestedSize;
+		public ulong freeRangeCount, largestFreeRange;
+		public ulong committedCount, committedSize;
+		public ulong movedCount, movedSize;
+
+		/// <summary>
+		/// 0 when all free heap memory is one range, approaching 1 as it splits into small ranges
+		/// </summary>
+		public double Fragmentation
+		{
+			get
+			{
+				ulong freeSize = reservedSize - allocatedSize;
+				if (freeSize == 0) return 0;
+				return 1.0 - ((double)largestFreeRange / freeSize);
+			}
+		}
+	}
+
+	/// <summary>
+	/// Pipeline states shared in memory, loaded from the pipeline library or compiled
+	/// </summary>
+	[StructLayout(LayoutKind.Sequential)]
+	public struct PipelineCacheStats
+	{
+		public ulong memoryHits;
+		public ulong libraryHits, misses;
+		public ulong compileMicroseconds;
+		public ulong pipelineCount;
+	}
+
+	/// <summary>
+	/// Root signatures requested by shader effects versus distinct ones created
+	/// </summary>
+	[StructLayout(LayoutKind.Sequential)]
+	public struct RootSignatureCacheStats
+	{
+		public ulong requestCount, createCount;
+		public ulong uniqueCount, referenceCount;
 	}
 
 	public sealed class Device : DeviceBase
@@ -49,7 +107,7 @@ namespace Orbital.Video.D3D12
 		private static extern IntPtr Orbital_Video_D3D12_Device_Create(IntPtr Instance);
 
 		[DllImport(Instance.lib, CallingConvention = Instance.callingConvention)]
-		private static extern int Orbital_Video_D3D12_Device_Init(IntPtr handle, int adapterIndex, int softwareRasterizer);
+		private static extern int Orbital_Video_D3D12_Device_Init(IntPtr handle, int adapterIndex, int softwareRasterizer, int frameCount, int pipelineWorkerCount);
 
 		[DllImport(Instance.lib, CallingConvention = Instance.callingConvention)]
 		private static extern void Orbital_Video_D3D12_Device_Dispose(IntPtr handle);
@@ -60,6 +118,36 @@ namespace Orbital.Video.D3D12
 		[DllImport(Instance.lib, CallingConvention = Instance.callingConvention)]
 		private static extern void Orbital_Video_D3D12_Device_EndFrame(IntPtr handle);
 
+		[DllImport(Instance.lib, CallingConvention = Instance.callingConvention)]
+		private static unsafe extern ulong Orbital_Video_D3D12_Device_ExecuteCommandLists(IntPtr handle, IntPtr* commandLists, uint commandListCount);
+
+		[DllImport(Instance.lib, CallingConvention = Instance.callingConvention)]
+		private static extern int Orbital_Video_D3D12_Device_IsFenceTicketComplete(IntPtr handle, CommandListType type, ulong ticket);
+
+		[DllImport(Instance.lib, CallingConvention = Instance.callingConvention)]
+		private static extern void Orbital_Video_D3D12_Device_WaitForFenceTicket(IntPtr handle, CommandListType type, ulong ticket);
+
+		[DllImport(Instance.lib, CallingConvention = Instance.callingConvention)]
+		private static extern void Orbital_Video_D3D12_Device_QueueWaitForFenceTicket(IntPtr handle, CommandListType type, CommandListType ticketType, ulong ticket);
+
+		[DllImport(Instance.lib, CallingConvention = Instance.callingConvention)]
+		private static extern void Orbital_Video_D3D12_Device_GetHeapAllocatorStats(IntPtr handle, out HeapAllocatorStats stats);
+
+		[DllImport(Instance.lib, CallingConvention = Instance.callingConvention)]
+		private static extern void Orbital_Video_D3D12_Device_SetDefragmentBudget(IntPtr handle, ulong bytesPerFrame);
+
+		[DllImport(Instance.lib, CallingConvention = Instance.callingConvention)]
+		private static unsafe extern int Orbital_Video_D3D12_Device_LoadPipelineCache(IntPtr handle, byte* data, ulong size);
+
+		[DllImport(Instance.lib, CallingConvention = Instance.callingConvention)]
+		private static unsafe extern int Orbital_Video_D3D12_Device_SerializePipelineCache(IntPtr handle, byte* data, ulong* size);
+
+		[DllImport(Instance.lib, CallingConvention = Instance.callingConvention)]
+		private static extern void Orbital_Video_D3D12_Device_GetPipelineCacheStats(IntPtr handle, out PipelineCacheStats stats);
+
+		[DllImport(Instance.lib, CallingConvention = Instance.callingConvention)]
+		private static extern void Orbital_Video_D3D12_Device_GetRootSignatureCacheStats(IntPtr handle, out RootSignatureCacheStats stats);
+
 		public Device(Instance instance, DeviceType type)
 		: base(instance, type)
 		{
@@ -70,7 +158,7 @@ namespace Orbital.Video.D3D12
 		public bool Init(DeviceDesc desc)
 		{
 			window = desc.window;
-			if (Orbital_Video_D3D12_Device_Init(handle, desc.adapterIndex, (desc.softwareRasterizer ? 1 : 0)) == 0) return false;
+			if (Orbital_Video_D3D12_Device_Init(handle, desc.adapterIndex, (desc.softwareRasterizer ? 1 : 0), desc.frameCount, desc.pipelineWorkerCount) == 0) return false;
 			if (type == DeviceType.Presentation)
 			{
 				swapChain = new SwapChain(this, desc.ensureSwapChainMatchesWindowSize);
@@ -109,6 +197,106 @@ namespace Orbital.Video.D3D12
 			Orbital_Video_D3D12_Device_EndFrame(handle);
 		}
 
+		/// <summary>
+		/// Submits command lists in one batch without waiting for the GPU. All lists must be of the same type
+		/// </summary>
+		/// <returns>Fence ticket that completes when the GPU has finished all lists (only valid for the lists queue type)</returns>
+		public unsafe ulong ExecuteCommandLists(params CommandList[] commandLists)
+		{
+			var commandListHandles = stackalloc IntPtr[commandLists.Length];
+			for (int i = 0; i != commandLists.Length; ++i) commandListHandles[i] = commandLists[i].handle;
+			ulong ticket = Orbital_Video_D3D12_Device_ExecuteCommandLists(handle, commandListHandles, (uint)commandLists.Length);
+			foreach (var commandList in commandLists) commandList.fenceTicket = ticket;
+			return ticket;
+		}
+
+		/// <summary>
+		/// True if the GPU has finished the submission the ticket belongs to
+		/// </summary>
+		public bool IsFenceTicketComplete(ulong ticket, CommandListType type = CommandListType.Rasterize)
+		{
+			return Orbital_Video_D3D12_Device_IsFenceTicketComplete(handle, type, ticket) != 0;
+		}
+
+		/// <summary>
+		/// Blocks until the GPU has finished the submission the ticket belongs to
+		/// </summary>
+		public void WaitForFenceTicket(ulong ticket, CommandListType type = CommandListType.Rasterize)
+		{
+			Orbital_Video_D3D12_Device_WaitForFenceTicket(handle, type, ticket);
+		}
+
+		/// <summary>
+		/// Makes lists submitted to one queue after this call wait GPU-side for a ticket of another queue (doesn't block the CPU)
+		/// </summary>
+		/// <param name="type">Queue that waits</param>
+		/// <param name="ticketType">Queue the ticket belongs to</param>
+		public void QueueWaitForFenceTicket(CommandListType type, CommandListType ticketType, ulong ticket)
+		{
+			Orbital_Video_D3D12_Device_QueueWaitForFenceTicket(handle, type, ticketType, ticket);
+		}
+
+		/// <summary>
+		/// Makes lists submitted to one queue after this call wait GPU-side for the last submission of a command list
+		/// </summary>
+		public void QueueWaitForCommandList(CommandListType type, CommandList commandList)
+		{
+			Orbital_Video_D3D12_Device_QueueWaitForFenceTicket(handle, type, commandList.type, commandList.fenceTicket);
+		}
+
+		/// <summary>
+		/// Memory used by placed resources and how fragmented their heaps are
+		/// </summary>
+		public HeapAllocatorStats GetHeapAllocatorStats()
+		{
+			Orbital_Video_D3D12_Device_GetHeapAllocatorStats(handle, out var stats);
+			return stats;
+		}
+
+		/// <summary>
+		/// Max bytes the background defragmenter copies per frame (0 disables it)
+		/// </summary>
+		public void SetDefragmentBudget(ulong bytesPerFrame)
+		{
+			Orbital_Video_D3D12_Device_SetDefragmentBudget(handle, bytesPerFrame);
+		}
+
+		public override unsafe bool LoadPipelineCache(byte[] data)
+		{
+			if (data == null || data.Length == 0) return false;
+			fixed (byte* dataPtr = data) return Orbital_Video_D3D12_Device_LoadPipelineCache(handle, dataPtr, (ulong)data.Length) != 0;
+		}
+
+		public override unsafe byte[] SavePipelineCache()
+		{
+			ulong size;
+			if (Orbital_Video_D3D12_Device_SerializePipelineCache(handle, null, &size) == 0 || size == 0) return null;
+			var data = new byte[size];
+			fixed (byte* dataPtr = data)
+			{
+				if (Orbital_Video_D3D12_Device_SerializePipelineCache(handle, dataPtr, &size) == 0) return null;
+			}
+			return data;
+		}
+
+		/// <summary>
+		/// Hits and misses of render state pipelines, compare across runs to check the saved cache is used
+		/// </summary>
+		public PipelineCacheStats GetPipelineCacheStats()
+		{
+			Orbital_Video_D3D12_Device_GetPipelineCacheStats(handle, out var stats);
+			return stats;
+		}
+
+		/// <summary>
+		/// How many shader effects share each root signature
+		/// </summary>
+		public RootSignatureCacheStats GetRootSignatureCacheStats()
+		{
+			Orbital_Video_D3D12_Device_GetRootSignatureCacheStats(handle, out var stats);
+			return stats;
+		}
+
 		#region Create Methods
 		public override SwapChainBase CreateSwapChain(WindowBase window, int bufferCount, bool fullscreen, bool ensureSwapChainMatchesWindowSize)
 		{
@@ -123,7 +311,12 @@ namespace Orbital.Video.D3D12
 
 		public override CommandListBase CreateCommandList()
 		{
-			var abstraction = new CommandList(this);
+			return CreateCommandList(CommandListType.Rasterize);
+		}
+
+		public override CommandListBase CreateCommandList(CommandListType type)
+		{
+			var abstraction = new CommandList(this, type);
 			if (!abstraction.Init())
 			{
 				abstraction.Dispose();
@@ -148,6 +341,17 @@ namespace Orbital.Video.D3D12
 			return abstraction;
 		}
 
+		public override BindingSetBase CreateBindingSet(BindingSetDesc desc)
+		{
+			var abstraction = new BindingSet(this);
+			if (!abstraction.Init(desc))
+			{
+				abstraction.Dispose();
+				throw new Exception("Failed to create BindingSet");
+			}
+			return abstraction;
+		}
+
 		public override ShaderEffectBase CreateShaderEffect(Stream stream, ShaderEffectSamplerAnisotropy anisotropyOverride)
 		{
 			var abstraction = new ShaderEffect(this);
@@ -170,6 +374,36 @@ namespace Orbital.Video.D3D12
 			return abstraction;
 		}
 
+		public override ShaderEffectBase CreateShaderEffect(ShaderPackBase pack, int effectIndex, ShaderEffectSamplerAnisotropy anisotropyOverride)
+		{
+			var abstraction = new ShaderEffect(this);
+			if (!abstraction.Init((ShaderPack)pack, effectIndex, anisotropyOverride))
+			{
+				abstraction.Dispose();
+				throw new Exception("Failed to create ShaderEffect");
+			}
+			return abstraction;
+		}
+
+		public override ShaderEffectBase CreateShaderEffect(ShaderPackBase pack, string name, ShaderVariantKey[] keys, ShaderEffectSamplerAnisotropy anisotropyOverride)
+		{
+			// permutations are precompiled, keys only select one
+			int effectIndex = pack.FindVariant(name, keys);
+			if (effectIndex < 0) throw new Exception("ShaderPack variant not found: " + name);
+			return CreateShaderEffect(pack, effectIndex, anisotropyOverride);
+		}
+
+		public override ShaderPackBase CreateShaderPack(string filename)
+		{
+			var abstraction = new ShaderPack(this);
+			if (!abstraction.Init(filename))
+			{
+				abstraction.Dispose();
+				throw new Exception("Failed to create ShaderPack");
+			}
+			return abstraction;
+		}
+
 		public override VertexBufferBase CreateVertexBuffer(int size, VertexBufferLayout layout, VertexBufferMode mode)
 		{
 			var abstraction = new VertexBuffer(this, mode);
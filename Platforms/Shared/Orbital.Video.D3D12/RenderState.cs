@@ -17,6 +17,12 @@ namespace Orbital.Video.D3D12
 		[DllImport(Instance.lib, CallingConvention = Instance.callingConvention)]
 		private static extern void Orbital_Video_D3D12_RenderState_Dispose(IntPtr handle);
 
+		[DllImport(Instance.lib, CallingConvention = Instance.callingConvention)]
+		private static extern RenderStateStatus Orbital_Video_D3D12_RenderState_GetStatus(IntPtr handle);
+
+		[DllImport(Instance.lib, CallingConvention = Instance.callingConvention)]
+		private static extern void Orbital_Video_D3D12_RenderState_SetCompilePriority(IntPtr handle, int priority);
+
 		public RenderState(Device device)
 		{
 			handle = Orbital_Video_D3D12_RenderState_Create(device.handle);
@@ -32,6 +38,16 @@ namespace Orbital.Video.D3D12
 			}
 		}
 
+		public override RenderStateStatus GetStatus()
+		{
+			return Orbital_Video_D3D12_RenderState_GetStatus(handle);
+		}
+
+		public override void SetCompilePriority(int priority)
+		{
+			Orbital_Video_D3D12_RenderState_SetCompilePriority(handle, priority);
+		}
+
 		public override void Dispose()
 		{
 			if (handle != IntPtr.Zero)
@@ -21,6 +21,12 @@ namespace Orbital.Video.D3D12
 		[DllImport(Instance.lib, CallingConvention = Instance.callingConvention)]
 		private static unsafe extern int Orbital_Video_D3D12_ShaderEffect_Init(IntPtr handle, IntPtr vs, IntPtr ps, IntPtr hs, IntPtr ds, IntPtr gs, ShaderEffectDesc_NativeInterop* desc);
 
+		[DllImport(Instance.lib, CallingConvention = Instance.callingConvention)]
+		private static extern int Orbital_Video_D3D12_ShaderEffect_InitFromPack(IntPtr handle, IntPtr pack, int effectIndex, ShaderEffectSamplerAnisotropy anisotropyOverride);
+
+		[DllImport(Instance.lib, CallingConvention = Instance.callingConvention)]
+		private static unsafe extern ulong Orbital_Video_D3D12_ShaderEffect_GetSerializedRootSignature(IntPtr handle, byte* data, ulong size, out int version, out int bindlessTableCount);
+
 		[DllImport(Instance.lib, CallingConvention = Instance.callingConvention)]
 		private static extern void Orbital_Video_D3D12_ShaderEffect_Dispose(IntPtr handle);
 
@@ -41,6 +47,30 @@ namespace Orbital.Video.D3D12
 			return InitFinish(ref desc);
 		}
 
+		/// <summary>
+		/// Loads effect from a shader pack, its shaders are owned by the native effect
+		/// </summary>
+		public bool Init(ShaderPack pack, int effectIndex, ShaderEffectSamplerAnisotropy anisotropyOverride)
+		{
+			if (!pack.GetEffectResourceCounts(effectIndex, out int constantBufferCount, out int textureCount)) return false;
+			this.constantBufferCount = constantBufferCount;
+			this.textureCount = textureCount;
+			return Orbital_Video_D3D12_ShaderEffect_InitFromPack(handle, pack.handle, effectIndex, anisotropyOverride) != 0;
+		}
+
+		/// <summary>
+		/// Serialized root signature to store in a 'ShaderPackEntry'
+		/// </summary>
+		/// <returns>Null if the effect isn't initialized</returns>
+		public unsafe byte[] GetSerializedRootSignature(out int version, out int bindlessTableCount)
+		{
+			ulong size = Orbital_Video_D3D12_ShaderEffect_GetSerializedRootSignature(handle, null, 0, out version, out bindlessTableCount);
+			if (size == 0) return null;
+			var data = new byte[size];
+			fixed (byte* dataPtr = data) Orbital_Video_D3D12_ShaderEffect_GetSerializedRootSignature(handle, dataPtr, size, out version, out bindlessTableCount);
+			return data;
+		}
+
 		protected unsafe override bool InitFinish(ref ShaderEffectDesc desc)
 		{
 			if (desc.constantBuffers != null) constantBufferCount = desc.constantBuffers.Length;
@@ -0,0 +1,62 @@
+﻿using System;
+using System.Runtime.InteropServices;
+
+namespace Orbital.Video.D3D12
+{
+	public sealed class ShaderPack : ShaderPackBase
+	{
+		internal IntPtr handle;
+
+		[DllImport(Instance.lib, CallingConvention = Instance.callingConvention)]
+		private static extern IntPtr Orbital_Video_D3D12_ShaderPack_Create(IntPtr device);
+
+		[DllImport(Instance.lib, CallingConvention = Instance.callingConvention)]
+		private static unsafe extern int Orbital_Video_D3D12_ShaderPack_Init(IntPtr handle, char* filename);
+
+		[DllImport(Instance.lib, CallingConvention = Instance.callingConvention)]
+		private static extern int Orbital_Video_D3D12_ShaderPack_GetEffectCount(IntPtr handle);
+
+		[DllImport(Instance.lib, CallingConvention = Instance.callingConvention)]
+		private static unsafe extern int Orbital_Video_D3D12_ShaderPack_FindEffect(IntPtr handle, char* name, int nameLength, ulong variantHash);
+
+		[DllImport(Instance.lib, CallingConvention = Instance.callingConvention)]
+		private static extern int Orbital_Video_D3D12_ShaderPack_GetEffectResourceCounts(IntPtr handle, int effectIndex, out int constantBufferCount, out int textureCount);
+
+		[DllImport(Instance.lib, CallingConvention = Instance.callingConvention)]
+		private static extern void Orbital_Video_D3D12_ShaderPack_Dispose(IntPtr handle);
+
+		public ShaderPack(Device device)
+		{
+			handle = Orbital_Video_D3D12_ShaderPack_Create(device.handle);
+		}
+
+		public unsafe bool Init(string filename)
+		{
+			fixed (char* filenamePtr = filename)
+			{
+				if (Orbital_Video_D3D12_ShaderPack_Init(handle, filenamePtr) == 0) return false;
+			}
+			effectCount = Orbital_Video_D3D12_ShaderPack_GetEffectCount(handle);
+			return true;
+		}
+
+		public override unsafe int FindEffect(string name, ulong variantHash)
+		{
+			fixed (char* namePtr = name) return Orbital_Video_D3D12_ShaderPack_FindEffect(handle, namePtr, name.Length, variantHash);
+		}
+
+		internal bool GetEffectResourceCounts(int effectIndex, out int constantBufferCount, out int textureCount)
+		{
+			return Orbital_Video_D3D12_ShaderPack_GetEffectResourceCounts(handle, effectIndex, out constantBufferCount, out textureCount) != 0;
+		}
+
+		public override void Dispose()
+		{
+			if (handle != IntPtr.Zero)
+			{
+				Orbital_Video_D3D12_ShaderPack_Dispose(handle);
+				handle = IntPtr.Zero;
+			}
+		}
+	}
+}
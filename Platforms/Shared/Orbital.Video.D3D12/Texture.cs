@@ -13,5 +13,8 @@ namespace Orbital.Video.D3D12
 
 		[DllImport(Instance.lib, CallingConvention = Instance.callingConvention)]
 		public static extern void Orbital_Video_D3D12_Texture_Dispose(IntPtr handle);
+
+		[DllImport(Instance.lib, CallingConvention = Instance.callingConvention)]
+		public static extern uint Orbital_Video_D3D12_Texture_GetBindlessIndex(IntPtr handle);
 	}
 }
@@ -34,6 +34,14 @@ namespace Orbital.Video.D3D12
 			}
 		}
 
+		/// <summary>
+		/// Index into the device heap, valid for 'Texture2D[]' declared unbounded in register space 1. Changes if the texture is relocated so query it when recording
+		/// </summary>
+		public int GetBindlessIndex()
+		{
+			return (int)Texture.Orbital_Video_D3D12_Texture_GetBindlessIndex(handle);
+		}
+
 		public override IntPtr GetHandle()
 		{
 			return handle;
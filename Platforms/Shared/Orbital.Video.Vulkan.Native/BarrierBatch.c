@@ -0,0 +1,95 @@
+#include "BarrierBatch.h"
+#include "Device.h"
+
+#define BARRIER_BATCH_WRITE_ACCESS (VK_ACCESS_2_SHADER_WRITE_BIT_KHR | VK_ACCESS_2_SHADER_STORAGE_WRITE_BIT_KHR | VK_ACCESS_2_COLOR_ATTACHMENT_WRITE_BIT_KHR | VK_ACCESS_2_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT_KHR | VK_ACCESS_2_TRANSFER_WRITE_BIT_KHR | VK_ACCESS_2_HOST_WRITE_BIT_KHR | VK_ACCESS_2_MEMORY_WRITE_BIT_KHR)
+
+void BarrierBatch_Init(BarrierBatch* handle, Device* device)
+{
+	handle->device = device;
+	handle->barrierCount = 0;
+}
+
+void BarrierBatch_Transition(BarrierBatch* handle, VkCommandBuffer commandBuffer, VkImage image, const VkImageSubresourceRange* subresourceRange, ImageState* state, VkImageLayout layout, VkPipelineStageFlags2KHR stageMask, VkAccessFlags2KHR accessMask, char discard)
+{
+	// reads in the same layout don't need a barrier, just remember who else reads
+	if (state->layout == layout && (state->accessMask & BARRIER_BATCH_WRITE_ACCESS) == 0 && (accessMask & BARRIER_BATCH_WRITE_ACCESS) == 0)
+	{
+		state->stageMask |= stageMask;
+		state->accessMask |= accessMask;
+		return;
+	}
+
+	// fold into a queued transition of the same image (barriers in one call can't depend on each other)
+	for (uint32_t i = 0; i != handle->barrierCount; ++i)
+	{
+		VkImageMemoryBarrier2KHR* barrier = &handle->barriers[i];
+		if (barrier->image != image || memcmp(&barrier->subresourceRange, subresourceRange, sizeof(VkImageSubresourceRange)) != 0) continue;
+		barrier->dstStageMask = stageMask;
+		barrier->dstAccessMask = accessMask;
+		barrier->newLayout = layout;
+		if (discard) barrier->oldLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+		state->layout = layout;
+		state->stageMask = stageMask;
+		state->accessMask = accessMask;
+		return;
+	}
+
+	if (handle->barrierCount == BARRIER_BATCH_MAX_COUNT) BarrierBatch_Flush(handle, commandBuffer);
+	VkImageMemoryBarrier2KHR* barrier = &handle->barriers[handle->barrierCount];
+	memset(barrier, 0, sizeof(VkImageMemoryBarrier2KHR));
+	barrier->sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER_2_KHR;
+	barrier->srcStageMask = state->stageMask;
+	barrier->srcAccessMask = state->accessMask & BARRIER_BATCH_WRITE_ACCESS;// only writes need to be made available
+	barrier->dstStageMask = stageMask;
+	barrier->dstAccessMask = accessMask;
+	barrier->oldLayout = discard ? VK_IMAGE_LAYOUT_UNDEFINED : state->layout;
+	barrier->newLayout = layout;
+	barrier->srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+	barrier->dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+	barrier->image = image;
+	barrier->subresourceRange = *subresourceRange;
+	++handle->barrierCount;
+
+	state->layout = layout;
+	state->stageMask = stageMask;
+	state->accessMask = accessMask;
+}
+
+void BarrierBatch_Flush(BarrierBatch* handle, VkCommandBuffer commandBuffer)
+{
+	if (handle->barrierCount == 0) return;
+	if (handle->device->synchronization2Supported)
+	{
+		VkDependencyInfoKHR dependencyInfo = {0};
+		dependencyInfo.sType = VK_STRUCTURE_TYPE_DEPENDENCY_INFO_KHR;
+		dependencyInfo.imageMemoryBarrierCount = handle->barrierCount;
+		dependencyInfo.pImageMemoryBarriers = handle->barriers;
+		handle->device->vkCmdPipelineBarrier2KHR(commandBuffer, &dependencyInfo);
+	}
+	else
+	{
+		// legacy barriers share one stage mask pair per call (flags used here all fit in 32 bits)
+		VkImageMemoryBarrier barriers[BARRIER_BATCH_MAX_COUNT];
+		VkPipelineStageFlags srcStageMask = 0, dstStageMask = 0;
+		for (uint32_t i = 0; i != handle->barrierCount; ++i)
+		{
+			VkImageMemoryBarrier2KHR* barrier = &handle->barriers[i];
+			memset(&barriers[i], 0, sizeof(VkImageMemoryBarrier));
+			barriers[i].sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+			barriers[i].srcAccessMask = (VkAccessFlags)barrier->srcAccessMask;
+			barriers[i].dstAccessMask = (VkAccessFlags)barrier->dstAccessMask;
+			barriers[i].oldLayout = barrier->oldLayout;
+			barriers[i].newLayout = barrier->newLayout;
+			barriers[i].srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+			barriers[i].dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+			barriers[i].image = barrier->image;
+			barriers[i].subresourceRange = barrier->subresourceRange;
+			srcStageMask |= (VkPipelineStageFlags)barrier->srcStageMask;
+			dstStageMask |= (VkPipelineStageFlags)barrier->dstStageMask;
+		}
+		if (srcStageMask == 0) srcStageMask = VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT;
+		if (dstStageMask == 0) dstStageMask = VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT;
+		vkCmdPipelineBarrier(commandBuffer, srcStageMask, dstStageMask, 0, 0, NULL, 0, NULL, handle->barrierCount, barriers);
+	}
+	handle->barrierCount = 0;
+}
@@ -0,0 +1,25 @@
+#pragma once
+#include "Common.h"
+
+#define BARRIER_BATCH_MAX_COUNT 32
+
+struct Device;
+
+// last layout an image was transitioned to and the stages / accesses that used it since
+typedef struct ImageState
+{
+	VkImageLayout layout;
+	VkPipelineStageFlags2KHR stageMask;
+	VkAccessFlags2KHR accessMask;
+} ImageState;
+
+typedef struct BarrierBatch
+{
+	struct Device* device;
+	VkImageMemoryBarrier2KHR barriers[BARRIER_BATCH_MAX_COUNT];// queued until the next flush
+	uint32_t barrierCount;
+} BarrierBatch;
+
+void BarrierBatch_Init(BarrierBatch* handle, struct Device* device);
+void BarrierBatch_Transition(BarrierBatch* handle, VkCommandBuffer commandBuffer, VkImage image, const VkImageSubresourceRange* subresourceRange, ImageState* state, VkImageLayout layout, VkPipelineStageFlags2KHR stageMask, VkAccessFlags2KHR accessMask, char discard);
+void BarrierBatch_Flush(BarrierBatch* handle, VkCommandBuffer commandBuffer);
@@ -0,0 +1,48 @@
+#include "BindingSet.h"
+#include "ConstantBuffer.h"
+#include "Texture.h"
+
+ORBITAL_EXPORT BindingSet* Orbital_Video_Vulkan_BindingSet_Create(Device* device)
+{
+	BindingSet* handle = (BindingSet*)calloc(1, sizeof(BindingSet));
+	handle->device = device;
+	return handle;
+}
+
+ORBITAL_EXPORT int Orbital_Video_Vulkan_BindingSet_Init(BindingSet* handle, BindingSetDesc* desc)
+{
+	ShaderEffect* shaderEffect = (ShaderEffect*)desc->shaderEffect;
+	handle->shaderEffect = shaderEffect;
+	if (desc->constantBufferCount != shaderEffect->constantBufferCount || desc->textureCount != shaderEffect->textureCount) return 0;
+
+	// bindings follow the register shifts of the effect's set layout
+	uint32_t bindingCount = desc->constantBufferCount + desc->textureCount;
+	DescriptorBinding* bindings = alloca(sizeof(DescriptorBinding) * (bindingCount + 1));
+	memset(bindings, 0, sizeof(DescriptorBinding) * (bindingCount + 1));
+	uint32_t b = 0;
+	for (int i = 0; i != desc->constantBufferCount; ++i, ++b)
+	{
+		ConstantBuffer* constantBuffer = (ConstantBuffer*)desc->constantBuffers[i];
+		bindings[b].binding = DESCRIPTOR_BINDING_CONSTANT_BUFFER_OFFSET + shaderEffect->constantBuffers[i].registerIndex;
+		bindings[b].type = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+		bindings[b].buffer = constantBuffer->buffer;
+		bindings[b].range = constantBuffer->size;
+	}
+	for (int i = 0; i != desc->textureCount; ++i, ++b)
+	{
+		Texture* texture = (Texture*)desc->textures[i];
+		bindings[b].binding = DESCRIPTOR_BINDING_TEXTURE_OFFSET + shaderEffect->textures[i].registerIndex;
+		bindings[b].type = VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE;
+		bindings[b].imageView = texture->imageView;
+		bindings[b].imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;// layout uploads leave images in
+	}
+
+	// materials sharing resources share one set, so creating a binding set is usually a cache hit
+	return DescriptorAllocator_GetCachedSet(&handle->device->descriptorAllocator, shaderEffect->descriptorSetLayout, bindings, bindingCount, &handle->set);
+}
+
+ORBITAL_EXPORT void Orbital_Video_Vulkan_BindingSet_Dispose(BindingSet* handle)
+{
+	// set stays cached until one of its resources is destroyed
+	free(handle);
+}
\ No newline at end of file
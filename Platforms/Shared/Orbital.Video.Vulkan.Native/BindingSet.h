@@ -0,0 +1,11 @@
+#pragma once
+#include "Device.h"
+#include "ShaderEffect.h"
+
+// resources for a ShaderEffect's set layout, bound independently of the pipeline
+typedef struct BindingSet
+{
+	Device* device;
+	ShaderEffect* shaderEffect;
+	VkDescriptorSet set;// owned by the descriptor cache, shared by binding sets of the same resources
+} BindingSet;
\ No newline at end of file
@@ -1,6 +1,74 @@
 #include "CommandList.h"
 #include "SwapChain.h"
-#include "RenderPass.h"
+#include "BindingSet.h"
+
+void CommandList_TransitionSwapChain(CommandList* handle, SwapChain* swapChain, VkImageLayout layout, VkPipelineStageFlags2KHR stageMask, VkAccessFlags2KHR accessMask, char discard)
+{
+	// first use since acquire: submit waits on the acquire semaphore at this stage, which the barrier then chains off
+	ImageState* state = &swapChain->imageStates[swapChain->currentRenderTargetIndex];
+	if (swapChain->acquireWaitStageMask == 0)
+	{
+		swapChain->acquireWaitStageMask = (VkPipelineStageFlags)stageMask;
+		state->stageMask = stageMask;
+		state->accessMask = VK_ACCESS_2_NONE_KHR;
+	}
+	if (swapChain->acquireSemaphore != NULL) handle->waitSwapChain = swapChain;
+	BarrierBatch_Transition(&handle->barrierBatch, handle->commandBuffer, swapChain->images[swapChain->currentRenderTargetIndex], &swapChain->subresourceRange, state, layout, stageMask, accessMask, discard);
+}
+
+void CommandList_BeginPendingRenderPass(CommandList* handle, VkSubpassContents contents)
+{
+	RenderPass* renderPass = handle->pendingRenderPass;
+	if (renderPass == NULL) return;
+	handle->pendingRenderPass = NULL;
+	handle->activeRenderPass = renderPass;
+
+	// bring attachment into the layout the pass expects (contents are discarded if the pass clears them)
+	VkPipelineStageFlags2KHR stageMask = VK_PIPELINE_STAGE_2_COLOR_ATTACHMENT_OUTPUT_BIT_KHR;
+	VkAccessFlags2KHR accessMask = VK_ACCESS_2_COLOR_ATTACHMENT_WRITE_BIT_KHR;
+	if (!renderPass->clearColor) accessMask |= VK_ACCESS_2_COLOR_ATTACHMENT_READ_BIT_KHR;
+	if (renderPass->swapChain != NULL)
+	{
+		CommandList_TransitionSwapChain(handle, renderPass->swapChain, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL, stageMask, accessMask, renderPass->clearColor);
+	}
+	else
+	{
+		VkImageSubresourceRange subresourceRange = {VK_IMAGE_ASPECT_COLOR_BIT, 0, VK_REMAINING_MIP_LEVELS, 0, VK_REMAINING_ARRAY_LAYERS};
+		BarrierBatch_Transition(&handle->barrierBatch, handle->commandBuffer, renderPass->texture->image, &subresourceRange, &renderPass->texture->imageState, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL, stageMask, accessMask, renderPass->clearColor);
+	}
+	BarrierBatch_Flush(&handle->barrierBatch, handle->commandBuffer);
+
+	VkRenderPassBeginInfo renderPassBeginInfo = {0};
+	renderPassBeginInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
+	renderPassBeginInfo.renderPass = renderPass->renderPass;
+	renderPassBeginInfo.renderArea.offset.x = 0;
+	renderPassBeginInfo.renderArea.offset.y = 0;
+	renderPassBeginInfo.renderArea.extent.width = renderPass->width;
+	renderPassBeginInfo.renderArea.extent.height = renderPass->height;
+	VkClearValue clearValues[1] = {0};
+	if (renderPass->clearColor)
+	{
+		memcpy(clearValues[0].color.float32, renderPass->clearColorValue, sizeof(float) * 4);
+		renderPassBeginInfo.clearValueCount = 1;
+		renderPassBeginInfo.pClearValues = clearValues;
+	}
+	//clearValues[1].depthStencil.depth = 1.0f;
+	//clearValues[1].depthStencil.stencil = 0.0f;
+	if (renderPass->swapChain != NULL) renderPassBeginInfo.framebuffer = renderPass->frameBuffers[renderPass->swapChain->currentRenderTargetIndex];
+	else renderPassBeginInfo.framebuffer = renderPass->frameBuffers[0];
+	vkCmdBeginRenderPass(handle->commandBuffer, &renderPassBeginInfo, contents);
+}
+
+void CommandList_BindDescriptorSet(CommandList* handle, ShaderEffect* shaderEffect, VkDescriptorSet set)
+{
+	// one bind per material change, the bindless set rides along in the same call
+	if (handle->boundDescriptorSet == set && handle->boundPipelineLayout == shaderEffect->pipelineLayout) return;
+	VkDescriptorSet sets[2] = {set, handle->device->descriptorAllocator.bindlessSet};
+	VkPipelineBindPoint bindPoint = handle->type == CommandListType_Compute ? VK_PIPELINE_BIND_POINT_COMPUTE : VK_PIPELINE_BIND_POINT_GRAPHICS;
+	vkCmdBindDescriptorSets(handle->commandBuffer, bindPoint, shaderEffect->pipelineLayout, 0, shaderEffect->descriptorSetCount, sets, 0, NULL);
+	handle->boundDescriptorSet = set;
+	handle->boundPipelineLayout = shaderEffect->pipelineLayout;
+}
 
 ORBITAL_EXPORT CommandList* Orbital_Video_Vulkan_CommandList_Create(Device* device)
 {
@@ -9,104 +77,220 @@ ORBITAL_EXPORT CommandList* Orbital_Video_Vulkan_CommandList_Create(Device* devi
 	return handle;
 }
 
-ORBITAL_EXPORT int Orbital_Video_Vulkan_CommandList_Init(CommandList* handle)
+ORBITAL_EXPORT int Orbital_Video_Vulkan_CommandList_Init(CommandList* handle, CommandListType type)
 {
-	// create command buffer
-	VkCommandBufferAllocateInfo allocInfo = {0};
-    allocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
-    allocInfo.commandPool = handle->device->commandPool;
-    allocInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
-    allocInfo.commandBufferCount = 1;
-    if (vkAllocateCommandBuffers(handle->device->device, &allocInfo, &handle->commandBuffer) != VK_SUCCESS) return 0;
+	handle->type = type;
+	BarrierBatch_Init(&handle->barrierBatch, handle->device);
+
+	// create secondary command buffer
+	if (type == CommandListType_Bundle)
+	{
+		VkCommandPoolCreateInfo poolCreateInfo = {0};
+		poolCreateInfo.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+		poolCreateInfo.queueFamilyIndex = handle->device->queueFamilyIndex;
+		poolCreateInfo.flags = VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT;
+		if (vkCreateCommandPool(handle->device->device, &poolCreateInfo, NULL, &handle->bundleCommandPool) != VK_SUCCESS) return 0;
 
-	// create fence
-	VkFenceCreateInfo fenceInfo = {0};
-    fenceInfo.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
-    fenceInfo.flags = 0;
-    if (vkCreateFence(handle->device->device, &fenceInfo, NULL, &handle->fence) != VK_SUCCESS) return 0;
+		VkCommandBufferAllocateInfo allocInfo = {0};
+		allocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+		allocInfo.commandPool = handle->bundleCommandPool;
+		allocInfo.level = VK_COMMAND_BUFFER_LEVEL_SECONDARY;
+		allocInfo.commandBufferCount = 1;
+		return vkAllocateCommandBuffers(handle->device->device, &allocInfo, &handle->commandBuffer) == VK_SUCCESS;
+	}
 
 	return 1;
 }
 
 ORBITAL_EXPORT void Orbital_Video_Vulkan_CommandList_Dispose(CommandList* handle)
 {
-	if (handle->fence != NULL)
+	if (handle->recordingContext != NULL)
 	{
-		vkDestroyFence(handle->device->device, handle->fence, NULL);
-		handle->fence = NULL;
+		Device_ReleaseRecordingContext(handle->device, handle->recordingContext);
+		handle->recordingContext = NULL;
 	}
 
-	if (handle->commandBuffer != NULL)
+	if (handle->bundleCommandPool != NULL)
 	{
-		vkFreeCommandBuffers(handle->device->device, handle->device->commandPool, 1, &handle->commandBuffer);
-		handle->commandBuffer = NULL;
+		vkDestroyCommandPool(handle->device->device, handle->bundleCommandPool, NULL);
+		handle->bundleCommandPool = NULL;
 	}
+	handle->commandBuffer = NULL;// freed with recording context or bundle pool
 }
 
 ORBITAL_EXPORT void Orbital_Video_Vulkan_CommandList_Start(CommandList* handle, Device* device)
 {
-	vkResetCommandBuffer(handle->commandBuffer, VK_COMMAND_BUFFER_RESET_RELEASE_RESOURCES_BIT);
+	// grab command pool no other thread is recording with (safe to call from worker threads)
+	handle->recordingContext = Device_AcquireRecordingContext(device, handle->type);
+	handle->commandBuffer = DeviceRecordingContext_NextCommandBuffer(device, handle->recordingContext);
+	handle->waitSwapChain = NULL;
+	handle->shaderEffect = NULL;
+	handle->boundDescriptorSet = NULL;
+	handle->boundPipelineLayout = NULL;
 
 	VkCommandBufferBeginInfo beginInfo = {0};
     beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+	beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
 	vkBeginCommandBuffer(handle->commandBuffer, &beginInfo);
 }
 
+ORBITAL_EXPORT void Orbital_Video_Vulkan_CommandList_StartBundle(CommandList* handle, RenderPass* renderPass)
+{
+	// bundle can be replayed inside any render pass compatible with the one it's recorded against
+	VkCommandBufferInheritanceInfo inheritanceInfo = {0};
+	inheritanceInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_INHERITANCE_INFO;
+	inheritanceInfo.renderPass = renderPass->renderPass;
+	inheritanceInfo.subpass = 0;
+	handle->shaderEffect = NULL;
+	handle->boundDescriptorSet = NULL;
+	handle->boundPipelineLayout = NULL;
+
+	VkCommandBufferBeginInfo beginInfo = {0};
+	beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+	beginInfo.flags = VK_COMMAND_BUFFER_USAGE_RENDER_PASS_CONTINUE_BIT | VK_COMMAND_BUFFER_USAGE_SIMULTANEOUS_USE_BIT;
+	beginInfo.pInheritanceInfo = &inheritanceInfo;
+	vkBeginCommandBuffer(handle->commandBuffer, &beginInfo);// implicitly resets the buffer
+}
+
 ORBITAL_EXPORT void Orbital_Video_Vulkan_CommandList_Finish(CommandList* handle)
 {
+	BarrierBatch_Flush(&handle->barrierBatch, handle->commandBuffer);
 	vkEndCommandBuffer(handle->commandBuffer);
+	if (handle->recordingContext == NULL) return;// bundles own their command buffer
+
+	// pool can now record another list, the command buffer stays valid until the frame completes
+	Device_ReleaseRecordingContext(handle->device, handle->recordingContext);
+	handle->recordingContext = NULL;
 }
 
 ORBITAL_EXPORT void Orbital_Video_Vulkan_CommandList_BeginRenderPass(CommandList* handle, RenderPass* renderPass)
 {
-	VkRenderPassBeginInfo renderPassBeginInfo = {0};
-	renderPassBeginInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
-	renderPassBeginInfo.renderPass = renderPass->renderPass;
-	renderPassBeginInfo.renderArea.offset.x = 0;
-	renderPassBeginInfo.renderArea.offset.y = 0;
-	renderPassBeginInfo.renderArea.extent.width = renderPass->width;
-	renderPassBeginInfo.renderArea.extent.height = renderPass->height;
-	if (renderPass->clearColor)
-	{
-		VkClearValue clearValues[1] = {0};
-		memcpy(clearValues[0].color.float32, renderPass->clearColorValue, sizeof(float) * 4);
-		renderPassBeginInfo.clearValueCount = 1;
-		renderPassBeginInfo.pClearValues = clearValues;
-	}
-	//clearValues[1].depthStencil.depth = 1.0f;
-	//clearValues[1].depthStencil.stencil = 0.0f;
-	if (renderPass->swapChain != NULL) renderPassBeginInfo.framebuffer = renderPass->frameBuffers[renderPass->swapChain->currentRenderTargetIndex];
-	else renderPassBeginInfo.framebuffer = renderPass->frameBuffers[0];
-	vkCmdBeginRenderPass(handle->commandBuffer, &renderPassBeginInfo, VK_SUBPASS_CONTENTS_INLINE);
+	if (handle->type == CommandListType_Compute) return;// compute queues may lack the graphics bit
+
+	// a subpass either records inline or only replays bundles, so begin on first use
+	handle->pendingRenderPass = renderPass;
 }
 
 ORBITAL_EXPORT void Orbital_Video_Vulkan_CommandList_EndRenderPass(CommandList* handle)
 {
+	if (handle->type == CommandListType_Compute) return;
+	CommandList_BeginPendingRenderPass(handle, VK_SUBPASS_CONTENTS_INLINE);
 	vkCmdEndRenderPass(handle->commandBuffer);
+
+	// swap-chain images leave for present (queued so a following pass on the same image folds it away)
+	RenderPass* renderPass = handle->activeRenderPass;
+	handle->activeRenderPass = NULL;
+	if (renderPass != NULL && renderPass->swapChain != NULL)
+	{
+		CommandList_TransitionSwapChain(handle, renderPass->swapChain, VK_IMAGE_LAYOUT_PRESENT_SRC_KHR, VK_PIPELINE_STAGE_2_NONE_KHR, VK_ACCESS_2_NONE_KHR, 0);
+	}
+}
+
+ORBITAL_EXPORT void Orbital_Video_Vulkan_CommandList_ExecuteBundle(CommandList* handle, CommandList* bundle)
+{
+	if (handle->type == CommandListType_Compute) return;
+	CommandList_BeginPendingRenderPass(handle, VK_SUBPASS_CONTENTS_SECONDARY_COMMAND_BUFFERS);
+	vkCmdExecuteCommands(handle->commandBuffer, 1, &bundle->commandBuffer);
+}
+
+ORBITAL_EXPORT void Orbital_Video_Vulkan_CommandList_SetRootConstants(CommandList* handle, uint32_t index, void* data, uint32_t count, uint32_t offset)
+{
+	ShaderEffect* shaderEffect = handle->shaderEffect;
+	if (shaderEffect == NULL || index >= shaderEffect->pushConstantCount) return;
+	ShaderEffectPushConstant* pushConstant = &shaderEffect->pushConstants[index];
+	if ((offset + count) * sizeof(uint32_t) > pushConstant->size) return;
+	vkCmdPushConstants(handle->commandBuffer, shaderEffect->pipelineLayout, pushConstant->stageFlags, pushConstant->offset + (offset * sizeof(uint32_t)), count * sizeof(uint32_t), data);
+}
+
+ORBITAL_EXPORT void Orbital_Video_Vulkan_CommandList_SetBindingSet(CommandList* handle, BindingSet* bindingSet)
+{
+	// compatible layouts keep the set bound across pipeline changes (compute lists bind to the compute point)
+	handle->shaderEffect = bindingSet->shaderEffect;
+	CommandList_BindDescriptorSet(handle, bindingSet->shaderEffect, bindingSet->set);
 }
 
 ORBITAL_EXPORT void Orbital_Video_Vulkan_CommandList_ClearSwapChainRenderTarget(CommandList* handle, SwapChain* swapChain, float r, float g, float b, float a)
 {
+	if (handle->type == CommandListType_Compute) return;
 	VkClearColorValue rgba;
 	rgba.float32[0] = r;
 	rgba.float32[1] = g;
 	rgba.float32[2] = b;
 	rgba.float32[3] = a;
-	vkCmdClearColorImage(handle->commandBuffer, swapChain->images[swapChain->currentRenderTargetIndex], VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL, &rgba, 1, &swapChain->subresourceRange);
+	CommandList_TransitionSwapChain(handle, swapChain, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_PIPELINE_STAGE_2_TRANSFER_BIT_KHR, VK_ACCESS_2_TRANSFER_WRITE_BIT_KHR, 1);
+	BarrierBatch_Flush(&handle->barrierBatch, handle->commandBuffer);
+	vkCmdClearColorImage(handle->commandBuffer, swapChain->images[swapChain->currentRenderTargetIndex], VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, &rgba, 1, &swapChain->subresourceRange);
 }
 
-ORBITAL_EXPORT void Orbital_Video_Vulkan_CommandList_Execute(CommandList* handle)
+ORBITAL_EXPORT uint64_t Orbital_Video_Vulkan_CommandList_Execute(CommandList* handle)
 {
-	VkPipelineStageFlags pipeStageFlags = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
+	Device* device = handle->device;
+	if (handle->type == CommandListType_Bundle) return 0;// bundles are only replayed by other lists
+	char isCompute = handle->type == CommandListType_Compute;
+	VkQueue queue = isCompute ? device->computeQueue : device->queue;
+
+	// gather GPU-side waits on transfer queue uploads and the other queue's timeline (only stages reading their resources wait)
+	VkSemaphore waitSemaphores[3];
+	uint64_t waitValues[3];
+	VkPipelineStageFlags waitStageFlags[3];
+	VkPipelineStageFlags queueWaitStageFlags = isCompute ? DEVICE_COMPUTE_QUEUE_WAIT_STAGES : DEVICE_QUEUE_WAIT_STAGES;
+	uint32_t waitCount = 0;
+	if (UploadEngine_QueueWait(&device->uploadEngine, isCompute ? &device->computeUploadWaitValue : &device->uploadWaitValue, &waitSemaphores[waitCount], &waitValues[waitCount]))
+	{
+		waitStageFlags[waitCount] = queueWaitStageFlags;
+		++waitCount;
+	}
+
+	uint64_t* queueWaitValue = isCompute ? &device->computeQueueWaitValue : &device->queueComputeWaitValue;
+	if (*queueWaitValue != 0)
+	{
+		waitSemaphores[waitCount] = isCompute ? device->semaphore : device->computeSemaphore;
+		waitValues[waitCount] = *queueWaitValue;
+		waitStageFlags[waitCount] = queueWaitStageFlags;
+		++waitCount;
+		*queueWaitValue = 0;
+	}
+
+	// first submit using an acquired swap-chain image waits for the presentation engine to release it
+	SwapChain* swapChain = handle->waitSwapChain;
+	handle->waitSwapChain = NULL;
+	if (swapChain != NULL && swapChain->acquireSemaphore != NULL)
+	{
+		waitSemaphores[waitCount] = swapChain->acquireSemaphore;
+		waitValues[waitCount] = 0;// binary semaphore
+		waitStageFlags[waitCount] = swapChain->acquireWaitStageMask;
+		++waitCount;
+		swapChain->acquireSemaphore = NULL;
+	}
+
 	VkSubmitInfo submitInfo = {0};
     submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
-    submitInfo.waitSemaphoreCount = 0;
-    submitInfo.pWaitSemaphores = VK_NULL_HANDLE;
-    submitInfo.pWaitDstStageMask = &pipeStageFlags;
+    submitInfo.waitSemaphoreCount = waitCount;
+    submitInfo.pWaitSemaphores = waitSemaphores;
+    submitInfo.pWaitDstStageMask = waitStageFlags;
     submitInfo.commandBufferCount = 1;
     submitInfo.pCommandBuffers = &handle->commandBuffer;
     submitInfo.signalSemaphoreCount = 0;
     submitInfo.pSignalSemaphores = NULL;
-	vkQueueSubmit(handle->device->queue, 1, &submitInfo, handle->fence);
-	Device_AddFence(handle->device, handle->fence);
+
+	// signal queue timeline so the submission can be waited on by ticket
+	VkTimelineSemaphoreSubmitInfoKHR timelineInfo = {0};
+	VkSemaphore signalSemaphore = isCompute ? device->computeSemaphore : device->semaphore;
+	uint64_t* signalValue = isCompute ? &device->computeSemaphoreValue : &device->semaphoreValue;
+	if (signalSemaphore != NULL)
+	{
+		++(*signalValue);
+		timelineInfo.sType = VK_STRUCTURE_TYPE_TIMELINE_SEMAPHORE_SUBMIT_INFO_KHR;
+		timelineInfo.waitSemaphoreValueCount = waitCount;
+		timelineInfo.pWaitSemaphoreValues = waitValues;
+		timelineInfo.signalSemaphoreValueCount = 1;
+		timelineInfo.pSignalSemaphoreValues = signalValue;
+		submitInfo.pNext = &timelineInfo;
+		submitInfo.signalSemaphoreCount = 1;
+		submitInfo.pSignalSemaphores = &signalSemaphore;
+	}
+
+	Device_QueueSubmit(device, queue, 1, &submitInfo, VK_NULL_HANDLE);// frame end signals completion
+	handle->fenceValue = *signalValue;
+	return handle->fenceValue;
 }
\ No newline at end of file
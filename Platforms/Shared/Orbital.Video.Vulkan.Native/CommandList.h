@@ -1,9 +1,24 @@
 #pragma once
 #include "Device.h"
+#include "RenderPass.h"
+#include "BarrierBatch.h"
+#include "ShaderEffect.h"
 
 typedef struct CommandList
 {
 	Device* device;
-	VkCommandBuffer commandBuffer;
-	VkFence fence;
-} CommandList;
\ No newline at end of file
+	CommandListType type;
+	DeviceRecordingContext* recordingContext;// held between Start and Finish
+	VkCommandBuffer commandBuffer;// owned by recording context pool, valid until the frame completes
+	uint64_t fenceValue;// queue timeline ticket of the last submission
+	RenderPass* pendingRenderPass;// begun once we know if the subpass records inline or replays bundles
+	RenderPass* activeRenderPass;
+	BarrierBatch barrierBatch;// layout transitions flushed before the next command that needs them
+	SwapChain* waitSwapChain;// swap-chain whose acquire semaphore the submit must wait on
+	VkCommandPool bundleCommandPool;// bundles own their secondary command buffer as they are replayed across frames
+	ShaderEffect* shaderEffect;// layout push constants are recorded against (bound with the render state)
+	VkDescriptorSet boundDescriptorSet;// material set last bound, binds are skipped until it changes
+	VkPipelineLayout boundPipelineLayout;
+} CommandList;
+
+void CommandList_BindDescriptorSet(CommandList* handle, ShaderEffect* shaderEffect, VkDescriptorSet set);
\ No newline at end of file
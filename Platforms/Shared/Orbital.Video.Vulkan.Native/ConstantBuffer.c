@@ -0,0 +1,93 @@
+#include "ConstantBuffer.h"
+
+ORBITAL_EXPORT ConstantBuffer* Orbital_Video_Vulkan_ConstantBuffer_Create(Device* device, ConstantBufferMode mode)
+{
+	ConstantBuffer* handle = (ConstantBuffer*)calloc(1, sizeof(ConstantBuffer));
+	handle->device = device;
+	handle->mode = mode;
+	handle->bindlessSlot.index = DESCRIPTOR_ALLOCATOR_INVALID_INDEX;
+	return handle;
+}
+
+ORBITAL_EXPORT int Orbital_Video_Vulkan_ConstantBuffer_Init(ConstantBuffer* handle, uint32_t size, void* initialData)
+{
+	handle->size = size;
+
+	// create buffer
+	MemoryUsage usage;
+	VkBufferCreateInfo bufferInfo = {0};
+	bufferInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+	bufferInfo.size = size;
+	if (handle->mode == ConstantBufferMode_GPUOptimized)
+	{
+		usage = MemoryUsage_GPU;
+		bufferInfo.usage = VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT;
+	}
+	else if (handle->mode == ConstantBufferMode_Write)
+	{
+		usage = MemoryUsage_Upload;
+		bufferInfo.usage = VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT;
+	}
+	else if (handle->mode == ConstantBufferMode_Read)
+	{
+		usage = MemoryUsage_Readback;
+		bufferInfo.usage = VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT;
+	}
+	else
+	{
+		return 0;
+	}
+	Device_GetSharingMode(handle->device, &bufferInfo.sharingMode, &bufferInfo.queueFamilyIndexCount, &bufferInfo.pQueueFamilyIndices);
+	if (!MemoryAllocator_CreateBuffer(&handle->device->memoryAllocator, &bufferInfo, usage, MemoryStrategy_TLSF, &handle->buffer, &handle->allocation)) return 0;
+
+	// write buffer into the bindless set
+	if (handle->device->descriptorAllocator.bindlessConstantBuffersSupported)
+	{
+		DescriptorBinding binding = {0};
+		binding.type = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+		binding.buffer = handle->buffer;
+		binding.range = size;
+		if (!DescriptorAllocator_AllocateBindless(&handle->device->descriptorAllocator, &binding, &handle->bindlessSlot)) return 0;
+	}
+
+	// upload initial data
+	if (initialData != NULL)
+	{
+		if (handle->allocation.data != NULL)
+		{
+			memcpy(handle->allocation.data, initialData, size);// persistently mapped coherent memory
+		}
+		else
+		{
+			// copy on transfer queue (doesn't wait for GPU, graphics queue waits on it before next submit)
+			if (UploadEngine_UploadBuffer(&handle->device->uploadEngine, handle->buffer, initialData, size) == 0) return 0;
+		}
+	}
+
+	return 1;
+}
+
+ORBITAL_EXPORT void Orbital_Video_Vulkan_ConstantBuffer_Dispose(ConstantBuffer* handle)
+{
+	if (handle->buffer != NULL)
+	{
+		DescriptorAllocator_Evict(&handle->device->descriptorAllocator, handle->buffer, NULL);
+		DescriptorAllocator_FreeBindless(&handle->device->descriptorAllocator, &handle->bindlessSlot);
+		Device_DeferDestroyBuffer(handle->device, handle->buffer, &handle->allocation);
+		handle->buffer = NULL;
+	}
+
+	free(handle);
+}
+
+ORBITAL_EXPORT uint32_t Orbital_Video_Vulkan_ConstantBuffer_GetBindlessIndex(ConstantBuffer* handle)
+{
+	return handle->bindlessSlot.index;
+}
+
+ORBITAL_EXPORT int Orbital_Video_Vulkan_ConstantBuffer_Update(ConstantBuffer* handle, void* data, uint32_t dataSize, uint32_t dstOffset)
+{
+	if (handle->allocation.data == NULL || dstOffset + dataSize > handle->size) return 0;
+	memcpy(handle->allocation.data + dstOffset, data, dataSize);
+	return 1;
+}
\ No newline at end of file
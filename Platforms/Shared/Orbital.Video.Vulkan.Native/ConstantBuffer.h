@@ -0,0 +1,12 @@
+#pragma once
+#include "Device.h"
+
+typedef struct ConstantBuffer
+{
+	Device* device;
+	ConstantBufferMode mode;
+	VkBuffer buffer;
+	MemoryAllocation allocation;// persistently mapped unless GPU optimized
+	uint32_t size;
+	DescriptorBindlessSlot bindlessSlot;// DESCRIPTOR_ALLOCATOR_INVALID_INDEX if uniform buffers can't be indexed
+} ConstantBuffer;
\ No newline at end of file
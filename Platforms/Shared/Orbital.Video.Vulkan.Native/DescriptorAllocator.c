@@ -0,0 +1,455 @@
+#include "DescriptorAllocator.h"
+#include "Device.h"
+
+int DescriptorAllocator_CreatePool(DescriptorAllocator* handle, VkDescriptorPoolCreateFlags flags, VkDescriptorPool* pool)
+{
+	VkDescriptorPoolSize poolSizes[3];
+	poolSizes[0].type = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+	poolSizes[0].descriptorCount = DESCRIPTOR_ALLOCATOR_POOL_SET_COUNT * 4;
+	poolSizes[1].type = VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE;
+	poolSizes[1].descriptorCount = DESCRIPTOR_ALLOCATOR_POOL_SET_COUNT * 4;
+	poolSizes[2].type = VK_DESCRIPTOR_TYPE_SAMPLER;// immutable samplers still take pool space
+	poolSizes[2].descriptorCount = DESCRIPTOR_ALLOCATOR_POOL_SET_COUNT * 2;
+
+	VkDescriptorPoolCreateInfo poolInfo = {0};
+	poolInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+	poolInfo.flags = flags;
+	poolInfo.maxSets = DESCRIPTOR_ALLOCATOR_POOL_SET_COUNT;
+	poolInfo.poolSizeCount = 3;
+	poolInfo.pPoolSizes = poolSizes;
+	return vkCreateDescriptorPool(handle->device->device, &poolInfo, NULL, pool) == VK_SUCCESS;
+}
+
+int DescriptorAllocator_AllocateFromChain(DescriptorAllocator* handle, DescriptorPoolChain* chain, VkDescriptorPoolCreateFlags flags, VkDescriptorSetLayout layout, VkDescriptorPool* pool, VkDescriptorSet* set)
+{
+	VkDescriptorSetAllocateInfo allocInfo = {0};
+	allocInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+	allocInfo.descriptorSetCount = 1;
+	allocInfo.pSetLayouts = &layout;
+
+	// move through the chain until a pool has room
+	for (; chain->activePool < chain->poolCount; ++chain->activePool)
+	{
+		allocInfo.descriptorPool = chain->pools[chain->activePool];
+		VkResult result = vkAllocateDescriptorSets(handle->device->device, &allocInfo, set);
+		if (result == VK_SUCCESS)
+		{
+			*pool = allocInfo.descriptorPool;
+			return 1;
+		}
+		if (result != VK_ERROR_OUT_OF_POOL_MEMORY && result != VK_ERROR_FRAGMENTED_POOL) return 0;
+	}
+
+	// every pool is full, add one (kept for the lifetime of the chain)
+	if (chain->poolCount == chain->poolCapacity)
+	{
+		chain->poolCapacity = chain->poolCapacity == 0 ? 4 : chain->poolCapacity * 2;
+		chain->pools = (VkDescriptorPool*)realloc(chain->pools, sizeof(VkDescriptorPool) * chain->poolCapacity);
+	}
+	if (!DescriptorAllocator_CreatePool(handle, flags, &chain->pools[chain->poolCount])) return 0;
+	chain->activePool = chain->poolCount;
+	++chain->poolCount;
+
+	allocInfo.descriptorPool = chain->pools[chain->activePool];
+	if (vkAllocateDescriptorSets(handle->device->device, &allocInfo, set) != VK_SUCCESS) return 0;
+	*pool = allocInfo.descriptorPool;
+	return 1;
+}
+
+void DescriptorAllocator_Write(DescriptorAllocator* handle, VkDescriptorSet set, const DescriptorBinding* bindings, uint32_t bindingCount, uint32_t arrayElement)
+{
+	VkWriteDescriptorSet* writes = alloca(sizeof(VkWriteDescriptorSet) * bindingCount);
+	VkDescriptorBufferInfo* bufferInfos = alloca(sizeof(VkDescriptorBufferInfo) * bindingCount);
+	VkDescriptorImageInfo* imageInfos = alloca(sizeof(VkDescriptorImageInfo) * bindingCount);
+	memset(writes, 0, sizeof(VkWriteDescriptorSet) * bindingCount);
+	for (uint32_t i = 0; i != bindingCount; ++i)
+	{
+		writes[i].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+		writes[i].dstSet = set;
+		writes[i].dstBinding = bindings[i].binding;
+		writes[i].dstArrayElement = arrayElement;
+		writes[i].descriptorCount = 1;
+		writes[i].descriptorType = bindings[i].type;
+		if (bindings[i].type == VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER)
+		{
+			bufferInfos[i].buffer = bindings[i].buffer;
+			bufferInfos[i].offset = bindings[i].offset;
+			bufferInfos[i].range = bindings[i].range;
+			writes[i].pBufferInfo = &bufferInfos[i];
+		}
+		else
+		{
+			imageInfos[i].sampler = NULL;
+			imageInfos[i].imageView = bindings[i].imageView;
+			imageInfos[i].imageLayout = bindings[i].imageLayout;
+			writes[i].pImageInfo = &imageInfos[i];
+		}
+	}
+	vkUpdateDescriptorSets(handle->device->device, bindingCount, writes, 0, NULL);
+}
+
+uint64_t DescriptorAllocator_HashValue(uint64_t hash, uint64_t value)
+{
+	// FNV-1a one byte at a time
+	for (uint32_t i = 0; i != 8; ++i)
+	{
+		hash ^= (value >> (i * 8)) & 0xFF;
+		hash *= 1099511628211ull;
+	}
+	return hash;
+}
+
+uint64_t DescriptorAllocator_Hash(VkDescriptorSetLayout layout, const DescriptorBinding* bindings, uint32_t bindingCount)
+{
+	// hash fields individually as the struct may contain padding
+	uint64_t hash = DescriptorAllocator_HashValue(14695981039346656037ull, (uint64_t)layout);
+	for (uint32_t i = 0; i != bindingCount; ++i)
+	{
+		hash = DescriptorAllocator_HashValue(hash, bindings[i].binding);
+		hash = DescriptorAllocator_HashValue(hash, bindings[i].type);
+		hash = DescriptorAllocator_HashValue(hash, (uint64_t)bindings[i].buffer);
+		hash = DescriptorAllocator_HashValue(hash, bindings[i].offset);
+		hash = DescriptorAllocator_HashValue(hash, bindings[i].range);
+		hash = DescriptorAllocator_HashValue(hash, (uint64_t)bindings[i].imageView);
+		hash = DescriptorAllocator_HashValue(hash, bindings[i].imageLayout);
+	}
+	return hash;
+}
+
+char DescriptorAllocator_BindingsEqual(const DescriptorBinding* a, const DescriptorBinding* b, uint32_t bindingCount)
+{
+	for (uint32_t i = 0; i != bindingCount; ++i)
+	{
+		if (a[i].binding != b[i].binding || a[i].type != b[i].type) return 0;
+		if (a[i].buffer != b[i].buffer || a[i].offset != b[i].offset || a[i].range != b[i].range) return 0;
+		if (a[i].imageView != b[i].imageView || a[i].imageLayout != b[i].imageLayout) return 0;
+	}
+	return 1;
+}
+
+void DescriptorAllocator_PushRelease(DescriptorAllocator* handle, DescriptorRelease* release)
+{
+	release->frameSerial = handle->device->frameSerial;
+	if (handle->releaseCount == handle->releaseCapacity)
+	{
+		handle->releaseCapacity = handle->releaseCapacity == 0 ? 64 : handle->releaseCapacity * 2;
+		handle->releases = (DescriptorRelease*)realloc(handle->releases, sizeof(DescriptorRelease) * handle->releaseCapacity);
+	}
+	handle->releases[handle->releaseCount] = *release;
+	++handle->releaseCount;
+}
+
+int DescriptorAllocator_Init(DescriptorAllocator* handle, struct Device* device, char bindlessSupported, char bindlessConstantBuffersSupported, uint32_t bindlessCount)
+{
+	handle->device = device;
+	InitializeCriticalSection(&handle->mutex);
+	handle->mutexInitialized = 1;
+	if (!bindlessSupported) return 1;
+
+	// one update-after-bind set every pipeline layout shares, slots are written as resources are created
+	handle->bindlessSupported = 1;
+	handle->bindlessConstantBuffersSupported = bindlessConstantBuffersSupported;
+	handle->bindlessCount = bindlessCount;
+	uint32_t bindingCount = bindlessConstantBuffersSupported ? 2 : 1;
+
+	VkDescriptorSetLayoutBinding bindings[2] = {0};
+	VkDescriptorBindingFlagsEXT bindingFlags[2];
+	VkDescriptorPoolSize poolSizes[2];
+	for (uint32_t i = 0; i != bindingCount; ++i)
+	{
+		bindings[i].binding = i == 0 ? DESCRIPTOR_BINDING_BINDLESS_TEXTURES : DESCRIPTOR_BINDING_BINDLESS_CONSTANT_BUFFERS;
+		bindings[i].descriptorType = i == 0 ? VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE : VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+		bindings[i].descriptorCount = bindlessCount;
+		bindings[i].stageFlags = VK_SHADER_STAGE_ALL_GRAPHICS;
+		bindingFlags[i] = VK_DESCRIPTOR_BINDING_UPDATE_AFTER_BIND_BIT_EXT | VK_DESCRIPTOR_BINDING_PARTIALLY_BOUND_BIT_EXT;// free slots hold stale views
+		poolSizes[i].type = bindings[i].descriptorType;
+		poolSizes[i].descriptorCount = bindlessCount;
+	}
+
+	VkDescriptorSetLayoutBindingFlagsCreateInfoEXT bindingFlagsInfo = {0};
+	bindingFlagsInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_BINDING_FLAGS_CREATE_INFO_EXT;
+	bindingFlagsInfo.bindingCount = bindingCount;
+	bindingFlagsInfo.pBindingFlags = bindingFlags;
+
+	VkDescriptorSetLayoutCreateInfo layoutInfo = {0};
+	layoutInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+	layoutInfo.pNext = &bindingFlagsInfo;
+	layoutInfo.flags = VK_DESCRIPTOR_SET_LAYOUT_CREATE_UPDATE_AFTER_BIND_POOL_BIT_EXT;
+	layoutInfo.bindingCount = bindingCount;
+	layoutInfo.pBindings = bindings;
+	if (vkCreateDescriptorSetLayout(device->device, &layoutInfo, NULL, &handle->bindlessLayout) != VK_SUCCESS) return 0;
+
+	VkDescriptorPoolCreateInfo poolInfo = {0};
+	poolInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+	poolInfo.flags = VK_DESCRIPTOR_POOL_CREATE_UPDATE_AFTER_BIND_BIT_EXT;
+	poolInfo.maxSets = 1;
+	poolInfo.poolSizeCount = bindingCount;
+	poolInfo.pPoolSizes = poolSizes;
+	if (vkCreateDescriptorPool(device->device, &poolInfo, NULL, &handle->bindlessPool) != VK_SUCCESS) return 0;
+
+	VkDescriptorSetAllocateInfo allocInfo = {0};
+	allocInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+	allocInfo.descriptorPool = handle->bindlessPool;
+	allocInfo.descriptorSetCount = 1;
+	allocInfo.pSetLayouts = &handle->bindlessLayout;
+	if (vkAllocateDescriptorSets(device->device, &allocInfo, &handle->bindlessSet) != VK_SUCCESS) return 0;
+
+	handle->bindlessGenerations = (uint32_t*)calloc(bindlessCount, sizeof(uint32_t));
+	handle->bindlessFreeSlots = (uint32_t*)malloc(sizeof(uint32_t) * bindlessCount);
+	return 1;
+}
+
+void DescriptorAllocator_Dispose(DescriptorAllocator* handle)
+{
+	// device is idle, destroying the pools frees every set in them
+	if (!handle->mutexInitialized) return;
+	for (uint32_t i = 0; i != DESCRIPTOR_ALLOCATOR_CACHE_BUCKET_COUNT; ++i)
+	{
+		DescriptorCacheEntry* entry = handle->buckets[i];
+		while (entry != NULL)
+		{
+			DescriptorCacheEntry* next = entry->next;
+			free(entry->bindings);
+			free(entry);
+			entry = next;
+		}
+		handle->buckets[i] = NULL;
+	}
+	DescriptorAllocator_DisposeFramePools(handle, &handle->cachePools);
+
+	free(handle->releases);
+	handle->releases = NULL;
+	handle->releaseCount = 0;
+
+	if (handle->bindlessPool != NULL)
+	{
+		vkDestroyDescriptorPool(handle->device->device, handle->bindlessPool, NULL);
+		handle->bindlessPool = NULL;
+	}
+
+	if (handle->bindlessLayout != NULL)
+	{
+		vkDestroyDescriptorSetLayout(handle->device->device, handle->bindlessLayout, NULL);
+		handle->bindlessLayout = NULL;
+	}
+
+	free(handle->bindlessGenerations);
+	handle->bindlessGenerations = NULL;
+	free(handle->bindlessFreeSlots);
+	handle->bindlessFreeSlots = NULL;
+
+	DeleteCriticalSection(&handle->mutex);
+	handle->mutexInitialized = 0;
+}
+
+int DescriptorAllocator_GetCachedSet(DescriptorAllocator* handle, VkDescriptorSetLayout layout, const DescriptorBinding* bindings, uint32_t bindingCount, VkDescriptorSet* set)
+{
+	uint64_t hash = DescriptorAllocator_Hash(layout, bindings, bindingCount);
+	EnterCriticalSection(&handle->mutex);
+
+	// reuse set already written with the same resources
+	DescriptorCacheEntry** bucket = &handle->buckets[hash & (DESCRIPTOR_ALLOCATOR_CACHE_BUCKET_COUNT - 1)];
+	for (DescriptorCacheEntry* entry = *bucket; entry != NULL; entry = entry->next)
+	{
+		if (entry->hash != hash || entry->layout != layout || entry->bindingCount != bindingCount) continue;
+		if (!DescriptorAllocator_BindingsEqual(entry->bindings, bindings, bindingCount)) continue;
+		++handle->cacheHits;
+		*set = entry->set;
+		LeaveCriticalSection(&handle->mutex);
+		return 1;
+	}
+
+	// write new set once, it is never updated again so any list can bind it
+	++handle->cacheMisses;
+	VkDescriptorPool pool;
+	VkDescriptorSet newSet;
+	if (!DescriptorAllocator_AllocateFromChain(handle, &handle->cachePools, VK_DESCRIPTOR_POOL_CREATE_FREE_DESCRIPTOR_SET_BIT, layout, &pool, &newSet))
+	{
+		LeaveCriticalSection(&handle->mutex);
+		return 0;
+	}
+	DescriptorAllocator_Write(handle, newSet, bindings, bindingCount, 0);
+
+	DescriptorCacheEntry* entry = (DescriptorCacheEntry*)calloc(1, sizeof(DescriptorCacheEntry));
+	entry->hash = hash;
+	entry->layout = layout;
+	entry->bindingCount = bindingCount;
+	entry->bindings = (DescriptorBinding*)malloc(sizeof(DescriptorBinding) * bindingCount);
+	memcpy(entry->bindings, bindings, sizeof(DescriptorBinding) * bindingCount);
+	entry->set = newSet;
+	entry->pool = pool;
+	entry->next = *bucket;
+	*bucket = entry;
+	++handle->cacheEntryCount;
+
+	*set = newSet;
+	LeaveCriticalSection(&handle->mutex);
+	return 1;
+}
+
+int DescriptorAllocator_AllocateFrameSet(DescriptorAllocator* handle, DescriptorPoolChain* framePools, VkDescriptorSetLayout layout, const DescriptorBinding* bindings, uint32_t bindingCount, VkDescriptorSet* set)
+{
+	// sets for resources that change every frame, released all at once when the frame's pools are reset
+	EnterCriticalSection(&handle->mutex);
+	VkDescriptorPool pool;
+	int result = DescriptorAllocator_AllocateFromChain(handle, framePools, 0, layout, &pool, set);
+	if (result) DescriptorAllocator_Write(handle, *set, bindings, bindingCount, 0);
+	LeaveCriticalSection(&handle->mutex);
+	return result;
+}
+
+void DescriptorAllocator_ResetFramePools(DescriptorAllocator* handle, DescriptorPoolChain* framePools)
+{
+	for (uint32_t i = 0; i != framePools->poolCount; ++i) vkResetDescriptorPool(handle->device->device, framePools->pools[i], 0);
+	framePools->activePool = 0;
+}
+
+void DescriptorAllocator_DisposeFramePools(DescriptorAllocator* handle, DescriptorPoolChain* framePools)
+{
+	for (uint32_t i = 0; i != framePools->poolCount; ++i) vkDestroyDescriptorPool(handle->device->device, framePools->pools[i], NULL);
+	free(framePools->pools);
+	framePools->pools = NULL;
+	framePools->poolCount = 0;
+	framePools->poolCapacity = 0;
+	framePools->activePool = 0;
+}
+
+void DescriptorAllocator_Evict(DescriptorAllocator* handle, VkBuffer buffer, VkImageView imageView)
+{
+	// drop cached sets referencing a destroyed resource, frames in flight may still bind them
+	EnterCriticalSection(&handle->mutex);
+	for (uint32_t i = 0; i != DESCRIPTOR_ALLOCATOR_CACHE_BUCKET_COUNT; ++i)
+	{
+		DescriptorCacheEntry** link = &handle->buckets[i];
+		while (*link != NULL)
+		{
+			DescriptorCacheEntry* entry = *link;
+			char referenced = 0;
+			for (uint32_t b = 0; b != entry->bindingCount && !referenced; ++b)
+			{
+				if (buffer != NULL && entry->bindings[b].buffer == buffer) referenced = 1;
+				if (imageView != NULL && entry->bindings[b].imageView == imageView) referenced = 1;
+			}
+
+			if (!referenced)
+			{
+				link = &entry->next;
+				continue;
+			}
+
+			DescriptorRelease release = {0};
+			release.pool = entry->pool;
+			release.set = entry->set;
+			release.bindlessIndex = DESCRIPTOR_ALLOCATOR_INVALID_INDEX;
+			DescriptorAllocator_PushRelease(handle, &release);
+			*link = entry->next;
+			free(entry->bindings);
+			free(entry);
+			--handle->cacheEntryCount;
+		}
+	}
+	LeaveCriticalSection(&handle->mutex);
+}
+
+void DescriptorAllocator_EvictLayout(DescriptorAllocator* handle, VkDescriptorSetLayout layout)
+{
+	// drop cached sets allocated with a layout about to be destroyed, frames in flight may still bind them
+	EnterCriticalSection(&handle->mutex);
+	for (uint32_t i = 0; i != DESCRIPTOR_ALLOCATOR_CACHE_BUCKET_COUNT; ++i)
+	{
+		DescriptorCacheEntry** link = &handle->buckets[i];
+		while (*link != NULL)
+		{
+			DescriptorCacheEntry* entry = *link;
+			if (entry->layout != layout)
+			{
+				link = &entry->next;
+				continue;
+			}
+
+			DescriptorRelease release = {0};
+			release.pool = entry->pool;
+			release.set = entry->set;
+			release.bindlessIndex = DESCRIPTOR_ALLOCATOR_INVALID_INDEX;
+			DescriptorAllocator_PushRelease(handle, &release);
+			*link = entry->next;
+			free(entry->bindings);
+			free(entry);
+			--handle->cacheEntryCount;
+		}
+	}
+	LeaveCriticalSection(&handle->mutex);
+}
+
+void DescriptorAllocator_ProcessReleases(DescriptorAllocator* handle, uint64_t completedFrameSerial)
+{
+	EnterCriticalSection(&handle->mutex);
+	uint32_t count = 0;
+	for (; count != handle->releaseCount; ++count)
+	{
+		DescriptorRelease* release = &handle->releases[count];
+		if (release->frameSerial > completedFrameSerial) break;
+		if (release->set != NULL)
+		{
+			vkFreeDescriptorSets(handle->device->device, release->pool, 1, &release->set);
+			handle->cachePools.activePool = 0;// freed set made room in an earlier pool
+		}
+		else
+		{
+			handle->bindlessFreeSlots[handle->bindlessFreeCount] = release->bindlessIndex;
+			++handle->bindlessFreeCount;
+		}
+	}
+	memmove(handle->releases, handle->releases + count, sizeof(DescriptorRelease) * (handle->releaseCount - count));
+	handle->releaseCount -= count;
+	LeaveCriticalSection(&handle->mutex);
+}
+
+int DescriptorAllocator_AllocateBindless(DescriptorAllocator* handle, const DescriptorBinding* binding, DescriptorBindlessSlot* slot)
+{
+	if (!handle->bindlessSupported) return 0;
+	if (binding->type == VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER && !handle->bindlessConstantBuffersSupported) return 0;
+
+	// reuse freed slots before growing into untouched ones
+	EnterCriticalSection(&handle->mutex);
+	uint32_t index;
+	if (handle->bindlessFreeCount != 0)
+	{
+		--handle->bindlessFreeCount;
+		index = handle->bindlessFreeSlots[handle->bindlessFreeCount];
+	}
+	else if (handle->bindlessHighWater != handle->bindlessCount)
+	{
+		index = handle->bindlessHighWater;
+		++handle->bindlessHighWater;
+	}
+	else
+	{
+		LeaveCriticalSection(&handle->mutex);
+		return 0;
+	}
+	slot->index = index;
+	slot->generation = handle->bindlessGenerations[index];
+
+	// textures and constant buffers share one index space
+	DescriptorBinding slotBinding = *binding;
+	slotBinding.binding = binding->type == VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER ? DESCRIPTOR_BINDING_BINDLESS_CONSTANT_BUFFERS : DESCRIPTOR_BINDING_BINDLESS_TEXTURES;
+	DescriptorAllocator_Write(handle, handle->bindlessSet, &slotBinding, 1, index);// update-after-bind, lists already holding the set see it
+	LeaveCriticalSection(&handle->mutex);
+	return 1;
+}
+
+void DescriptorAllocator_FreeBindless(DescriptorAllocator* handle, DescriptorBindlessSlot* slot)
+{
+	if (slot->index == DESCRIPTOR_ALLOCATOR_INVALID_INDEX) return;
+	EnterCriticalSection(&handle->mutex);
+	if (handle->bindlessGenerations[slot->index] == slot->generation)// ignore stale slots
+	{
+		++handle->bindlessGenerations[slot->index];
+		DescriptorRelease release = {0};
+		release.bindlessIndex = slot->index;
+		DescriptorAllocator_PushRelease(handle, &release);
+	}
+	LeaveCriticalSection(&handle->mutex);
+	slot->index = DESCRIPTOR_ALLOCATOR_INVALID_INDEX;
+}
\ No newline at end of file
@@ -0,0 +1,102 @@
+#pragma once
+#include "Common.h"
+
+#define DESCRIPTOR_ALLOCATOR_POOL_SET_COUNT 256
+#define DESCRIPTOR_ALLOCATOR_CACHE_BUCKET_COUNT 1024// power of two
+#define DESCRIPTOR_ALLOCATOR_BINDLESS_COUNT (32 * 1024)// clamped to the update-after-bind limits
+#define DESCRIPTOR_ALLOCATOR_INVALID_INDEX UINT32_MAX
+
+// binding numbers HLSL registers map to (dxc -fvk-b-shift 0 0 -fvk-t-shift 64 0 -fvk-s-shift 128 0)
+#define DESCRIPTOR_BINDING_CONSTANT_BUFFER_OFFSET 0
+#define DESCRIPTOR_BINDING_TEXTURE_OFFSET 64
+#define DESCRIPTOR_BINDING_SAMPLER_OFFSET 128
+
+// set 1 of every pipeline layout if VK_EXT_descriptor_indexing is enabled (mirrors D3D12 bindless spaces 1 and 2)
+#define DESCRIPTOR_SET_BINDLESS 1
+#define DESCRIPTOR_BINDING_BINDLESS_TEXTURES 0
+#define DESCRIPTOR_BINDING_BINDLESS_CONSTANT_BUFFERS 1
+
+struct Device;
+
+// resource written into one binding of a set (also the cache key)
+typedef struct DescriptorBinding
+{
+	uint32_t binding;
+	VkDescriptorType type;
+	VkBuffer buffer;
+	VkDeviceSize offset, range;
+	VkImageView imageView;
+	VkImageLayout imageLayout;
+} DescriptorBinding;
+
+// pools sets are carved from, the active one moves on once it is full
+typedef struct DescriptorPoolChain
+{
+	VkDescriptorPool* pools;
+	uint32_t poolCount, poolCapacity, activePool;
+} DescriptorPoolChain;
+
+typedef struct DescriptorCacheEntry
+{
+	uint64_t hash;
+	VkDescriptorSetLayout layout;
+	DescriptorBinding* bindings;
+	uint32_t bindingCount;
+	VkDescriptorSet set;
+	VkDescriptorPool pool;// set is freed back to it once evicted
+	struct DescriptorCacheEntry* next;// link in bucket
+} DescriptorCacheEntry;
+
+// evicted set or bindless slot waiting on frames in flight
+typedef struct DescriptorRelease
+{
+	uint64_t frameSerial;
+	VkDescriptorPool pool;
+	VkDescriptorSet set;
+	uint32_t bindlessIndex;// DESCRIPTOR_ALLOCATOR_INVALID_INDEX if a set
+} DescriptorRelease;
+
+// stable index into the bindless set, generation catches handles used after their slot was reused
+typedef struct DescriptorBindlessSlot
+{
+	uint32_t index, generation;
+} DescriptorBindlessSlot;
+
+typedef struct DescriptorAllocator
+{
+	struct Device* device;
+
+	// immutable sets shared by every binding of the same resources
+	DescriptorPoolChain cachePools;
+	DescriptorCacheEntry* buckets[DESCRIPTOR_ALLOCATOR_CACHE_BUCKET_COUNT];
+	uint32_t cacheEntryCount;
+	uint64_t cacheHits, cacheMisses;
+
+	DescriptorRelease* releases;
+	uint32_t releaseCount, releaseCapacity;
+
+	// VK_EXT_descriptor_indexing
+	char bindlessSupported, bindlessConstantBuffersSupported;
+	uint32_t bindlessCount;
+	VkDescriptorSetLayout bindlessLayout;
+	VkDescriptorPool bindlessPool;
+	VkDescriptorSet bindlessSet;
+	uint32_t* bindlessGenerations;
+	uint32_t* bindlessFreeSlots;
+	uint32_t bindlessFreeCount, bindlessHighWater;
+
+	CRITICAL_SECTION mutex;
+	char mutexInitialized;
+} DescriptorAllocator;
+
+int DescriptorAllocator_Init(DescriptorAllocator* handle, struct Device* device, char bindlessSupported, char bindlessConstantBuffersSupported, uint32_t bindlessCount);
+void DescriptorAllocator_Dispose(DescriptorAllocator* handle);
+int DescriptorAllocator_GetCachedSet(DescriptorAllocator* handle, VkDescriptorSetLayout layout, const DescriptorBinding* bindings, uint32_t bindingCount, VkDescriptorSet* set);
+int DescriptorAllocator_AllocateFrameSet(DescriptorAllocator* handle, DescriptorPoolChain* framePools, VkDescriptorSetLayout layout, const DescriptorBinding* bindings, uint32_t bindingCount, VkDescriptorSet* set);
+void DescriptorAllocator_ResetFramePools(DescriptorAllocator* handle, DescriptorPoolChain* framePools);
+void DescriptorAllocator_DisposeFramePools(DescriptorAllocator* handle, DescriptorPoolChain* framePools);
+void DescriptorAllocator_Evict(DescriptorAllocator* handle, VkBuffer buffer, VkImageView imageView);
+void DescriptorAllocator_EvictLayout(DescriptorAllocator* handle, VkDescriptorSetLayout layout);
+void DescriptorAllocator_ProcessReleases(DescriptorAllocator* handle, uint64_t completedFrameSerial);
+int DescriptorAllocator_AllocateBindless(DescriptorAllocator* handle, const DescriptorBinding* binding, DescriptorBindlessSlot* slot);
+void DescriptorAllocator_FreeBindless(DescriptorAllocator* handle, DescriptorBindlessSlot* slot);
\ No newline at end of file
@@ -1,10 +1,197 @@
 #include "Device.h"
 #include "CommandList.h"
 
-void Device_AddFence(Device* device, VkFence fence)
+int Device_CreateTimelineSemaphore(Device* device, VkSemaphore* semaphore)
 {
-	device->activeFences[device->activeFenceCount] = fence;
-	++device->activeFenceCount;
+	VkSemaphoreTypeCreateInfoKHR typeInfo = {0};
+	typeInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_TYPE_CREATE_INFO_KHR;
+	typeInfo.semaphoreType = VK_SEMAPHORE_TYPE_TIMELINE_KHR;
+	typeInfo.initialValue = 0;
+
+	VkSemaphoreCreateInfo semaphoreInfo = {0};
+	semaphoreInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
+	semaphoreInfo.pNext = &typeInfo;
+	return vkCreateSemaphore(device->device, &semaphoreInfo, NULL, semaphore) == VK_SUCCESS;
+}
+
+DeviceRecordingContext* Device_AcquireRecordingContext(Device* device, CommandListType type)
+{
+	EnterCriticalSection(&device->recordingContextMutex);
+
+	// reuse context no other list is recording with
+	DeviceRecordingContext* context = device->freeRecordingContexts[type];
+	if (context != NULL)
+	{
+		device->freeRecordingContexts[type] = context->nextFree;
+		context->nextFree = NULL;
+		LeaveCriticalSection(&device->recordingContextMutex);
+		return context;
+	}
+
+	// create new context (only happens when more lists record at once than ever before)
+	context = (DeviceRecordingContext*)calloc(1, sizeof(DeviceRecordingContext));
+	context->type = type;
+	VkCommandPoolCreateInfo poolCreateInfo = {0};
+    poolCreateInfo.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+    poolCreateInfo.queueFamilyIndex = type == CommandListType_Compute ? device->computeQueueFamilyIndex : device->queueFamilyIndex;
+    poolCreateInfo.flags = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT;
+	for (uint32_t i = 0; i != device->frameCount; ++i)
+	{
+		if (vkCreateCommandPool(device->device, &poolCreateInfo, NULL, &context->commandPools[i]) != VK_SUCCESS)
+		{
+			for (uint32_t p = 0; p != i; ++p) vkDestroyCommandPool(device->device, context->commandPools[p], NULL);
+			free(context);
+			LeaveCriticalSection(&device->recordingContextMutex);
+			return NULL;
+		}
+	}
+	context->next = device->recordingContexts;
+	device->recordingContexts = context;
+
+	LeaveCriticalSection(&device->recordingContextMutex);
+	return context;
+}
+
+void Device_ReleaseRecordingContext(Device* device, DeviceRecordingContext* context)
+{
+	EnterCriticalSection(&device->recordingContextMutex);
+	context->nextFree = device->freeRecordingContexts[context->type];
+	device->freeRecordingContexts[context->type] = context;
+	LeaveCriticalSection(&device->recordingContextMutex);
+}
+
+VkCommandBuffer DeviceRecordingContext_NextCommandBuffer(Device* device, DeviceRecordingContext* context)
+{
+	// only the thread holding the context touches its pool so no lock is needed
+	uint32_t frameIndex = device->frameIndex;
+	if (context->commandBufferUsedCounts[frameIndex] == context->commandBufferCounts[frameIndex])
+	{
+		uint32_t count = context->commandBufferCounts[frameIndex] == 0 ? 4 : context->commandBufferCounts[frameIndex] * 2;
+		VkCommandBuffer* commandBuffers = (VkCommandBuffer*)realloc(context->commandBuffers[frameIndex], sizeof(VkCommandBuffer) * count);
+		if (commandBuffers == NULL) return NULL;
+		context->commandBuffers[frameIndex] = commandBuffers;
+
+		VkCommandBufferAllocateInfo allocInfo = {0};
+		allocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+		allocInfo.commandPool = context->commandPools[frameIndex];
+		allocInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+		allocInfo.commandBufferCount = count - context->commandBufferCounts[frameIndex];
+		if (vkAllocateCommandBuffers(device->device, &allocInfo, &commandBuffers[context->commandBufferCounts[frameIndex]]) != VK_SUCCESS) return NULL;
+		context->commandBufferCounts[frameIndex] = count;
+	}
+
+	VkCommandBuffer commandBuffer = context->commandBuffers[frameIndex][context->commandBufferUsedCounts[frameIndex]];
+	++context->commandBufferUsedCounts[frameIndex];
+	return commandBuffer;
+}
+
+void Device_GetSharingMode(Device* device, VkSharingMode* sharingMode, uint32_t* queueFamilyIndexCount, const uint32_t** queueFamilyIndices)
+{
+	// resources are written on the transfer queue and read on the graphics / compute queues without ownership transfers
+	if (device->sharingQueueFamilyIndexCount > 1)
+	{
+		*sharingMode = VK_SHARING_MODE_CONCURRENT;
+		*queueFamilyIndexCount = device->sharingQueueFamilyIndexCount;
+		*queueFamilyIndices = device->sharingQueueFamilyIndices;
+	}
+	else
+	{
+		*sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+		*queueFamilyIndexCount = 0;
+		*queueFamilyIndices = NULL;
+	}
+}
+
+void Device_PushRelease(Device* device, DeviceRelease* release)
+{
+	// copies into the resource still sitting in the open upload batch must be submitted before it can go away
+	release->uploadFenceValue = UploadEngine_Flush(&device->uploadEngine);
+
+	EnterCriticalSection(&device->releaseMutex);
+	release->frameSerial = device->frameSerial;
+	if (device->releaseCount == device->releaseCapacity)
+	{
+		device->releaseCapacity = device->releaseCapacity == 0 ? 64 : device->releaseCapacity * 2;
+		device->releases = (DeviceRelease*)realloc(device->releases, sizeof(DeviceRelease) * device->releaseCapacity);
+	}
+	device->releases[device->releaseCount] = *release;
+	++device->releaseCount;
+	LeaveCriticalSection(&device->releaseMutex);
+}
+
+void Device_DeferDestroyBuffer(Device* device, VkBuffer buffer, MemoryAllocation* allocation)
+{
+	DeviceRelease release = {0};
+	release.buffer = buffer;
+	release.allocation = *allocation;
+	Device_PushRelease(device, &release);
+	memset(allocation, 0, sizeof(MemoryAllocation));
+}
+
+void Device_DeferDestroyImage(Device* device, VkImage image, VkImageView imageView, MemoryAllocation* allocation)
+{
+	DeviceRelease release = {0};
+	release.image = image;
+	release.imageView = imageView;
+	release.allocation = *allocation;
+	Device_PushRelease(device, &release);
+	memset(allocation, 0, sizeof(MemoryAllocation));
+}
+
+void Device_DeferDestroySampler(Device* device, VkSampler sampler)
+{
+	DeviceRelease release = {0};
+	release.sampler = sampler;
+	Device_PushRelease(device, &release);
+}
+
+void Device_ProcessReleases(Device* device, uint64_t completedFrameSerial)
+{
+	EnterCriticalSection(&device->releaseMutex);
+	if (device->releaseCount == 0)
+	{
+		LeaveCriticalSection(&device->releaseMutex);
+		return;
+	}
+
+	// destroy in order until one may still be in use
+	uint64_t completedUploadFenceValue = UploadEngine_GetCompletedFenceValue(&device->uploadEngine);
+	uint32_t count = 0;
+	for (; count != device->releaseCount; ++count)
+	{
+		DeviceRelease* release = &device->releases[count];
+		if (release->frameSerial > completedFrameSerial || release->uploadFenceValue > completedUploadFenceValue) break;
+		if (release->imageView != NULL) vkDestroyImageView(device->device, release->imageView, NULL);
+		if (release->image != NULL) vkDestroyImage(device->device, release->image, NULL);
+		if (release->buffer != NULL) vkDestroyBuffer(device->device, release->buffer, NULL);
+		if (release->sampler != NULL) vkDestroySampler(device->device, release->sampler, NULL);
+		MemoryAllocator_Free(&device->memoryAllocator, &release->allocation);
+	}
+	memmove(device->releases, device->releases + count, sizeof(DeviceRelease) * (device->releaseCount - count));
+	device->releaseCount -= count;
+	LeaveCriticalSection(&device->releaseMutex);
+}
+
+uint32_t Device_ReserveQueue(VkQueueFamilyProperties* queueFamilyProperties, uint32_t* queueCounts, uint32_t queueFamilyIndex)
+{
+	// share first queue of family once it runs out of queues
+	if (queueCounts[queueFamilyIndex] == queueFamilyProperties[queueFamilyIndex].queueCount) return 0;
+	uint32_t queueIndex = queueCounts[queueFamilyIndex];
+	++queueCounts[queueFamilyIndex];
+	return queueIndex;
+}
+
+int Device_FindMemoryType(Device* device, uint32_t typeBits, VkMemoryPropertyFlags properties, uint32_t* memoryTypeIndex)
+{
+	for (uint32_t i = 0; i != device->memoryProperties.memoryTypeCount; ++i)
+	{
+		if ((typeBits & (1 << i)) != 0 && (device->memoryProperties.memoryTypes[i].propertyFlags & properties) == properties)
+		{
+			*memoryTypeIndex = i;
+			return 1;
+		}
+	}
+	return 0;
 }
 
 ORBITAL_EXPORT Device* Orbital_Video_Vulkan_Device_Create(Instance* instance, DeviceType type)
@@ -12,11 +199,20 @@ ORBITAL_EXPORT Device* Orbital_Video_Vulkan_Device_Create(Instance* instance, De
 	Device* handle = (Device*)calloc(1, sizeof(Device));
 	handle->instance = instance;
 	handle->type = type;
+	handle->frameSerial = 1;
+	InitializeCriticalSection(&handle->recordingContextMutex);
+	InitializeCriticalSection(&handle->releaseMutex);
+	for (uint32_t i = 0; i != 3; ++i) InitializeCriticalSection(&handle->queueMutexes[i]);
 	return handle;
 }
 
-ORBITAL_EXPORT int Orbital_Video_Vulkan_Device_Init(Device* handle, int adapterIndex)
+ORBITAL_EXPORT int Orbital_Video_Vulkan_Device_Init(Device* handle, int adapterIndex, int frameCount)
 {
+	// validate frames in flight
+	if (frameCount <= 0) frameCount = DEVICE_DEFAULT_FRAME_COUNT;
+	if (frameCount > DEVICE_MAX_FRAME_COUNT) return 0;
+	handle->frameCount = frameCount;
+
 	// -1 adapter defaults to 0
 	if (adapterIndex == -1) adapterIndex = 0;
 
@@ -47,6 +243,10 @@ ORBITAL_EXPORT int Orbital_Video_Vulkan_Device_Init(Device* handle, int adapterI
 	VkPhysicalDeviceProperties physicalDeviceProperties = {0};
 	vkGetPhysicalDeviceProperties(handle->physicalDevice, &physicalDeviceProperties);
 	handle->nativeFeatureLevel = physicalDeviceProperties.apiVersion;
+	handle->limits = physicalDeviceProperties.limits;
+	handle->vendorID = physicalDeviceProperties.vendorID;
+	handle->deviceID = physicalDeviceProperties.deviceID;
+	memcpy(handle->pipelineCacheUUID, physicalDeviceProperties.pipelineCacheUUID, VK_UUID_SIZE);
 
 	// validate max isn't less than min
 	if (handle->nativeFeatureLevel < handle->instance->nativeMinFeatureLevel) return 0;
@@ -60,6 +260,7 @@ ORBITAL_EXPORT int Orbital_Video_Vulkan_Device_Init(Device* handle, int adapterI
 
 	// get device features
     vkGetPhysicalDeviceFeatures(handle->physicalDevice, &handle->physicalDeviceFeatures);
+	vkGetPhysicalDeviceMemoryProperties(handle->physicalDevice, &handle->memoryProperties);
 	
 	// get supported extensions for device
 	uint32_t extensionPropertiesCount = 0;
@@ -94,6 +295,101 @@ ORBITAL_EXPORT int Orbital_Video_Vulkan_Device_Init(Device* handle, int adapterI
 		if (expectedExtensionCount != initExtensionCount) return 0;
 	}
 
+	// enable timeline semaphores if supported (used to sync transfer queue uploads)
+	VkPhysicalDeviceTimelineSemaphoreFeaturesKHR timelineSemaphoreFeatures = {0};
+	timelineSemaphoreFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_TIMELINE_SEMAPHORE_FEATURES_KHR;
+	if (handle->instance->nativeMaxFeatureLevel >= VK_API_VERSION_1_1)
+	{
+		for (uint32_t i = 0; i != extensionPropertiesCount; ++i)
+		{
+			if (strcmp(extensionProperties[i].extensionName, VK_KHR_TIMELINE_SEMAPHORE_EXTENSION_NAME) != 0) continue;
+
+			VkPhysicalDeviceFeatures2 features = {0};
+			features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2;
+			features.pNext = &timelineSemaphoreFeatures;
+			vkGetPhysicalDeviceFeatures2(handle->physicalDevice, &features);
+			if (timelineSemaphoreFeatures.timelineSemaphore)
+			{
+				initExtensions[initExtensionCount] = extensionProperties[i].extensionName;
+				++initExtensionCount;
+				handle->timelineSemaphoreSupported = 1;
+			}
+			break;
+		}
+	}
+
+	// enable synchronization2 if supported (used for image layout barriers)
+	VkPhysicalDeviceSynchronization2FeaturesKHR synchronization2Features = {0};
+	synchronization2Features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_SYNCHRONIZATION_2_FEATURES_KHR;
+	if (handle->instance->nativeMaxFeatureLevel >= VK_API_VERSION_1_1)
+	{
+		for (uint32_t i = 0; i != extensionPropertiesCount; ++i)
+		{
+			if (strcmp(extensionProperties[i].extensionName, VK_KHR_SYNCHRONIZATION_2_EXTENSION_NAME) != 0) continue;
+
+			VkPhysicalDeviceFeatures2 features = {0};
+			features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2;
+			features.pNext = &synchronization2Features;
+			vkGetPhysicalDeviceFeatures2(handle->physicalDevice, &features);
+			if (synchronization2Features.synchronization2)
+			{
+				initExtensions[initExtensionCount] = extensionProperties[i].extensionName;
+				++initExtensionCount;
+				handle->synchronization2Supported = 1;
+			}
+			break;
+		}
+	}
+
+	// enable descriptor indexing if supported (used for the bindless set)
+	VkPhysicalDeviceDescriptorIndexingFeaturesEXT descriptorIndexingFeatures = {0};
+	descriptorIndexingFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DESCRIPTOR_INDEXING_FEATURES_EXT;
+	char bindlessConstantBuffersSupported = 0;
+	uint32_t bindlessCount = 0;
+	if (handle->instance->nativeMaxFeatureLevel >= VK_API_VERSION_1_1)
+	{
+		for (uint32_t i = 0; i != extensionPropertiesCount; ++i)
+		{
+			if (strcmp(extensionProperties[i].extensionName, VK_EXT_DESCRIPTOR_INDEXING_EXTENSION_NAME) != 0) continue;
+
+			VkPhysicalDeviceFeatures2 features = {0};
+			features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2;
+			features.pNext = &descriptorIndexingFeatures;
+			vkGetPhysicalDeviceFeatures2(handle->physicalDevice, &features);
+
+			VkPhysicalDeviceDescriptorIndexingPropertiesEXT descriptorIndexingProperties = {0};
+			descriptorIndexingProperties.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DESCRIPTOR_INDEXING_PROPERTIES_EXT;
+			VkPhysicalDeviceProperties2 properties = {0};
+			properties.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PROPERTIES_2;
+			properties.pNext = &descriptorIndexingProperties;
+			vkGetPhysicalDeviceProperties2(handle->physicalDevice, &properties);
+
+			// leave headroom for the per material set which shares the stage limits
+			bindlessCount = DESCRIPTOR_ALLOCATOR_BINDLESS_COUNT;
+			uint32_t sampledImageLimit = descriptorIndexingProperties.maxPerStageDescriptorUpdateAfterBindSampledImages;
+			if (descriptorIndexingProperties.maxDescriptorSetUpdateAfterBindSampledImages < sampledImageLimit) sampledImageLimit = descriptorIndexingProperties.maxDescriptorSetUpdateAfterBindSampledImages;
+			if (sampledImageLimit < bindlessCount + DESCRIPTOR_BINDING_SAMPLER_OFFSET) bindlessCount = sampledImageLimit > DESCRIPTOR_BINDING_SAMPLER_OFFSET ? sampledImageLimit - DESCRIPTOR_BINDING_SAMPLER_OFFSET : 0;
+			if
+			(
+				descriptorIndexingFeatures.runtimeDescriptorArray &&
+				descriptorIndexingFeatures.descriptorBindingPartiallyBound &&
+				descriptorIndexingFeatures.descriptorBindingSampledImageUpdateAfterBind &&
+				bindlessCount != 0
+			)
+			{
+				initExtensions[initExtensionCount] = extensionProperties[i].extensionName;
+				++initExtensionCount;
+				handle->descriptorIndexingSupported = 1;
+
+				// uniform buffer limits are usually far lower, only index them if the whole range fits
+				uint32_t uniformBufferLimit = descriptorIndexingProperties.maxPerStageDescriptorUpdateAfterBindUniformBuffers;
+				if (descriptorIndexingProperties.maxDescriptorSetUpdateAfterBindUniformBuffers < uniformBufferLimit) uniformBufferLimit = descriptorIndexingProperties.maxDescriptorSetUpdateAfterBindUniformBuffers;
+				bindlessConstantBuffersSupported = descriptorIndexingFeatures.descriptorBindingUniformBufferUpdateAfterBind && uniformBufferLimit >= bindlessCount + DESCRIPTOR_BINDING_TEXTURE_OFFSET;
+			}
+			break;
+		}
+	}
+
 	// make sure device supports all command queue types
 	uint32_t queueFamilyCount = 0;
 	vkGetPhysicalDeviceQueueFamilyProperties(handle->physicalDevice, &queueFamilyCount, NULL);
@@ -102,30 +398,87 @@ ORBITAL_EXPORT int Orbital_Video_Vulkan_Device_Init(Device* handle, int adapterI
 	VkQueueFamilyProperties* queueFamilyProperties = alloca(sizeof(VkQueueFamilyProperties) * queueFamilyCount);
     vkGetPhysicalDeviceQueueFamilyProperties(handle->physicalDevice, &queueFamilyCount, queueFamilyProperties);
 	int foundQueueFamilyIndex = -1;
+	int foundTransferQueueFamilyIndex = -1;
+	int foundComputeQueueFamilyIndex = -1;
     for (uint32_t i = 0; i != queueFamilyCount; ++i)
 	{
-		VkQueueFlags flags = queueFamilyProperties->queueFlags;
-		if ((flags & VK_QUEUE_GRAPHICS_BIT) != 0 && (flags & VK_QUEUE_COMPUTE_BIT) != 0 && (flags & VK_QUEUE_TRANSFER_BIT) != 0)
+		VkQueueFlags flags = queueFamilyProperties[i].queueFlags;
+		if (foundQueueFamilyIndex == -1 && (flags & VK_QUEUE_GRAPHICS_BIT) != 0 && (flags & VK_QUEUE_COMPUTE_BIT) != 0 && (flags & VK_QUEUE_TRANSFER_BIT) != 0)
 		{
 			foundQueueFamilyIndex = i;
-			break;
+		}
+		else if (foundTransferQueueFamilyIndex == -1 && (flags & VK_QUEUE_TRANSFER_BIT) != 0 && (flags & VK_QUEUE_GRAPHICS_BIT) == 0 && (flags & VK_QUEUE_COMPUTE_BIT) == 0)
+		{
+			foundTransferQueueFamilyIndex = i;// dedicated DMA queue
+		}
+		else if (foundComputeQueueFamilyIndex == -1 && (flags & VK_QUEUE_COMPUTE_BIT) != 0 && (flags & VK_QUEUE_GRAPHICS_BIT) == 0)
+		{
+			foundComputeQueueFamilyIndex = i;// dedicated async compute queue
 		}
 	}
 	if (foundQueueFamilyIndex == -1) return 0;
 	handle->queueFamilyIndex = foundQueueFamilyIndex;
 
+	// use extra graphics queues for uploads and compute if there are no dedicated families (falls back to sharing the graphics queue)
+	if (foundTransferQueueFamilyIndex == -1) foundTransferQueueFamilyIndex = foundQueueFamilyIndex;
+	if (foundComputeQueueFamilyIndex == -1) foundComputeQueueFamilyIndex = foundQueueFamilyIndex;
+	handle->transferQueueFamilyIndex = foundTransferQueueFamilyIndex;
+	handle->computeQueueFamilyIndex = foundComputeQueueFamilyIndex;
+
+	handle->sharingQueueFamilyIndices[0] = foundQueueFamilyIndex;
+	handle->sharingQueueFamilyIndexCount = 1;
+	if (foundTransferQueueFamilyIndex != foundQueueFamilyIndex)
+	{
+		handle->sharingQueueFamilyIndices[handle->sharingQueueFamilyIndexCount] = foundTransferQueueFamilyIndex;
+		++handle->sharingQueueFamilyIndexCount;
+	}
+	if (foundComputeQueueFamilyIndex != foundQueueFamilyIndex && foundComputeQueueFamilyIndex != foundTransferQueueFamilyIndex)
+	{
+		handle->sharingQueueFamilyIndices[handle->sharingQueueFamilyIndexCount] = foundComputeQueueFamilyIndex;
+		++handle->sharingQueueFamilyIndexCount;
+	}
+
+	uint32_t* queueCounts = alloca(sizeof(uint32_t) * queueFamilyCount);
+	memset(queueCounts, 0, sizeof(uint32_t) * queueFamilyCount);
+	uint32_t queueIndex = Device_ReserveQueue(queueFamilyProperties, queueCounts, foundQueueFamilyIndex);
+	uint32_t transferQueueIndex = Device_ReserveQueue(queueFamilyProperties, queueCounts, foundTransferQueueFamilyIndex);
+	uint32_t computeQueueIndex = Device_ReserveQueue(queueFamilyProperties, queueCounts, foundComputeQueueFamilyIndex);
+
 	// create device
-    float queuePriorities = 0;
-    VkDeviceQueueCreateInfo queueCreateInfo[1] = {0};
-    queueCreateInfo[0].sType = VK_STRUCTURE_TYPE_DEVICE_QUEUE_CREATE_INFO;
-    queueCreateInfo[0].queueFamilyIndex = foundQueueFamilyIndex;
-    queueCreateInfo[0].queueCount = 1;
-    queueCreateInfo[0].pQueuePriorities = &queuePriorities;
-    queueCreateInfo[0].flags = 0;
+    float queuePriorities[3] = {0, 0, 0};
+    VkDeviceQueueCreateInfo queueCreateInfo[3] = {0};
+	uint32_t queueCreateInfoCount = 0;
+	for (uint32_t i = 0; i != queueFamilyCount; ++i)
+	{
+		if (queueCounts[i] == 0) continue;
+		queueCreateInfo[queueCreateInfoCount].sType = VK_STRUCTURE_TYPE_DEVICE_QUEUE_CREATE_INFO;
+		queueCreateInfo[queueCreateInfoCount].queueFamilyIndex = i;
+		queueCreateInfo[queueCreateInfoCount].queueCount = queueCounts[i];
+		queueCreateInfo[queueCreateInfoCount].pQueuePriorities = queuePriorities;
+		queueCreateInfo[queueCreateInfoCount].flags = 0;
+		++queueCreateInfoCount;
+	}
 
     VkDeviceCreateInfo deviceInfo = {0};
     deviceInfo.sType = VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO;
-    deviceInfo.queueCreateInfoCount = 1;
+	void* featuresChain = NULL;
+	if (handle->timelineSemaphoreSupported)
+	{
+		timelineSemaphoreFeatures.pNext = featuresChain;
+		featuresChain = &timelineSemaphoreFeatures;
+	}
+	if (handle->synchronization2Supported)
+	{
+		synchronization2Features.pNext = featuresChain;
+		featuresChain = &synchronization2Features;
+	}
+	if (handle->descriptorIndexingSupported)
+	{
+		descriptorIndexingFeatures.pNext = featuresChain;
+		featuresChain = &descriptorIndexingFeatures;
+	}
+	deviceInfo.pNext = featuresChain;
+    deviceInfo.queueCreateInfoCount = queueCreateInfoCount;
     deviceInfo.pQueueCreateInfos = queueCreateInfo;
     deviceInfo.enabledLayerCount = 0;
     deviceInfo.ppEnabledLayerNames = NULL;
@@ -134,24 +487,120 @@ ORBITAL_EXPORT int Orbital_Video_Vulkan_Device_Init(Device* handle, int adapterI
     deviceInfo.pEnabledFeatures = NULL;
 
 	if (vkCreateDevice(handle->physicalDevice, &deviceInfo, NULL, &handle->device) != VK_SUCCESS) return 0;
-	vkGetDeviceQueue(handle->device, foundQueueFamilyIndex, 0, &handle->queue);
-	
-	// create command pool
-	VkCommandPoolCreateInfo poolCreateInfo = {0};
-    poolCreateInfo.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
-    poolCreateInfo.queueFamilyIndex = foundQueueFamilyIndex;
-    poolCreateInfo.flags = VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT;
-	if (vkCreateCommandPool(handle->device, &poolCreateInfo, NULL, &handle->commandPool) != VK_SUCCESS) return 0;
+	vkGetDeviceQueue(handle->device, foundQueueFamilyIndex, queueIndex, &handle->queue);
+	vkGetDeviceQueue(handle->device, foundTransferQueueFamilyIndex, transferQueueIndex, &handle->transferQueue);
+	vkGetDeviceQueue(handle->device, foundComputeQueueFamilyIndex, computeQueueIndex, &handle->computeQueue);
+
+	// get timeline semaphore functions
+	if (handle->timelineSemaphoreSupported)
+	{
+		handle->vkGetSemaphoreCounterValueKHR = (PFN_vkGetSemaphoreCounterValueKHR)vkGetDeviceProcAddr(handle->device, "vkGetSemaphoreCounterValueKHR");
+		handle->vkWaitSemaphoresKHR = (PFN_vkWaitSemaphoresKHR)vkGetDeviceProcAddr(handle->device, "vkWaitSemaphoresKHR");
+		if (handle->vkGetSemaphoreCounterValueKHR == NULL || handle->vkWaitSemaphoresKHR == NULL) return 0;
+
+		// create queue timelines
+		if (!Device_CreateTimelineSemaphore(handle, &handle->semaphore)) return 0;
+		if (!Device_CreateTimelineSemaphore(handle, &handle->computeSemaphore)) return 0;
+	}
+	else
+	{
+		// fall back to fences signaled at the end of each frame
+		VkFenceCreateInfo fenceInfo = {0};
+		fenceInfo.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
+		for (uint32_t i = 0; i != handle->frameCount; ++i)
+		{
+			if (vkCreateFence(handle->device, &fenceInfo, NULL, &handle->frames[i].fence) != VK_SUCCESS) return 0;
+			if (vkCreateFence(handle->device, &fenceInfo, NULL, &handle->frames[i].computeFence) != VK_SUCCESS) return 0;
+		}
+	}
+
+	// get synchronization2 functions
+	if (handle->synchronization2Supported)
+	{
+		handle->vkCmdPipelineBarrier2KHR = (PFN_vkCmdPipelineBarrier2KHR)vkGetDeviceProcAddr(handle->device, "vkCmdPipelineBarrier2KHR");
+		if (handle->vkCmdPipelineBarrier2KHR == NULL) handle->synchronization2Supported = 0;
+	}
+
+	// create memory allocator
+	if (!MemoryAllocator_Init(&handle->memoryAllocator, handle)) return 0;
+
+	// create upload engine (staging memory comes from the allocator)
+	if (!UploadEngine_Init(&handle->uploadEngine, handle)) return 0;
+
+	// create descriptor allocator
+	if (!DescriptorAllocator_Init(&handle->descriptorAllocator, handle, handle->descriptorIndexingSupported, bindlessConstantBuffersSupported, bindlessCount)) return 0;
+
+	// create pipeline cache (data of previous runs is merged in by LoadPipelineCache)
+	VkPipelineCacheCreateInfo pipelineCacheInfo = {0};
+	pipelineCacheInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO;
+	if (vkCreatePipelineCache(handle->device, &pipelineCacheInfo, NULL, &handle->pipelineCache) != VK_SUCCESS) return 0;
 
 	return 1;
 }
 
 ORBITAL_EXPORT void Orbital_Video_Vulkan_Device_Dispose(Device* handle)
 {
-	if (handle->commandPool != NULL)
+	if (handle->device != NULL)
 	{
-		vkDestroyCommandPool(handle->device, handle->commandPool, NULL);
-		handle->commandPool = NULL;
+		Device_WaitIdle(handle);
+		Device_ProcessReleases(handle, UINT64_MAX);
+		DescriptorAllocator_ProcessReleases(&handle->descriptorAllocator, UINT64_MAX);
+		for (uint32_t i = 0; i != handle->frameCount; ++i) DescriptorAllocator_DisposeFramePools(&handle->descriptorAllocator, &handle->frames[i].descriptorPools);
+		DescriptorAllocator_Dispose(&handle->descriptorAllocator);
+		UploadEngine_Dispose(&handle->uploadEngine);
+		MemoryAllocator_Dispose(&handle->memoryAllocator);
+		if (handle->pipelineCache != NULL)
+		{
+			vkDestroyPipelineCache(handle->device, handle->pipelineCache, NULL);
+			handle->pipelineCache = NULL;
+		}
+	}
+	free(handle->releases);
+	handle->releases = NULL;
+	DeleteCriticalSection(&handle->releaseMutex);
+
+	// dispose recording contexts
+	DeviceRecordingContext* context = handle->recordingContexts;
+	while (context != NULL)
+	{
+		DeviceRecordingContext* next = context->next;
+		for (uint32_t i = 0; i != handle->frameCount; ++i)
+		{
+			vkDestroyCommandPool(handle->device, context->commandPools[i], NULL);// frees command buffers
+			free(context->commandBuffers[i]);
+		}
+		free(context);
+		context = next;
+	}
+	handle->recordingContexts = NULL;
+	DeleteCriticalSection(&handle->recordingContextMutex);
+
+	// dispose frame fences
+	for (uint32_t i = 0; i != handle->frameCount; ++i)
+	{
+		DeviceFrame* frame = &handle->frames[i];
+		if (frame->fence != NULL)
+		{
+			vkDestroyFence(handle->device, frame->fence, NULL);
+			frame->fence = NULL;
+		}
+		if (frame->computeFence != NULL)
+		{
+			vkDestroyFence(handle->device, frame->computeFence, NULL);
+			frame->computeFence = NULL;
+		}
+	}
+
+	if (handle->computeSemaphore != NULL)
+	{
+		vkDestroySemaphore(handle->device, handle->computeSemaphore, NULL);
+		handle->computeSemaphore = NULL;
+	}
+
+	if (handle->semaphore != NULL)
+	{
+		vkDestroySemaphore(handle->device, handle->semaphore, NULL);
+		handle->semaphore = NULL;
 	}
 
 	if (handle->device != NULL)
@@ -159,22 +608,169 @@ ORBITAL_EXPORT void Orbital_Video_Vulkan_Device_Dispose(Device* handle)
 		vkDestroyDevice(handle->device, NULL);
 		handle->device = NULL;
 	}
+	for (uint32_t i = 0; i != 3; ++i) DeleteCriticalSection(&handle->queueMutexes[i]);
 	
 	free(handle);
 }
 
+CRITICAL_SECTION* Device_GetQueueMutex(Device* device, VkQueue queue)
+{
+	if (queue == device->queue) return &device->queueMutexes[0];
+	if (queue == device->transferQueue) return &device->queueMutexes[1];
+	return &device->queueMutexes[2];
+}
+
+VkResult Device_QueueSubmit(Device* device, VkQueue queue, uint32_t submitCount, const VkSubmitInfo* submits, VkFence fence)
+{
+	CRITICAL_SECTION* mutex = Device_GetQueueMutex(device, queue);
+	EnterCriticalSection(mutex);
+	VkResult result = vkQueueSubmit(queue, submitCount, submits, fence);
+	LeaveCriticalSection(mutex);
+	return result;
+}
+
+VkResult Device_QueueWaitIdle(Device* device, VkQueue queue)
+{
+	CRITICAL_SECTION* mutex = Device_GetQueueMutex(device, queue);
+	EnterCriticalSection(mutex);
+	VkResult result = vkQueueWaitIdle(queue);
+	LeaveCriticalSection(mutex);
+	return result;
+}
+
+void Device_WaitIdle(Device* device)
+{
+	// vkDeviceWaitIdle needs external sync on every queue
+	for (uint32_t i = 0; i != 3; ++i) EnterCriticalSection(&device->queueMutexes[i]);
+	vkDeviceWaitIdle(device->device);
+	for (uint32_t i = 3; i != 0; --i) LeaveCriticalSection(&device->queueMutexes[i - 1]);
+}
+
+void Device_SignalFrame(Device* device, VkQueue queue, VkSemaphore semaphore, uint64_t* semaphoreValue, VkFence fence, uint64_t* frameSemaphoreValue)
+{
+	// empty submit orders after everything already on the queue (including present)
+	VkSubmitInfo submitInfo = {0};
+	submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+	VkTimelineSemaphoreSubmitInfoKHR timelineInfo = {0};
+	if (semaphore != NULL)
+	{
+		++(*semaphoreValue);
+		timelineInfo.sType = VK_STRUCTURE_TYPE_TIMELINE_SEMAPHORE_SUBMIT_INFO_KHR;
+		timelineInfo.signalSemaphoreValueCount = 1;
+		timelineInfo.pSignalSemaphoreValues = semaphoreValue;
+		submitInfo.pNext = &timelineInfo;
+		submitInfo.signalSemaphoreCount = 1;
+		submitInfo.pSignalSemaphores = &semaphore;
+		*frameSemaphoreValue = *semaphoreValue;
+	}
+	Device_QueueSubmit(device, queue, 1, &submitInfo, fence);
+}
+
 ORBITAL_EXPORT void Orbital_Video_Vulkan_Device_BeginFrame(Device* handle)
 {
-	if (handle->activeFenceCount != 0)
+	// only blocks if the ring wrapped onto a frame the GPU hasn't finished yet
+	DeviceFrame* frame = &handle->frames[handle->frameIndex];
+	if (handle->semaphore != NULL)
+	{
+		VkSemaphore semaphores[2] = {handle->semaphore, handle->computeSemaphore};
+		uint64_t values[2] = {frame->semaphoreValue, frame->computeSemaphoreValue};
+		VkSemaphoreWaitInfoKHR waitInfo = {0};
+		waitInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_WAIT_INFO_KHR;
+		waitInfo.semaphoreCount = 2;
+		waitInfo.pSemaphores = semaphores;
+		waitInfo.pValues = values;
+		handle->vkWaitSemaphoresKHR(handle->device, &waitInfo, UINT64_MAX);
+	}
+	else if (frame->fencesPending)
 	{
-		vkResetFences(handle->device, handle->activeFenceCount, &handle->activeFences);
-		handle->activeFenceCount = 0;
+		VkFence fences[2] = {frame->fence, frame->computeFence};
+		vkWaitForFences(handle->device, 2, fences, VK_TRUE, UINT64_MAX);
+		vkResetFences(handle->device, 2, fences);
+		frame->fencesPending = 0;
 	}
+	Device_ProcessReleases(handle, frame->serial);
+	DescriptorAllocator_ProcessReleases(&handle->descriptorAllocator, frame->serial);
+	DescriptorAllocator_ResetFramePools(&handle->descriptorAllocator, &frame->descriptorPools);
+
+	// recycle command buffers of the completed frame
+	EnterCriticalSection(&handle->recordingContextMutex);
+	for (DeviceRecordingContext* context = handle->recordingContexts; context != NULL; context = context->next)
+	{
+		vkResetCommandPool(handle->device, context->commandPools[handle->frameIndex], 0);
+		context->commandBufferUsedCounts[handle->frameIndex] = 0;
+	}
+	LeaveCriticalSection(&handle->recordingContextMutex);
 }
 
 ORBITAL_EXPORT void Orbital_Video_Vulkan_Device_EndFrame(Device* handle)
 {
-	if (handle->activeFenceCount != 0) vkWaitForFences(handle->device, handle->activeFenceCount, &handle->activeFences, VK_TRUE, UINT64_MAX);
-	vkQueueWaitIdle(handle->queue);
-	vkDeviceWaitIdle(handle->device);
+	// mark end of frame on the queue timelines without waiting for it
+	DeviceFrame* frame = &handle->frames[handle->frameIndex];
+	Device_SignalFrame(handle, handle->queue, handle->semaphore, &handle->semaphoreValue, frame->fence, &frame->semaphoreValue);
+	Device_SignalFrame(handle, handle->computeQueue, handle->computeSemaphore, &handle->computeSemaphoreValue, frame->computeFence, &frame->computeSemaphoreValue);
+	frame->fencesPending = handle->semaphore == NULL;
+	frame->serial = handle->frameSerial;
+	++handle->frameSerial;
+
+	// move to next frame in ring
+	handle->frameIndex = (handle->frameIndex + 1) % handle->frameCount;
+}
+
+ORBITAL_EXPORT void Orbital_Video_Vulkan_Device_QueueWaitForFenceTicket(Device* handle, CommandListType type, CommandListType ticketType, uint64_t ticket)
+{
+	// without timelines there is nothing to wait on GPU-side so finish the other queue now
+	if (handle->semaphore == NULL)
+	{
+		Device_QueueWaitIdle(handle, ticketType == CommandListType_Compute ? handle->computeQueue : handle->queue);
+		return;
+	}
+
+	// attached to the next submit of the waiting queue (waits on its own queue are implicit)
+	if (type == ticketType) return;
+	if (type == CommandListType_Compute)
+	{
+		if (ticket > handle->computeQueueWaitValue) handle->computeQueueWaitValue = ticket;
+	}
+	else
+	{
+		if (ticket > handle->queueComputeWaitValue) handle->queueComputeWaitValue = ticket;
+	}
+}
+
+ORBITAL_EXPORT void Orbital_Video_Vulkan_Device_GetMemoryAllocatorStats(Device* handle, MemoryAllocatorStats* stats)
+{
+	MemoryAllocator_GetStats(&handle->memoryAllocator, stats);
+}
+
+ORBITAL_EXPORT int Orbital_Video_Vulkan_Device_LoadPipelineCache(Device* handle, void* data, uint64_t size)
+{
+	// drivers silently ignore data of another driver or device, check the header so the caller knows
+	// (headerSize, headerVersion, vendorID, deviceID, pipelineCacheUUID)
+	const uint32_t headerSize = sizeof(uint32_t) * 4 + VK_UUID_SIZE;
+	if (size < headerSize) return 0;
+	uint32_t header[4];
+	memcpy(header, data, sizeof(uint32_t) * 4);
+	if (header[0] < headerSize || header[1] != VK_PIPELINE_CACHE_HEADER_VERSION_ONE) return 0;
+	if (header[2] != handle->vendorID || header[3] != handle->deviceID) return 0;
+	if (memcmp((char*)data + sizeof(uint32_t) * 4, handle->pipelineCacheUUID, VK_UUID_SIZE) != 0) return 0;
+
+	// merge into the device cache (must not race pipeline creation, load before creating render states)
+	VkPipelineCacheCreateInfo cacheInfo = {0};
+	cacheInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO;
+	cacheInfo.initialDataSize = (size_t)size;
+	cacheInfo.pInitialData = data;
+	VkPipelineCache loadedCache = NULL;
+	if (vkCreatePipelineCache(handle->device, &cacheInfo, NULL, &loadedCache) != VK_SUCCESS) return 0;
+	VkResult result = vkMergePipelineCaches(handle->device, handle->pipelineCache, 1, &loadedCache);
+	vkDestroyPipelineCache(handle->device, loadedCache, NULL);
+	return result == VK_SUCCESS;
+}
+
+ORBITAL_EXPORT int Orbital_Video_Vulkan_Device_SerializePipelineCache(Device* handle, void* data, uint64_t* size)
+{
+	// query size when no buffer is passed
+	size_t dataSize = data != NULL ? (size_t)(*size) : 0;
+	if (vkGetPipelineCacheData(handle->device, handle->pipelineCache, &dataSize, data) != VK_SUCCESS) return 0;
+	*size = dataSize;
+	return 1;
 }
\ No newline at end of file
@@ -1,5 +1,15 @@
 #pragma once
 #include "Instance.h"
+#include "UploadEngine.h"
+#include "MemoryAllocator.h"
+#include "DescriptorAllocator.h"
+
+#define DEVICE_MAX_FRAME_COUNT 3
+#define DEVICE_DEFAULT_FRAME_COUNT 2
+
+// stages a queue waits at for uploads and cross-queue work (resources are only read from these)
+#define DEVICE_QUEUE_WAIT_STAGES (VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT | VK_PIPELINE_STAGE_VERTEX_INPUT_BIT | VK_PIPELINE_STAGE_VERTEX_SHADER_BIT | VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT | VK_PIPELINE_STAGE_TRANSFER_BIT)
+#define DEVICE_COMPUTE_QUEUE_WAIT_STAGES (VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT | VK_PIPELINE_STAGE_TRANSFER_BIT)
 
 typedef enum DeviceType
 {
@@ -7,6 +17,37 @@ typedef enum DeviceType
 	DeviceType_Background
 } DeviceType;
 
+typedef struct DeviceFrame
+{
+	uint64_t semaphoreValue, computeSemaphoreValue;// queue timeline values reached when the GPU finished this frame
+	VkFence fence, computeFence;// signaled at frame end instead if timeline semaphores are unsupported
+	char fencesPending;
+	uint64_t serial;// Device.frameSerial this frame was recorded with (0 if never used)
+	DescriptorPoolChain descriptorPools;// transient sets, reset wholesale once the frame completes
+} DeviceFrame;
+
+// resource destroyed once the GPU can no longer reference it
+typedef struct DeviceRelease
+{
+	uint64_t frameSerial;// frame that may still use it
+	uint64_t uploadFenceValue;// upload batch that may still write it
+	VkBuffer buffer;
+	VkImage image;
+	VkImageView imageView;
+	VkSampler sampler;
+	MemoryAllocation allocation;
+} DeviceRelease;
+
+typedef struct DeviceRecordingContext
+{
+	CommandListType type;
+	VkCommandPool commandPools[DEVICE_MAX_FRAME_COUNT];// one per frame in flight, reset once the GPU finished the frame
+	VkCommandBuffer* commandBuffers[DEVICE_MAX_FRAME_COUNT];
+	uint32_t commandBufferCounts[DEVICE_MAX_FRAME_COUNT], commandBufferUsedCounts[DEVICE_MAX_FRAME_COUNT];
+	struct DeviceRecordingContext* next;// link in device context list
+	struct DeviceRecordingContext* nextFree;// link in device free list
+} DeviceRecordingContext;
+
 typedef struct Device
 {
 	DeviceType type;
@@ -14,15 +55,82 @@ typedef struct Device
 	VkPhysicalDevice physicalDevice;
 	VkPhysicalDeviceGroupProperties physicalDeviceGroup;
 	VkPhysicalDeviceFeatures physicalDeviceFeatures;
-	uint32_t queueFamilyIndex;
+	VkPhysicalDeviceLimits limits;
+	uint32_t vendorID, deviceID;
+	uint8_t pipelineCacheUUID[VK_UUID_SIZE];// saved pipeline caches are only valid for the same driver
+	uint32_t queueFamilyIndex, transferQueueFamilyIndex, computeQueueFamilyIndex;
+	uint32_t sharingQueueFamilyIndices[3], sharingQueueFamilyIndexCount;// distinct families resources are shared between (see Device_GetSharingMode)
+	VkPhysicalDeviceMemoryProperties memoryProperties;
+
+	// VK_KHR_timeline_semaphore
+	char timelineSemaphoreSupported;
+	PFN_vkGetSemaphoreCounterValueKHR vkGetSemaphoreCounterValueKHR;
+	PFN_vkWaitSemaphoresKHR vkWaitSemaphoresKHR;
+
+	// VK_KHR_synchronization2 (barriers fall back to vkCmdPipelineBarrier if unsupported)
+	char synchronization2Supported;
+	PFN_vkCmdPipelineBarrier2KHR vkCmdPipelineBarrier2KHR;
+
+	// VK_EXT_descriptor_indexing (bindless set is not created if unsupported)
+	char descriptorIndexingSupported;
 
 	Instance* instance;
 	VkDevice device;
 	VkQueue queue;
-	VkCommandPool commandPool;
+	VkQueue transferQueue;
+
+	// async compute queue
+	VkQueue computeQueue;
+
+	// external sync for queue submits, indexed by the first of queue/transferQueue/computeQueue with the same handle
+	// (transfer and compute fall back to the graphics VkQueue when no separate family/queue exists)
+	CRITICAL_SECTION queueMutexes[3];
+
+	// command pools held by command lists while they record (one per recording thread)
+	DeviceRecordingContext* recordingContexts;
+	DeviceRecordingContext* freeRecordingContexts[2];// indexed by CommandListType
+	CRITICAL_SECTION recordingContextMutex;
+
+	// queue timelines used for fence tickets and cross-queue waits (NULL if timeline semaphores are unsupported)
+	VkSemaphore semaphore, computeSemaphore;
+	uint64_t semaphoreValue, computeSemaphoreValue;
+	uint64_t queueComputeWaitValue;// compute ticket the graphics queue waits on at its next submit
+	uint64_t computeQueueWaitValue;// graphics ticket the compute queue waits on at its next submit
+	uint64_t uploadWaitValue, computeUploadWaitValue;// last upload batch each queue waits on
+
+	// frames in flight
+	uint32_t frameCount, frameIndex;
+	DeviceFrame frames[DEVICE_MAX_FRAME_COUNT];
+	uint64_t frameSerial;// incremented every frame, starts at 1
+
+	// destroyed resources waiting on frames in flight (ordered by frame serial)
+	DeviceRelease* releases;
+	uint32_t releaseCount, releaseCapacity;
+	CRITICAL_SECTION releaseMutex;
+
+	// asynchronous resource uploads on transfer queue
+	UploadEngine uploadEngine;
+
+	// device memory suballocated for buffers and images
+	MemoryAllocator memoryAllocator;
+
+	// descriptor set pools, cache and bindless set
+	DescriptorAllocator descriptorAllocator;
 
-	uint32_t activeFenceCount;
-	VkFence activeFences[1024];
+	// passed to every pipeline creation, persisted through Load/SerializePipelineCache
+	VkPipelineCache pipelineCache;
 } Device;
 
-void Device_AddFence(Device* device, VkFence fence);
\ No newline at end of file
+int Device_FindMemoryType(Device* device, uint32_t typeBits, VkMemoryPropertyFlags properties, uint32_t* memoryTypeIndex);
+int Device_CreateTimelineSemaphore(Device* device, VkSemaphore* semaphore);
+DeviceRecordingContext* Device_AcquireRecordingContext(Device* device, CommandListType type);
+void Device_ReleaseRecordingContext(Device* device, DeviceRecordingContext* context);
+VkCommandBuffer DeviceRecordingContext_NextCommandBuffer(Device* device, DeviceRecordingContext* context);
+CRITICAL_SECTION* Device_GetQueueMutex(Device* device, VkQueue queue);
+VkResult Device_QueueSubmit(Device* device, VkQueue queue, uint32_t submitCount, const VkSubmitInfo* submits, VkFence fence);
+VkResult Device_QueueWaitIdle(Device* device, VkQueue queue);
+void Device_WaitIdle(Device* device);
+void Device_GetSharingMode(Device* device, VkSharingMode* sharingMode, uint32_t* queueFamilyIndexCount, const uint32_t** queueFamilyIndices);
+void Device_DeferDestroyBuffer(Device* device, VkBuffer buffer, MemoryAllocation* allocation);
+void Device_DeferDestroyImage(Device* device, VkImage image, VkImageView imageView, MemoryAllocation* allocation);
+void Device_DeferDestroySampler(Device* device, VkSampler sampler);
\ No newline at end of file
@@ -0,0 +1,545 @@
+#include "MemoryAllocator.h"
+#include "Device.h"
+#include <intrin.h>
+
+#pragma region TLSF
+uint32_t MemoryAllocator_BitScanForward(uint32_t mask)
+{
+	unsigned long index;
+	_BitScanForward(&index, mask);
+	return index;
+}
+
+uint32_t MemoryAllocator_BitScanReverse(uint64_t value)
+{
+	unsigned long index;
+	_BitScanReverse64(&index, value);
+	return index;
+}
+
+void MemoryAllocator_TLSFMapping(uint64_t size, uint32_t* fl, uint32_t* sl)
+{
+	// first level is the power of two, second level splits it linearly
+	if (size < MEMORY_ALLOCATOR_TLSF_SL_COUNT)
+	{
+		*fl = 0;
+		*sl = (uint32_t)size;
+		return;
+	}
+	uint32_t msb = MemoryAllocator_BitScanReverse(size);
+	*fl = msb - MEMORY_ALLOCATOR_TLSF_SL_BITS + 1;
+	*sl = (uint32_t)(size >> (msb - MEMORY_ALLOCATOR_TLSF_SL_BITS)) - MEMORY_ALLOCATOR_TLSF_SL_COUNT;
+}
+
+void MemoryAllocator_TLSFInsert(MemoryBlock* block, MemoryRange* range)
+{
+	uint32_t fl, sl;
+	MemoryAllocator_TLSFMapping(range->size, &fl, &sl);
+	range->free = 1;
+	range->prevFree = NULL;
+	range->nextFree = block->freeLists[fl][sl];
+	if (range->nextFree != NULL) range->nextFree->prevFree = range;
+	block->freeLists[fl][sl] = range;
+	block->flBitmap |= 1u << fl;
+	block->slBitmaps[fl] |= 1u << sl;
+}
+
+void MemoryAllocator_TLSFRemove(MemoryBlock* block, MemoryRange* range)
+{
+	uint32_t fl, sl;
+	MemoryAllocator_TLSFMapping(range->size, &fl, &sl);
+	if (range->prevFree != NULL) range->prevFree->nextFree = range->nextFree;
+	else block->freeLists[fl][sl] = range->nextFree;
+	if (range->nextFree != NULL) range->nextFree->prevFree = range->prevFree;
+	range->free = 0;
+	range->prevFree = NULL;
+	range->nextFree = NULL;
+
+	if (block->freeLists[fl][sl] == NULL)
+	{
+		block->slBitmaps[fl] &= ~(1u << sl);
+		if (block->slBitmaps[fl] == 0) block->flBitmap &= ~(1u << fl);
+	}
+}
+
+MemoryRange* MemoryAllocator_TLSFFind(MemoryBlock* block, uint64_t size)
+{
+	// round up to the next list so any range in it fits (good-fit in O(1))
+	if (size >= MEMORY_ALLOCATOR_TLSF_SL_COUNT) size += (1ull << (MemoryAllocator_BitScanReverse(size) - MEMORY_ALLOCATOR_TLSF_SL_BITS)) - 1;
+	uint32_t fl, sl;
+	MemoryAllocator_TLSFMapping(size, &fl, &sl);
+	if (fl >= MEMORY_ALLOCATOR_TLSF_FL_COUNT) return NULL;
+
+	uint32_t slMask = block->slBitmaps[fl] & (~0u << sl);
+	if (slMask == 0)
+	{
+		uint32_t flMask = fl + 1 < MEMORY_ALLOCATOR_TLSF_FL_COUNT ? block->flBitmap & (~0u << (fl + 1)) : 0;
+		if (flMask == 0) return NULL;
+		fl = MemoryAllocator_BitScanForward(flMask);
+		slMask = block->slBitmaps[fl];
+	}
+	sl = MemoryAllocator_BitScanForward(slMask);
+	return block->freeLists[fl][sl];
+}
+
+MemoryRange* MemoryAllocator_TLSFSplit(MemoryRange* range, uint64_t size)
+{
+	// carve the tail off into a new range placed after this one
+	MemoryRange* tail = (MemoryRange*)calloc(1, sizeof(MemoryRange));
+	tail->offset = range->offset + size;
+	tail->size = range->size - size;
+	tail->prevPhysical = range;
+	tail->nextPhysical = range->nextPhysical;
+	if (tail->nextPhysical != NULL) tail->nextPhysical->prevPhysical = tail;
+	range->nextPhysical = tail;
+	range->size = size;
+	return tail;
+}
+
+int MemoryAllocator_TLSFAllocate(MemoryBlock* block, uint64_t size, uint64_t alignment, MemoryRange** result)
+{
+	MemoryRange* range = MemoryAllocator_TLSFFind(block, size + alignment - 1);// worst case padding
+	if (range == NULL) return 0;
+	MemoryAllocator_TLSFRemove(block, range);
+
+	// padding in front of the aligned offset becomes its own free range
+	uint64_t alignedOffset = (range->offset + (alignment - 1)) & ~(alignment - 1);
+	if (alignedOffset != range->offset)
+	{
+		MemoryRange* aligned = MemoryAllocator_TLSFSplit(range, alignedOffset - range->offset);
+		MemoryAllocator_TLSFInsert(block, range);
+		range = aligned;
+	}
+
+	// return unused tail
+	if (range->size - size >= MEMORY_ALLOCATOR_TLSF_MIN_SPLIT)
+	{
+		MemoryRange* tail = MemoryAllocator_TLSFSplit(range, size);
+		MemoryAllocator_TLSFInsert(block, tail);
+	}
+
+	*result = range;
+	return 1;
+}
+
+void MemoryAllocator_TLSFFree(MemoryBlock* block, MemoryRange* range)
+{
+	// coalesce with free neighbours
+	MemoryRange* next = range->nextPhysical;
+	if (next != NULL && next->free)
+	{
+		MemoryAllocator_TLSFRemove(block, next);
+		range->size += next->size;
+		range->nextPhysical = next->nextPhysical;
+		if (range->nextPhysical != NULL) range->nextPhysical->prevPhysical = range;
+		free(next);
+	}
+
+	MemoryRange* prev = range->prevPhysical;
+	if (prev != NULL && prev->free)
+	{
+		MemoryAllocator_TLSFRemove(block, prev);
+		prev->size += range->size;
+		prev->nextPhysical = range->nextPhysical;
+		if (prev->nextPhysical != NULL) prev->nextPhysical->prevPhysical = prev;
+		free(range);
+		range = prev;
+	}
+
+	MemoryAllocator_TLSFInsert(block, range);
+}
+#pragma endregion
+
+#pragma region Blocks
+uint64_t MemoryAllocator_GetBlockSize(MemoryAllocator* handle, uint32_t memoryTypeIndex)
+{
+	// small heaps (like the 256MB host visible device-local one) get smaller blocks so one type can't take it all
+	uint64_t heapSize = handle->memoryProperties.memoryHeaps[handle->memoryProperties.memoryTypes[memoryTypeIndex].heapIndex].size;
+	uint64_t blockSize = MEMORY_ALLOCATOR_BLOCK_SIZE;
+	while (blockSize > heapSize / 8 && blockSize > 1024 * 1024) blockSize /= 2;
+	return blockSize;
+}
+
+int MemoryAllocator_AllocateMemory(MemoryAllocator* handle, uint64_t size, uint32_t memoryTypeIndex, VkBuffer dedicatedBuffer, VkImage dedicatedImage, VkDeviceMemory* memory, uint8_t** data)
+{
+	VkMemoryAllocateInfo allocInfo = {0};
+	allocInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+	allocInfo.allocationSize = size;
+	allocInfo.memoryTypeIndex = memoryTypeIndex;
+
+	VkMemoryDedicatedAllocateInfo dedicatedInfo = {0};
+	if (handle->dedicatedAllocationSupported && (dedicatedBuffer != NULL || dedicatedImage != NULL))
+	{
+		dedicatedInfo.sType = VK_STRUCTURE_TYPE_MEMORY_DEDICATED_ALLOCATE_INFO;
+		dedicatedInfo.buffer = dedicatedBuffer;
+		dedicatedInfo.image = dedicatedImage;
+		allocInfo.pNext = &dedicatedInfo;
+	}
+	if (vkAllocateMemory(handle->device->device, &allocInfo, NULL, memory) != VK_SUCCESS) return 0;
+
+	// host visible memory stays mapped for its lifetime
+	*data = NULL;
+	if ((handle->memoryProperties.memoryTypes[memoryTypeIndex].propertyFlags & VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT) != 0)
+	{
+		if (vkMapMemory(handle->device->device, *memory, 0, VK_WHOLE_SIZE, 0, (void**)data) != VK_SUCCESS)
+		{
+			vkFreeMemory(handle->device->device, *memory, NULL);
+			return 0;
+		}
+	}
+
+	++handle->stats.deviceMemoryCount;
+	return 1;
+}
+
+void MemoryAllocator_FreeMemory(MemoryAllocator* handle, VkDeviceMemory memory)
+{
+	vkFreeMemory(handle->device->device, memory, NULL);// implicitly unmapped
+	--handle->stats.deviceMemoryCount;
+}
+
+MemoryBlock* MemoryAllocator_CreateBlock(MemoryAllocator* handle, uint32_t memoryTypeIndex, MemoryStrategy strategy)
+{
+	MemoryBlock* block = (MemoryBlock*)calloc(1, sizeof(MemoryBlock));
+	block->strategy = strategy;
+	block->size = MemoryAllocator_GetBlockSize(handle, memoryTypeIndex);
+	if (!MemoryAllocator_AllocateMemory(handle, block->size, memoryTypeIndex, NULL, NULL, &block->memory, &block->data))
+	{
+		free(block);
+		return NULL;
+	}
+
+	// TLSF blocks start as one free range
+	if (strategy == MemoryStrategy_TLSF)
+	{
+		MemoryRange* range = (MemoryRange*)calloc(1, sizeof(MemoryRange));
+		range->size = block->size;
+		MemoryAllocator_TLSFInsert(block, range);
+	}
+
+	++handle->stats.blockCount;
+	handle->stats.reservedSize += block->size;
+	return block;
+}
+
+void MemoryAllocator_DisposeBlock(MemoryAllocator* handle, MemoryBlock* block)
+{
+	if (block->strategy == MemoryStrategy_TLSF)
+	{
+		// find first range then walk physical neighbours
+		MemoryRange* range = NULL;
+		for (uint32_t fl = 0; fl != MEMORY_ALLOCATOR_TLSF_FL_COUNT && range == NULL; ++fl)
+		{
+			for (uint32_t sl = 0; sl != MEMORY_ALLOCATOR_TLSF_SL_COUNT && range == NULL; ++sl) range = block->freeLists[fl][sl];
+		}
+		while (range != NULL && range->prevPhysical != NULL) range = range->prevPhysical;
+		while (range != NULL)
+		{
+			MemoryRange* next = range->nextPhysical;
+			free(range);
+			range = next;
+		}
+	}
+
+	MemoryAllocator_FreeMemory(handle, block->memory);
+	--handle->stats.blockCount;
+	handle->stats.reservedSize -= block->size;
+	free(block);
+}
+
+int MemoryAllocator_AllocateFromBlock(MemoryBlock* block, uint64_t size, uint64_t alignment, MemoryAllocation* allocation)
+{
+	if (block->size - block->usedSize < size) return 0;
+	if (block->strategy == MemoryStrategy_Linear)
+	{
+		uint64_t offset = (block->linearOffset + (alignment - 1)) & ~(alignment - 1);
+		if (offset + size > block->size) return 0;
+		block->linearOffset = offset + size;
+		allocation->offset = offset;
+		allocation->range = NULL;
+	}
+	else
+	{
+		if (!MemoryAllocator_TLSFAllocate(block, size, alignment, &allocation->range)) return 0;
+		allocation->offset = allocation->range->offset;
+		size = allocation->range->size;// includes the tail too small to split off
+	}
+
+	allocation->block = block;
+	allocation->memory = block->memory;
+	allocation->size = size;
+	allocation->data = block->data != NULL ? block->data + allocation->offset : NULL;
+	block->usedSize += size;
+	++block->allocationCount;
+	return 1;
+}
+#pragma endregion
+
+int MemoryAllocator_Allocate(MemoryAllocator* handle, const VkMemoryRequirements* requirements, MemoryUsage usage, MemoryStrategy strategy, MemoryResourceKind kind, VkBuffer dedicatedBuffer, VkImage dedicatedImage, MemoryAllocation* allocation)
+{
+	memset(allocation, 0, sizeof(MemoryAllocation));
+	if (!MemoryAllocator_FindMemoryType(handle, requirements->memoryTypeBits, usage, &allocation->memoryTypeIndex)) return 0;
+	allocation->kind = kind;
+
+	// resources larger than half a block would mostly waste it
+	if (requirements->size > MemoryAllocator_GetBlockSize(handle, allocation->memoryTypeIndex) / 2) strategy = MemoryStrategy_Dedicated;
+
+	EnterCriticalSection(&handle->mutex);
+	if (strategy != MemoryStrategy_Dedicated)
+	{
+		// granularity only matters if the pool could mix buffers and optimal images
+		MemoryResourceKind poolKind = handle->bufferImageGranularity > 1 ? kind : MemoryResourceKind_Linear;
+		MemoryBlock** pool = &handle->pools[allocation->memoryTypeIndex][poolKind][strategy];
+		char allocated = 0;
+		for (MemoryBlock* block = *pool; block != NULL && !allocated; block = block->next)
+		{
+			allocated = MemoryAllocator_AllocateFromBlock(block, requirements->size, requirements->alignment, allocation);
+		}
+
+		if (!allocated)
+		{
+			MemoryBlock* block = MemoryAllocator_CreateBlock(handle, allocation->memoryTypeIndex, strategy);
+			if (block != NULL)
+			{
+				block->next = *pool;
+				*pool = block;
+				allocated = MemoryAllocator_AllocateFromBlock(block, requirements->size, requirements->alignment, allocation);
+			}
+		}
+
+		if (allocated)
+		{
+			++handle->stats.allocationCount;
+			handle->stats.allocatedSize += allocation->size;
+			LeaveCriticalSection(&handle->mutex);
+			return 1;
+		}
+		// out of memory for a new block, a dedicated allocation of just this size may still fit
+	}
+
+	int result = MemoryAllocator_AllocateMemory(handle, requirements->size, allocation->memoryTypeIndex, dedicatedBuffer, dedicatedImage, &allocation->memory, &allocation->data);
+	if (result)
+	{
+		allocation->size = requirements->size;
+		++handle->stats.dedicatedCount;
+		handle->stats.dedicatedSize += allocation->size;
+	}
+	LeaveCriticalSection(&handle->mutex);
+	return result;
+}
+
+int MemoryAllocator_Init(MemoryAllocator* handle, Device* device)
+{
+	handle->device = device;
+	InitializeCriticalSection(&handle->mutex);
+	handle->mutexInitialized = 1;
+	handle->memoryProperties = device->memoryProperties;
+	handle->dedicatedAllocationSupported = device->instance->nativeMaxFeatureLevel >= VK_API_VERSION_1_1 && device->nativeFeatureLevel >= VK_API_VERSION_1_1;
+
+	VkPhysicalDeviceProperties physicalDeviceProperties = {0};
+	vkGetPhysicalDeviceProperties(device->physicalDevice, &physicalDeviceProperties);
+	handle->bufferImageGranularity = physicalDeviceProperties.limits.bufferImageGranularity;
+	handle->stats.maxDeviceMemoryCount = physicalDeviceProperties.limits.maxMemoryAllocationCount;
+	return 1;
+}
+
+void MemoryAllocator_Dispose(MemoryAllocator* handle)
+{
+	for (uint32_t t = 0; t != VK_MAX_MEMORY_TYPES; ++t)
+	for (uint32_t k = 0; k != MemoryResourceKind_Count; ++k)
+	for (uint32_t s = 0; s != MemoryStrategy_Count; ++s)
+	{
+		MemoryBlock* block = handle->pools[t][k][s];
+		while (block != NULL)
+		{
+			MemoryBlock* next = block->next;
+			MemoryAllocator_DisposeBlock(handle, block);
+			block = next;
+		}
+		handle->pools[t][k][s] = NULL;
+	}
+
+	if (handle->mutexInitialized)
+	{
+		DeleteCriticalSection(&handle->mutex);
+		handle->mutexInitialized = 0;
+	}
+}
+
+int MemoryAllocator_FindMemoryType(MemoryAllocator* handle, uint32_t typeBits, MemoryUsage usage, uint32_t* memoryTypeIndex)
+{
+	VkMemoryPropertyFlags required, preferred, avoided;
+	switch (usage)
+	{
+		case MemoryUsage_GPU:
+			required = VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT;
+			preferred = 0;
+			avoided = VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT;// leave the small BAR heap to uploads
+			break;
+
+		case MemoryUsage_Upload:
+			required = VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT;
+			preferred = 0;
+			avoided = VK_MEMORY_PROPERTY_HOST_CACHED_BIT;// write-combined is faster for streaming writes
+			break;
+
+		case MemoryUsage_Readback:
+			required = VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT;
+			preferred = VK_MEMORY_PROPERTY_HOST_CACHED_BIT;// uncached CPU reads are very slow
+			avoided = 0;
+			break;
+
+		default: return 0;
+	}
+
+	// types are ordered by performance so the first with the lowest cost wins
+	uint32_t bestCost = UINT32_MAX;
+	for (uint32_t i = 0; i != handle->memoryProperties.memoryTypeCount; ++i)
+	{
+		VkMemoryPropertyFlags flags = handle->memoryProperties.memoryTypes[i].propertyFlags;
+		if ((typeBits & (1u << i)) == 0 || (flags & required) != required) continue;
+		uint32_t cost = __popcnt(preferred & ~flags) + __popcnt(avoided & flags);
+		if (cost < bestCost)
+		{
+			bestCost = cost;
+			*memoryTypeIndex = i;
+		}
+	}
+	return bestCost != UINT32_MAX;
+}
+
+int MemoryAllocator_CreateBuffer(MemoryAllocator* handle, const VkBufferCreateInfo* bufferInfo, MemoryUsage usage, MemoryStrategy strategy, VkBuffer* buffer, MemoryAllocation* allocation)
+{
+	if (vkCreateBuffer(handle->device->device, bufferInfo, NULL, buffer) != VK_SUCCESS) return 0;
+
+	// get requirements (and whether the driver wants the buffer in its own allocation)
+	VkMemoryRequirements requirements;
+	if (handle->dedicatedAllocationSupported)
+	{
+		VkMemoryDedicatedRequirements dedicatedRequirements = {0};
+		dedicatedRequirements.sType = VK_STRUCTURE_TYPE_MEMORY_DEDICATED_REQUIREMENTS;
+		VkMemoryRequirements2 requirements2 = {0};
+		requirements2.sType = VK_STRUCTURE_TYPE_MEMORY_REQUIREMENTS_2;
+		requirements2.pNext = &dedicatedRequirements;
+		VkBufferMemoryRequirementsInfo2 requirementsInfo = {0};
+		requirementsInfo.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_REQUIREMENTS_INFO_2;
+		requirementsInfo.buffer = *buffer;
+		vkGetBufferMemoryRequirements2(handle->device->device, &requirementsInfo, &requirements2);
+		requirements = requirements2.memoryRequirements;
+		if (dedicatedRequirements.requiresDedicatedAllocation || dedicatedRequirements.prefersDedicatedAllocation) strategy = MemoryStrategy_Dedicated;
+	}
+	else
+	{
+		vkGetBufferMemoryRequirements(handle->device->device, *buffer, &requirements);
+	}
+
+	if (!MemoryAllocator_Allocate(handle, &requirements, usage, strategy, MemoryResourceKind_Linear, *buffer, NULL, allocation))
+	{
+		vkDestroyBuffer(handle->device->device, *buffer, NULL);
+		*buffer = NULL;
+		return 0;
+	}
+
+	if (vkBindBufferMemory(handle->device->device, *buffer, allocation->memory, allocation->offset) != VK_SUCCESS)
+	{
+		vkDestroyBuffer(handle->device->device, *buffer, NULL);
+		*buffer = NULL;
+		MemoryAllocator_Free(handle, allocation);
+		return 0;
+	}
+	return 1;
+}
+
+int MemoryAllocator_CreateImage(MemoryAllocator* handle, const VkImageCreateInfo* imageInfo, MemoryUsage usage, VkImage* image, MemoryAllocation* allocation)
+{
+	if (vkCreateImage(handle->device->device, imageInfo, NULL, image) != VK_SUCCESS) return 0;
+
+	// get requirements (render targets often prefer their own allocation for compression metadata)
+	MemoryStrategy strategy = MemoryStrategy_TLSF;
+	VkMemoryRequirements requirements;
+	if (handle->dedicatedAllocationSupported)
+	{
+		VkMemoryDedicatedRequirements dedicatedRequirements = {0};
+		dedicatedRequirements.sType = VK_STRUCTURE_TYPE_MEMORY_DEDICATED_REQUIREMENTS;
+		VkMemoryRequirements2 requirements2 = {0};
+		requirements2.sType = VK_STRUCTURE_TYPE_MEMORY_REQUIREMENTS_2;
+		requirements2.pNext = &dedicatedRequirements;
+		VkImageMemoryRequirementsInfo2 requirementsInfo = {0};
+		requirementsInfo.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_REQUIREMENTS_INFO_2;
+		requirementsInfo.image = *image;
+		vkGetImageMemoryRequirements2(handle->device->device, &requirementsInfo, &requirements2);
+		requirements = requirements2.memoryRequirements;
+		if (dedicatedRequirements.requiresDedicatedAllocation || dedicatedRequirements.prefersDedicatedAllocation) strategy = MemoryStrategy_Dedicated;
+	}
+	else
+	{
+		vkGetImageMemoryRequirements(handle->device->device, *image, &requirements);
+	}
+
+	MemoryResourceKind kind = imageInfo->tiling == VK_IMAGE_TILING_LINEAR ? MemoryResourceKind_Linear : MemoryResourceKind_Optimal;
+	if (!MemoryAllocator_Allocate(handle, &requirements, usage, strategy, kind, NULL, *image, allocation))
+	{
+		vkDestroyImage(handle->device->device, *image, NULL);
+		*image = NULL;
+		return 0;
+	}
+
+	if (vkBindImageMemory(handle->device->device, *image, allocation->memory, allocation->offset) != VK_SUCCESS)
+	{
+		vkDestroyImage(handle->device->device, *image, NULL);
+		*image = NULL;
+		MemoryAllocator_Free(handle, allocation);
+		return 0;
+	}
+	return 1;
+}
+
+void MemoryAllocator_Free(MemoryAllocator* handle, MemoryAllocation* allocation)
+{
+	if (allocation->memory == NULL) return;
+	EnterCriticalSection(&handle->mutex);
+
+	// dedicated
+	MemoryBlock* block = allocation->block;
+	if (block == NULL)
+	{
+		MemoryAllocator_FreeMemory(handle, allocation->memory);
+		--handle->stats.dedicatedCount;
+		handle->stats.dedicatedSize -= allocation->size;
+		LeaveCriticalSection(&handle->mutex);
+		memset(allocation, 0, sizeof(MemoryAllocation));
+		return;
+	}
+
+	// suballocated
+	if (allocation->range != NULL) MemoryAllocator_TLSFFree(block, allocation->range);
+	block->usedSize -= allocation->size;
+	--block->allocationCount;
+	--handle->stats.allocationCount;
+	handle->stats.allocatedSize -= allocation->size;
+
+	if (block->allocationCount == 0)
+	{
+		block->linearOffset = 0;
+
+		// release empty blocks unless it's the last one of its pool (avoids churn at the boundary)
+		MemoryResourceKind poolKind = handle->bufferImageGranularity > 1 ? allocation->kind : MemoryResourceKind_Linear;
+		MemoryBlock** link = &handle->pools[allocation->memoryTypeIndex][poolKind][block->strategy];
+		if ((*link)->next != NULL)
+		{
+			while (*link != block) link = &(*link)->next;
+			*link = block->next;
+			MemoryAllocator_DisposeBlock(handle, block);
+		}
+	}
+
+	LeaveCriticalSection(&handle->mutex);
+	memset(allocation, 0, sizeof(MemoryAllocation));
+}
+
+void MemoryAllocator_GetStats(MemoryAllocator* handle, MemoryAllocatorStats* stats)
+{
+	EnterCriticalSection(&handle->mutex);
+	*stats = handle->stats;
+	LeaveCriticalSection(&handle->mutex);
+}
\ No newline at end of file
@@ -0,0 +1,103 @@
+#pragma once
+#include "Common.h"
+
+#define MEMORY_ALLOCATOR_BLOCK_SIZE (64 * 1024 * 1024)// shrunk for small heaps (see MemoryAllocator_GetBlockSize)
+#define MEMORY_ALLOCATOR_TLSF_SL_BITS 4
+#define MEMORY_ALLOCATOR_TLSF_SL_COUNT (1 << MEMORY_ALLOCATOR_TLSF_SL_BITS)
+#define MEMORY_ALLOCATOR_TLSF_FL_COUNT 32
+#define MEMORY_ALLOCATOR_TLSF_MIN_SPLIT 256// smaller tails stay with the allocation instead of becoming free ranges
+
+struct Device;
+
+// picks the memory type (see MemoryAllocator_FindMemoryType)
+typedef enum MemoryUsage
+{
+	MemoryUsage_GPU,// device-local, not CPU accessible
+	MemoryUsage_Upload,// host-visible coherent, written by the CPU and read by the GPU
+	MemoryUsage_Readback// host-visible coherent (cached if available), written by the GPU and read by the CPU
+} MemoryUsage;
+
+typedef enum MemoryStrategy
+{
+	MemoryStrategy_TLSF,// general purpose, ranges are reused as soon as they are freed
+	MemoryStrategy_Linear,// bump allocated, block is reused once all its allocations are freed (immutable buffers)
+	MemoryStrategy_Dedicated,// own VkDeviceMemory (large resources or ones the driver wants dedicated)
+	MemoryStrategy_Count = MemoryStrategy_Dedicated// dedicated allocations aren't pooled
+} MemoryStrategy;
+
+// buffers and linear images can't share a page with optimal images (bufferImageGranularity)
+typedef enum MemoryResourceKind
+{
+	MemoryResourceKind_Linear,
+	MemoryResourceKind_Optimal,
+	MemoryResourceKind_Count
+} MemoryResourceKind;
+
+// TLSF range, linked to its physical neighbours and to a free list while unused
+typedef struct MemoryRange
+{
+	uint64_t offset, size;
+	char free;
+	struct MemoryRange *prevPhysical, *nextPhysical;
+	struct MemoryRange *prevFree, *nextFree;
+} MemoryRange;
+
+// large VkDeviceMemory suballocated by one strategy
+typedef struct MemoryBlock
+{
+	VkDeviceMemory memory;
+	uint64_t size, usedSize;
+	uint8_t* data;// persistently mapped (NULL if not host visible)
+	uint32_t allocationCount;
+	MemoryStrategy strategy;
+
+	// MemoryStrategy_Linear
+	uint64_t linearOffset;
+
+	// MemoryStrategy_TLSF
+	uint32_t flBitmap;
+	uint32_t slBitmaps[MEMORY_ALLOCATOR_TLSF_FL_COUNT];
+	MemoryRange* freeLists[MEMORY_ALLOCATOR_TLSF_FL_COUNT][MEMORY_ALLOCATOR_TLSF_SL_COUNT];
+
+	struct MemoryBlock* next;// link in pool
+} MemoryBlock;
+
+typedef struct MemoryAllocation
+{
+	MemoryBlock* block;// NULL if dedicated
+	MemoryRange* range;// NULL unless TLSF
+	VkDeviceMemory memory;
+	uint64_t offset, size;
+	uint8_t* data;// persistently mapped pointer at offset (NULL if not host visible)
+	uint32_t memoryTypeIndex;
+	MemoryResourceKind kind;
+} MemoryAllocation;
+
+// mirrored in C# (Vulkan Device.MemoryAllocatorStats)
+typedef struct MemoryAllocatorStats
+{
+	uint64_t blockCount, reservedSize;// memory owned by blocks
+	uint64_t allocationCount, allocatedSize;// suballocated from blocks
+	uint64_t dedicatedCount, dedicatedSize;
+	uint64_t deviceMemoryCount, maxDeviceMemoryCount;// live vkAllocateMemory calls vs maxMemoryAllocationCount
+} MemoryAllocatorStats;
+
+typedef struct MemoryAllocator
+{
+	struct Device* device;
+	VkPhysicalDeviceMemoryProperties memoryProperties;
+	uint64_t bufferImageGranularity;
+	char dedicatedAllocationSupported;// Vulkan 1.1 (VK_KHR_dedicated_allocation)
+	MemoryBlock* pools[VK_MAX_MEMORY_TYPES][MemoryResourceKind_Count][MemoryStrategy_Count];
+	MemoryAllocatorStats stats;
+	CRITICAL_SECTION mutex;
+	char mutexInitialized;
+} MemoryAllocator;
+
+int MemoryAllocator_Init(MemoryAllocator* handle, struct Device* device);
+void MemoryAllocator_Dispose(MemoryAllocator* handle);
+int MemoryAllocator_FindMemoryType(MemoryAllocator* handle, uint32_t typeBits, MemoryUsage usage, uint32_t* memoryTypeIndex);
+int MemoryAllocator_CreateBuffer(MemoryAllocator* handle, const VkBufferCreateInfo* bufferInfo, MemoryUsage usage, MemoryStrategy strategy, VkBuffer* buffer, MemoryAllocation* allocation);
+int MemoryAllocator_CreateImage(MemoryAllocator* handle, const VkImageCreateInfo* imageInfo, MemoryUsage usage, VkImage* image, MemoryAllocation* allocation);
+void MemoryAllocator_Free(MemoryAllocator* handle, MemoryAllocation* allocation);
+void MemoryAllocator_GetStats(MemoryAllocator* handle, MemoryAllocatorStats* stats);
\ No newline at end of file
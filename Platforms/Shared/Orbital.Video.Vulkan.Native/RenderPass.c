@@ -22,12 +22,12 @@ ORBITAL_EXPORT int Orbital_Video_Vulkan_RenderPass_Init_Native(RenderPass* handl
 	attachments[0].format = format;
 	attachments[0].flags = 0;
 	attachments[0].samples = VK_SAMPLE_COUNT_1_BIT;
-	attachments[0].loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR;
+	attachments[0].loadOp = desc->clearColor ? VK_ATTACHMENT_LOAD_OP_CLEAR : VK_ATTACHMENT_LOAD_OP_LOAD;
 	attachments[0].storeOp = VK_ATTACHMENT_STORE_OP_STORE;
 	attachments[0].stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE,
 	attachments[0].stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
-	attachments[0].initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
-	attachments[0].finalLayout = VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
+	attachments[0].initialLayout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;// layouts outside the pass are transitioned by command lists
+	attachments[0].finalLayout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
 
 	/*attachments[1].format = format;
 	attachments[1].flags = 0;
@@ -105,6 +105,8 @@ ORBITAL_EXPORT int Orbital_Video_Vulkan_RenderPass_Init_Native(RenderPass* handl
 		frameBufferInfo.layers = depth;
 		if (vkCreateFramebuffer(handle->device->device, &frameBufferInfo, NULL, &handle->frameBuffers[i]) != VK_SUCCESS) return 0;
 	}
+
+	return 1;
 }
 
 ORBITAL_EXPORT int Orbital_Video_Vulkan_RenderPass_Init(RenderPass* handle, RenderPassDesc* desc)
@@ -115,6 +117,9 @@ ORBITAL_EXPORT int Orbital_Video_Vulkan_RenderPass_Init(RenderPass* handle, Rend
 
 ORBITAL_EXPORT void Orbital_Video_Vulkan_RenderPass_Dispose(RenderPass* handle)
 {
+	// frames may still be in flight using the frame buffers
+	Device_WaitIdle(handle->device);
+
 	if (handle->frameBuffers != NULL)
 	{
 		for (uint32_t i = 0; i != handle->frameBufferCount; ++i)
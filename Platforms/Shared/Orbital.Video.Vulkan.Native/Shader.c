@@ -0,0 +1,36 @@
+#include "Shader.h"
+
+ORBITAL_EXPORT Shader* Orbital_Video_Vulkan_Shader_Create(Device* device)
+{
+	Shader* handle = (Shader*)calloc(1, sizeof(Shader));
+	handle->device = device;
+	return handle;
+}
+
+ORBITAL_EXPORT int Orbital_Video_Vulkan_Shader_Init(Shader* handle, uint8_t* bytecode, uint32_t bytecodeLength)
+{
+	if (bytecodeLength == 0 || (bytecodeLength % sizeof(uint32_t)) != 0) return 0;// SPIR-V is a stream of words
+
+	// copy so the words are aligned
+	uint32_t* code = (uint32_t*)malloc(bytecodeLength);
+	memcpy(code, bytecode, bytecodeLength);
+
+	VkShaderModuleCreateInfo createInfo = {0};
+	createInfo.sType = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO;
+	createInfo.codeSize = bytecodeLength;
+	createInfo.pCode = code;
+	VkResult result = vkCreateShaderModule(handle->device->device, &createInfo, NULL, &handle->module);
+	free(code);
+	return result == VK_SUCCESS;
+}
+
+ORBITAL_EXPORT void Orbital_Video_Vulkan_Shader_Dispose(Shader* handle)
+{
+	if (handle->module != NULL)
+	{
+		vkDestroyShaderModule(handle->device->device, handle->module, NULL);
+		handle->module = NULL;
+	}
+
+	free(handle);
+}
\ No newline at end of file
@@ -0,0 +1,10 @@
+#pragma once
+#include "Device.h"
+
+typedef struct Shader
+{
+	Device* device;
+	VkShaderModule module;
+} Shader;
+
+ORBITAL_EXPORT void Orbital_Video_Vulkan_Shader_Dispose(Shader* handle);
\ No newline at end of file
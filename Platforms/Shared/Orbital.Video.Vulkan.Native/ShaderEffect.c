@@ -0,0 +1,361 @@
+#include "ShaderEffect.h"
+#include "ShaderPack.h"
+
+#define SHADER_EFFECT_STAGE_COUNT 5
+
+VkShaderStageFlags ResourceUsageToNative(ShaderEffectResourceUsage usage)
+{
+	VkShaderStageFlags stageFlags = 0;
+	if (usage & ShaderEffectResourceUsage_VS) stageFlags |= VK_SHADER_STAGE_VERTEX_BIT;
+	if (usage & ShaderEffectResourceUsage_PS) stageFlags |= VK_SHADER_STAGE_FRAGMENT_BIT;
+	if (usage & ShaderEffectResourceUsage_HS) stageFlags |= VK_SHADER_STAGE_TESSELLATION_CONTROL_BIT;
+	if (usage & ShaderEffectResourceUsage_DS) stageFlags |= VK_SHADER_STAGE_TESSELLATION_EVALUATION_BIT;
+	if (usage & ShaderEffectResourceUsage_GS) stageFlags |= VK_SHADER_STAGE_GEOMETRY_BIT;
+	return stageFlags;
+}
+
+int SamplerAddressToNative(ShaderEffectSamplerAddress address, VkSamplerAddressMode* nativeAddress)
+{
+	switch (address)
+	{
+		case ShaderEffectSamplerAddress_Wrap:
+			*nativeAddress = VK_SAMPLER_ADDRESS_MODE_REPEAT;
+			return 1;
+
+		case ShaderEffectSamplerAddress_Clamp:
+			*nativeAddress = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+			return 1;
+	}
+	return 0;
+}
+
+int SamplerFilterToNative(ShaderEffectSamplerFilter filter, VkSamplerCreateInfo* samplerInfo)
+{
+	switch (filter)
+	{
+		case ShaderEffectSamplerFilter_Point:
+			samplerInfo->minFilter = VK_FILTER_NEAREST;
+			samplerInfo->magFilter = VK_FILTER_NEAREST;
+			samplerInfo->mipmapMode = VK_SAMPLER_MIPMAP_MODE_NEAREST;
+			return 1;
+
+		case ShaderEffectSamplerFilter_Bilinear:
+			samplerInfo->minFilter = VK_FILTER_LINEAR;
+			samplerInfo->magFilter = VK_FILTER_LINEAR;
+			samplerInfo->mipmapMode = VK_SAMPLER_MIPMAP_MODE_NEAREST;
+			return 1;
+
+		case ShaderEffectSamplerFilter_Default:
+		case ShaderEffectSamplerFilter_Trilinear:
+			samplerInfo->minFilter = VK_FILTER_LINEAR;
+			samplerInfo->magFilter = VK_FILTER_LINEAR;
+			samplerInfo->mipmapMode = VK_SAMPLER_MIPMAP_MODE_LINEAR;
+			return 1;
+	}
+	return 0;
+}
+
+ORBITAL_EXPORT ShaderEffect* Orbital_Video_Vulkan_ShaderEffect_Create(Device* device)
+{
+	ShaderEffect* handle = (ShaderEffect*)calloc(1, sizeof(ShaderEffect));
+	handle->device = device;
+	return handle;
+}
+
+ORBITAL_EXPORT int Orbital_Video_Vulkan_ShaderEffect_Init(ShaderEffect* handle, Shader* vs, Shader* ps, Shader* hs, Shader* ds, Shader* gs, ShaderEffectDesc* desc)
+{
+	// reference shaders
+	handle->vs = vs;
+	handle->ps = ps;
+	handle->hs = hs;
+	handle->ds = ds;
+	handle->gs = gs;
+
+	// root descriptors have no Vulkan equivalent bound by GPU address, fail rather than drop them
+	if (desc->rootConstantBufferCount != 0 || desc->rootShaderResourceCount != 0) return 0;
+
+	// root constants become push constants packed in declaration order
+	uint32_t pushConstantSize = 0;
+	if (desc->rootConstantCount != 0)
+	{
+		handle->pushConstantCount = desc->rootConstantCount;
+		handle->pushConstants = (ShaderEffectPushConstant*)calloc(desc->rootConstantCount, sizeof(ShaderEffectPushConstant));
+		for (int i = 0; i != desc->rootConstantCount; ++i)
+		{
+			if (desc->rootConstants[i].count <= 0) return 0;
+			handle->pushConstants[i].offset = pushConstantSize;
+			handle->pushConstants[i].size = desc->rootConstants[i].count * sizeof(uint32_t);
+			handle->pushConstants[i].stageFlags = ResourceUsageToNative(desc->rootConstants[i].usage);
+			if (handle->pushConstants[i].stageFlags == 0) return 0;
+			pushConstantSize += handle->pushConstants[i].size;
+		}
+		if (pushConstantSize > handle->device->limits.maxPushConstantsSize) return 0;
+	}
+
+	// a stage may only appear in one range, so each stage gets one spanning all its constants
+	const VkShaderStageFlags stages[SHADER_EFFECT_STAGE_COUNT] = {VK_SHADER_STAGE_VERTEX_BIT, VK_SHADER_STAGE_FRAGMENT_BIT, VK_SHADER_STAGE_TESSELLATION_CONTROL_BIT, VK_SHADER_STAGE_TESSELLATION_EVALUATION_BIT, VK_SHADER_STAGE_GEOMETRY_BIT};
+	VkPushConstantRange ranges[SHADER_EFFECT_STAGE_COUNT] = {0};
+	uint32_t rangeCount = 0;
+	for (uint32_t s = 0; s != SHADER_EFFECT_STAGE_COUNT; ++s)
+	{
+		uint32_t begin = UINT32_MAX, end = 0;
+		for (uint32_t i = 0; i != handle->pushConstantCount; ++i)
+		{
+			ShaderEffectPushConstant* pushConstant = &handle->pushConstants[i];
+			if ((pushConstant->stageFlags & stages[s]) == 0) continue;
+			if (pushConstant->offset < begin) begin = pushConstant->offset;
+			if (pushConstant->offset + pushConstant->size > end) end = pushConstant->offset + pushConstant->size;
+		}
+		if (begin == UINT32_MAX) continue;
+		ranges[rangeCount].stageFlags = stages[s];
+		ranges[rangeCount].offset = begin;
+		ranges[rangeCount].size = end - begin;
+		++rangeCount;
+	}
+
+	// pushes must name every stage whose range overlaps the bytes written
+	for (uint32_t i = 0; i != handle->pushConstantCount; ++i)
+	{
+		ShaderEffectPushConstant* pushConstant = &handle->pushConstants[i];
+		for (uint32_t r = 0; r != rangeCount; ++r)
+		{
+			if (ranges[r].offset < pushConstant->offset + pushConstant->size && pushConstant->offset < ranges[r].offset + ranges[r].size) pushConstant->stageFlags |= ranges[r].stageFlags;
+		}
+	}
+
+	// create immutable samplers (anisotropy is validated but unused, matching the D3D12 filters)
+	if (desc->samplersCount != 0)
+	{
+		handle->samplerCount = desc->samplersCount;
+		handle->samplers = (VkSampler*)calloc(desc->samplersCount, sizeof(VkSampler));
+		for (int i = 0; i != desc->samplersCount; ++i)
+		{
+			ShaderEffectSampler sampler = desc->samplers[i];
+			VkSamplerCreateInfo samplerInfo = {0};
+			samplerInfo.sType = VK_STRUCTURE_TYPE_SAMPLER_CREATE_INFO;
+			samplerInfo.maxLod = VK_LOD_CLAMP_NONE;
+			samplerInfo.compareOp = VK_COMPARE_OP_NEVER;
+			if (sampler.anisotropy < ShaderEffectSamplerAnisotropy_Default || sampler.anisotropy > ShaderEffectSamplerAnisotropy_X16) return 0;
+			if (!SamplerFilterToNative(sampler.filter, &samplerInfo)) return 0;
+			if (!SamplerAddressToNative(sampler.addressU, &samplerInfo.addressModeU)) return 0;
+			if (!SamplerAddressToNative(sampler.addressV, &samplerInfo.addressModeV)) return 0;
+			if (!SamplerAddressToNative(sampler.addressW, &samplerInfo.addressModeW)) return 0;
+			if (vkCreateSampler(handle->device->device, &samplerInfo, NULL, &handle->samplers[i]) != VK_SUCCESS) return 0;
+		}
+	}
+
+	// create material set layout, HLSL registers are shifted per type so they can't collide
+	uint32_t bindingCount = desc->constantBufferCount + desc->textureCount + desc->samplersCount;
+	VkDescriptorSetLayoutBinding* bindings = alloca(sizeof(VkDescriptorSetLayoutBinding) * (bindingCount + 1));
+	memset(bindings, 0, sizeof(VkDescriptorSetLayoutBinding) * (bindingCount + 1));
+	uint32_t b = 0;
+	if (desc->constantBufferCount != 0)
+	{
+		handle->constantBufferCount = desc->constantBufferCount;
+		handle->constantBuffers = (ShaderEffectConstantBuffer*)malloc(sizeof(ShaderEffectConstantBuffer) * desc->constantBufferCount);
+		memcpy(handle->constantBuffers, desc->constantBuffers, sizeof(ShaderEffectConstantBuffer) * desc->constantBufferCount);
+		for (int i = 0; i != desc->constantBufferCount; ++i, ++b)
+		{
+			if (desc->constantBuffers[i].registerIndex < 0 || desc->constantBuffers[i].registerIndex >= DESCRIPTOR_BINDING_TEXTURE_OFFSET) return 0;
+			bindings[b].binding = DESCRIPTOR_BINDING_CONSTANT_BUFFER_OFFSET + desc->constantBuffers[i].registerIndex;
+			bindings[b].descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+			bindings[b].descriptorCount = 1;
+			bindings[b].stageFlags = ResourceUsageToNative(desc->constantBuffers[i].usage);
+		}
+	}
+	if (desc->textureCount != 0)
+	{
+		handle->textureCount = desc->textureCount;
+		handle->textures = (ShaderEffectTexture*)malloc(sizeof(ShaderEffectTexture) * desc->textureCount);
+		memcpy(handle->textures, desc->textures, sizeof(ShaderEffectTexture) * desc->textureCount);
+		for (int i = 0; i != desc->textureCount; ++i, ++b)
+		{
+			if (desc->textures[i].registerIndex < 0 || desc->textures[i].registerIndex >= DESCRIPTOR_BINDING_SAMPLER_OFFSET - DESCRIPTOR_BINDING_TEXTURE_OFFSET) return 0;
+			bindings[b].binding = DESCRIPTOR_BINDING_TEXTURE_OFFSET + desc->textures[i].registerIndex;
+			bindings[b].descriptorType = VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE;
+			bindings[b].descriptorCount = 1;
+			bindings[b].stageFlags = ResourceUsageToNative(desc->textures[i].usage);
+		}
+	}
+	for (int i = 0; i != desc->samplersCount; ++i, ++b)
+	{
+		if (desc->samplers[i].registerIndex < 0) return 0;
+		bindings[b].binding = DESCRIPTOR_BINDING_SAMPLER_OFFSET + desc->samplers[i].registerIndex;
+		bindings[b].descriptorType = VK_DESCRIPTOR_TYPE_SAMPLER;
+		bindings[b].descriptorCount = 1;
+		bindings[b].stageFlags = VK_SHADER_STAGE_ALL_GRAPHICS;// static samplers are visible to all stages on D3D12 too
+		bindings[b].pImmutableSamplers = &handle->samplers[i];
+	}
+
+	VkDescriptorSetLayoutCreateInfo setLayoutInfo = {0};
+	setLayoutInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+	setLayoutInfo.bindingCount = bindingCount;
+	setLayoutInfo.pBindings = bindings;
+	if (vkCreateDescriptorSetLayout(handle->device->device, &setLayoutInfo, NULL, &handle->descriptorSetLayout) != VK_SUCCESS) return 0;
+
+	// bindless set is shared by every layout so it stays bound across effect changes
+	VkDescriptorSetLayout setLayouts[2] = {handle->descriptorSetLayout, handle->device->descriptorAllocator.bindlessLayout};
+	handle->descriptorSetCount = handle->device->descriptorAllocator.bindlessSupported ? 2 : 1;
+
+	// create pipeline layout
+	VkPipelineLayoutCreateInfo layoutCreateInfo = {0};
+	layoutCreateInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+	layoutCreateInfo.setLayoutCount = handle->descriptorSetCount;
+	layoutCreateInfo.pSetLayouts = setLayouts;
+	layoutCreateInfo.pushConstantRangeCount = rangeCount;
+	layoutCreateInfo.pPushConstantRanges = ranges;
+	return vkCreatePipelineLayout(handle->device->device, &layoutCreateInfo, NULL, &handle->pipelineLayout) == VK_SUCCESS;
+}
+
+ORBITAL_EXPORT int Orbital_Video_Vulkan_ShaderEffect_InitFromPack(ShaderEffect* handle, ShaderPack* pack, int effectIndex, ShaderEffectSamplerAnisotropy anisotropyOverride)
+{
+	if (pack->effects == NULL || effectIndex < 0 || (uint32_t)effectIndex >= pack->header->effectCount) return 0;
+	const ShaderPackEffect* effect = &pack->effects[effectIndex];
+	handle->ownsShaders = 1;
+
+	// modules are created straight from the mapping (sections are aligned so no copy is needed)
+	Shader* stages[SHADER_PACK_STAGE_COUNT] = {0};
+	for (uint32_t i = 0; i != SHADER_PACK_STAGE_COUNT; ++i)
+	{
+		const ShaderPackRange* range = &effect->bytecode[ShaderPackBytecode_SPIRV][i];
+		if (range->size == 0) continue;
+		Shader* shader = (Shader*)calloc(1, sizeof(Shader));
+		shader->device = handle->device;
+		stages[i] = shader;
+		const void* bytecode;
+		if (!ShaderPack_GetRange(pack, range, &bytecode)) break;
+		if ((range->size % sizeof(uint32_t)) != 0 || ((uintptr_t)bytecode % sizeof(uint32_t)) != 0) break;
+		VkShaderModuleCreateInfo createInfo = {0};
+		createInfo.sType = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO;
+		createInfo.codeSize = (size_t)range->size;
+		createInfo.pCode = (const uint32_t*)bytecode;
+		if (vkCreateShaderModule(handle->device->device, &createInfo, NULL, &shader->module) != VK_SUCCESS) break;
+	}
+	handle->vs = stages[ShaderType_VS];
+	handle->ps = stages[ShaderType_PS];
+	handle->hs = stages[ShaderType_HS];
+	handle->ds = stages[ShaderType_DS];
+	handle->gs = stages[ShaderType_GS];
+	for (uint32_t i = 0; i != SHADER_PACK_STAGE_COUNT; ++i)
+	{
+		if (stages[i] != NULL && stages[i]->module == NULL) return 0;
+	}
+
+	// desc arrays are read in place (Init copies what it keeps)
+	ShaderEffectDesc desc = {0};
+	desc.constantBufferCount = effect->constantBufferCount;
+	desc.textureCount = effect->textureCount;
+	desc.samplersCount = effect->samplersCount;
+	desc.rootConstantBufferCount = effect->rootConstantBufferCount;
+	desc.rootShaderResourceCount = effect->rootShaderResourceCount;
+	desc.rootConstantCount = effect->rootConstantCount;
+	if (!ShaderPack_GetArray(pack, effect->constantBuffersOffset, effect->constantBufferCount, sizeof(ShaderEffectConstantBuffer), (const void**)&desc.constantBuffers)) return 0;
+	if (!ShaderPack_GetArray(pack, effect->texturesOffset, effect->textureCount, sizeof(ShaderEffectTexture), (const void**)&desc.textures)) return 0;
+	if (!ShaderPack_GetArray(pack, effect->samplersOffset, effect->samplersCount, sizeof(ShaderEffectSampler), (const void**)&desc.samplers)) return 0;
+	if (!ShaderPack_GetArray(pack, effect->rootConstantBuffersOffset, effect->rootConstantBufferCount, sizeof(ShaderEffectConstantBuffer), (const void**)&desc.rootConstantBuffers)) return 0;
+	if (!ShaderPack_GetArray(pack, effect->rootShaderResourcesOffset, effect->rootShaderResourceCount, sizeof(ShaderEffectRootShaderResource), (const void**)&desc.rootShaderResources)) return 0;
+	if (!ShaderPack_GetArray(pack, effect->rootConstantsOffset, effect->rootConstantCount, sizeof(ShaderEffectRootConstant), (const void**)&desc.rootConstants)) return 0;
+
+	if (anisotropyOverride != ShaderEffectSamplerAnisotropy_Default && desc.samplersCount != 0)
+	{
+		ShaderEffectSampler* samplers = (ShaderEffectSampler*)alloca(sizeof(ShaderEffectSampler) * desc.samplersCount);
+		memcpy(samplers, desc.samplers, sizeof(ShaderEffectSampler) * desc.samplersCount);
+		for (int i = 0; i != desc.samplersCount; ++i) samplers[i].anisotropy = anisotropyOverride;
+		desc.samplers = samplers;
+	}
+	return Orbital_Video_Vulkan_ShaderEffect_Init(handle, handle->vs, handle->ps, handle->hs, handle->ds, handle->gs, &desc);
+}
+
+ORBITAL_EXPORT int Orbital_Video_Vulkan_ShaderEffect_SetSpecialization(ShaderEffect* handle, ShaderVariantKey* keys, int keyCount)
+{
+	if (keyCount <= 0 || handle->specializationEntries != NULL) return 0;
+
+	// bool and int constants are both 32-bit in SPIR-V
+	handle->specializationEntries = (VkSpecializationMapEntry*)calloc(keyCount, sizeof(VkSpecializationMapEntry));
+	handle->specializationData = (uint32_t*)calloc(keyCount, sizeof(uint32_t));
+	for (int i = 0; i != keyCount; ++i)
+	{
+		if (keys[i].id < 0) return 0;
+		handle->specializationEntries[i].constantID = keys[i].id;
+		handle->specializationEntries[i].offset = i * sizeof(uint32_t);
+		handle->specializationEntries[i].size = sizeof(uint32_t);
+		handle->specializationData[i] = (uint32_t)keys[i].value;
+	}
+	handle->specializationInfo.mapEntryCount = keyCount;
+	handle->specializationInfo.pMapEntries = handle->specializationEntries;
+	handle->specializationInfo.dataSize = keyCount * sizeof(uint32_t);
+	handle->specializationInfo.pData = handle->specializationData;
+	return 1;
+}
+
+ORBITAL_EXPORT void Orbital_Video_Vulkan_ShaderEffect_Dispose(ShaderEffect* handle)
+{
+	// shaders loaded from a pack belong to the effect
+	if (handle->ownsShaders)
+	{
+		Shader* stages[SHADER_EFFECT_STAGE_COUNT] = {handle->vs, handle->ps, handle->hs, handle->ds, handle->gs};
+		for (uint32_t i = 0; i != SHADER_EFFECT_STAGE_COUNT; ++i)
+		{
+			if (stages[i] != NULL) Orbital_Video_Vulkan_Shader_Dispose(stages[i]);
+		}
+		handle->vs = handle->ps = handle->hs = handle->ds = handle->gs = NULL;
+	}
+
+	// command buffers that already recorded with the layout stay valid
+	if (handle->pipelineLayout != NULL)
+	{
+		vkDestroyPipelineLayout(handle->device->device, handle->pipelineLayout, NULL);
+		handle->pipelineLayout = NULL;
+	}
+
+	// cached sets are keyed on the layout and must not outlive it in the cache
+	if (handle->descriptorSetLayout != NULL)
+	{
+		DescriptorAllocator_EvictLayout(&handle->device->descriptorAllocator, handle->descriptorSetLayout);
+		vkDestroyDescriptorSetLayout(handle->device->device, handle->descriptorSetLayout, NULL);
+		handle->descriptorSetLayout = NULL;
+	}
+
+	// immutable samplers are baked into sets frames in flight may still bind
+	if (handle->samplers != NULL)
+	{
+		for (uint32_t i = 0; i != handle->samplerCount; ++i)
+		{
+			if (handle->samplers[i] != NULL) Device_DeferDestroySampler(handle->device, handle->samplers[i]);
+		}
+		free(handle->samplers);
+		handle->samplers = NULL;
+	}
+
+	if (handle->constantBuffers != NULL)
+	{
+		free(handle->constantBuffers);
+		handle->constantBuffers = NULL;
+	}
+
+	if (handle->textures != NULL)
+	{
+		free(handle->textures);
+		handle->textures = NULL;
+	}
+
+	if (handle->pushConstants != NULL)
+	{
+		free(handle->pushConstants);
+		handle->pushConstants = NULL;
+	}
+
+	if (handle->specializationEntries != NULL)
+	{
+		free(handle->specializationEntries);
+		handle->specializationEntries = NULL;
+	}
+
+	if (handle->specializationData != NULL)
+	{
+		free(handle->specializationData);
+		handle->specializationData = NULL;
+	}
+
+	free(handle);
+}
\ No newline at end of file
@@ -0,0 +1,33 @@
+#pragma once
+#include "Device.h"
+#include "Shader.h"
+
+// ShaderEffectDesc.rootConstants entry mapped to push constant bytes
+typedef struct ShaderEffectPushConstant
+{
+	uint32_t offset, size;
+	VkShaderStageFlags stageFlags;// every stage whose range overlaps these bytes (required by vkCmdPushConstants)
+} ShaderEffectPushConstant;
+
+typedef struct ShaderEffect
+{
+	Device* device;
+	Shader *vs, *ps, *hs, *ds, *gs;
+	char ownsShaders;// created from a shader pack
+	VkPipelineLayout pipelineLayout;
+
+	// set 0 holds the material resources (registers offset per type, see DescriptorAllocator.h)
+	VkDescriptorSetLayout descriptorSetLayout;
+	uint32_t descriptorSetCount;// 2 if the device bindless set is appended
+	uint32_t constantBufferCount, textureCount, samplerCount;
+	ShaderEffectConstantBuffer* constantBuffers;
+	ShaderEffectTexture* textures;
+	VkSampler* samplers;// immutable, baked into the set layout
+	uint32_t pushConstantCount;
+	ShaderEffectPushConstant* pushConstants;// packed in declaration order
+
+	// variant keys as 32-bit specialization constants, pipelines pass it to every stage (empty if mapEntryCount is 0)
+	VkSpecializationInfo specializationInfo;
+	VkSpecializationMapEntry* specializationEntries;
+	uint32_t* specializationData;
+} ShaderEffect;
\ No newline at end of file
@@ -0,0 +1,125 @@
+#include "ShaderPack.h"
+
+uint64_t ShaderPack_HashName(const wchar_t* name, uint32_t nameLength)
+{
+	// FNV-1a over the UTF-16 bytes (matches the pack writer)
+	const uint8_t* bytes = (const uint8_t*)name;
+	uint64_t hash = 14695981039346656037ull;
+	for (size_t i = 0; i != sizeof(wchar_t) * nameLength; ++i)
+	{
+		hash ^= bytes[i];
+		hash *= 1099511628211ull;
+	}
+	return hash;
+}
+
+int ShaderPack_GetRange(ShaderPack* handle, const ShaderPackRange* range, const void** data)
+{
+	// corrupt or truncated packs must not read outside the mapping
+	if (range->size == 0 || range->offset > handle->size || range->size > handle->size - range->offset) return 0;
+	*data = handle->data + range->offset;
+	return 1;
+}
+
+int ShaderPack_GetArray(ShaderPack* handle, uint64_t offset, int count, size_t elementSize, const void** data)
+{
+	*data = NULL;
+	if (count < 0) return 0;
+	if (count == 0) return 1;
+	ShaderPackRange range;
+	range.offset = offset;
+	range.size = (uint64_t)count * elementSize;
+	return ShaderPack_GetRange(handle, &range, data);
+}
+
+ORBITAL_EXPORT ShaderPack* Orbital_Video_Vulkan_ShaderPack_Create(Device* device)
+{
+	ShaderPack* handle = (ShaderPack*)calloc(1, sizeof(ShaderPack));
+	handle->device = device;
+	handle->file = INVALID_HANDLE_VALUE;
+	return handle;
+}
+
+ORBITAL_EXPORT int Orbital_Video_Vulkan_ShaderPack_Init(ShaderPack* handle, const wchar_t* filename)
+{
+	// map whole file, pages are only read once an effect touches them
+	handle->file = CreateFileW(filename, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_RANDOM_ACCESS, NULL);
+	if (handle->file == INVALID_HANDLE_VALUE) return 0;
+	LARGE_INTEGER fileSize;
+	if (!GetFileSizeEx(handle->file, &fileSize) || fileSize.QuadPart < (LONGLONG)sizeof(ShaderPackHeader)) return 0;
+	handle->size = (uint64_t)fileSize.QuadPart;
+	handle->mapping = CreateFileMappingW(handle->file, NULL, PAGE_READONLY, 0, 0, NULL);
+	if (handle->mapping == NULL) return 0;
+	handle->data = (const uint8_t*)MapViewOfFile(handle->mapping, FILE_MAP_READ, 0, 0, 0);
+	if (handle->data == NULL) return 0;
+
+	// validate header and effect table
+	handle->header = (const ShaderPackHeader*)handle->data;
+	if (handle->header->magic != SHADER_PACK_MAGIC || handle->header->version != SHADER_PACK_VERSION) return 0;
+	const void* effects;
+	if (!ShaderPack_GetArray(handle, handle->header->effectsOffset, handle->header->effectCount, sizeof(ShaderPackEffect), &effects)) return 0;
+	handle->effects = (const ShaderPackEffect*)effects;
+	return 1;
+}
+
+ORBITAL_EXPORT int Orbital_Video_Vulkan_ShaderPack_GetEffectCount(ShaderPack* handle)
+{
+	return handle->effects != NULL ? handle->header->effectCount : 0;
+}
+
+ORBITAL_EXPORT int Orbital_Video_Vulkan_ShaderPack_FindEffect(ShaderPack* handle, const wchar_t* name, int nameLength, uint64_t variantHash)
+{
+	if (handle->effects == NULL) return -1;
+
+	// first entry with the hash, then compare names of entries sharing it (permutations of one effect are adjacent)
+	uint64_t hash = ShaderPack_HashName(name, nameLength);
+	uint32_t first = 0, last = handle->header->effectCount;
+	while (first != last)
+	{
+		uint32_t middle = first + ((last - first) / 2);
+		if (handle->effects[middle].nameHash < hash) first = middle + 1;
+		else last = middle;
+	}
+
+	for (uint32_t i = first; i != handle->header->effectCount && handle->effects[i].nameHash == hash; ++i)
+	{
+		const void* effectName;
+		if (handle->effects[i].variantHash != variantHash) continue;
+		if (handle->effects[i].name.size != sizeof(wchar_t) * nameLength) continue;
+		if (!ShaderPack_GetRange(handle, &handle->effects[i].name, &effectName)) continue;
+		if (memcmp(effectName, name, sizeof(wchar_t) * nameLength) == 0) return i;
+	}
+	return -1;
+}
+
+ORBITAL_EXPORT int Orbital_Video_Vulkan_ShaderPack_GetEffectResourceCounts(ShaderPack* handle, int effectIndex, int* constantBufferCount, int* textureCount)
+{
+	if (handle->effects == NULL || effectIndex < 0 || (uint32_t)effectIndex >= handle->header->effectCount) return 0;
+	*constantBufferCount = handle->effects[effectIndex].constantBufferCount;
+	*textureCount = handle->effects[effectIndex].textureCount;
+	return 1;
+}
+
+ORBITAL_EXPORT void Orbital_Video_Vulkan_ShaderPack_Dispose(ShaderPack* handle)
+{
+	// effects create their shader modules while loading, so nothing references the mapping afterwards
+	if (handle->data != NULL)
+	{
+		UnmapViewOfFile(handle->data);
+		handle->data = NULL;
+	}
+
+	if (handle->mapping != NULL)
+	{
+		CloseHandle(handle->mapping);
+		handle->mapping = NULL;
+	}
+
+	if (handle->file != INVALID_HANDLE_VALUE)
+	{
+		CloseHandle(handle->file);
+		handle->file = INVALID_HANDLE_VALUE;
+	}
+
+	free(handle);
+}
\ No newline at end of file
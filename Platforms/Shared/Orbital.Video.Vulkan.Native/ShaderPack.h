@@ -0,0 +1,17 @@
+#pragma once
+#include "Device.h"
+
+// read only mapping of a shader pack file, effects are loaded from it on demand
+typedef struct ShaderPack
+{
+	Device* device;
+	HANDLE file, mapping;
+	const uint8_t* data;
+	uint64_t size;
+	const ShaderPackHeader* header;
+	const ShaderPackEffect* effects;
+} ShaderPack;
+
+uint64_t ShaderPack_HashName(const wchar_t* name, uint32_t nameLength);
+int ShaderPack_GetRange(ShaderPack* handle, const ShaderPackRange* range, const void** data);
+int ShaderPack_GetArray(ShaderPack* handle, uint64_t offset, int count, size_t elementSize, const void** data);
\ No newline at end of file
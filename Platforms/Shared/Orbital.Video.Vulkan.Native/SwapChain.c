@@ -113,7 +113,7 @@ ORBITAL_EXPORT int Orbital_Video_Vulkan_SwapChain_Init(SwapChain* handle, HWND h
     swapChainCreateInfo.presentMode = VK_PRESENT_MODE_FIFO_KHR;
     swapChainCreateInfo.oldSwapchain = VK_NULL_HANDLE;
     swapChainCreateInfo.imageColorSpace = handle->colorSpace;
-    swapChainCreateInfo.imageUsage = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT;
+    swapChainCreateInfo.imageUsage = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT;
     swapChainCreateInfo.imageSharingMode = VK_SHARING_MODE_EXCLUSIVE;
     swapChainCreateInfo.queueFamilyIndexCount = 0;
     swapChainCreateInfo.pQueueFamilyIndices = NULL;
@@ -151,21 +151,54 @@ ORBITAL_EXPORT int Orbital_Video_Vulkan_SwapChain_Init(SwapChain* handle, HWND h
 		if (vkCreateImageView(handle->device->device, &imageViewCreateInfo, NULL, &handle->imageViews[i]) != VK_SUCCESS) return 0;
 	}
 
-	// create fence
-	VkFenceCreateInfo fenceInfo = {0};
-    fenceInfo.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
-    fenceInfo.flags = 0;
-    if (vkCreateFence(handle->device->device, &fenceInfo, NULL, &handle->fence) != VK_SUCCESS) return 0;
+	// create image states (images start out undefined)
+	handle->imageStates = calloc(handle->bufferCount, sizeof(ImageState));
+
+	// create acquire / present semaphores
+	VkSemaphoreCreateInfo semaphoreInfo = {0};
+	semaphoreInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
+	for (uint32_t i = 0; i != handle->device->frameCount; ++i)
+	{
+		if (vkCreateSemaphore(handle->device->device, &semaphoreInfo, NULL, &handle->acquireSemaphores[i]) != VK_SUCCESS) return 0;
+	}
+
+	handle->presentSemaphores = calloc(handle->bufferCount, sizeof(VkSemaphore));
+	for (uint32_t i = 0; i != handle->bufferCount; ++i)
+	{
+		if (vkCreateSemaphore(handle->device->device, &semaphoreInfo, NULL, &handle->presentSemaphores[i]) != VK_SUCCESS) return 0;
+	}
 
 	return 1;
 }
 
 ORBITAL_EXPORT void Orbital_Video_Vulkan_SwapChain_Dispose(SwapChain* handle)
 {
-	if (handle->fence != NULL)
+	// frames may still be in flight using images and semaphores
+	if (handle->device->device != NULL) Device_WaitIdle(handle->device);
+
+	for (uint32_t i = 0; i != DEVICE_MAX_FRAME_COUNT; ++i)
 	{
-		vkDestroyFence(handle->device->device, handle->fence, NULL);
-		handle->fence = NULL;
+		if (handle->acquireSemaphores[i] != NULL)
+		{
+			vkDestroySemaphore(handle->device->device, handle->acquireSemaphores[i], NULL);
+			handle->acquireSemaphores[i] = NULL;
+		}
+	}
+
+	if (handle->presentSemaphores != NULL)
+	{
+		for (uint32_t i = 0; i != handle->bufferCount; ++i)
+		{
+			if (handle->presentSemaphores[i] != NULL) vkDestroySemaphore(handle->device->device, handle->presentSemaphores[i], NULL);
+		}
+		free(handle->presentSemaphores);
+		handle->presentSemaphores = NULL;
+	}
+
+	if (handle->imageStates != NULL)
+	{
+		free(handle->imageStates);
+		handle->imageStates = NULL;
 	}
 
 	if (handle->imageViews != NULL)
@@ -199,19 +232,45 @@ ORBITAL_EXPORT void Orbital_Video_Vulkan_SwapChain_Dispose(SwapChain* handle)
 
 ORBITAL_EXPORT void Orbital_Video_Vulkan_SwapChain_BeginFrame(SwapChain* handle)
 {
-	vkAcquireNextImageKHR(handle->device->device, handle->swapChain, UINT64_MAX, VK_NULL_HANDLE, handle->fence, &handle->currentRenderTargetIndex);
-	Device_AddFence(handle->device, handle->fence);
+	// GPU waits on acquire at the first stage that touches the image instead of the CPU waiting on a fence
+	VkSemaphore semaphore = handle->acquireSemaphores[handle->device->frameIndex];
+	vkAcquireNextImageKHR(handle->device->device, handle->swapChain, UINT64_MAX, semaphore, VK_NULL_HANDLE, &handle->currentRenderTargetIndex);
+	handle->acquireSemaphore = semaphore;
+	handle->acquireWaitStageMask = 0;
+
+	ImageState* state = &handle->imageStates[handle->currentRenderTargetIndex];
+	state->stageMask = VK_PIPELINE_STAGE_2_NONE_KHR;
+	state->accessMask = VK_ACCESS_2_NONE_KHR;
 }
 
 ORBITAL_EXPORT void Orbital_Video_Vulkan_SwapChain_Present(SwapChain* handle)
 {
+	// signal present semaphore after all prior work on the queue (also consumes acquire if nothing used the image)
+	VkSemaphore presentSemaphore = handle->presentSemaphores[handle->currentRenderTargetIndex];
+	VkPipelineStageFlags waitStageMask = VK_PIPELINE_STAGE_ALL_COMMANDS_BIT;
+	VkSubmitInfo submitInfo = {0};
+	submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+	if (handle->acquireSemaphore != NULL)
+	{
+		submitInfo.waitSemaphoreCount = 1;
+		submitInfo.pWaitSemaphores = &handle->acquireSemaphore;
+		submitInfo.pWaitDstStageMask = &waitStageMask;
+		handle->acquireSemaphore = NULL;
+	}
+	submitInfo.signalSemaphoreCount = 1;
+	submitInfo.pSignalSemaphores = &presentSemaphore;
+	CRITICAL_SECTION* queueMutex = Device_GetQueueMutex(handle->device, handle->device->queue);
+	EnterCriticalSection(queueMutex);
+	vkQueueSubmit(handle->device->queue, 1, &submitInfo, VK_NULL_HANDLE);
+
 	VkPresentInfoKHR present = {0};
     present.sType = VK_STRUCTURE_TYPE_PRESENT_INFO_KHR;
     present.swapchainCount = 1;
     present.pSwapchains = &handle->swapChain;
     present.pImageIndices = &handle->currentRenderTargetIndex;
-    present.pWaitSemaphores = NULL;
-    present.waitSemaphoreCount = 0;
+    present.pWaitSemaphores = &presentSemaphore;
+    present.waitSemaphoreCount = 1;
     present.pResults = NULL;
     vkQueuePresentKHR(handle->device->queue, &present);
+	LeaveCriticalSection(queueMutex);
 }
\ No newline at end of file
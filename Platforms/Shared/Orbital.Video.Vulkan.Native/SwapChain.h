@@ -1,5 +1,6 @@
 #pragma once
 #include "Device.h"
+#include "BarrierBatch.h"
 
 typedef struct SwapChain
 {
@@ -13,5 +14,11 @@ typedef struct SwapChain
 	VkSwapchainKHR swapChain;
 	VkImage* images;
 	VkImageView* imageViews;
-	VkFence fence;
+	ImageState* imageStates;// per image, reset on acquire as the presentation engine owns the previous contents
+
+	// binary semaphores chaining acquire -> first use -> present
+	VkSemaphore acquireSemaphores[DEVICE_MAX_FRAME_COUNT];// per frame in flight, free again once the device finished that frame
+	VkSemaphore* presentSemaphores;// per image
+	VkSemaphore acquireSemaphore;// waited on by the first submit that uses the current image (NULL once waited)
+	VkPipelineStageFlags acquireWaitStageMask;// first stage that touches the current image (0 until used)
 } SwapChain;
\ No newline at end of file
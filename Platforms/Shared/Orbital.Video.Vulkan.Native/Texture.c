@@ -1,15 +1,187 @@
 #include "Texture.h"
 
-ORBITAL_EXPORT Texture* Orbital_Video_Vulkan_Texture_Create(Device* device)
+int TextureFormatToNative(TextureFormat format, VkFormat* nativeFormat)
+{
+	switch (format)
+	{
+		case TextureFormat_Default:
+		case TextureFormat_B8G8R8A8:
+			*nativeFormat = VK_FORMAT_B8G8R8A8_UNORM;
+			break;
+
+		case TextureFormat_DefaultHDR:
+		case TextureFormat_R10G10B10A2:
+			*nativeFormat = VK_FORMAT_A2B10G10R10_UNORM_PACK32;// same bit layout as DXGI R10G10B10A2
+			break;
+		default: return 0;
+	}
+	return 1;
+}
+
+uint32_t TextureFormatSizePerPixel(VkFormat nativeFormat)
+{
+	switch (nativeFormat)
+	{
+		case VK_FORMAT_B8G8R8A8_UNORM:
+		case VK_FORMAT_A2B10G10R10_UNORM_PACK32:
+			return 4;
+
+		default: return 0;
+	}
+}
+
+ORBITAL_EXPORT Texture* Orbital_Video_Vulkan_Texture_Create(Device* device, TextureMode mode)
 {
 	Texture* handle = (Texture*)calloc(1, sizeof(Texture));
 	handle->device = device;
+	handle->mode = mode;
+	handle->bindlessSlot.index = DESCRIPTOR_ALLOCATOR_INVALID_INDEX;
 	return handle;
 }
 
-ORBITAL_EXPORT int Orbital_Video_Vulkan_Texture_Init()
+ORBITAL_EXPORT int Orbital_Video_Vulkan_Texture_Init(Texture* handle, TextureFormat format, TextureType type, uint32_t mipLevels, uint32_t* width, uint32_t* height, uint32_t* depth, uint8_t** data)
+{
+	if (!TextureFormatToNative(format, &handle->format)) return 0;
+	handle->width = *width;
+	handle->height = *height;
+	handle->depth = *depth;
+
+	// create image
+	VkImageCreateInfo imageInfo = {0};
+	imageInfo.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
+	imageInfo.format = handle->format;
+	imageInfo.mipLevels = mipLevels;
+	imageInfo.samples = VK_SAMPLE_COUNT_1_BIT;
+	imageInfo.usage = VK_IMAGE_USAGE_SAMPLED_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT;
+	imageInfo.extent.width = *width;
+	imageInfo.extent.height = *height;
+	imageInfo.extent.depth = 1;
+	imageInfo.arrayLayers = *depth;
+	VkImageViewType viewType;
+	if (type == TextureType_1D)
+	{
+		imageInfo.imageType = VK_IMAGE_TYPE_1D;
+		viewType = *depth > 1 ? VK_IMAGE_VIEW_TYPE_1D_ARRAY : VK_IMAGE_VIEW_TYPE_1D;
+	}
+	else if (type == TextureType_2D)
+	{
+		imageInfo.imageType = VK_IMAGE_TYPE_2D;
+		viewType = *depth > 1 ? VK_IMAGE_VIEW_TYPE_2D_ARRAY : VK_IMAGE_VIEW_TYPE_2D;
+	}
+	else if (type == TextureType_3D)
+	{
+		imageInfo.imageType = VK_IMAGE_TYPE_3D;
+		imageInfo.extent.depth = *depth;
+		imageInfo.arrayLayers = 1;
+		viewType = VK_IMAGE_VIEW_TYPE_3D;
+	}
+	else if (type == TextureType_Cube)
+	{
+		imageInfo.imageType = VK_IMAGE_TYPE_2D;
+		imageInfo.flags = VK_IMAGE_CREATE_CUBE_COMPATIBLE_BIT;
+		viewType = VK_IMAGE_VIEW_TYPE_CUBE;
+	}
+	else
+	{
+		return 0;
+	}
+
+	// CPU accessed textures are linear and persistently mapped (linear tiling only supports single 2D images)
+	MemoryUsage usage;
+	if (handle->mode == TextureMode_GPUOptimized)
+	{
+		usage = MemoryUsage_GPU;
+		imageInfo.tiling = VK_IMAGE_TILING_OPTIMAL;
+		imageInfo.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+	}
+	else if (handle->mode == TextureMode_Write || handle->mode == TextureMode_Read)
+	{
+		if (type != TextureType_2D || mipLevels != 1 || *depth != 1) return 0;
+		usage = handle->mode == TextureMode_Write ? MemoryUsage_Upload : MemoryUsage_Readback;
+		imageInfo.tiling = VK_IMAGE_TILING_LINEAR;
+		imageInfo.initialLayout = handle->mode == TextureMode_Write ? VK_IMAGE_LAYOUT_PREINITIALIZED : VK_IMAGE_LAYOUT_UNDEFINED;
+	}
+	else
+	{
+		return 0;
+	}
+	Device_GetSharingMode(handle->device, &imageInfo.sharingMode, &imageInfo.queueFamilyIndexCount, &imageInfo.pQueueFamilyIndices);
+	if (!MemoryAllocator_CreateImage(&handle->device->memoryAllocator, &imageInfo, usage, &handle->image, &handle->allocation)) return 0;
+	handle->imageState.layout = imageInfo.initialLayout;
+	handle->imageState.stageMask = VK_PIPELINE_STAGE_2_NONE_KHR;
+	handle->imageState.accessMask = VK_ACCESS_2_NONE_KHR;
+
+	handle->subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+	handle->subresourceRange.baseMipLevel = 0;
+	handle->subresourceRange.levelCount = mipLevels;
+	handle->subresourceRange.baseArrayLayer = 0;
+	handle->subresourceRange.layerCount = imageInfo.arrayLayers;
+
+	// create view
+	VkImageViewCreateInfo viewInfo = {0};
+	viewInfo.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
+	viewInfo.image = handle->image;
+	viewInfo.viewType = viewType;
+	viewInfo.format = handle->format;
+	viewInfo.subresourceRange = handle->subresourceRange;
+	if (vkCreateImageView(handle->device->device, &viewInfo, NULL, &handle->imageView) != VK_SUCCESS) return 0;
+
+	// write view into the bindless set (sampled in the layout shaders read it with)
+	if (handle->device->descriptorAllocator.bindlessSupported)
+	{
+		DescriptorBinding binding = {0};
+		binding.type = VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE;
+		binding.imageView = handle->imageView;
+		binding.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+		if (!DescriptorAllocator_AllocateBindless(&handle->device->descriptorAllocator, &binding, &handle->bindlessSlot)) return 0;
+	}
+
+	// upload initial data
+	if (data != NULL)
+	{
+		if (handle->allocation.data != NULL)
+		{
+			// copy CPU memory to GPU (rows are pitched by the driver's layout)
+			VkImageSubresource subresource = {VK_IMAGE_ASPECT_COLOR_BIT, 0, 0};
+			VkSubresourceLayout layout;
+			vkGetImageSubresourceLayout(handle->device->device, handle->image, &subresource, &layout);
+			uint32_t srcPitch = *width * TextureFormatSizePerPixel(handle->format);
+			for (uint32_t y = 0; y != *height; ++y)
+			{
+				memcpy(handle->allocation.data + layout.offset + (layout.rowPitch * y), data[0] + (srcPitch * y), srcPitch);// copy texture row
+			}
+		}
+		else
+		{
+			// depth is the array size unless the image is 3D
+			uint32_t extentDepths[UPLOAD_ENGINE_MAX_MIP_COUNT];
+			if (mipLevels > UPLOAD_ENGINE_MAX_MIP_COUNT) return 0;
+			for (uint32_t i = 0; i != mipLevels; ++i) extentDepths[i] = type == TextureType_3D ? depth[i] : 1;
+
+			// copy all mip levels on transfer queue (doesn't wait for GPU, graphics queue waits on it before next submit)
+			if (UploadEngine_UploadImage(&handle->device->uploadEngine, handle->image, &handle->subresourceRange, width, height, extentDepths, TextureFormatSizePerPixel(handle->format), data) == 0) return 0;
+			handle->imageState.layout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+		}
+	}
+
+	return 1;
+}
+
+ORBITAL_EXPORT void Orbital_Video_Vulkan_Texture_Dispose(Texture* handle)
 {
-	
+	if (handle->image != NULL)
+	{
+		DescriptorAllocator_Evict(&handle->device->descriptorAllocator, NULL, handle->imageView);
+		DescriptorAllocator_FreeBindless(&handle->device->descriptorAllocator, &handle->bindlessSlot);
+		Device_DeferDestroyImage(handle->device, handle->image, handle->imageView, &handle->allocation);
+		handle->image = NULL;
+		handle->imageView = NULL;
+	}
 
-	return 0;
+	free(handle);
+}
+
+ORBITAL_EXPORT uint32_t Orbital_Video_Vulkan_Texture_GetBindlessIndex(Texture* handle)
+{
+	return handle->bindlessSlot.index;
 }
\ No newline at end of file
@@ -1,11 +1,17 @@
 #pragma once
 #include "Device.h"
+#include "BarrierBatch.h"
 
 typedef struct Texture
 {
 	Device* device;
+	TextureMode mode;
 	VkImage image;
 	VkImageView imageView;
+	MemoryAllocation allocation;
 	uint32_t width, height, depth;
 	VkFormat format;
+	VkImageSubresourceRange subresourceRange;
+	ImageState imageState;
+	DescriptorBindlessSlot bindlessSlot;// DESCRIPTOR_ALLOCATOR_INVALID_INDEX if descriptor indexing is unsupported
 } Texture;
\ No newline at end of file
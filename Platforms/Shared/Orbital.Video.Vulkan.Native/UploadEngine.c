@@ -0,0 +1,444 @@
+#include "UploadEngine.h"
+#include "Device.h"
+
+uint64_t UploadEngine_GCD(uint64_t a, uint64_t b)
+{
+	while (b != 0)
+	{
+		uint64_t r = a % b;
+		a = b;
+		b = r;
+	}
+	return a;
+}
+
+uint64_t UploadEngine_LCM(uint64_t a, uint64_t b)
+{
+	return a / UploadEngine_GCD(a, b) * b;
+}
+
+uint64_t UploadEngine_GetCopyAlignment(UploadEngine* handle, uint32_t texelSize)
+{
+	// image copy offsets must be a multiple of the texel size (12 bytes for R32G32B32) which isn't a power of two
+	uint64_t alignment = UploadEngine_LCM(16, texelSize != 0 ? texelSize : 1);
+	uint64_t optimalAlignment = handle->device->limits.optimalBufferCopyOffsetAlignment;
+	if (optimalAlignment > 1) alignment = UploadEngine_LCM(alignment, optimalAlignment);
+	return alignment;
+}
+
+uint64_t UploadEngine_Align(uint64_t value, uint64_t alignment)
+{
+	return (value + (alignment - 1)) / alignment * alignment;
+}
+
+void UploadEngine_WaitForFenceValue(UploadEngine* handle, uint64_t fenceValue)
+{
+	if (handle->completedFenceValue >= fenceValue) return;
+	if (handle->semaphore != NULL)
+	{
+		VkSemaphoreWaitInfoKHR waitInfo = {0};
+		waitInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_WAIT_INFO_KHR;
+		waitInfo.semaphoreCount = 1;
+		waitInfo.pSemaphores = &handle->semaphore;
+		waitInfo.pValues = &fenceValue;
+		handle->device->vkWaitSemaphoresKHR(handle->device->device, &waitInfo, UINT64_MAX);
+	}
+	handle->completedFenceValue = fenceValue;
+}
+
+void UploadEngine_UpdateCompletedFenceValue(UploadEngine* handle)
+{
+	if (handle->semaphore == NULL) return;// batches complete synchronously
+	uint64_t value;
+	if (handle->device->vkGetSemaphoreCounterValueKHR(handle->device->device, handle->semaphore, &value) == VK_SUCCESS) handle->completedFenceValue = value;
+}
+
+uint64_t UploadEngine_Flush_Locked(UploadEngine* handle)
+{
+	if (!handle->commandBufferOpen) return handle->fenceValue;
+
+	// submit batch to transfer queue
+	VkCommandBuffer commandBuffer = handle->commandBuffers[handle->commandBufferIndex];
+	vkEndCommandBuffer(commandBuffer);
+	++handle->fenceValue;
+
+	VkSubmitInfo submitInfo = {0};
+	submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+	submitInfo.commandBufferCount = 1;
+	submitInfo.pCommandBuffers = &commandBuffer;
+
+	VkTimelineSemaphoreSubmitInfoKHR timelineInfo = {0};
+	if (handle->semaphore != NULL)
+	{
+		timelineInfo.sType = VK_STRUCTURE_TYPE_TIMELINE_SEMAPHORE_SUBMIT_INFO_KHR;
+		timelineInfo.signalSemaphoreValueCount = 1;
+		timelineInfo.pSignalSemaphoreValues = &handle->fenceValue;
+		submitInfo.pNext = &timelineInfo;
+		submitInfo.signalSemaphoreCount = 1;
+		submitInfo.pSignalSemaphores = &handle->semaphore;
+	}
+	Device_QueueSubmit(handle->device, handle->queue, 1, &submitInfo, VK_NULL_HANDLE);
+
+	// without timeline semaphores the graphics queue has nothing to wait on so finish here
+	if (handle->semaphore == NULL)
+	{
+		Device_QueueWaitIdle(handle->device, handle->queue);
+		handle->completedFenceValue = handle->fenceValue;
+	}
+
+	// command buffer can be reused once this batch completes
+	handle->commandBufferFenceValues[handle->commandBufferIndex] = handle->fenceValue;
+	handle->commandBufferIndex = (handle->commandBufferIndex + 1) % UPLOAD_ENGINE_COMMAND_BUFFER_COUNT;
+	handle->commandBufferOpen = 0;
+	return handle->fenceValue;
+}
+
+void UploadEngine_OpenCommandBuffer(UploadEngine* handle)
+{
+	if (handle->commandBufferOpen) return;
+	VkCommandBuffer commandBuffer = handle->commandBuffers[handle->commandBufferIndex];
+	UploadEngine_WaitForFenceValue(handle, handle->commandBufferFenceValues[handle->commandBufferIndex]);
+	vkResetCommandBuffer(commandBuffer, 0);
+
+	VkCommandBufferBeginInfo beginInfo = {0};
+	beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+	beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+	vkBeginCommandBuffer(commandBuffer, &beginInfo);
+	handle->commandBufferOpen = 1;
+}
+
+void UploadEngine_ReclaimStaging(UploadEngine* handle)
+{
+	UploadEngine_UpdateCompletedFenceValue(handle);
+	while (handle->stagingRegionCount != 0 && handle->stagingRegions[handle->stagingRegionFirst].fenceValue <= handle->completedFenceValue)
+	{
+		UploadStagingRegion* region = &handle->stagingRegions[handle->stagingRegionFirst];
+		if (region->dedicatedBuffer != NULL)
+		{
+			vkDestroyBuffer(handle->device->device, region->dedicatedBuffer, NULL);
+			MemoryAllocator_Free(&handle->device->memoryAllocator, &region->dedicatedAllocation);
+		}
+		else
+		{
+			handle->stagingTail = region->end;
+		}
+		handle->stagingRegionFirst = (handle->stagingRegionFirst + 1) % UPLOAD_ENGINE_MAX_REGION_COUNT;
+		--handle->stagingRegionCount;
+	}
+
+	// reset ring when empty to avoid needless wrapping
+	if (handle->stagingHead == handle->stagingTail)
+	{
+		handle->stagingHead = 0;
+		handle->stagingTail = 0;
+	}
+}
+
+int UploadEngine_CreateStagingBuffer(UploadEngine* handle, uint64_t size, VkBuffer* buffer, MemoryAllocation* allocation, uint8_t** data)
+{
+	VkBufferCreateInfo bufferInfo = {0};
+	bufferInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+	bufferInfo.size = size;
+	bufferInfo.usage = VK_BUFFER_USAGE_TRANSFER_SRC_BIT;
+	bufferInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+
+	// staging buffers are freed whole once their batch completes, so linear blocks recycle without fragmenting
+	if (!MemoryAllocator_CreateBuffer(&handle->device->memoryAllocator, &bufferInfo, MemoryUsage_Upload, MemoryStrategy_Linear, buffer, allocation)) return 0;
+	*data = allocation->data;// persistently mapped by the allocator
+	return 1;
+}
+
+int UploadEngine_PushRegion(UploadEngine* handle, UploadStagingRegion* region)
+{
+	if (handle->stagingRegionCount == UPLOAD_ENGINE_MAX_REGION_COUNT) return 0;
+	uint32_t index = (handle->stagingRegionFirst + handle->stagingRegionCount) % UPLOAD_ENGINE_MAX_REGION_COUNT;
+	handle->stagingRegions[index] = *region;
+	++handle->stagingRegionCount;
+	return 1;
+}
+
+int UploadEngine_AllocateStaging(UploadEngine* handle, uint64_t size, uint64_t alignment, VkBuffer* buffer, uint64_t* offset, uint8_t** data)
+{
+	// make sure region ring has space
+	if (handle->stagingRegionCount == UPLOAD_ENGINE_MAX_REGION_COUNT)
+	{
+		UploadEngine_Flush_Locked(handle);
+		UploadEngine_WaitForFenceValue(handle, handle->stagingRegions[handle->stagingRegionFirst].fenceValue);
+		UploadEngine_ReclaimStaging(handle);
+	}
+
+	// uploads larger than half the ring get their own buffer which is destroyed once the batch completes
+	if (size > UPLOAD_ENGINE_STAGING_SIZE / 2)
+	{
+		UploadStagingRegion region = {0};
+		region.fenceValue = handle->fenceValue + 1;
+		if (!UploadEngine_CreateStagingBuffer(handle, size, &region.dedicatedBuffer, &region.dedicatedAllocation, data)) return 0;
+		UploadEngine_PushRegion(handle, &region);
+
+		*buffer = region.dedicatedBuffer;
+		*offset = 0;
+		return 1;
+	}
+
+	for (;;)
+	{
+		UploadEngine_ReclaimStaging(handle);
+
+		// find space in ring
+		uint64_t alignedHead = UploadEngine_Align(handle->stagingHead, alignment);
+		char found = 0;
+		if (handle->stagingHead >= handle->stagingTail)
+		{
+			if (alignedHead + size <= UPLOAD_ENGINE_STAGING_SIZE) found = 1;
+			else if (size < handle->stagingTail)// wrap around
+			{
+				alignedHead = 0;
+				found = 1;
+			}
+		}
+		else if (alignedHead + size < handle->stagingTail)
+		{
+			found = 1;
+		}
+
+		if (found)
+		{
+			UploadStagingRegion region = {0};
+			region.end = alignedHead + size;
+			region.fenceValue = handle->fenceValue + 1;
+			UploadEngine_PushRegion(handle, &region);
+			handle->stagingHead = region.end;
+
+			*buffer = handle->stagingBuffer;
+			*offset = alignedHead;
+			*data = handle->stagingData + alignedHead;
+			return 1;
+		}
+
+		// ring is full: submit pending copies and wait for the oldest region
+		if (handle->stagingRegionCount == 0) return 0;
+		UploadEngine_Flush_Locked(handle);
+		UploadEngine_WaitForFenceValue(handle, handle->stagingRegions[handle->stagingRegionFirst].fenceValue);
+	}
+}
+
+int UploadEngine_Init(UploadEngine* handle, Device* device)
+{
+	handle->device = device;
+	InitializeCriticalSection(&handle->mutex);
+	handle->mutexInitialized = 1;
+	handle->queue = device->transferQueue;
+
+	// create timeline semaphore
+	if (device->timelineSemaphoreSupported)
+	{
+		if (!Device_CreateTimelineSemaphore(device, &handle->semaphore)) return 0;
+	}
+
+	// create command pool and buffers
+	VkCommandPoolCreateInfo poolCreateInfo = {0};
+	poolCreateInfo.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+	poolCreateInfo.queueFamilyIndex = device->transferQueueFamilyIndex;
+	poolCreateInfo.flags = VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT | VK_COMMAND_POOL_CREATE_TRANSIENT_BIT;
+	if (vkCreateCommandPool(device->device, &poolCreateInfo, NULL, &handle->commandPool) != VK_SUCCESS) return 0;
+
+	VkCommandBufferAllocateInfo allocInfo = {0};
+	allocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+	allocInfo.commandPool = handle->commandPool;
+	allocInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+	allocInfo.commandBufferCount = UPLOAD_ENGINE_COMMAND_BUFFER_COUNT;
+	if (vkAllocateCommandBuffers(device->device, &allocInfo, handle->commandBuffers) != VK_SUCCESS) return 0;
+
+	// create persistently mapped staging ring
+	if (!UploadEngine_CreateStagingBuffer(handle, UPLOAD_ENGINE_STAGING_SIZE, &handle->stagingBuffer, &handle->stagingAllocation, &handle->stagingData)) return 0;
+
+	return 1;
+}
+
+void UploadEngine_Dispose(UploadEngine* handle)
+{
+	// finish pending copies
+	if (handle->queue != NULL)
+	{
+		if (handle->commandPool != NULL) UploadEngine_Flush_Locked(handle);
+		Device_QueueWaitIdle(handle->device, handle->queue);
+		handle->completedFenceValue = handle->fenceValue;
+	}
+
+	while (handle->stagingRegionCount != 0)
+	{
+		UploadStagingRegion* region = &handle->stagingRegions[handle->stagingRegionFirst];
+		if (region->dedicatedBuffer != NULL)
+		{
+			vkDestroyBuffer(handle->device->device, region->dedicatedBuffer, NULL);
+			MemoryAllocator_Free(&handle->device->memoryAllocator, &region->dedicatedAllocation);
+		}
+		handle->stagingRegionFirst = (handle->stagingRegionFirst + 1) % UPLOAD_ENGINE_MAX_REGION_COUNT;
+		--handle->stagingRegionCount;
+	}
+
+	if (handle->stagingBuffer != NULL)
+	{
+		vkDestroyBuffer(handle->device->device, handle->stagingBuffer, NULL);
+		handle->stagingBuffer = NULL;
+	}
+
+	if (handle->stagingAllocation.memory != NULL)
+	{
+		MemoryAllocator_Free(&handle->device->memoryAllocator, &handle->stagingAllocation);
+		memset(&handle->stagingAllocation, 0, sizeof(MemoryAllocation));
+		handle->stagingData = NULL;
+	}
+
+	if (handle->commandPool != NULL)
+	{
+		vkDestroyCommandPool(handle->device->device, handle->commandPool, NULL);// frees command buffers
+		handle->commandPool = NULL;
+	}
+
+	if (handle->semaphore != NULL)
+	{
+		vkDestroySemaphore(handle->device->device, handle->semaphore, NULL);
+		handle->semaphore = NULL;
+	}
+
+	if (handle->mutexInitialized)
+	{
+		DeleteCriticalSection(&handle->mutex);
+		handle->mutexInitialized = 0;
+	}
+}
+
+uint64_t UploadEngine_UploadBuffer(UploadEngine* handle, VkBuffer buffer, void* data, uint64_t dataSize)
+{
+	EnterCriticalSection(&handle->mutex);
+
+	// copy CPU memory to staging
+	VkBuffer stagingBuffer;
+	uint64_t stagingOffset;
+	uint8_t* stagingData;
+	if (!UploadEngine_AllocateStaging(handle, dataSize, UploadEngine_GetCopyAlignment(handle, 1), &stagingBuffer, &stagingOffset, &stagingData))
+	{
+		LeaveCriticalSection(&handle->mutex);
+		return 0;
+	}
+	memcpy(stagingData, data, dataSize);
+
+	// record copy into current batch
+	UploadEngine_OpenCommandBuffer(handle);
+	VkBufferCopy region = {0};
+	region.srcOffset = stagingOffset;
+	region.dstOffset = 0;
+	region.size = dataSize;
+	vkCmdCopyBuffer(handle->commandBuffers[handle->commandBufferIndex], stagingBuffer, buffer, 1, &region);
+	uint64_t result = handle->fenceValue + 1;
+
+	LeaveCriticalSection(&handle->mutex);
+	return result;
+}
+
+uint64_t UploadEngine_UploadImage(UploadEngine* handle, VkImage image, const VkImageSubresourceRange* subresourceRange, uint32_t* width, uint32_t* height, uint32_t* depth, uint32_t bytesPerPixel, uint8_t** data)
+{
+	// mips are tightly packed per level (all array layers of a level together)
+	uint64_t mipSizes[UPLOAD_ENGINE_MAX_MIP_COUNT];
+	uint64_t mipOffsets[UPLOAD_ENGINE_MAX_MIP_COUNT];
+	uint64_t dataSize = 0;
+	uint32_t mipLevels = subresourceRange->levelCount;
+	if (mipLevels > UPLOAD_ENGINE_MAX_MIP_COUNT) return 0;
+	uint64_t alignment = UploadEngine_GetCopyAlignment(handle, bytesPerPixel);
+	for (uint32_t i = 0; i != mipLevels; ++i)
+	{
+		mipSizes[i] = (uint64_t)width[i] * height[i] * depth[i] * subresourceRange->layerCount * bytesPerPixel;
+		mipOffsets[i] = dataSize;
+		dataSize += UploadEngine_Align(mipSizes[i], alignment);// copy offsets must be texel aligned
+	}
+
+	EnterCriticalSection(&handle->mutex);
+
+	// copy CPU memory to staging
+	VkBuffer stagingBuffer;
+	uint64_t stagingOffset;
+	uint8_t* stagingData;
+	if (!UploadEngine_AllocateStaging(handle, dataSize, alignment, &stagingBuffer, &stagingOffset, &stagingData))
+	{
+		LeaveCriticalSection(&handle->mutex);
+		return 0;
+	}
+	for (uint32_t i = 0; i != mipLevels; ++i) memcpy(stagingData + mipOffsets[i], data[i], mipSizes[i]);
+
+	// transition, copy and leave in shader read layout (queue families share the image concurrently, no ownership transfer needed)
+	UploadEngine_OpenCommandBuffer(handle);
+	VkCommandBuffer commandBuffer = handle->commandBuffers[handle->commandBufferIndex];
+	VkImageMemoryBarrier barrier = {0};
+	barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+	barrier.srcAccessMask = 0;
+	barrier.dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+	barrier.oldLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+	barrier.newLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+	barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+	barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+	barrier.image = image;
+	barrier.subresourceRange = *subresourceRange;
+	vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 0, NULL, 0, NULL, 1, &barrier);
+
+	VkBufferImageCopy regions[UPLOAD_ENGINE_MAX_MIP_COUNT];
+	memset(regions, 0, sizeof(VkBufferImageCopy) * mipLevels);
+	for (uint32_t i = 0; i != mipLevels; ++i)
+	{
+		regions[i].bufferOffset = stagingOffset + mipOffsets[i];
+		regions[i].imageSubresource.aspectMask = subresourceRange->aspectMask;
+		regions[i].imageSubresource.mipLevel = subresourceRange->baseMipLevel + i;
+		regions[i].imageSubresource.baseArrayLayer = subresourceRange->baseArrayLayer;
+		regions[i].imageSubresource.layerCount = subresourceRange->layerCount;
+		regions[i].imageExtent.width = width[i];
+		regions[i].imageExtent.height = height[i];
+		regions[i].imageExtent.depth = depth[i];
+	}
+	vkCmdCopyBufferToImage(commandBuffer, stagingBuffer, image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, mipLevels, regions);
+
+	barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+	barrier.dstAccessMask = 0;// made visible by the semaphore the reading queue waits on
+	barrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+	barrier.newLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+	vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, 0, 0, NULL, 0, NULL, 1, &barrier);
+	uint64_t result = handle->fenceValue + 1;
+
+	LeaveCriticalSection(&handle->mutex);
+	return result;
+}
+
+uint64_t UploadEngine_Flush(UploadEngine* handle)
+{
+	EnterCriticalSection(&handle->mutex);
+	uint64_t result = UploadEngine_Flush_Locked(handle);
+	LeaveCriticalSection(&handle->mutex);
+	return result;
+}
+
+uint64_t UploadEngine_GetCompletedFenceValue(UploadEngine* handle)
+{
+	EnterCriticalSection(&handle->mutex);
+	UploadEngine_UpdateCompletedFenceValue(handle);
+	uint64_t result = handle->completedFenceValue;
+	LeaveCriticalSection(&handle->mutex);
+	return result;
+}
+
+int UploadEngine_QueueWait(UploadEngine* handle, uint64_t* queueWaitFenceValue, VkSemaphore* semaphore, uint64_t* fenceValue)
+{
+	EnterCriticalSection(&handle->mutex);
+
+	// submit pending copies and return the timeline value the graphics queue must wait on GPU-side
+	int result = 0;
+	UploadEngine_Flush_Locked(handle);
+	if (handle->semaphore != NULL && handle->fenceValue > *queueWaitFenceValue)
+	{
+		*semaphore = handle->semaphore;
+		*fenceValue = handle->fenceValue;
+		*queueWaitFenceValue = handle->fenceValue;
+		result = 1;
+	}
+
+	LeaveCriticalSection(&handle->mutex);
+	return result;
+}
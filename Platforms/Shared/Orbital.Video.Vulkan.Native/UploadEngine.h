@@ -0,0 +1,53 @@
+#pragma once
+#include "Common.h"
+#include "MemoryAllocator.h"
+
+#define UPLOAD_ENGINE_STAGING_SIZE (64 * 1024 * 1024)
+#define UPLOAD_ENGINE_COMMAND_BUFFER_COUNT 4
+#define UPLOAD_ENGINE_MAX_REGION_COUNT 1024
+#define UPLOAD_ENGINE_MAX_MIP_COUNT 16
+
+struct Device;
+
+typedef struct UploadStagingRegion
+{
+	uint64_t end;// ring offset freed once the region completes
+	uint64_t fenceValue;
+	VkBuffer dedicatedBuffer;// set for uploads too large for the ring
+	MemoryAllocation dedicatedAllocation;
+} UploadStagingRegion;
+
+typedef struct UploadEngine
+{
+	struct Device* device;
+	VkQueue queue;
+	VkCommandPool commandPool;
+	VkSemaphore semaphore;// timeline semaphore (NULL if unsupported, batches then complete synchronously)
+	uint64_t fenceValue;// last submitted batch
+	uint64_t completedFenceValue;// last batch known to be complete
+
+	// persistently mapped staging ring
+	VkBuffer stagingBuffer;
+	MemoryAllocation stagingAllocation;
+	uint8_t* stagingData;
+	uint64_t stagingHead, stagingTail;
+	UploadStagingRegion stagingRegions[UPLOAD_ENGINE_MAX_REGION_COUNT];
+	uint32_t stagingRegionFirst, stagingRegionCount;
+
+	// batch being recorded
+	VkCommandBuffer commandBuffers[UPLOAD_ENGINE_COMMAND_BUFFER_COUNT];
+	uint64_t commandBufferFenceValues[UPLOAD_ENGINE_COMMAND_BUFFER_COUNT];
+	uint32_t commandBufferIndex;
+	char commandBufferOpen;
+
+	CRITICAL_SECTION mutex;
+	char mutexInitialized;
+} UploadEngine;
+
+int UploadEngine_Init(UploadEngine* handle, struct Device* device);
+void UploadEngine_Dispose(UploadEngine* handle);
+uint64_t UploadEngine_UploadBuffer(UploadEngine* handle, VkBuffer buffer, void* data, uint64_t dataSize);
+uint64_t UploadEngine_UploadImage(UploadEngine* handle, VkImage image, const VkImageSubresourceRange* subresourceRange, uint32_t* width, uint32_t* height, uint32_t* depth, uint32_t bytesPerPixel, uint8_t** data);
+uint64_t UploadEngine_Flush(UploadEngine* handle);
+uint64_t UploadEngine_GetCompletedFenceValue(UploadEngine* handle);
+int UploadEngine_QueueWait(UploadEngine* handle, uint64_t* queueWaitFenceValue, VkSemaphore* semaphore, uint64_t* fenceValue);
@@ -0,0 +1,72 @@
+#include "VertexBuffer.h"
+
+ORBITAL_EXPORT VertexBuffer* Orbital_Video_Vulkan_VertexBuffer_Create(Device* device, VertexBufferMode mode)
+{
+	VertexBuffer* handle = (VertexBuffer*)calloc(1, sizeof(VertexBuffer));
+	handle->device = device;
+	handle->mode = mode;
+	return handle;
+}
+
+ORBITAL_EXPORT int Orbital_Video_Vulkan_VertexBuffer_Init(VertexBuffer* handle, void* vertices, uint64_t vertexCount, uint32_t vertexSize, VertexBufferLayout* layout)
+{
+	handle->size = vertexSize * vertexCount;
+	if (handle->mode != VertexBufferMode_GPUOptimized) return 0;
+
+	// create buffer (vertex data is immutable so it's bump allocated next to other meshes)
+	VkBufferCreateInfo bufferInfo = {0};
+	bufferInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+	bufferInfo.size = handle->size;
+	bufferInfo.usage = VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT;
+	Device_GetSharingMode(handle->device, &bufferInfo.sharingMode, &bufferInfo.queueFamilyIndexCount, &bufferInfo.pQueueFamilyIndices);
+	if (!MemoryAllocator_CreateBuffer(&handle->device->memoryAllocator, &bufferInfo, MemoryUsage_GPU, MemoryStrategy_Linear, &handle->buffer, &handle->allocation)) return 0;
+
+	// copy on transfer queue (doesn't wait for GPU, graphics queue waits on it before next submit)
+	if (vertices != NULL)
+	{
+		if (UploadEngine_UploadBuffer(&handle->device->uploadEngine, handle->buffer, vertices, handle->size) == 0) return 0;
+	}
+
+	// vertex buffer layout
+	handle->bindingDescription.binding = 0;
+	handle->bindingDescription.stride = vertexSize;
+	handle->bindingDescription.inputRate = VK_VERTEX_INPUT_RATE_VERTEX;
+	handle->attributeCount = layout->elementCount;
+	handle->attributes = (VkVertexInputAttributeDescription*)calloc(layout->elementCount, sizeof(VkVertexInputAttributeDescription));
+	for (int i = 0; i != layout->elementCount; ++i)
+	{
+		VertexBufferLayoutElement element = layout->elements[i];
+		VkVertexInputAttributeDescription* attribute = &handle->attributes[i];
+		attribute->location = i;// SPIR-V has no semantics, shaders declare inputs in layout order
+		attribute->binding = element.streamIndex;
+		attribute->offset = element.byteOffset;
+		switch (element.type)
+		{
+			case VertexBufferLayoutElementType_Float: attribute->format = VK_FORMAT_R32_SFLOAT; break;
+			case VertexBufferLayoutElementType_Float2: attribute->format = VK_FORMAT_R32G32_SFLOAT; break;
+			case VertexBufferLayoutElementType_Float3: attribute->format = VK_FORMAT_R32G32B32_SFLOAT; break;
+			case VertexBufferLayoutElementType_Float4: attribute->format = VK_FORMAT_R32G32B32A32_SFLOAT; break;
+			case VertexBufferLayoutElementType_RGBAx8: attribute->format = VK_FORMAT_R8G8B8A8_UNORM; break;
+			default: return 0;
+		}
+	}
+
+	return 1;
+}
+
+ORBITAL_EXPORT void Orbital_Video_Vulkan_VertexBuffer_Dispose(VertexBuffer* handle)
+{
+	if (handle->attributes != NULL)
+	{
+		free(handle->attributes);
+		handle->attributes = NULL;
+	}
+
+	if (handle->buffer != NULL)
+	{
+		Device_DeferDestroyBuffer(handle->device, handle->buffer, &handle->allocation);
+		handle->buffer = NULL;
+	}
+
+	free(handle);
+}
\ No newline at end of file
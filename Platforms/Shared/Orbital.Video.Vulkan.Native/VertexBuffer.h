@@ -0,0 +1,14 @@
+#pragma once
+#include "Device.h"
+
+typedef struct VertexBuffer
+{
+	Device* device;
+	VertexBufferMode mode;
+	VkBuffer buffer;
+	MemoryAllocation allocation;
+	uint64_t size;
+	VkVertexInputBindingDescription bindingDescription;
+	uint32_t attributeCount;
+	VkVertexInputAttributeDescription* attributes;// location matches element order
+} VertexBuffer;
\ No newline at end of file
@@ -0,0 +1,42 @@
+﻿using System;
+using System.Runtime.InteropServices;
+
+namespace Orbital.Video.Vulkan
+{
+	public sealed class BindingSet : BindingSetBase
+	{
+		internal IntPtr handle;
+
+		[DllImport(Instance.lib, CallingConvention = Instance.callingConvention)]
+		private static extern IntPtr Orbital_Video_Vulkan_BindingSet_Create(IntPtr device);
+
+		[DllImport(Instance.lib, CallingConvention = Instance.callingConvention)]
+		private static unsafe extern int Orbital_Video_Vulkan_BindingSet_Init(IntPtr handle, BindingSetDesc_NativeInterop* desc);
+
+		[DllImport(Instance.lib, CallingConvention = Instance.callingConvention)]
+		private static extern void Orbital_Video_Vulkan_BindingSet_Dispose(IntPtr handle);
+
+		public BindingSet(Device device)
+		{
+			handle = Orbital_Video_Vulkan_BindingSet_Create(device.handle);
+		}
+
+		public unsafe bool Init(BindingSetDesc desc)
+		{
+			ValidateInit(ref desc);
+			using (var nativeDesc = new BindingSetDesc_NativeInterop(ref desc))
+			{
+				return Orbital_Video_Vulkan_BindingSet_Init(handle, &nativeDesc) != 0;
+			}
+		}
+
+		public override void Dispose()
+		{
+			if (handle != IntPtr.Zero)
+			{
+				Orbital_Video_Vulkan_BindingSet_Dispose(handle);
+				handle = IntPtr.Zero;
+			}
+		}
+	}
+}
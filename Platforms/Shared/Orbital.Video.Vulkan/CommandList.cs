@@ -8,11 +8,16 @@ namespace Orbital.Video.Vulkan
 		public readonly Device deviceVulkan;
 		internal IntPtr handle;
 
+		/// <summary>
+		/// Queue timeline ticket of the last submission
+		/// </summary>
+		public ulong fenceTicket { get; internal set; }
+
 		[DllImport(Instance.lib, CallingConvention = Instance.callingConvention)]
 		private static extern IntPtr Orbital_Video_Vulkan_CommandList_Create(IntPtr device);
 
 		[DllImport(Instance.lib, CallingConvention = Instance.callingConvention)]
-		private static extern int Orbital_Video_Vulkan_CommandList_Init(IntPtr handle);
+		private static extern int Orbital_Video_Vulkan_CommandList_Init(IntPtr handle, CommandListType type);
 
 		[DllImport(Instance.lib, CallingConvention = Instance.callingConvention)]
 		private static extern void Orbital_Video_Vulkan_CommandList_Dispose(IntPtr handle);
@@ -20,6 +25,9 @@ namespace Orbital.Video.Vulkan
 		[DllImport(Instance.lib, CallingConvention = Instance.callingConvention)]
 		private static extern void Orbital_Video_Vulkan_CommandList_Start(IntPtr handle, IntPtr device);
 
+		[DllImport(Instance.lib, CallingConvention = Instance.callingConvention)]
+		private static extern void Orbital_Video_Vulkan_CommandList_StartBundle(IntPtr handle, IntPtr renderPass);
+
 		[DllImport(Instance.lib, CallingConvention = Instance.callingConvention)]
 		private static extern void Orbital_Video_Vulkan_CommandList_Finish(IntPtr handle);
 
@@ -33,10 +41,19 @@ namespace Orbital.Video.Vulkan
 		private static extern void Orbital_Video_Vulkan_CommandList_ClearSwapChainRenderTarget(IntPtr handle, IntPtr swapChain, float r, float g, float b, float a);
 
 		[DllImport(Instance.lib, CallingConvention = Instance.callingConvention)]
-		private static extern void Orbital_Video_Vulkan_CommandList_Execute(IntPtr handle);
+		private static extern void Orbital_Video_Vulkan_CommandList_ExecuteBundle(IntPtr handle, IntPtr bundle);
+
+		[DllImport(Instance.lib, CallingConvention = Instance.callingConvention)]
+		private static extern ulong Orbital_Video_Vulkan_CommandList_Execute(IntPtr handle);
+
+		[DllImport(Instance.lib, CallingConvention = Instance.callingConvention)]
+		private static unsafe extern void Orbital_Video_Vulkan_CommandList_SetRootConstants(IntPtr handle, uint index, void* data, uint count, uint offset);
+
+		[DllImport(Instance.lib, CallingConvention = Instance.callingConvention)]
+		private static extern void Orbital_Video_Vulkan_CommandList_SetBindingSet(IntPtr handle, IntPtr bindingSet);
 
-		internal CommandList(Device device)
-		: base(device)
+		internal CommandList(Device device, CommandListType type)
+		: base(device, type)
 		{
 			deviceVulkan = device;
 			handle = Orbital_Video_Vulkan_CommandList_Create(device.handle);
@@ -44,7 +61,7 @@ namespace Orbital.Video.Vulkan
 
 		public bool Init()
 		{
-			return Orbital_Video_Vulkan_CommandList_Init(handle) != 0;
+			return Orbital_Video_Vulkan_CommandList_Init(handle, type) != 0;
 		}
 
 		public override void Dispose()
@@ -58,9 +75,21 @@ namespace Orbital.Video.Vulkan
 
 		public override void Start()
 		{
+			if (type == CommandListType.Bundle) throw new NotSupportedException("Bundles must be started with the RenderPass they replay in");
 			Orbital_Video_Vulkan_CommandList_Start(handle, deviceVulkan.handle);
 		}
 
+		public override void Start(RenderPassBase renderPass)
+		{
+			if (type != CommandListType.Bundle)
+			{
+				Start();
+				return;
+			}
+			var renderPassVulkan = (RenderPass)renderPass;
+			Orbital_Video_Vulkan_CommandList_StartBundle(handle, renderPassVulkan.handle);
+		}
+
 		public override void Finish()
 		{
 			Orbital_Video_Vulkan_CommandList_Finish(handle);
@@ -103,19 +132,38 @@ namespace Orbital.Video.Vulkan
 			throw new NotImplementedException();
 		}
 
+		public override void SetBindingSet(BindingSetBase bindingSet)
+		{
+			var bindingSetVulkan = (BindingSet)bindingSet;
+			Orbital_Video_Vulkan_CommandList_SetBindingSet(handle, bindingSetVulkan.handle);
+		}
+
 		public override void SetVertexBuffer(VertexBufferBase vertexBuffer)
 		{
 			throw new NotImplementedException();
 		}
 
+		public override unsafe void SetRootConstants(int index, void* data, int count, int offset)
+		{
+			Orbital_Video_Vulkan_CommandList_SetRootConstants(handle, (uint)index, data, (uint)count, (uint)offset);
+		}
+
 		public override void Draw()
 		{
 			throw new NotImplementedException();
 		}
 
+		public override void ExecuteBundle(CommandListBase bundle)
+		{
+			var bundleVulkan = (CommandList)bundle;
+			if (bundleVulkan.type != CommandListType.Bundle) throw new ArgumentException("CommandList must be of type Bundle");
+			Orbital_Video_Vulkan_CommandList_ExecuteBundle(handle, bundleVulkan.handle);
+		}
+
 		public override void Execute()
 		{
-			Orbital_Video_Vulkan_CommandList_Execute(handle);
+			if (type == CommandListType.Bundle) throw new NotSupportedException("Bundles can only be replayed with ExecuteBundle");
+			fenceTicket = Orbital_Video_Vulkan_CommandList_Execute(handle);
 		}
 	}
 }
@@ -16,6 +16,12 @@ namespace Orbital.Video.Vulkan
 		[DllImport(Instance.lib, CallingConvention = Instance.callingConvention)]
 		private static extern void Orbital_Video_Vulkan_ConstantBuffer_Dispose(IntPtr handle);
 
+		[DllImport(Instance.lib, CallingConvention = Instance.callingConvention)]
+		private static unsafe extern int Orbital_Video_Vulkan_ConstantBuffer_Update(IntPtr handle, void* data, uint dataSize, uint dstOffset);
+
+		[DllImport(Instance.lib, CallingConvention = Instance.callingConvention)]
+		private static extern uint Orbital_Video_Vulkan_ConstantBuffer_GetBindlessIndex(IntPtr handle);
+
 		public ConstantBuffer(Device device, ConstantBufferMode mode)
 		{
 			handle = Orbital_Video_Vulkan_ConstantBuffer_Create(device.handle, mode);
@@ -37,7 +43,7 @@ namespace Orbital.Video.Vulkan
 		public unsafe bool Init<T>(T initialData) where T : unmanaged
 		{
 			size = Marshal.SizeOf<T>();
-			return Orbital_Video_D3D12_ConstantBuffer_Init(handle, (uint)size, &initialData) != 0;
+			return Orbital_Video_Vulkan_ConstantBuffer_Init(handle, (uint)size, &initialData) != 0;
 		}
 		#else
 		public unsafe bool Init<T>(T initialData) where T : struct
@@ -61,14 +67,33 @@ namespace Orbital.Video.Vulkan
 			}
 		}
 
-		public override bool Update<T>(T data)
+		#if CS_7_3
+		public unsafe override bool Update<T>(T data)
+		{
+			return Orbital_Video_Vulkan_ConstantBuffer_Update(handle, &data, (uint)Marshal.SizeOf<T>(), 0) != 0;
+		}
+		#else
+		public unsafe override bool Update<T>(T data)
 		{
-			throw new NotImplementedException();
+			// marshal into a stack copy as T isn't constrained to unmanaged here
+			int dataSize = Marshal.SizeOf<T>();
+			byte* ptr = stackalloc byte[dataSize];
+			Marshal.StructureToPtr(data, (IntPtr)ptr, false);
+			return Orbital_Video_Vulkan_ConstantBuffer_Update(handle, ptr, (uint)dataSize, 0) != 0;
 		}
+		#endif
 
 		public override unsafe bool Update(void* data, int dataSize, int dstOffset)
 		{
-			throw new NotImplementedException();
+			return Orbital_Video_Vulkan_ConstantBuffer_Update(handle, data, (uint)dataSize, (uint)dstOffset) != 0;
+		}
+
+		/// <summary>
+		/// Stable index into the bindless set, valid for constant buffer arrays at set 1 binding 1 (uint.MaxValue if uniform buffers can't be indexed)
+		/// </summary>
+		public int GetBindlessIndex()
+		{
+			return (int)Orbital_Video_Vulkan_ConstantBuffer_GetBindlessIndex(handle);
 		}
 	}
 }
@@ -31,6 +31,27 @@ namespace Orbital.Video.Vulkan
 		/// True to launch in fullscreen
 		/// </summary>
 		public bool fullscreen;
+
+		/// <summary>
+		/// Number of frames the CPU can record ahead of the GPU (1-3). 0 uses the default of 2
+		/// </summary>
+		public int frameCount;
+	}
+
+	/// <summary>
+	/// Usage of the device memory blocks buffers and images are suballocated from
+	/// </summary>
+	[StructLayout(LayoutKind.Sequential)]
+	public struct MemoryAllocatorStats
+	{
+		public ulong blockCount, reservedSize;
+		public ulong allocationCount, allocatedSize;
+		public ulong dedicatedCount, dedicatedSize;
+
+		/// <summary>
+		/// Live vkAllocateMemory allocations and the device limit (maxMemoryAllocationCount)
+		/// </summary>
+		public ulong deviceMemoryCount, maxDeviceMemoryCount;
 	}
 
 	public sealed class Device : DeviceBase
@@ -43,7 +64,7 @@ namespace Orbital.Video.Vulkan
 		private static extern IntPtr Orbital_Video_Vulkan_Device_Create(IntPtr Instance, DeviceType type);
 
 		[DllImport(Instance.lib, CallingConvention = Instance.callingConvention)]
-		private static extern int Orbital_Video_Vulkan_Device_Init(IntPtr handle, int adapterIndex);
+		private static extern int Orbital_Video_Vulkan_Device_Init(IntPtr handle, int adapterIndex, int frameCount);
 
 		[DllImport(Instance.lib, CallingConvention = Instance.callingConvention)]
 		private static extern void Orbital_Video_Vulkan_Device_Dispose(IntPtr handle);
@@ -54,6 +75,18 @@ namespace Orbital.Video.Vulkan
 		[DllImport(Instance.lib, CallingConvention = Instance.callingConvention)]
 		private static extern void Orbital_Video_Vulkan_Device_EndFrame(IntPtr handle);
 
+		[DllImport(Instance.lib, CallingConvention = Instance.callingConvention)]
+		private static extern void Orbital_Video_Vulkan_Device_QueueWaitForFenceTicket(IntPtr handle, CommandListType type, CommandListType ticketType, ulong ticket);
+
+		[DllImport(Instance.lib, CallingConvention = Instance.callingConvention)]
+		private static extern void Orbital_Video_Vulkan_Device_GetMemoryAllocatorStats(IntPtr handle, out MemoryAllocatorStats stats);
+
+		[DllImport(Instance.lib, CallingConvention = Instance.callingConvention)]
+		private static unsafe extern int Orbital_Video_Vulkan_Device_LoadPipelineCache(IntPtr handle, byte* data, ulong size);
+
+		[DllImport(Instance.lib, CallingConvention = Instance.callingConvention)]
+		private static unsafe extern int Orbital_Video_Vulkan_Device_SerializePipelineCache(IntPtr handle, byte* data, ulong* size);
+
 		public Device(Instance instance, DeviceType type)
 		: base(instance, type)
 		{
@@ -63,7 +96,7 @@ namespace Orbital.Video.Vulkan
 
 		public bool Init(DeviceDesc desc)
 		{
-			if (Orbital_Video_Vulkan_Device_Init(handle, desc.adapterIndex) == 0) return false;
+			if (Orbital_Video_Vulkan_Device_Init(handle, desc.adapterIndex, desc.frameCount) == 0) return false;
 			if (type == DeviceType.Presentation)
 			{
 				swapChain = new SwapChain(this, desc.ensureSwapChainMatchesWindowSize);
@@ -102,6 +135,51 @@ namespace Orbital.Video.Vulkan
 			Orbital_Video_Vulkan_Device_EndFrame(handle);
 		}
 
+		/// <summary>
+		/// Makes the next list submitted to one queue wait GPU-side for a ticket of another queue (doesn't block the CPU)
+		/// </summary>
+		/// <param name="type">Queue that waits</param>
+		/// <param name="ticketType">Queue the ticket belongs to</param>
+		public void QueueWaitForFenceTicket(CommandListType type, CommandListType ticketType, ulong ticket)
+		{
+			Orbital_Video_Vulkan_Device_QueueWaitForFenceTicket(handle, type, ticketType, ticket);
+		}
+
+		/// <summary>
+		/// Makes the next list submitted to one queue wait GPU-side for the last submission of a command list
+		/// </summary>
+		public void QueueWaitForCommandList(CommandListType type, CommandList commandList)
+		{
+			Orbital_Video_Vulkan_Device_QueueWaitForFenceTicket(handle, type, commandList.type, commandList.fenceTicket);
+		}
+
+		/// <summary>
+		/// Device memory used by buffers and images
+		/// </summary>
+		public MemoryAllocatorStats GetMemoryAllocatorStats()
+		{
+			Orbital_Video_Vulkan_Device_GetMemoryAllocatorStats(handle, out var stats);
+			return stats;
+		}
+
+		public override unsafe bool LoadPipelineCache(byte[] data)
+		{
+			if (data == null || data.Length == 0) return false;
+			fixed (byte* dataPtr = data) return Orbital_Video_Vulkan_Device_LoadPipelineCache(handle, dataPtr, (ulong)data.Length) != 0;
+		}
+
+		public override unsafe byte[] SavePipelineCache()
+		{
+			ulong size;
+			if (Orbital_Video_Vulkan_Device_SerializePipelineCache(handle, null, &size) == 0 || size == 0) return null;
+			var data = new byte[size];
+			fixed (byte* dataPtr = data)
+			{
+				if (Orbital_Video_Vulkan_Device_SerializePipelineCache(handle, dataPtr, &size) == 0) return null;
+			}
+			return data;
+		}
+
 		#region Create Methods
 		public override SwapChainBase CreateSwapChain(WindowBase window, int bufferCount, bool fullscreen, bool ensureSwapChainMatchesWindowSize)
 		{
@@ -116,7 +194,12 @@ namespace Orbital.Video.Vulkan
 
 		public override CommandListBase CreateCommandList()
 		{
-			var abstraction = new CommandList(this);
+			return CreateCommandList(CommandListType.Rasterize);
+		}
+
+		public override CommandListBase CreateCommandList(CommandListType type)
+		{
+			var abstraction = new CommandList(this, type);
 			if (!abstraction.Init())
 			{
 				abstraction.Dispose();
@@ -135,6 +218,17 @@ namespace Orbital.Video.Vulkan
 			throw new NotImplementedException();
 		}
 
+		public override BindingSetBase CreateBindingSet(BindingSetDesc desc)
+		{
+			var abstraction = new BindingSet(this);
+			if (!abstraction.Init(desc))
+			{
+				abstraction.Dispose();
+				throw new Exception("Failed to create BindingSet");
+			}
+			return abstraction;
+		}
+
 		public override ShaderEffectBase CreateShaderEffect(Stream stream, ShaderEffectSamplerAnisotropy anisotropyOverride)
 		{
 			throw new NotImplementedException();
@@ -145,34 +239,109 @@ namespace Orbital.Video.Vulkan
 			throw new NotImplementedException();
 		}
 
+		public override ShaderEffectBase CreateShaderEffect(ShaderPackBase pack, int effectIndex, ShaderEffectSamplerAnisotropy anisotropyOverride)
+		{
+			var abstraction = new ShaderEffect(this);
+			if (!abstraction.Init((ShaderPack)pack, effectIndex, anisotropyOverride))
+			{
+				abstraction.Dispose();
+				throw new Exception("Failed to create ShaderEffect");
+			}
+			return abstraction;
+		}
+
+		public override ShaderEffectBase CreateShaderEffect(ShaderPackBase pack, string name, ShaderVariantKey[] keys, ShaderEffectSamplerAnisotropy anisotropyOverride)
+		{
+			// use a precompiled permutation if the pack has one, else specialize the base effect
+			int effectIndex = pack.FindVariant(name, keys);
+			if (effectIndex >= 0) return CreateShaderEffect(pack, effectIndex, anisotropyOverride);
+			effectIndex = pack.FindEffect(name);
+			if (effectIndex < 0) throw new Exception("ShaderPack effect not found: " + name);
+
+			var abstraction = new ShaderEffect(this);
+			if (!abstraction.Init((ShaderPack)pack, effectIndex, anisotropyOverride) || !abstraction.SetSpecialization(keys))
+			{
+				abstraction.Dispose();
+				throw new Exception("Failed to create ShaderEffect");
+			}
+			return abstraction;
+		}
+
+		public override ShaderPackBase CreateShaderPack(string filename)
+		{
+			var abstraction = new ShaderPack(this);
+			if (!abstraction.Init(filename))
+			{
+				abstraction.Dispose();
+				throw new Exception("Failed to create ShaderPack");
+			}
+			return abstraction;
+		}
+
 		public override VertexBufferBase CreateVertexBuffer(int size, VertexBufferLayout layout, VertexBufferMode mode)
 		{
-			throw new NotImplementedException();
+			var abstraction = new VertexBuffer(this, mode);
+			if (!abstraction.Init(size, layout))
+			{
+				abstraction.Dispose();
+				throw new Exception("Failed to create VertexBuffer");
+			}
+			return abstraction;
 		}
 
 		public override VertexBufferBase CreateVertexBuffer<T>(T[] vertices, VertexBufferLayout layout, VertexBufferMode mode)
 		{
-			throw new NotImplementedException();
+			var abstraction = new VertexBuffer(this, mode);
+			if (!abstraction.Init<T>(vertices, layout))
+			{
+				abstraction.Dispose();
+				throw new Exception("Failed to create VertexBuffer");
+			}
+			return abstraction;
 		}
 
 		public override ConstantBufferBase CreateConstantBuffer(int size, ConstantBufferMode mode)
 		{
-			throw new NotImplementedException();
+			var abstraction = new ConstantBuffer(this, mode);
+			if (!abstraction.Init(size))
+			{
+				abstraction.Dispose();
+				throw new Exception("Failed to create ConstantBuffer");
+			}
+			return abstraction;
 		}
 
 		public override ConstantBufferBase CreateConstantBuffer<T>(ConstantBufferMode mode)
 		{
-			throw new NotImplementedException();
+			var abstraction = new ConstantBuffer(this, mode);
+			if (!abstraction.Init<T>())
+			{
+				abstraction.Dispose();
+				throw new Exception("Failed to create ConstantBuffer");
+			}
+			return abstraction;
 		}
 
 		public override ConstantBufferBase CreateConstantBuffer<T>(T initialData, ConstantBufferMode mode)
 		{
-			throw new NotImplementedException();
+			var abstraction = new ConstantBuffer(this, mode);
+			if (!abstraction.Init<T>(initialData))
+			{
+				abstraction.Dispose();
+				throw new Exception("Failed to create ConstantBuffer");
+			}
+			return abstraction;
 		}
 
 		public override Texture2DBase CreateTexture2D(TextureFormat format, int width, int height, byte[] data, TextureMode mode)
 		{
-			throw new NotImplementedException();
+			var abstraction = new Texture2D(this, mode);
+			if (!abstraction.Init(format, width, height, data))
+			{
+				abstraction.Dispose();
+				throw new Exception("Failed to create Texture2D");
+			}
+			return abstraction;
 		}
 		#endregion
 	}
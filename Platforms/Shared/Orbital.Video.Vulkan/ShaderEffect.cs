@@ -21,6 +21,12 @@ namespace Orbital.Video.Vulkan
 		[DllImport(Instance.lib, CallingConvention = Instance.callingConvention)]
 		private static unsafe extern int Orbital_Video_Vulkan_ShaderEffect_Init(IntPtr handle, IntPtr vs, IntPtr ps, IntPtr hs, IntPtr ds, IntPtr gs, ShaderEffectDesc_NativeInterop* desc);
 
+		[DllImport(Instance.lib, CallingConvention = Instance.callingConvention)]
+		private static extern int Orbital_Video_Vulkan_ShaderEffect_InitFromPack(IntPtr handle, IntPtr pack, int effectIndex, ShaderEffectSamplerAnisotropy anisotropyOverride);
+
+		[DllImport(Instance.lib, CallingConvention = Instance.callingConvention)]
+		private static unsafe extern int Orbital_Video_Vulkan_ShaderEffect_SetSpecialization(IntPtr handle, ShaderVariantKey* keys, int keyCount);
+
 		[DllImport(Instance.lib, CallingConvention = Instance.callingConvention)]
 		private static extern void Orbital_Video_Vulkan_ShaderEffect_Dispose(IntPtr handle);
 
@@ -41,6 +47,26 @@ namespace Orbital.Video.Vulkan
 			return InitFinish(ref desc);
 		}
 
+		/// <summary>
+		/// Loads effect from a shader pack, its shaders are owned by the native effect
+		/// </summary>
+		public bool Init(ShaderPack pack, int effectIndex, ShaderEffectSamplerAnisotropy anisotropyOverride)
+		{
+			if (!pack.GetEffectResourceCounts(effectIndex, out int constantBufferCount, out int textureCount)) return false;
+			this.constantBufferCount = constantBufferCount;
+			this.textureCount = textureCount;
+			return Orbital_Video_Vulkan_ShaderEffect_InitFromPack(handle, pack.handle, effectIndex, anisotropyOverride) != 0;
+		}
+
+		/// <summary>
+		/// Sets specialization constants pipelines compile the effect with
+		/// </summary>
+		public unsafe bool SetSpecialization(ShaderVariantKey[] keys)
+		{
+			if (keys == null || keys.Length == 0) return true;
+			fixed (ShaderVariantKey* keysPtr = keys) return Orbital_Video_Vulkan_ShaderEffect_SetSpecialization(handle, keysPtr, keys.Length) != 0;
+		}
+
 		protected unsafe override bool InitFinish(ref ShaderEffectDesc desc)
 		{
 			if (desc.constantBuffers != null) constantBufferCount = desc.constantBuffers.Length;
@@ -0,0 +1,20 @@
+﻿using System;
+using System.Runtime.InteropServices;
+
+namespace Orbital.Video.Vulkan
+{
+	static class Texture
+	{
+		[DllImport(Instance.lib, CallingConvention = Instance.callingConvention)]
+		public static extern IntPtr Orbital_Video_Vulkan_Texture_Create(IntPtr device, TextureMode mode);
+
+		[DllImport(Instance.lib, CallingConvention = Instance.callingConvention)]
+		public static unsafe extern int Orbital_Video_Vulkan_Texture_Init(IntPtr handle, TextureFormat format, TextureType_NativeInterop type, uint mipLevels, uint* width, uint* height, uint* depth, byte** data);
+
+		[DllImport(Instance.lib, CallingConvention = Instance.callingConvention)]
+		public static extern void Orbital_Video_Vulkan_Texture_Dispose(IntPtr handle);
+
+		[DllImport(Instance.lib, CallingConvention = Instance.callingConvention)]
+		public static extern uint Orbital_Video_Vulkan_Texture_GetBindlessIndex(IntPtr handle);
+	}
+}
@@ -0,0 +1,55 @@
+﻿using System;
+using System.Runtime.InteropServices;
+
+namespace Orbital.Video.Vulkan
+{
+	public sealed class Texture2D : Texture2DBase
+	{
+		internal IntPtr handle;
+
+		public Texture2D(Device device, TextureMode mode)
+		{
+			handle = Texture.Orbital_Video_Vulkan_Texture_Create(device.handle, mode);
+		}
+
+		public unsafe bool Init(TextureFormat format, int width, int height, byte[] data)
+		{
+			this.width = width;
+			this.height = height;
+			fixed (byte* dataPtr = data)
+			{
+				uint widthValue = (uint)width;
+				uint heightValue = (uint)height;
+				uint depthValue = 1;
+				return Texture.Orbital_Video_Vulkan_Texture_Init(handle, format, TextureType_NativeInterop._2D, 1, &widthValue, &heightValue, &depthValue, &dataPtr) != 0;
+			}
+		}
+
+		public override void Dispose()
+		{
+			if (handle != IntPtr.Zero)
+			{
+				Texture.Orbital_Video_Vulkan_Texture_Dispose(handle);
+				handle = IntPtr.Zero;
+			}
+		}
+
+		/// <summary>
+		/// Stable index into the bindless set, valid for 'Texture2D[]' at set 1 binding 0 (uint.MaxValue if descriptor indexing is unsupported)
+		/// </summary>
+		public int GetBindlessIndex()
+		{
+			return (int)Texture.Orbital_Video_Vulkan_Texture_GetBindlessIndex(handle);
+		}
+
+		public override IntPtr GetHandle()
+		{
+			return handle;
+		}
+
+		public override object GetManagedHandle()
+		{
+			return this;
+		}
+	}
+}
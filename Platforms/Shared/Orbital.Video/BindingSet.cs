@@ -0,0 +1,28 @@
+﻿using System;
+
+namespace Orbital.Video
+{
+	public struct BindingSetDesc
+	{
+		public ShaderEffectBase shaderEffect;
+		public ConstantBufferBase[] constantBuffers;
+		public TextureBase[] textures;
+	}
+
+	/// <summary>
+	/// Resources for a ShaderEffect's layout, bound separately from the pipeline state of a RenderState
+	/// </summary>
+	public abstract class BindingSetBase : IDisposable
+	{
+		public abstract void Dispose();
+
+		protected void ValidateInit(ref BindingSetDesc desc)
+		{
+			int constantBufferCount = desc.constantBuffers != null ? desc.constantBuffers.Length : 0;
+			if (desc.shaderEffect.constantBufferCount != constantBufferCount) throw new ArgumentException("BindingSet constant-buffer count doesn't match ShaderEffect requirements");
+
+			int textureCount = desc.textures != null ? desc.textures.Length : 0;
+			if (desc.shaderEffect.textureCount != textureCount) throw new ArgumentException("BindingSet texture count doesn't match ShaderEffect requirements");
+		}
+	}
+}
@@ -1,14 +1,38 @@
 ﻿using System;
+using System.Runtime.InteropServices;
 
 namespace Orbital.Video
 {
+	/// <summary>
+	/// GPU queue a command list executes on
+	/// </summary>
+	public enum CommandListType
+	{
+		/// <summary>
+		/// Graphics queue (supports all commands)
+		/// </summary>
+		Rasterize,
+
+		/// <summary>
+		/// Async compute queue (runs in parallel with rasterize work)
+		/// </summary>
+		Compute,
+
+		/// <summary>
+		/// Pre-recorded draw sequence replayed inside a render pass with 'ExecuteBundle' (record once, reuse every frame)
+		/// </summary>
+		Bundle
+	}
+
 	public abstract class CommandListBase : IDisposable
 	{
 		public readonly DeviceBase device;
+		public readonly CommandListType type;
 
-		public CommandListBase(DeviceBase device)
+		public CommandListBase(DeviceBase device, CommandListType type)
 		{
 			this.device = device;
+			this.type = type;
 		}
 
 		public abstract void Dispose();
@@ -18,6 +42,11 @@ namespace Orbital.Video
 		/// </summary>
 		public abstract void Start();
 
+		/// <summary>
+		/// Start recording a bundle replayed inside render passes compatible with 'renderPass' (clears existing commands)
+		/// </summary>
+		public abstract void Start(RenderPassBase renderPass);
+
 		/// <summary>
 		/// Finish so we can execute commands (no new commands can be added)
 		/// </summary>
@@ -58,16 +87,51 @@ namespace Orbital.Video
 		/// </summary>
 		public abstract void SetRenderState(RenderStateBase renderState);
 
+		/// <summary>
+		/// Sets constant buffers and textures without changing the pipeline state (set after a pipeline only RenderState)
+		/// </summary>
+		public abstract void SetBindingSet(BindingSetBase bindingSet);
+
 		/// <summary>
 		/// Sets vertex buffer (NOTE: RenderState will set this for you)
 		/// </summary>
 		public abstract void SetVertexBuffer(VertexBufferBase vertexBuffer);
 
+		/// <summary>
+		/// Sets 32-bit values of a root constant declared in the active render state's 'ShaderEffectDesc.rootConstants'
+		/// </summary>
+		/// <param name="index">Index into 'ShaderEffectDesc.rootConstants'</param>
+		/// <param name="count">Number of 32-bit values to set</param>
+		/// <param name="offset">First 32-bit value to set</param>
+		public unsafe abstract void SetRootConstants(int index, void* data, int count, int offset);
+
+		#if CS_7_3
+		public unsafe void SetRootConstants<T>(int index, T data) where T : unmanaged
+		{
+			SetRootConstants(index, &data, sizeof(T) / sizeof(int), 0);
+		}
+		#else
+		public unsafe void SetRootConstants<T>(int index, T data) where T : struct
+		{
+			TypedReference reference = __makeref(data);
+			byte* ptr = (byte*)*((IntPtr*)&reference);
+			#if MONO
+			ptr += Marshal.SizeOf(typeof(RuntimeTypeHandle));
+			#endif
+			SetRootConstants(index, ptr, Marshal.SizeOf<T>() / sizeof(int), 0);
+		}
+		#endif
+
 		/// <summary>
 		/// Draw actively set vertex buffer. Must first call 'SetVertexBuffer'
 		/// </summary>
 		public abstract void Draw();
 
+		/// <summary>
+		/// Replays a finished bundle inside the active render pass
+		/// </summary>
+		public abstract void ExecuteBundle(CommandListBase bundle);
+
 		/// <summary>
 		/// Executes command-list operations
 		/// </summary>
@@ -43,13 +43,30 @@ namespace Orbital.Video
 		/// </summary>
 		public abstract void EndFrame();
 
+		/// <summary>
+		/// Seeds the pipeline cache with data saved by a previous run. Call before creating render states
+		/// </summary>
+		/// <returns>False if the data is from another driver or adapter, pipelines are then compiled and cached again</returns>
+		public abstract bool LoadPipelineCache(byte[] data);
+
+		/// <summary>
+		/// Serializes compiled pipelines so the next run can load instead of compile them
+		/// </summary>
+		/// <returns>Null if nothing was cached</returns>
+		public abstract byte[] SavePipelineCache();
+
 		#region Create Methods
 		public abstract SwapChainBase CreateSwapChain(WindowBase window, int bufferCount, bool fullscreen, bool ensureSwapChainMatchesWindowSize);
 		public abstract CommandListBase CreateCommandList();
+		public abstract CommandListBase CreateCommandList(CommandListType type);
 		public abstract RenderPassBase CreateRenderPass(RenderPassDesc desc);
 		public abstract RenderStateBase CreateRenderState(RenderStateDesc desc, int gpuIndex);
+		public abstract BindingSetBase CreateBindingSet(BindingSetDesc desc);
 		public abstract ShaderEffectBase CreateShaderEffect(Stream stream, ShaderEffectSamplerAnisotropy anisotropyOverride);
 		public abstract ShaderEffectBase CreateShaderEffect(ShaderBase vs, ShaderBase ps, ShaderBase hs, ShaderBase ds, ShaderBase gs, ShaderEffectDesc desc, bool disposeShaders);
+		public abstract ShaderEffectBase CreateShaderEffect(ShaderPackBase pack, int effectIndex, ShaderEffectSamplerAnisotropy anisotropyOverride);
+		public abstract ShaderEffectBase CreateShaderEffect(ShaderPackBase pack, string name, ShaderVariantKey[] keys, ShaderEffectSamplerAnisotropy anisotropyOverride);
+		public abstract ShaderPackBase CreateShaderPack(string filename);
 		#if CS_7_3
 		public abstract VertexBufferBase CreateVertexBuffer<T>(T[] vertices, VertexBufferLayout layout, VertexBufferMode mode) where T : unmanaged;
 		public abstract ConstantBufferBase CreateConstantBuffer<T>(T initialData, ConstantBufferMode mode) where T : unmanaged;
@@ -62,5 +79,15 @@ namespace Orbital.Video
 		public abstract ConstantBufferBase CreateConstantBuffer(int size, ConstantBufferMode mode);
 		public abstract Texture2DBase CreateTexture2D(TextureFormat format, int width, int height, byte[] data, TextureMode mode);
 		#endregion
+
+		/// <summary>
+		/// Creates effect from a shader pack by name
+		/// </summary>
+		public ShaderEffectBase CreateShaderEffect(ShaderPackBase pack, string name, ShaderEffectSamplerAnisotropy anisotropyOverride)
+		{
+			int effectIndex = pack.FindEffect(name);
+			if (effectIndex < 0) throw new Exception("ShaderPack effect not found: " + name);
+			return CreateShaderEffect(pack, effectIndex, anisotropyOverride);
+		}
 	}
 }
@@ -41,25 +41,82 @@ namespace Orbital.Video.Vulkan
 		public VertexBufferTopology vertexBufferTopology;
 		public byte depthEnable, stencilEnable;
 		public int msaaLevel;
+		public byte compileAsync;
+		public int compilePriority;
+		public IntPtr fallback;
 
 		public RenderStateDesc_NativeInterop(ref RenderStateDesc desc)
 		{
 			renderPass = ((RenderPass)desc.renderPass).handle;
 			shaderEffect = ((ShaderEffect)desc.shaderEffect).handle;
 
-			constantBufferCount = desc.constantBuffers.Length;
-			constantBuffers = (IntPtr*)Marshal.AllocHGlobal(Marshal.SizeOf<IntPtr>() * constantBufferCount);
-			for (int i = 0; i != constantBufferCount; ++i) constantBuffers[i] = ((ConstantBuffer)desc.constantBuffers[i]).handle;
-
-			textureCount = desc.textures.Length;
-			textures = (IntPtr*)Marshal.AllocHGlobal(Marshal.SizeOf<IntPtr>() * textureCount);
-			for (int i = 0; i != textureCount; ++i) textures[i] = desc.textures[i].GetHandle();
+			// resources are left out of pipeline only states
+			BindingSetDesc_NativeInterop.InitResources(desc.constantBuffers, desc.textures, out constantBufferCount, out constantBuffers, out textureCount, out textures);
 
 			vertexBuffer = ((VertexBuffer)desc.vertexBuffer).handle;
 			vertexBufferTopology = desc.vertexBufferTopology;
 			depthEnable = (byte)(desc.depthEnable ? 1 : 0);
 			stencilEnable = (byte)(desc.stencilEnable ? 1 : 0);
 			msaaLevel = desc.msaaLevel;
+			compileAsync = (byte)(desc.compileAsync ? 1 : 0);
+			compilePriority = desc.compilePriority;
+			#if D3D12
+			fallback = desc.fallback != null ? ((RenderState)desc.fallback).handle : IntPtr.Zero;
+			#else
+			fallback = IntPtr.Zero;// no native render states yet
+			#endif
+		}
+
+		public void Dispose()
+		{
+			if (constantBuffers != null)
+			{
+				Marshal.FreeHGlobal((IntPtr)constantBuffers);
+				constantBuffers = null;
+			}
+
+			if (textures != null)
+			{
+				Marshal.FreeHGlobal((IntPtr)textures);
+				textures = null;
+			}
+		}
+	}
+
+	[StructLayout(LayoutKind.Sequential)]
+	unsafe struct BindingSetDesc_NativeInterop : IDisposable
+	{
+		public IntPtr shaderEffect;
+		public int constantBufferCount;
+		public IntPtr* constantBuffers;
+		public int textureCount;
+		public IntPtr* textures;
+
+		public BindingSetDesc_NativeInterop(ref BindingSetDesc desc)
+		{
+			shaderEffect = ((ShaderEffect)desc.shaderEffect).handle;
+			InitResources(desc.constantBuffers, desc.textures, out constantBufferCount, out constantBuffers, out textureCount, out textures);
+		}
+
+		internal static void InitResources(ConstantBufferBase[] constantBufferArray, TextureBase[] textureArray, out int constantBufferCount, out IntPtr* constantBuffers, out int textureCount, out IntPtr* textures)
+		{
+			constantBufferCount = 0;
+			constantBuffers = null;
+			if (constantBufferArray != null && constantBufferArray.Length != 0)
+			{
+				constantBufferCount = constantBufferArray.Length;
+				constantBuffers = (IntPtr*)Marshal.AllocHGlobal(Marshal.SizeOf<IntPtr>() * constantBufferCount);
+				for (int i = 0; i != constantBufferCount; ++i) constantBuffers[i] = ((ConstantBuffer)constantBufferArray[i]).handle;
+			}
+
+			textureCount = 0;
+			textures = null;
+			if (textureArray != null && textureArray.Length != 0)
+			{
+				textureCount = textureArray.Length;
+				textures = (IntPtr*)Marshal.AllocHGlobal(Marshal.SizeOf<IntPtr>() * textureCount);
+				for (int i = 0; i != textureCount; ++i) textures[i] = textureArray[i].GetHandle();
+			}
 		}
 
 		public void Dispose()
@@ -152,6 +209,20 @@ namespace Orbital.Video.Vulkan
 		public ShaderEffectResourceUsage usage;
 	}
 
+	[StructLayout(LayoutKind.Sequential)]
+	struct ShaderEffectRootShaderResource_NativeInterop
+	{
+		public int registerIndex;
+		public ShaderEffectResourceUsage usage;
+	}
+
+	[StructLayout(LayoutKind.Sequential)]
+	struct ShaderEffectRootConstant_NativeInterop
+	{
+		public int registerIndex, count;
+		public ShaderEffectResourceUsage usage;
+	}
+
 	[StructLayout(LayoutKind.Sequential)]
 	struct ShaderEffectSampler_NativeInterop
 	{
@@ -164,10 +235,13 @@ namespace Orbital.Video.Vulkan
 	[StructLayout(LayoutKind.Sequential)]
 	unsafe struct ShaderEffectDesc_NativeInterop : IDisposable
 	{
-		public int constantBufferCount, textureCount, samplersCount;
+		public int constantBufferCount, textureCount, samplersCount, rootConstantBufferCount, rootShaderResourceCount, rootConstantCount;
 		public ShaderEffectConstantBuffer_NativeInterop* constantBuffers;
 		public ShaderEffectTexture_NativeInterop* textures;
 		public ShaderEffectSampler_NativeInterop* samplers;
+		public ShaderEffectConstantBuffer_NativeInterop* rootConstantBuffers;
+		public ShaderEffectRootShaderResource_NativeInterop* rootShaderResources;
+		public ShaderEffectRootConstant_NativeInterop* rootConstants;
 
 		public ShaderEffectDesc_NativeInterop(ref ShaderEffectDesc desc)
 		{
@@ -175,9 +249,15 @@ namespace Orbital.Video.Vulkan
 			constantBufferCount = 0;
 			textureCount = 0;
 			samplersCount = 0;
+			rootConstantBufferCount = 0;
+			rootShaderResourceCount = 0;
+			rootConstantCount = 0;
 			constantBuffers = null;
 			textures = null;
 			samplers = null;
+			rootConstantBuffers = null;
+			rootShaderResources = null;
+			rootConstants = null;
 
 			// allocate constant buffer heaps
 			if (desc.constantBuffers != null)
@@ -218,6 +298,43 @@ namespace Orbital.Video.Vulkan
 					samplers[i].anisotropy = desc.samplers[i].anisotropy;
 				}
 			}
+
+			// allocate root constant buffers
+			if (desc.rootConstantBuffers != null)
+			{
+				rootConstantBufferCount = desc.rootConstantBuffers.Length;
+				rootConstantBuffers = (ShaderEffectConstantBuffer_NativeInterop*)Marshal.AllocHGlobal(Marshal.SizeOf<ShaderEffectConstantBuffer_NativeInterop>() * rootConstantBufferCount);
+				for (int i = 0; i != rootConstantBufferCount; ++i)
+				{
+					rootConstantBuffers[i].registerIndex = desc.rootConstantBuffers[i].registerIndex;
+					rootConstantBuffers[i].usage = desc.rootConstantBuffers[i].usage;
+				}
+			}
+
+			// allocate root shader resources
+			if (desc.rootShaderResources != null)
+			{
+				rootShaderResourceCount = desc.rootShaderResources.Length;
+				rootShaderResources = (ShaderEffectRootShaderResource_NativeInterop*)Marshal.AllocHGlobal(Marshal.SizeOf<ShaderEffectRootShaderResource_NativeInterop>() * rootShaderResourceCount);
+				for (int i = 0; i != rootShaderResourceCount; ++i)
+				{
+					rootShaderResources[i].registerIndex = desc.rootShaderResources[i].registerIndex;
+					rootShaderResources[i].usage = desc.rootShaderResources[i].usage;
+				}
+			}
+
+			// allocate root constants
+			if (desc.rootConstants != null)
+			{
+				rootConstantCount = desc.rootConstants.Length;
+				rootConstants = (ShaderEffectRootConstant_NativeInterop*)Marshal.AllocHGlobal(Marshal.SizeOf<ShaderEffectRootConstant_NativeInterop>() * rootConstantCount);
+				for (int i = 0; i != rootConstantCount; ++i)
+				{
+					rootConstants[i].registerIndex = desc.rootConstants[i].registerIndex;
+					rootConstants[i].count = desc.rootConstants[i].count;
+					rootConstants[i].usage = desc.rootConstants[i].usage;
+				}
+			}
 		}
 
 		public void Dispose()
@@ -239,6 +356,24 @@ namespace Orbital.Video.Vulkan
 				Marshal.FreeHGlobal((IntPtr)samplers);
 				samplers = null;
 			}
+
+			if (rootConstantBuffers != null)
+			{
+				Marshal.FreeHGlobal((IntPtr)rootConstantBuffers);
+				rootConstantBuffers = null;
+			}
+
+			if (rootShaderResources != null)
+			{
+				Marshal.FreeHGlobal((IntPtr)rootShaderResources);
+				rootShaderResources = null;
+			}
+
+			if (rootConstants != null)
+			{
+				Marshal.FreeHGlobal((IntPtr)rootConstants);
+				rootConstants = null;
+			}
 		}
 	}
 	#endregion
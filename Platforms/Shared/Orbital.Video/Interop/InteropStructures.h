@@ -8,6 +8,15 @@ typedef struct RenderPassDesc
 	float depthValue, stencilValue;
 }RenderPassDesc;
 
+#pragma region Command List
+typedef enum CommandListType
+{
+	CommandListType_Rasterize,
+	CommandListType_Compute,
+	CommandListType_Bundle
+}CommandListType;
+#pragma endregion
+
 #pragma region Texture
 typedef enum TextureMode
 {
@@ -99,6 +108,13 @@ typedef struct VertexBufferLayout
 #pragma endregion
 
 #pragma region Render State
+typedef enum RenderStateStatus
+{
+	RenderStateStatus_Ready,
+	RenderStateStatus_Compiling,
+	RenderStateStatus_Failed
+}RenderStateStatus;
+
 typedef struct RenderStateDesc
 {
 	void* renderPass;
@@ -111,7 +127,19 @@ typedef struct RenderStateDesc
 	VertexBufferTopology vertexBufferTopology;
 	char depthEnable, stencilEnable;
 	int msaaLevel;
+	char compileAsync;
+	int compilePriority;
+	void* fallback;
 }RenderStateDesc;
+
+typedef struct BindingSetDesc
+{
+	void* shaderEffect;
+	int constantBufferCount;
+	intptr_t* constantBuffers;
+	int textureCount;
+	intptr_t* textures;
+}BindingSetDesc;
 #pragma endregion
 
 #pragma region Shaders
@@ -146,6 +174,18 @@ typedef struct ShaderEffectTexture
 	ShaderEffectResourceUsage usage;
 }ShaderEffectTexture;
 
+typedef struct ShaderEffectRootShaderResource
+{
+	int registerIndex;
+	ShaderEffectResourceUsage usage;
+}ShaderEffectRootShaderResource;
+
+typedef struct ShaderEffectRootConstant
+{
+	int registerIndex, count;// count of 32-bit values
+	ShaderEffectResourceUsage usage;
+}ShaderEffectRootConstant;
+
 typedef enum ShaderEffectSamplerFilter
 {
 	ShaderEffectSamplerFilter_Default,
@@ -180,9 +220,61 @@ typedef struct ShaderEffectSampler
 
 typedef struct ShaderEffectDesc
 {
-	int constantBufferCount, textureCount, samplersCount;
+	int constantBufferCount, textureCount, samplersCount, rootConstantBufferCount, rootShaderResourceCount, rootConstantCount;
 	ShaderEffectConstantBuffer* constantBuffers;
 	ShaderEffectTexture* textures;
 	ShaderEffectSampler* samplers;
+	ShaderEffectConstantBuffer* rootConstantBuffers;
+	ShaderEffectRootShaderResource* rootShaderResources;
+	ShaderEffectRootConstant* rootConstants;
 }ShaderEffectDesc;
+
+// Vulkan specialization constant (constant_id) or precompiled D3D12 permutation define
+typedef struct ShaderVariantKey
+{
+	int id, value;
+}ShaderVariantKey;
+#pragma endregion
+
+#pragma region Shader Pack
+#define SHADER_PACK_MAGIC 0x4B505348// "HSPK"
+#define SHADER_PACK_VERSION 2
+#define SHADER_PACK_ALIGNMENT 16// every section starts aligned so mapped SPIR-V words and desc arrays can be used in place
+#define SHADER_PACK_STAGE_COUNT 5// indexed by ShaderType
+
+typedef enum ShaderPackBytecode
+{
+	ShaderPackBytecode_DXIL,
+	ShaderPackBytecode_SPIRV,
+	ShaderPackBytecode_Count
+}ShaderPackBytecode;
+
+// bytes from the start of the pack, size is 0 if absent
+typedef struct ShaderPackRange
+{
+	uint64_t offset, size;
+}ShaderPackRange;
+
+typedef struct ShaderPackHeader
+{
+	uint32_t magic, version;
+	uint32_t effectCount, reserved;
+	uint64_t effectsOffset;// ShaderPackEffect table sorted by name hash then variant hash
+}ShaderPackHeader;
+
+typedef struct ShaderPackEffect
+{
+	uint64_t nameHash;// FNV-1a of the UTF-16 name
+	uint64_t variantHash;// FNV-1a of the ShaderVariantKey values sorted by id, 0 for the base permutation
+	ShaderPackRange name;// UTF-16, not null terminated
+	ShaderPackRange bytecode[ShaderPackBytecode_Count][SHADER_PACK_STAGE_COUNT];
+
+	// ShaderEffectDesc arrays stored with their native layout
+	int constantBufferCount, textureCount, samplersCount, rootConstantBufferCount, rootShaderResourceCount, rootConstantCount;
+	uint64_t constantBuffersOffset, texturesOffset, samplersOffset, rootConstantBuffersOffset, rootShaderResourcesOffset, rootConstantsOffset;
+
+	// D3D12 serialized root signature, used if the device picks the same version and bindless tables
+	ShaderPackRange rootSignature;
+	uint32_t rootSignatureVersion, rootSignatureBindlessTableCount;
+}ShaderPackEffect;
 #pragma endregion
\ No newline at end of file
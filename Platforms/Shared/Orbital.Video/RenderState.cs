@@ -2,24 +2,63 @@
 
 namespace Orbital.Video
 {
+	public enum RenderStateStatus
+	{
+		Ready,
+		Compiling,
+		Failed
+	}
+
 	public struct RenderStateDesc
 	{
 		public RenderPassBase renderPass;
 		public ShaderEffectBase shaderEffect;
+
+		/// <summary>
+		/// Leave both null to create a pipeline only state and bind resources with 'CommandListBase.SetBindingSet'
+		/// </summary>
 		public ConstantBufferBase[] constantBuffers;
 		public TextureBase[] textures;
 		public VertexBufferBase vertexBuffer;
 		public VertexBufferTopology vertexBufferTopology;
 		public bool depthEnable, stencilEnable;
 		public int msaaLevel;
+
+		/// <summary>
+		/// Create returns before the pipeline is compiled on a worker thread, check 'RenderStateBase.GetStatus'
+		/// </summary>
+		public bool compileAsync;
+
+		/// <summary>
+		/// Higher compiles first (visible materials)
+		/// </summary>
+		public int compilePriority;
+
+		/// <summary>
+		/// Bound in place of this state until it is ready, draws are skipped if null. Must outlive this state
+		/// </summary>
+		public RenderStateBase fallback;
 	}
 
 	public abstract class RenderStateBase : IDisposable
 	{
 		public abstract void Dispose();
 
+		/// <summary>
+		/// Compiling until an async pipeline is ready to draw with
+		/// </summary>
+		public abstract RenderStateStatus GetStatus();
+
+		/// <summary>
+		/// Moves a still queued async compile ahead of or behind others
+		/// </summary>
+		public abstract void SetCompilePriority(int priority);
+
 		protected void ValidateInit(ref RenderStateDesc desc)
 		{
+			// pipeline only state, resources come from a BindingSet
+			if (desc.constantBuffers == null && desc.textures == null) return;
+
 			int constantBufferCount = desc.constantBuffers != null ? desc.constantBuffers.Length : 0;
 			if (desc.shaderEffect.constantBufferCount != constantBufferCount) throw new ArgumentException("RenderState constant-buffer count doesn't match ShaderEffect requirements");
 
@@ -64,6 +64,37 @@ namespace Orbital.Video
 		public ShaderEffectResourceUsage usage;
 	}
 
+	public struct ShaderEffectRootShaderResource
+	{
+		/// <summary>
+		/// Register index of the buffer (raw or structured, textures need a descriptor table)
+		/// </summary>
+		public int registerIndex;
+
+		/// <summary>
+		/// Shader types the buffer is used in
+		/// </summary>
+		public ShaderEffectResourceUsage usage;
+	}
+
+	public struct ShaderEffectRootConstant
+	{
+		/// <summary>
+		/// Register index of the constant buffer the values appear as (push constant block in Vulkan)
+		/// </summary>
+		public int registerIndex;
+
+		/// <summary>
+		/// Number of 32-bit values
+		/// </summary>
+		public int count;
+
+		/// <summary>
+		/// Shader types the constants are used in
+		/// </summary>
+		public ShaderEffectResourceUsage usage;
+	}
+
 	public enum ShaderEffectSamplerFilter
 	{
 		/// <summary>
@@ -161,6 +192,101 @@ namespace Orbital.Video
 		public ShaderEffectConstantBuffer[] constantBuffers;
 		public ShaderEffectTexture[] textures;
 		public ShaderEffectSampler[] samplers;
+
+		/// <summary>
+		/// Constant buffers bound directly from a GPU address per draw (no descriptor copies)
+		/// NOTE: D3D12 only, Vulkan effects fail to init when any are set
+		/// </summary>
+		public ShaderEffectConstantBuffer[] rootConstantBuffers;
+
+		/// <summary>
+		/// Buffers bound directly from a GPU address per draw
+		/// NOTE: D3D12 only, Vulkan effects fail to init when any are set
+		/// </summary>
+		public ShaderEffectRootShaderResource[] rootShaderResources;
+
+		/// <summary>
+		/// 32-bit values set per draw with 'CommandListBase.SetRootConstants'
+		/// </summary>
+		public ShaderEffectRootConstant[] rootConstants;
+	}
+
+	/// <summary>
+	/// Feature switch of an uber-shader variant (Vulkan specialization constant or precompiled D3D12 permutation)
+	/// </summary>
+	public struct ShaderVariantKey
+	{
+		/// <summary>
+		/// Specialization constant id (must match the one the permutation was compiled with)
+		/// </summary>
+		public int id;
+
+		/// <summary>
+		/// Int value, bools are 0 or 1
+		/// </summary>
+		public int value;
+
+		public ShaderVariantKey(int id, int value)
+		{
+			this.id = id;
+			this.value = value;
+		}
+
+		public ShaderVariantKey(int id, bool value)
+		{
+			this.id = id;
+			this.value = value ? 1 : 0;
+		}
+
+		/// <summary>
+		/// Copy of the keys sorted by id, null if there are none (base permutation)
+		/// </summary>
+		public static ShaderVariantKey[] Sort(ShaderVariantKey[] keys)
+		{
+			if (keys == null || keys.Length == 0) return null;
+			var ids = new int[keys.Length];
+			var sorted = (ShaderVariantKey[])keys.Clone();
+			for (int i = 0; i != keys.Length; ++i) ids[i] = keys[i].id;
+			Array.Sort(ids, sorted);
+
+			// a permutation can't be compiled with two values for one constant
+			for (int i = 1; i != sorted.Length; ++i)
+			{
+				if (sorted[i].id == sorted[i - 1].id) throw new ArgumentException("Duplicate ShaderVariantKey id: " + sorted[i].id.ToString());
+			}
+			return sorted;
+		}
+
+		/// <summary>
+		/// FNV-1a of the keys sorted by id, 0 if there are none (base permutation)
+		/// </summary>
+		public static ulong Hash(ShaderVariantKey[] keys)
+		{
+			return HashSorted(Sort(keys));
+		}
+
+		/// <summary>
+		/// Same as 'Hash' for keys already returned by 'Sort'
+		/// </summary>
+		public static ulong HashSorted(ShaderVariantKey[] sortedKeys)
+		{
+			if (sortedKeys == null || sortedKeys.Length == 0) return 0;
+			ulong hash = 14695981039346656037;
+			for (int i = 0; i != sortedKeys.Length; ++i)
+			{
+				for (int b = 0; b != 32; b += 8)
+				{
+					hash ^= (byte)(sortedKeys[i].id >> b);
+					hash *= 1099511628211;
+				}
+				for (int b = 0; b != 32; b += 8)
+				{
+					hash ^= (byte)(sortedKeys[i].value >> b);
+					hash *= 1099511628211;
+				}
+			}
+			return hash;
+		}
 	}
 
 	public abstract class ShaderEffectBase : IDisposable
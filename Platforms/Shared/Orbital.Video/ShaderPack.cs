@@ -0,0 +1,361 @@
+﻿using System;
+using System.IO;
+
+namespace Orbital.Video
+{
+	/// <summary>
+	/// Effect to be written into a shader pack
+	/// </summary>
+	public class ShaderPackEntry
+	{
+		/// <summary>
+		/// Name the effect is looked up by
+		/// </summary>
+		public string name;
+
+		/// <summary>
+		/// Keys the bytecode was compiled with, null for the base permutation
+		/// </summary>
+		public ShaderVariantKey[] variantKeys;
+
+		/// <summary>
+		/// Bytecode indexed by ShaderType, null if the stage is unused
+		/// </summary>
+		public byte[][] dxil, spirv;
+
+		public ShaderEffectDesc desc;
+
+		/// <summary>
+		/// D3D12 root signature from 'ShaderEffect.GetSerializedRootSignature' (optional)
+		/// </summary>
+		public byte[] rootSignature;
+		public int rootSignatureVersion, rootSignatureBindlessTableCount;
+
+		public ShaderPackEntry(string name)
+		{
+			this.name = name;
+			dxil = new byte[ShaderPackWriter.stageCount][];
+			spirv = new byte[ShaderPackWriter.stageCount][];
+		}
+	}
+
+	/// <summary>
+	/// Writes the shader pack format loaded by 'DeviceBase.CreateShaderPack' (layout in InteropStructures.h)
+	/// </summary>
+	public static class ShaderPackWriter
+	{
+		internal const int stageCount = 5;
+		private const uint magic = 0x4B505348, version = 2;
+		private const int alignment = 16, headerSize = 24, effectSize = 288;
+
+		private struct Range
+		{
+			public ulong offset, size;
+		}
+
+		/// <summary>
+		/// FNV-1a of the UTF-16 name
+		/// </summary>
+		public static ulong HashName(string name)
+		{
+			ulong hash = 14695981039346656037;
+			for (int i = 0; i != name.Length; ++i)
+			{
+				hash ^= (byte)name[i];
+				hash *= 1099511628211;
+				hash ^= (byte)(name[i] >> 8);
+				hash *= 1099511628211;
+			}
+			return hash;
+		}
+
+		private static void Align(BinaryWriter writer)
+		{
+			while ((writer.BaseStream.Position % alignment) != 0) writer.Write((byte)0);
+		}
+
+		private static Range WriteBytes(BinaryWriter writer, byte[] data)
+		{
+			var range = new Range();
+			if (data == null || data.Length == 0) return range;
+			Align(writer);
+			range.offset = (ulong)writer.BaseStream.Position;
+			range.size = (ulong)data.Length;
+			writer.Write(data);
+			return range;
+		}
+
+		private static void WriteRange(BinaryWriter writer, Range range)
+		{
+			writer.Write(range.offset);
+			writer.Write(range.size);
+		}
+
+		private static int Count(Array array)
+		{
+			return array != null ? array.Length : 0;
+		}
+
+		public static void Write(Stream stream, ShaderPackEntry[] entries)
+		{
+			// sort by name then variant hash so loaders can binary search
+			var sorted = (ShaderPackEntry[])entries.Clone();
+			var hashes = new ulong[sorted.Length];
+			var variantHashes = new ulong[sorted.Length];
+			for (int i = 0; i != sorted.Length; ++i)
+			{
+				var entry = sorted[i];
+				ulong hash = HashName(entry.name);
+				ulong variantHash = ShaderVariantKey.Hash(entry.variantKeys);
+				int s = i;
+				for (; s != 0 && (hashes[s - 1] > hash || (hashes[s - 1] == hash && variantHashes[s - 1] > variantHash)); --s)
+				{
+					sorted[s] = sorted[s - 1];
+					hashes[s] = hashes[s - 1];
+					variantHashes[s] = variantHashes[s - 1];
+				}
+				sorted[s] = entry;
+				hashes[s] = hash;
+				variantHashes[s] = variantHash;
+			}
+
+			using (var data = new MemoryStream())
+			using (var writer = new BinaryWriter(data))
+			{
+				// sections follow the effect table
+				long effectsOffset = ((headerSize + alignment - 1) / alignment) * alignment;
+				data.SetLength(effectsOffset + (effectSize * sorted.Length));
+				data.Position = data.Length;
+				for (int i = 0; i != sorted.Length; ++i)
+				{
+					var entry = sorted[i];
+					var desc = entry.desc;
+					var nameData = new byte[entry.name.Length * sizeof(char)];
+					for (int c = 0; c != entry.name.Length; ++c)
+					{
+						nameData[c * 2] = (byte)entry.name[c];
+						nameData[(c * 2) + 1] = (byte)(entry.name[c] >> 8);
+					}
+					var name = WriteBytes(writer, nameData);
+
+					var bytecode = new Range[stageCount * 2];
+					for (int s = 0; s != stageCount; ++s)
+					{
+						if (entry.dxil != null && s < entry.dxil.Length) bytecode[s] = WriteBytes(writer, entry.dxil[s]);
+						if (entry.spirv != null && s < entry.spirv.Length) bytecode[stageCount + s] = WriteBytes(writer, entry.spirv[s]);
+					}
+
+					// desc arrays use the native struct layouts
+					ulong constantBuffersOffset = 0, texturesOffset = 0, samplersOffset = 0, rootConstantBuffersOffset = 0, rootShaderResourcesOffset = 0, rootConstantsOffset = 0;
+					if (Count(desc.constantBuffers) != 0)
+					{
+						Align(writer);
+						constantBuffersOffset = (ulong)data.Position;
+						foreach (var constantBuffer in desc.constantBuffers)
+						{
+							writer.Write(constantBuffer.registerIndex);
+							writer.Write((int)constantBuffer.usage);
+						}
+					}
+					if (Count(desc.textures) != 0)
+					{
+						Align(writer);
+						texturesOffset = (ulong)data.Position;
+						foreach (var texture in desc.textures)
+						{
+							writer.Write(texture.registerIndex);
+							writer.Write((int)texture.usage);
+						}
+					}
+					if (Count(desc.samplers) != 0)
+					{
+						Align(writer);
+						samplersOffset = (ulong)data.Position;
+						foreach (var sampler in desc.samplers)
+						{
+							writer.Write(sampler.registerIndex);
+							writer.Write((int)sampler.filter);
+							writer.Write((int)sampler.anisotropy);
+							writer.Write((int)sampler.addressU);
+							writer.Write((int)sampler.addressV);
+							writer.Write((int)sampler.addressW);
+						}
+					}
+					if (Count(desc.rootConstantBuffers) != 0)
+					{
+						Align(writer);
+						rootConstantBuffersOffset = (ulong)data.Position;
+						foreach (var constantBuffer in desc.rootConstantBuffers)
+						{
+							writer.Write(constantBuffer.registerIndex);
+							writer.Write((int)constantBuffer.usage);
+						}
+					}
+					if (Count(desc.rootShaderResources) != 0)
+					{
+						Align(writer);
+						rootShaderResourcesOffset = (ulong)data.Position;
+						foreach (var resource in desc.rootShaderResources)
+						{
+							writer.Write(resource.registerIndex);
+							writer.Write((int)resource.usage);
+						}
+					}
+					if (Count(desc.rootConstants) != 0)
+					{
+						Align(writer);
+						rootConstantsOffset = (ulong)data.Position;
+						foreach (var constant in desc.rootConstants)
+						{
+							writer.Write(constant.registerIndex);
+							writer.Write(constant.count);
+							writer.Write((int)constant.usage);
+						}
+					}
+
+					var rootSignature = WriteBytes(writer, entry.rootSignature);
+					long end = data.Position;
+
+					// write table entry
+					data.Position = effectsOffset + (effectSize * i);
+					writer.Write(hashes[i]);
+					writer.Write(variantHashes[i]);
+					WriteRange(writer, name);
+					foreach (var range in bytecode) WriteRange(writer, range);
+					writer.Write(Count(desc.constantBuffers));
+					writer.Write(Count(desc.textures));
+					writer.Write(Count(desc.samplers));
+					writer.Write(Count(desc.rootConstantBuffers));
+					writer.Write(Count(desc.rootShaderResources));
+					writer.Write(Count(desc.rootConstants));
+					writer.Write(constantBuffersOffset);
+					writer.Write(texturesOffset);
+					writer.Write(samplersOffset);
+					writer.Write(rootConstantBuffersOffset);
+					writer.Write(rootShaderResourcesOffset);
+					writer.Write(rootConstantsOffset);
+					WriteRange(writer, rootSignature);
+					writer.Write((uint)entry.rootSignatureVersion);
+					writer.Write((uint)entry.rootSignatureBindlessTableCount);
+					data.Position = end;
+				}
+
+				// write header
+				data.Position = 0;
+				writer.Write(magic);
+				writer.Write(version);
+				writer.Write((uint)sorted.Length);
+				writer.Write((uint)0);
+				writer.Write((ulong)effectsOffset);
+				writer.Flush();
+				data.WriteTo(stream);
+			}
+		}
+	}
+
+	/// <summary>
+	/// Memory mapped shader pack, effects are only read when created from it
+	/// </summary>
+	public abstract class ShaderPackBase : IDisposable
+	{
+		public int effectCount { get; protected set; }
+
+		public abstract void Dispose();
+
+		/// <summary>
+		/// Finds effect index by name
+		/// </summary>
+		/// <returns>-1 if not found</returns>
+		public int FindEffect(string name)
+		{
+			return FindEffect(name, 0);
+		}
+
+		/// <summary>
+		/// Finds index of the permutation compiled with the keys
+		/// </summary>
+		/// <returns>-1 if not found</returns>
+		public int FindVariant(string name, ShaderVariantKey[] keys)
+		{
+			return FindEffect(name, ShaderVariantKey.Hash(keys));
+		}
+
+		/// <summary>
+		/// Finds effect index by name and 'ShaderVariantKey.Hash'
+		/// </summary>
+		/// <returns>-1 if not found</returns>
+		public abstract int FindEffect(string name, ulong variantHash);
+	}
+
+	/// <summary>
+	/// Variants of one shader pack effect, each created on first use then reused (not thread safe)
+	/// </summary>
+	public sealed class ShaderEffectVariants : IDisposable
+	{
+		public readonly DeviceBase device;
+		public readonly ShaderPackBase pack;
+		public readonly string name;
+		public readonly ShaderEffectSamplerAnisotropy anisotropyOverride;
+
+		private ulong[] hashes;
+		private ShaderVariantKey[][] sortedKeys;// compared on hash match
+		private ShaderEffectBase[] effects;
+		public int variantCount { get; private set; }
+
+		public ShaderEffectVariants(DeviceBase device, ShaderPackBase pack, string name, ShaderEffectSamplerAnisotropy anisotropyOverride)
+		{
+			this.device = device;
+			this.pack = pack;
+			this.name = name;
+			this.anisotropyOverride = anisotropyOverride;
+			hashes = new ulong[4];
+			sortedKeys = new ShaderVariantKey[4][];
+			effects = new ShaderEffectBase[4];
+		}
+
+		private static bool KeysEqual(ShaderVariantKey[] a, ShaderVariantKey[] b)
+		{
+			int count = a != null ? a.Length : 0;
+			if ((b != null ? b.Length : 0) != count) return false;
+			for (int i = 0; i != count; ++i)
+			{
+				if (a[i].id != b[i].id || a[i].value != b[i].value) return false;
+			}
+			return true;
+		}
+
+		public ShaderEffectBase GetVariant(params ShaderVariantKey[] keys)
+		{
+			var sorted = ShaderVariantKey.Sort(keys);
+			ulong hash = ShaderVariantKey.HashSorted(sorted);
+			for (int i = 0; i != variantCount; ++i)
+			{
+				if (hashes[i] == hash && KeysEqual(sortedKeys[i], sorted)) return effects[i];
+			}
+
+			var effect = device.CreateShaderEffect(pack, name, keys, anisotropyOverride);
+			if (variantCount == effects.Length)
+			{
+				Array.Resize(ref hashes, variantCount * 2);
+				Array.Resize(ref sortedKeys, variantCount * 2);
+				Array.Resize(ref effects, variantCount * 2);
+			}
+			hashes[variantCount] = hash;
+			sortedKeys[variantCount] = sorted;
+			effects[variantCount] = effect;
+			++variantCount;
+			return effect;
+		}
+
+		public void Dispose()
+		{
+			for (int i = 0; i != variantCount; ++i)
+			{
+				effects[i].Dispose();
+				effects[i] = null;
+				sortedKeys[i] = null;
+			}
+			variantCount = 0;
+		}
+	}
+}
@@ -27,7 +27,14 @@ namespace Orbital.Demo.Win32
 				#else
 				throw new NotImplementedException();
 				#endif
+				#if !CS2X
+				if (args.Length != 0 && args[0] == "-benchmark-recording") example.BenchmarkRecording(20000, Environment.ProcessorCount, 60);
+				else if (args.Length != 0 && args[0] == "-benchmark-frames-in-flight") example.BenchmarkFramesInFlight(300);
+				else if (args.Length != 0 && args[0] == "-validate-split-barriers") example.ValidateSplitBarriers(120);
+				else example.Run();
+				#else
 				example.Run();
+				#endif
 			}
 		}
 	}